@@ -451,7 +451,6 @@ std::string save_generated_json(const std::string &json_content, const std::stri
 // ============================================
 std::string generate_linear_chain_json(int num_objects, int object_size, size_t heap_size)
 {
-    (void)object_size;
     std::stringstream json;
     json << "{\n";
     json << "  \"name\": \"Generated Linear Chain\",\n";
@@ -460,21 +459,10 @@ std::string generate_linear_chain_json(int num_objects, int object_size, size_t
     json << "  \"heap_size\": " << heap_size << ",\n";
     json << "  \"operations\": [\n";
 
-    for (int i = 0; i < num_objects; ++i)
-    {
-        json << "    { \"op\": \"allocate\", \"id\": " << i << " }";
-        if (i < num_objects - 1)
-            json << ",";
-        json << "\n";
-    }
-
+    // Объекты 0..N-1 и связи i -> i+1 одной макрооперацией
+    json << "    { \"op\": \"chain\", \"id\": 0, \"count\": " << num_objects
+         << ", \"size\": " << object_size << " }\n";
     json << "    ,{ \"op\": \"addroot\", \"id\": 0 }\n";
-
-    for (int i = 1; i < num_objects; ++i)
-    {
-        json << "    ,{ \"op\": \"addref\", \"from\": " << (i - 1) << ", \"to\": " << i << " }\n";
-    }
-
     json << "    ,{ \"op\": \"removeroot\", \"id\": 0 }\n";
     json << "  ]\n";
     json << "}\n";
@@ -490,17 +478,9 @@ std::string generate_linear_chain_json_ms(int num_objects, int object_size, size
     json << " \"collection_type\": \"mark_sweep\",\n";
     json << " \"heap_size\": " << heap_size << ",\n";
     json << " \"operations\": [\n";
-    json << " { \"op\": \"allocate\", \"size\": " << object_size << " },\n";
+    json << " { \"op\": \"chain\", \"count\": " << num_objects << ", \"size\": " << object_size << " },\n";
     json << " { \"op\": \"make_root\", \"id\": 0 },\n";
-    for (int i = 1; i < num_objects; ++i)
-    {
-        json << " { \"op\": \"allocate\", \"size\": " << object_size << " },\n";
-        json << " { \"op\": \"add_ref\", \"from\": " << (i - 1) << ", \"to\": " << i << " }";
-        if (i < num_objects - 1)
-            json << ",";
-        json << "\n";
-    }
-    json << " ,{ \"op\": \"remove_root\", \"id\": 0 },\n";
+    json << " { \"op\": \"remove_root\", \"id\": 0 },\n";
     json << " { \"op\": \"collect\" }\n";
     json << " ]\n";
     json << "}\n";
@@ -513,7 +493,6 @@ std::string generate_linear_chain_json_ms(int num_objects, int object_size, size
 
 std::string generate_cyclic_graph_json_ms(int num_objects, int object_size, size_t heap_size)
 {
-    (void)object_size;
     std::stringstream json;
     json << "{\n";
     json << " \"name\": \"Generated Cyclic Graph\",\n";
@@ -526,34 +505,18 @@ std::string generate_cyclic_graph_json_ms(int num_objects, int object_size, size
     json << " { \"op\": \"allocate\", \"size\": " << object_size << " },\n";
     json << " { \"op\": \"make_root\", \"id\": 0 }";
 
-    int cycle_length = std::min(3, num_objects - 1);
-    if (cycle_length < 2)
-        cycle_length = 2;
-
-    // Создаем остальные объекты
-    for (int i = 1; i < num_objects; ++i)
-    {
-        json << ",\n";
-        json << " { \"op\": \"allocate\", \"size\": " << object_size << " }";
-    }
-
-    // Создаем циклические ссылки
-    for (int i = 0; i < num_objects - 1; ++i)
-    {
-        int from = i;
-        int to = (i + 1) % (num_objects - 1);
-        if (to == 0)
-            to = 1;
-
-        json << ",\n";
-        json << " { \"op\": \"add_ref\", \"from\": " << from << ", \"to\": " << to << " }";
-    }
+    // Кольцо из объектов 1..N-2
+    int ring_size = std::max(num_objects - 2, 0);
+    json << ",\n";
+    json << " { \"op\": \"ring\", \"count\": " << ring_size << ", \"size\": " << object_size << " }";
 
-    // Замыкаем цикл
+    // Последний объект ссылается в кольцо снаружи, корень — на вход кольца
     int last = num_objects - 1;
     if (last > 0)
     {
         json << ",\n";
+        json << " { \"op\": \"allocate\", \"size\": " << object_size << " },\n";
+        json << " { \"op\": \"add_ref\", \"from\": 0, \"to\": 1 },\n";
         json << " { \"op\": \"add_ref\", \"from\": " << last << ", \"to\": 1 }";
     }
 
@@ -567,7 +530,6 @@ std::string generate_cyclic_graph_json_ms(int num_objects, int object_size, size
 
 std::string generate_cascade_tree_json_ms(int num_objects, int object_size, size_t heap_size)
 {
-    (void)object_size;
     std::stringstream json;
     json << "{\n";
     json << " \"name\": \"Generated Cascade Tree\",\n";
@@ -576,18 +538,10 @@ std::string generate_cascade_tree_json_ms(int num_objects, int object_size, size
     json << " \"heap_size\": " << heap_size << ",\n";
     json << " \"operations\": [\n";
 
-    // Корневой объект
-    json << " { \"op\": \"allocate\", \"size\": " << object_size << " },\n";
+    // Корневой объект и дочерние (каждый ссылается на следующий)
+    json << " { \"op\": \"chain\", \"count\": " << num_objects << ", \"size\": " << object_size << " },\n";
     json << " { \"op\": \"make_root\", \"id\": 0 }";
 
-    // Дочерние объекты (каждый ссылается на следующий)
-    for (int i = 1; i < num_objects; ++i)
-    {
-        json << ",\n";
-        json << " { \"op\": \"allocate\", \"size\": " << object_size << " },\n";
-        json << " { \"op\": \"add_ref\", \"from\": " << (i - 1) << ", \"to\": " << i << " }";
-    }
-
     // Удаление корня вызовет каскадное удаление
     json << ",\n";
     json << " { \"op\": \"remove_root\", \"id\": 0 },\n";
@@ -599,7 +553,6 @@ std::string generate_cascade_tree_json_ms(int num_objects, int object_size, size
 
 std::string generate_cyclic_graph_json(int num_objects, int object_size, size_t heap_size)
 {
-    (void)object_size;
     std::stringstream json;
     json << "{\n";
     json << "  \"name\": \"Generated Cyclic Graph\",\n";
@@ -608,14 +561,8 @@ std::string generate_cyclic_graph_json(int num_objects, int object_size, size_t
     json << "  \"heap_size\": " << heap_size << ",\n";
     json << "  \"operations\": [\n";
 
-    for (int i = 0; i < num_objects; ++i)
-    {
-        json << "    { \"op\": \"allocate\", \"id\": " << i << " }";
-        if (i < num_objects - 1)
-            json << ",";
-        json << "\n";
-    }
-
+    json << "    { \"op\": \"allocate_range\", \"id\": 0, \"count\": " << num_objects
+         << ", \"size\": " << object_size << " }\n";
     json << "    ,{ \"op\": \"addroot\", \"id\": 0 }\n";
 
     int cycle_length = std::min(3, num_objects - 1);
@@ -644,7 +591,6 @@ std::string generate_cyclic_graph_json(int num_objects, int object_size, size_t
 
 std::string generate_cascade_tree_json(int num_objects, int object_size, size_t heap_size)
 {
-    (void)object_size;
     std::stringstream json;
     json << "{\n";
     json << "  \"name\": \"Generated Cascade Tree\",\n";
@@ -653,21 +599,10 @@ std::string generate_cascade_tree_json(int num_objects, int object_size, size_t
     json << "  \"heap_size\": " << heap_size << ",\n";
     json << "  \"operations\": [\n";
 
-    for (int i = 0; i < num_objects; ++i)
-    {
-        json << "    { \"op\": \"allocate\", \"id\": " << i << " }";
-        if (i < num_objects - 1)
-            json << ",";
-        json << "\n";
-    }
-
+    json << "    { \"op\": \"chain\", \"id\": 0, \"count\": " << num_objects
+         << ", \"size\": " << object_size << " }\n";
     json << "    ,{ \"op\": \"addroot\", \"id\": 0 }\n";
 
-    for (int i = 1; i < num_objects; ++i)
-    {
-        json << "    ,{ \"op\": \"addref\", \"from\": " << (i - 1) << ", \"to\": " << i << " }\n";
-    }
-
     json << "    ,{ \"op\": \"removeroot\", \"id\": 0 }\n";
     json << "  ]\n";
     json << "}\n";
@@ -45,21 +45,6 @@ struct MemoryConfig {
     bool validate();
 };
 
-struct Operation {
-    std::string type;
-    int id = -1;
-    int from = -1;
-    int to = -1;
-    int param1 = 0;
-    int param2 = 0;
-    std::string collection_type = "mark_sweep";
-};
-
-struct ParsedScenario {
-    std::vector<Operation> operations;
-    size_t heap_size = 104857600;
-};
-
 // ============================================
 // COMMON FUNCTIONS
 // ============================================
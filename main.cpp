@@ -90,34 +90,38 @@ GCResult run_reference_counting(const SimulationParams &params)
         RCHeap rc_heap(logger, rc_logger, params.heap_size_bytes);
 
         // ФАЗА 1: ВЫДЕЛЕНИЕ ПАМЯТИ (НЕ измеряем время)
+        std::vector<int> object_ids;
         for (int i = 0; i < params.num_objects; ++i)
-            rc_heap.allocate(i);
+            object_ids.push_back(rc_heap.allocate(params.object_size));
 
         // ФАЗА 2: СОЗДАНИЕ ГРАФА (НЕ измеряем время)
-        rc_heap.addroot(0);
+        if (!object_ids.empty())
+            rc_heap.make_root(object_ids[0]);
 
         create_graph_for_scenario(params.scenario_type, params.num_objects,
                                   [&](int from, int to)
                                   {
-                                      rc_heap.addref(from, to);
+                                      rc_heap.add_reference(object_ids[from], object_ids[to]);
                                   });
 
         // ФАЗА 3: УДАЛЕНИЕ (ИЗМЕРЯЕМ ТОЛЬКО ЭТО!)
         auto start = std::chrono::high_resolution_clock::now();
 
-        // ТОЛЬКО УДАЛЕНИЕ КОРНЯ И КАСКАД
-        rc_heap.removeroot(0);
+        // УДАЛЕНИЕ КОРНЯ, КАСКАД И ОТЛОЖЕННАЯ РАБОТА
+        if (!object_ids.empty())
+            rc_heap.remove_root(object_ids[0]);
+        rc_heap.collect();
 
         auto end = std::chrono::high_resolution_clock::now();
         result.execution_time_ms = std::chrono::duration<double, std::milli>(end - start).count();
 
         // Статистика
-        result.objects_left = rc_heap.getheapsize();
-        result.memory_freed = (params.num_objects - result.objects_left) * params.object_size;
-        result.memory_leaked = result.objects_left * params.object_size;
+        result.objects_left = rc_heap.get_alive_objects_count();
+        result.memory_freed = result.memory_allocated - rc_heap.get_total_memory();
+        result.memory_leaked = rc_heap.get_total_memory();
 
         // ЛОГ ДЛЯ ОТЛАДКИ
-        std::cout << "[RC_DEBUG] Time measured for removeroot+cascade only: "
+        std::cout << "[RC_DEBUG] Time measured for remove_root+cascade+collect only: "
                   << std::fixed << std::setprecision(3) << result.execution_time_ms << " ms\n";
     }
     catch (const std::exception &e)
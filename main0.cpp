@@ -117,18 +117,18 @@ void run_both_gc_simultaneously(const MemoryConfig &config)
         // Выполняем операции в зависимости от типа сценария
         for (int i = 0; i < config.num_objects; ++i)
         {
-            rc_heap.allocate(i, config.object_size);
+            rc_heap.allocate_at(i, config.object_size);
         }
 
         // Добавляем корень
-        rc_heap.addroot(0);
+        rc_heap.add_root(0);
 
         // Создаем связи в зависимости от сценария
         if (scenario_type == 1)
         { // Линейная цепь
             for (int i = 1; i < config.num_objects; ++i)
             {
-                rc_heap.addref(i - 1, i);
+                rc_heap.add_reference(i - 1, i);
             }
         }
         else if (scenario_type == 2)
@@ -136,25 +136,25 @@ void run_both_gc_simultaneously(const MemoryConfig &config)
             // Создаем цикл: каждый объект ссылается на следующий, последний на первый
             for (int i = 1; i < config.num_objects; ++i)
             {
-                rc_heap.addref(i - 1, i);
+                rc_heap.add_reference(i - 1, i);
             }
             // Замыкаем цикл
-            rc_heap.addref(config.num_objects - 1, 0);
+            rc_heap.add_reference(config.num_objects - 1, 0);
         }
         else if (scenario_type == 3)
         { // Каскадное дерево
             // Каждый объект ссылается на следующий (как в линейной цепи)
             for (int i = 1; i < config.num_objects; ++i)
             {
-                rc_heap.addref(i - 1, i);
+                rc_heap.add_reference(i - 1, i);
             }
         }
 
         // Удаляем корень
-        rc_heap.removeroot(0);
+        rc_heap.release_root(0);
 
         // Статистика RC
-        size_t rc_objects_left = rc_heap.getheapsize();
+        size_t rc_objects_left = rc_heap.get_alive_objects_count();
         size_t rc_memory_freed = (config.num_objects - rc_objects_left) * config.object_size;
 
         auto rc_end = std::chrono::high_resolution_clock::now();
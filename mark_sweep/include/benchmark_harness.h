@@ -0,0 +1,148 @@
+#ifndef BENCHMARK_HARNESS_H
+#define BENCHMARK_HARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <nlohmann/json.hpp>
+
+using json = nlohmann::json;
+
+/**
+ * @brief Параметры повторных замеров
+ */
+struct BenchmarkOptions {
+    int warmup_runs = 2;         // Прогоны без записи (кэши, страницы heap'а, частота CPU)
+    int repetitions = 10;        // Записываемые прогоны
+    double confidence = 0.95;    // Уровень доверительного интервала среднего
+    int pin_cpu = -1;            // Закрепить поток за CPU; -1 — не закреплять
+};
+
+/**
+ * @brief Сводка по выборке времён (мс)
+ *
+ * Доверительный интервал среднего — по распределению Стьюдента
+ * с count - 1 степенями свободы; для одного замера он вырождается
+ * в точку.
+ */
+struct SampleStats {
+    size_t count = 0;
+    double mean = 0.0;
+    double median = 0.0;
+    double stddev = 0.0;         // Выборочное (делитель count - 1)
+    double min = 0.0;
+    double max = 0.0;
+    double ci_low = 0.0;
+    double ci_high = 0.0;
+    double confidence = 0.95;
+
+    json to_json() const;
+};
+
+/**
+ * @brief Посчитать сводку по выборке
+ * @param samples Замеры в любом порядке
+ * @param confidence Уровень доверительного интервала (0, 1)
+ */
+SampleStats compute_sample_stats(const std::vector<double>& samples, double confidence = 0.95);
+
+/**
+ * @brief Функция распределения Стьюдента P(T <= t) с df степенями свободы
+ */
+double student_t_cdf(double t, double df);
+
+/**
+ * @brief Квантиль распределения Стьюдента: t, для которого P(T <= t) = p
+ */
+double student_t_quantile(double p, double df);
+
+/**
+ * @brief Итог сравнения двух выборок
+ */
+struct SampleComparison {
+    double t = 0.0;              // > 0 — среднее candidate больше
+    double df = 0.0;
+    double p_value = 1.0;        // Двусторонний; 1 — сравнение невозможно
+    bool valid = false;          // В каждой выборке не меньше двух замеров
+};
+
+/**
+ * @brief t-критерий Уэлча (дисперсии выборок не предполагаются равными)
+ *
+ * Степени свободы — по формуле Уэлча — Саттертуэйта. Если обе выборки
+ * без разброса, p-value равно 0 при разных средних и 1 при равных.
+ */
+SampleComparison welch_t_test(const std::vector<double>& baseline,
+                              const std::vector<double>& candidate);
+
+/**
+ * @brief Закрепить текущий поток за одним CPU
+ *
+ * Убирает из замеров миграции между ядрами. Работает только на Linux;
+ * на остальных платформах возвращает false.
+ *
+ * @param error Причина отказа (может быть nullptr)
+ */
+bool pin_current_thread(int cpu, std::string* error = nullptr);
+
+/**
+ * @brief Сведения о машине и сборке для сравнения прогонов
+ *
+ * Хост, модель и число CPU, ядро ОС, компилятор, тип сборки
+ * и параметры замеров из options.
+ */
+json benchmark_environment(const BenchmarkOptions& options);
+
+/**
+ * @class BenchmarkHarness
+ * @brief Повторные замеры с прогревом и отделённой подготовкой
+ *
+ * Каждый прогон заново вызывает setup(), и только body() попадает
+ * в замер: построение графа, выделение heap'а и разрушение фикстуры
+ * остаются снаружи. Первые warmup_runs прогонов отбрасываются.
+ *
+ * @code
+ * BenchmarkHarness harness(options);
+ * std::vector<double> samples = harness.measure(
+ *     [&]() { return make_fixture(); },          // unique_ptr или указатель
+ *     [&](Fixture& fixture) { fixture.gc.collect(); });
+ * @endcode
+ */
+class BenchmarkHarness {
+public:
+    explicit BenchmarkHarness(const BenchmarkOptions& options_)
+        : options(options_) {}
+
+    /**
+     * @brief Выполнить прогрев и repetitions замеров
+     * @param setup Создаёт фикстуру; возвращает что-то разыменовываемое
+     * @param body Измеряемая часть; получает ссылку на фикстуру
+     * @return Времена body() в мс, по одному на записанный прогон
+     */
+    template<typename Setup, typename Body>
+    std::vector<double> measure(Setup setup, Body body) const {
+        std::vector<double> samples;
+        int runs = std::max(options.warmup_runs, 0) + std::max(options.repetitions, 1);
+        samples.reserve(static_cast<size_t>(std::max(options.repetitions, 1)));
+
+        for (int run = 0; run < runs; ++run) {
+            auto fixture = setup();
+            auto start = std::chrono::steady_clock::now();
+            body(*fixture);
+            auto end = std::chrono::steady_clock::now();
+            if (run >= options.warmup_runs) {
+                samples.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+            }
+        }
+        return samples;
+    }
+
+    const BenchmarkOptions& get_options() const { return options; }
+
+private:
+    BenchmarkOptions options;
+};
+
+#endif // BENCHMARK_HARNESS_H
@@ -3,26 +3,39 @@
 
 #include "gc_interface.h"
 #include "heap_object.h"
+#include "heap_snapshot_writer.h"
+#include "heap_query.h"
+#include "heap_delta.h"
+#include "heap_checkpoint.h"
 #include <unordered_map>
+#include <set>
 #include <vector>
 #include <queue>
 #include <memory>
 #include <fstream>
 #include <string>
 
-class CascadeDeletionGC : public GCInterface {
+class CascadeDeletionGC final : public GCInterface {
 private:
     std::unordered_map<int, HeapObject> heap;
     int next_object_id;
     size_t max_heap_size;
-    size_t collection_threshold;
+    size_t collection_threshold;         // 0 — сборка только при нехватке памяти
+    size_t trigger_memory;
+    size_t used_memory;
+    std::set<int> root_ids;
+    size_t alive_objects;
+    size_t edge_count;
+    HeapDeltaTracker delta_tracker;
     std::vector<std::string> operation_logs;
     std::string last_operation;
     std::ofstream log_file;
+    bool logging_enabled;
     int collection_count;
     int total_objects_collected;
     size_t total_memory_freed;
     int total_collection_time;
+    GCCollectionStats collection_stats;
     int current_step;
     std::queue<int> deletion_queue;
     std::unordered_map<int, bool> processed_in_cascade;
@@ -30,7 +43,7 @@ private:
 public:
     CascadeDeletionGC(
         size_t max_heap_size = 1024 * 1024,
-        size_t collection_threshold = (1024 * 1024 * 80) / 100,
+        size_t collection_threshold = 0,
         const std::string& log_file_path = "cascade_trace.log"
     );
     
@@ -39,40 +52,62 @@ public:
     int allocate(size_t size) override;
     bool add_reference(int from_id, int to_id) override;
     bool remove_reference(int from_id, int to_id) override;
+    ObjectIdRange allocate_many(size_t count, size_t size) override;
+    size_t add_references(const ReferencePair* refs, size_t count) override;
     size_t collect() override;
     std::string get_heap_info() const override;
+    void write_heap_info(HeapSnapshotWriter& writer) const;
+    
+    // Дельта-снимки (формат см. heap_delta.h)
+    void enable_delta_tracking(int keyframe_interval = HeapDeltaTracker::DEFAULT_KEYFRAME_INTERVAL) {
+        delta_tracker.enable(keyframe_interval);
+    }
+    void disable_delta_tracking() { delta_tracker.disable(); }
+    void write_heap_delta(HeapSnapshotWriter& writer);
+    HeapDeltaTracker& get_delta_tracker() { return delta_tracker; }
+    
+    // Бинарный checkpoint (формат см. heap_checkpoint.h)
+    void write_checkpoint(HeapSnapshotWriter& writer) const override;
+    bool read_checkpoint(const uint8_t* data, size_t size) override;
+    bool save_checkpoint(const std::string& path) const;
+    bool load_checkpoint(const std::string& path);
     std::string get_gc_stats() const override;
+    GCCollectionStats get_collection_stats() const override;
     
     std::string get_last_operation_log() const override { return last_operation; }
     std::vector<std::string> get_all_logs() const override { return operation_logs; }
     void clear_logs() override { operation_logs.clear(); last_operation = ""; }
+    void set_logging_enabled(bool enabled) { logging_enabled = enabled; }
+    bool is_logging_enabled() const { return logging_enabled; }
     
     size_t get_total_memory() const override;
     size_t get_free_memory() const override;
     
     void set_current_step(int step) override { current_step = step; }
     int get_current_step() const override { return current_step; }
-    int get_alive_objects_count() const override {
-        int count = 0;
-        for (const auto& [id, obj] : heap) {
-            if (obj.is_alive) count++;
-        }
-        return count;
-    }
+    int get_alive_objects_count() const override { return static_cast<int>(alive_objects); }
     
-    void make_root(int object_id);
-    void remove_root(int object_id);
+    void make_root(int object_id) override;
+    void remove_root(int object_id) override;
     HeapObject* get_object(int id);
     const HeapObject* get_object(int id) const;
     bool object_exists(int id) const;
     
+    HeapQueryResult query_objects(const HeapQuery& query) const;
+    HeapNeighborhood get_neighborhood(int object_id, int hops, size_t max_nodes = 1000,
+                                      NeighborDirection direction = NeighborDirection::BOTH) const;
+    HeapSummary get_summary() const;
+    
     const std::unordered_map<int, HeapObject>& get_all_objects() const { return heap; }
     
 private:
+    void rebuild_indexes();
     size_t cascade_delete(int object_id);
     bool should_be_deleted(int object_id) const;
     void log_operation(const std::string& operation);
     bool has_enough_memory(size_t size) const;
+    bool threshold_reached(size_t size) const;
+    void update_trigger();
 };
 
 #endif
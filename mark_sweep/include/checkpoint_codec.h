@@ -0,0 +1,35 @@
+#ifndef CHECKPOINT_CODEC_H
+#define CHECKPOINT_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Сжатие checkpoint'ов в памяти (LZ77 без внешних зависимостей)
+ *
+ * Записи объектов в checkpoint'е почти одинаковые (размер, флаги,
+ * шаги), поэтому даже простой поиск повторов по хэшу 4-байтовых
+ * последовательностей сжимает их в разы.
+ *
+ * Формат:
+ *   uint64_t original_size
+ *   последовательности: varint literal_len, literal_len байт,
+ *                       varint match_len, [varint offset если match_len > 0]
+ *
+ * Последняя последовательность имеет match_len = 0.
+ */
+
+/**
+ * @brief Сжать буфер
+ */
+std::vector<uint8_t> compress_checkpoint(const uint8_t* data, size_t size);
+
+/**
+ * @brief Распаковать буфер
+ * @param out Результат (перезаписывается)
+ * @return false, если данные повреждены
+ */
+bool decompress_checkpoint(const uint8_t* data, size_t size, std::vector<uint8_t>& out);
+
+#endif // CHECKPOINT_CODEC_H
@@ -0,0 +1,34 @@
+#ifndef GC_BACKENDS_H
+#define GC_BACKENDS_H
+
+#include "gc_interface.h"
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Имена всех коллекторов за GCInterface, в порядке вывода
+ *
+ * Новый коллектор добавляется сюда и в make_gc_backend() — после
+ * этого его подхватывают матрица бенчмарков и прочие драйверы.
+ */
+std::vector<std::string> gc_backend_names();
+
+/**
+ * @brief Создать коллектор по имени
+ *
+ * Логирование выключено: коллекторы создаются для замеров, и запись
+ * каждой операции в лог исказила бы сравнение.
+ *
+ * @param name Имя из gc_backend_names()
+ * @param heap_bytes Размер heap'а
+ * @param collection_threshold Порог сборки по занятой памяти (0 — только при нехватке)
+ * @param log_file Лог коллектора (только сообщения конструктора)
+ * @return nullptr для неизвестного имени
+ */
+std::unique_ptr<GCInterface> make_gc_backend(const std::string& name, size_t heap_bytes,
+                                             size_t collection_threshold = 0,
+                                             const std::string& log_file = "");
+
+#endif // GC_BACKENDS_H
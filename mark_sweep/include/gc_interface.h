@@ -4,6 +4,40 @@
 #include <string>
 #include <vector>
 #include <cstddef>
+#include <cstdint>
+
+class HeapSnapshotWriter;
+
+/**
+ * @brief Диапазон id, выделенных одним вызовом allocate_many(): [first, first + count)
+ */
+struct ObjectIdRange {
+    int first = -1;
+    int count = 0;
+
+    bool empty() const { return count == 0; }
+    int end() const { return first + count; }
+};
+
+/**
+ * @brief Ссылка from -> to для пакетной вставки
+ */
+struct ReferencePair {
+    int from;
+    int to;
+};
+
+/**
+ * @brief Счётчики сборок для бенчмарков (паузы в наносекундах)
+ */
+struct GCCollectionStats {
+    uint64_t collections = 0;              // Всего сборок
+    uint64_t triggered_collections = 0;    // Из них запущено самим коллектором при выделении
+    uint64_t total_pause_ns = 0;
+    uint64_t last_pause_ns = 0;
+    uint64_t last_pause_start_ns = 0;      // Начало последней паузы (high_resolution_clock от эпохи)
+    uint64_t max_pause_ns = 0;
+};
 
 /**
  * @brief Абстрактный интерфейс для всех сборщиков мусора
@@ -38,6 +72,32 @@ public:
      */
     virtual bool remove_reference(int from_id, int to_id) = 0;
     
+    // === ПАКЕТНЫЕ ОПЕРАЦИИ ===
+    
+    /**
+     * @brief Выделить count объектов одного размера
+     * 
+     * Эквивалентно count вызовам allocate(size), но с одной проверкой,
+     * одним резервированием и одной записью в лог. Если места не
+     * хватает на все объекты, запускается сборка; после неё
+     * выделяется столько, сколько поместится.
+     * 
+     * @return Диапазон подряд идущих id (пустой при ошибке)
+     */
+    virtual ObjectIdRange allocate_many(size_t count, size_t size) = 0;
+    
+    /**
+     * @brief Создать ссылки пачкой
+     * 
+     * Эквивалентно add_reference() для каждой пары, но одна запись
+     * в лог на всю пачку вместо записи на каждую ссылку.
+     * 
+     * @param refs Пары (from, to)
+     * @param count Количество пар
+     * @return Сколько пар применено (уже существующие ссылки тоже считаются)
+     */
+    virtual size_t add_references(const ReferencePair* refs, size_t count) = 0;
+    
     /**
      * @brief Запустить цикл сборки мусора
      * @return Количество освобождённых байтов
@@ -56,6 +116,15 @@ public:
      */
     virtual std::string get_gc_stats() const = 0;
     
+    /**
+     * @brief Счётчики сборок и пауз
+     * 
+     * В отличие от get_gc_stats() — числа, а не текст: бенчмарки
+     * опрашивают их после каждого выделения, чтобы заметить сборку,
+     * запущенную изнутри allocate().
+     */
+    virtual GCCollectionStats get_collection_stats() const = 0;
+    
     /**
      * @brief Получить лог последней операции
      * @return Строка-лог для визуализации
@@ -104,6 +173,36 @@ public:
      * @return Количество объектов
      */
     virtual int get_alive_objects_count() const = 0;
+    
+    // === КОРНИ ===
+    
+    /**
+     * @brief Сделать объект root (всегда достижимым)
+     * @param object_id ID объекта
+     */
+    virtual void make_root(int object_id) = 0;
+    
+    /**
+     * @brief Снять статус root
+     * @param object_id ID объекта
+     */
+    virtual void remove_root(int object_id) = 0;
+    
+    // === CHECKPOINT ===
+    
+    /**
+     * @brief Записать полное состояние в бинарном формате (heap_checkpoint.h)
+     * @param writer Приёмник данных
+     */
+    virtual void write_checkpoint(HeapSnapshotWriter& writer) const = 0;
+    
+    /**
+     * @brief Восстановить состояние из checkpoint'а
+     * @param data Буфер с checkpoint'ом
+     * @param size Размер буфера
+     * @return false, если данные повреждены (состояние не меняется)
+     */
+    virtual bool read_checkpoint(const uint8_t* data, size_t size) = 0;
 };
 
 #endif // GC_INTERFACE_H
@@ -0,0 +1,232 @@
+#ifndef HEAP_CHECKPOINT_H
+#define HEAP_CHECKPOINT_H
+
+#include "heap_object.h"
+#include "heap_snapshot_writer.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Бинарный формат checkpoint'а heap'а
+ *
+ * Полное состояние коллектора (объекты, размеры, рёбра, корни,
+ * счётчики, шаг) пишется одним проходом и читается одним проходом
+ * прямо из отображённого в память файла:
+ *
+ *   CheckpointHeader                    128 байт
+ *   CheckpointObject[object_count]      по 40 байт, по возрастанию ID
+ *   int32_t[edge_count]                 исходящие рёбра всех объектов подряд
+ *   int32_t[incoming_count]             явные входящие рёбра (см. in_degree)
+ *
+ * Рёбра лежат в порядке объектов: первые out_degree значений
+ * принадлежат первому объекту и т.д. Порядок байт — родной для
+ * машины; файл с другим порядком не пройдёт проверку magic.
+ */
+
+/** @brief "GCHP" */
+constexpr uint32_t CHECKPOINT_MAGIC = 0x50484347;
+
+/** @brief Версия формата */
+constexpr uint32_t CHECKPOINT_VERSION = 1;
+
+/**
+ * @brief Какой коллектор записал checkpoint
+ */
+enum class CheckpointKind : uint32_t {
+    MARK_SWEEP = 1,
+    CASCADE_DELETION = 2,
+    REFERENCE_COUNTING = 3
+};
+
+/** @brief Флаги объекта */
+constexpr uint32_t CHECKPOINT_ROOT = 1u << 0;
+constexpr uint32_t CHECKPOINT_ALIVE = 1u << 1;
+constexpr uint32_t CHECKPOINT_MARKED = 1u << 2;
+
+/**
+ * @brief Заголовок файла
+ */
+struct CheckpointHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t kind;                   // CheckpointKind
+    uint32_t header_size;            // sizeof(CheckpointHeader)
+    uint64_t object_count;
+    uint64_t edge_count;             // Сумма out_degree
+    uint64_t incoming_count;         // Сумма in_degree
+    int64_t next_object_id;
+    int64_t current_step;
+    uint64_t max_heap_size;
+    uint64_t collection_threshold;
+    uint64_t collection_count;
+    uint64_t total_objects_collected;
+    uint64_t total_memory_freed;
+    uint64_t total_collection_time;
+    uint64_t marked_objects;
+    uint64_t trigger_memory;         // Занятая память, при которой сработает сборка (0 — нет)
+    uint64_t reserved;
+};
+
+/**
+ * @brief Запись об одном объекте
+ *
+ * in_degree ненулевой только там, где входящие рёбра нельзя
+ * восстановить по исходящим (у удалённых объектов Mark-Sweep
+ * остаются прежние списки refs_from).
+ */
+struct CheckpointObject {
+    int32_t id;
+    uint32_t flags;                  // CHECKPOINT_ROOT | ALIVE | MARKED
+    uint64_t size;
+    int32_t allocation_step;
+    int32_t collection_step;
+    int32_t reference_count;
+    uint32_t out_degree;
+    uint32_t in_degree;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(CheckpointHeader) == 128, "CheckpointHeader layout changed");
+static_assert(sizeof(CheckpointObject) == 40, "CheckpointObject layout changed");
+
+/**
+ * @brief Заполнить заголовок: magic, версия, тип, размер заголовка
+ */
+CheckpointHeader make_checkpoint_header(CheckpointKind kind);
+
+/**
+ * @brief Записать POD-структуру как есть
+ */
+template <typename T>
+void write_checkpoint_pod(HeapSnapshotWriter& writer, const T& value) {
+    writer.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+/**
+ * @brief Последовательное чтение checkpoint'а из буфера
+ *
+ * Буфер не копируется; все методы проверяют границы и
+ * возвращают false / nullptr, если данных не хватает.
+ */
+class CheckpointReader {
+public:
+    CheckpointReader(const uint8_t* data, size_t size)
+        : data(data), size(size), offset(0) {}
+
+    /**
+     * @brief Прочитать и проверить заголовок
+     * @param expected Ожидаемый тип коллектора
+     * @param header Куда положить заголовок
+     * @return false при неверном magic/версии/типе или обрезанном файле
+     */
+    bool read_header(CheckpointKind expected, CheckpointHeader& header);
+
+    /** @brief Прочитать POD-структуру */
+    template <typename T>
+    bool read(T& out) {
+        if (size - offset < sizeof(T)) return false;
+        std::memcpy(&out, data + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+
+    /**
+     * @brief Массив записей без копирования
+     *
+     * Выравнивание гарантировано форматом: заголовок и записи
+     * объектов кратны 8 байтам, а буфер выровнен по странице (mmap)
+     * или malloc.
+     */
+    template <typename T>
+    const T* read_array(size_t count) {
+        if ((size - offset) / sizeof(T) < count) return nullptr;
+        const T* result = reinterpret_cast<const T*>(data + offset);
+        offset += count * sizeof(T);
+        return result;
+    }
+
+    /** @brief Сколько байт прочитано */
+    size_t position() const { return offset; }
+
+private:
+    const uint8_t* data;
+    size_t size;
+    size_t offset;
+};
+
+/**
+ * @brief Файл checkpoint'а, отображённый в память только для чтения
+ *
+ * На POSIX используется mmap; если он недоступен, файл читается
+ * целиком в буфер.
+ */
+class MappedCheckpointFile {
+public:
+    MappedCheckpointFile();
+    ~MappedCheckpointFile();
+
+    MappedCheckpointFile(const MappedCheckpointFile&) = delete;
+    MappedCheckpointFile& operator=(const MappedCheckpointFile&) = delete;
+
+    /**
+     * @brief Открыть файл
+     * @return false, если файл не удалось открыть или прочитать
+     */
+    bool open(const std::string& path);
+
+    const uint8_t* data() const { return mapping ? mapping : fallback.data(); }
+    size_t size() const { return length; }
+
+private:
+    const uint8_t* mapping;
+    size_t length;
+    std::vector<uint8_t> fallback;
+
+    void close();
+};
+
+/**
+ * @brief Записать heap из HeapObject (Mark-Sweep, Cascade)
+ *
+ * object_count, edge_count и incoming_count заголовка заполняются
+ * здесь; остальные поля — вызывающим коллектором.
+ *
+ * @param header Заголовок с полями коллектора
+ * @param heap Хранилище объектов
+ * @param id_limit Верхняя граница выданных ID (next_object_id)
+ */
+void write_heap_checkpoint(HeapSnapshotWriter& writer,
+                           CheckpointHeader header,
+                           const std::unordered_map<int, HeapObject>& heap,
+                           int id_limit);
+
+/**
+ * @brief Прочитать объекты и рёбра после заголовка
+ *
+ * refs_from живых объектов восстанавливаются по исходящим рёбрам
+ * живых объектов, у удалённых — берутся из файла.
+ *
+ * @param header Уже прочитанный и проверенный заголовок
+ * @param heap Пустое хранилище для результата
+ * @return false, если данные противоречат заголовку
+ */
+bool read_heap_checkpoint(CheckpointReader& reader,
+                          const CheckpointHeader& header,
+                          std::unordered_map<int, HeapObject>& heap);
+
+/**
+ * @brief Открыть файл на запись и передать писателя в callback
+ *
+ * Писатель работает с буфером 1 MB; файл перезаписывается.
+ *
+ * @return false при ошибке открытия или записи
+ */
+bool write_checkpoint_file(const std::string& path,
+                           const std::function<void(HeapSnapshotWriter&)>& write_body);
+
+#endif // HEAP_CHECKPOINT_H
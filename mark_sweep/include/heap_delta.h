@@ -0,0 +1,156 @@
+#ifndef HEAP_DELTA_H
+#define HEAP_DELTA_H
+
+#include "heap_object.h"
+#include "heap_snapshot_writer.h"
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @brief Отслеживание изменений heap'а между снимками
+ *
+ * Коллектор сообщает трекеру о каждом изменении (выделение, удаление,
+ * рёбра, смена root). Вместо полного снимка после каждого шага
+ * пишется дельта — только изменившиеся объекты и рёбра. Каждый
+ * keyframe_interval-й снимок — полный (keyframe), чтобы потребитель
+ * мог начать воспроизведение с середины.
+ *
+ * Формат дельты:
+ * {
+ *  "type": "delta", "sequence": N, "step": S,
+ *  "alive_objects": M, "total_memory": X,
+ *  "added": [{"id": 5, "size": 64, "is_root": false}, ...],
+ *  "freed": [3, 4],
+ *  "roots_changed": [{"id": 0, "is_root": false}],
+ *  "edges_added": [[0, 5], ...],
+ *  "edges_removed": [[1, 2], ...]
+ * }
+ *
+ * Рёбра удалённых объектов не перечисляются — "freed" подразумевает
+ * удаление всех их рёбер. Флаг "marked" обновляется только в keyframe'ах.
+ */
+class HeapDeltaTracker {
+public:
+    /** @brief Интервал keyframe'ов по умолчанию */
+    static constexpr int DEFAULT_KEYFRAME_INTERVAL = 50;
+
+    HeapDeltaTracker();
+
+    /**
+     * @brief Начать отслеживание; следующий снимок будет keyframe
+     * @param keyframe_interval Каждый N-й снимок — полный
+     */
+    void enable(int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+
+    /** @brief Прекратить отслеживание и очистить накопленное */
+    void disable();
+
+    bool is_enabled() const { return enabled; }
+
+    // === УВЕДОМЛЕНИЯ ОТ КОЛЛЕКТОРА ===
+
+    void on_allocate(int id) {
+        if (enabled) added.insert(id);
+    }
+
+    void on_free(int id) {
+        if (!enabled) return;
+        // Объект родился и умер между снимками — потребитель его не видел
+        if (added.erase(id) == 0) freed.insert(id);
+        roots_changed.erase(id);
+    }
+
+    void on_edge_added(int from, int to) {
+        if (!enabled) return;
+        uint64_t key = edge_key(from, to);
+        if (edges_removed.erase(key) == 0) edges_added.insert(key);
+    }
+
+    void on_edge_removed(int from, int to) {
+        if (!enabled) return;
+        uint64_t key = edge_key(from, to);
+        if (edges_added.erase(key) == 0) edges_removed.insert(key);
+    }
+
+    void on_root_changed(int id) {
+        if (enabled && added.count(id) == 0) roots_changed.insert(id);
+    }
+
+    // === ЗАПИСЬ СНИМКОВ ===
+
+    /**
+     * @brief Нужен ли сейчас полный снимок
+     *
+     * true для первого снимка, каждого keyframe_interval-го,
+     * после request_keyframe() и если трекер выключен.
+     */
+    bool keyframe_due() const;
+
+    /** @brief Принудительно сделать следующий снимок полным */
+    void request_keyframe() { force_keyframe = true; }
+
+    /**
+     * @brief Состояние heap'а заменено целиком (загрузка checkpoint'а):
+     * накопленное теряет смысл, следующий снимок — keyframe
+     */
+    void invalidate() {
+        clear();
+        force_keyframe = true;
+    }
+
+    /**
+     * @brief Записать начало keyframe-конверта; дальше коллектор пишет heap целиком
+     */
+    void write_keyframe_begin(HeapSnapshotWriter& writer, int step) const;
+
+    /** @brief Закрыть keyframe-конверт */
+    void write_keyframe_end(HeapSnapshotWriter& writer) const;
+
+    /**
+     * @brief Записать дельту относительно предыдущего снимка
+     * @param heap Хранилище объектов коллектора
+     * @param step Текущий шаг симуляции
+     * @param alive_objects Количество живых объектов
+     * @param used_memory Занятая память
+     */
+    void write_delta(HeapSnapshotWriter& writer,
+                     const std::unordered_map<int, HeapObject>& heap,
+                     int step, size_t alive_objects, size_t used_memory) const;
+
+    /**
+     * @brief Завершить снимок: очистить накопленное, увеличить sequence
+     */
+    void commit();
+
+    /** @brief Номер следующего снимка */
+    long long get_sequence() const { return sequence; }
+
+    /** @brief Сколько изменений накоплено с последнего снимка */
+    size_t pending_changes() const {
+        return added.size() + freed.size() + roots_changed.size() +
+               edges_added.size() + edges_removed.size();
+    }
+
+private:
+    bool enabled;
+    bool force_keyframe;
+    int keyframe_interval;
+    long long sequence;
+
+    std::unordered_set<int> added;
+    std::unordered_set<int> freed;
+    std::unordered_set<int> roots_changed;
+    std::unordered_set<uint64_t> edges_added;
+    std::unordered_set<uint64_t> edges_removed;
+
+    static uint64_t edge_key(int from, int to) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(from)) << 32) |
+               static_cast<uint32_t>(to);
+    }
+
+    void clear();
+};
+
+#endif // HEAP_DELTA_H
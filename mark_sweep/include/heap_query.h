@@ -0,0 +1,142 @@
+#ifndef HEAP_QUERY_H
+#define HEAP_QUERY_H
+
+#include "heap_object.h"
+#include "heap_snapshot_writer.h"
+#include <cstddef>
+#include <climits>
+#include <cstdint>
+#include <optional>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Параметры постраничного запроса к heap'у
+ *
+ * Объекты перебираются по возрастанию ID начиная с start_id.
+ * Запрос останавливается, как только набрано limit объектов
+ * или просмотрено max_scan ID, и возвращает курсор next_id
+ * для продолжения — стоимость одного вызова ограничена
+ * размером страницы, а не размером heap'а.
+ */
+struct HeapQuery {
+    int start_id = 0;                     // Курсор: первый просматриваемый ID
+    int end_id = INT_MAX;                 // Граница диапазона (не включительно)
+    size_t limit = 100;                   // Размер страницы
+    size_t max_scan = 100000;             // Сколько ID просмотреть за вызов
+
+    // Фильтры (пустое значение = не фильтровать)
+    std::optional<bool> is_root;
+    std::optional<bool> is_alive;
+    std::optional<bool> is_marked;
+    size_t min_size = 0;
+    size_t max_size = SIZE_MAX;
+    int min_allocation_step = INT_MIN;    // Возраст: шаг выделения
+    int max_allocation_step = INT_MAX;
+
+    /**
+     * @brief Подходит ли объект под фильтры
+     */
+    bool matches(const HeapObject& obj) const {
+        if (is_root && obj.is_root != *is_root) return false;
+        if (is_alive && obj.is_alive != *is_alive) return false;
+        if (is_marked && obj.is_marked != *is_marked) return false;
+        if (obj.size < min_size || obj.size > max_size) return false;
+        if (obj.allocation_step < min_allocation_step ||
+            obj.allocation_step > max_allocation_step) return false;
+        return true;
+    }
+};
+
+/**
+ * @brief Страница результатов запроса
+ */
+struct HeapQueryResult {
+    std::vector<const HeapObject*> objects;  // Найденные объекты (по возрастанию ID)
+    int next_id = -1;                        // Курсор следующей страницы (-1 = конец)
+    size_t scanned = 0;                      // Сколько ID просмотрено
+};
+
+/**
+ * @brief Направление обхода при поиске окрестности
+ */
+enum class NeighborDirection {
+    OUTGOING,  // Только по refs_to
+    INCOMING,  // Только по refs_from
+    BOTH       // В обе стороны
+};
+
+/**
+ * @brief k-окрестность объекта: пары (ID, расстояние в хопах)
+ */
+struct HeapNeighborhood {
+    std::vector<std::pair<int, int>> nodes;  // В порядке BFS, центр первым
+    bool truncated = false;                  // Упёрлись в max_nodes
+};
+
+/**
+ * @brief Сводные показатели heap'а (поддерживаются инкрементально, O(1))
+ */
+struct HeapSummary {
+    size_t total_objects = 0;    // Включая удалённые (is_alive=false)
+    size_t alive_objects = 0;
+    size_t root_objects = 0;
+    size_t marked_objects = 0;   // По итогам последней mark-фазы
+    size_t edge_count = 0;       // Рёбер между живыми объектами
+    size_t used_memory = 0;
+    size_t free_memory = 0;
+    size_t max_heap_size = 0;
+    int next_object_id = 0;
+    int collection_count = 0;
+};
+
+/**
+ * @brief Выполнить постраничный запрос
+ *
+ * Если фильтр is_root == true, перебирается только индекс корней.
+ *
+ * @param heap Хранилище объектов коллектора
+ * @param id_limit Верхняя граница выданных ID (next_object_id)
+ * @param root_ids Индекс root объектов
+ * @param query Параметры запроса
+ */
+HeapQueryResult run_heap_query(const std::unordered_map<int, HeapObject>& heap,
+                               int id_limit,
+                               const std::set<int>& root_ids,
+                               const HeapQuery& query);
+
+/**
+ * @brief Найти k-окрестность объекта обходом в ширину
+ *
+ * Стоимость пропорциональна числу посещённых объектов и их рёбер.
+ *
+ * @param heap Хранилище объектов коллектора
+ * @param center_id ID центрального объекта
+ * @param hops Радиус окрестности
+ * @param max_nodes Максимум объектов в ответе
+ * @param direction По каким рёбрам идти
+ */
+HeapNeighborhood collect_heap_neighborhood(const std::unordered_map<int, HeapObject>& heap,
+                                           int center_id,
+                                           int hops,
+                                           size_t max_nodes,
+                                           NeighborDirection direction);
+
+/**
+ * @brief Записать один объект в JSON (та же схема, что в get_heap_info)
+ */
+void write_heap_object_json(HeapSnapshotWriter& writer, const HeapObject& obj);
+
+/**
+ * @brief Записать страницу запроса в JSON (схема объектов как в get_heap_info)
+ */
+void write_heap_query_json(HeapSnapshotWriter& writer, const HeapQueryResult& result);
+
+/**
+ * @brief Записать сводку heap'а в JSON
+ */
+void write_heap_summary_json(HeapSnapshotWriter& writer, const HeapSummary& summary);
+
+#endif // HEAP_QUERY_H
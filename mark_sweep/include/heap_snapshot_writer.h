@@ -0,0 +1,107 @@
+#ifndef HEAP_SNAPSHOT_WRITER_H
+#define HEAP_SNAPSHOT_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Потоковая запись снимка heap'а
+ *
+ * Данные накапливаются в буфере фиксированного размера и сбрасываются
+ * порциями либо в файловый дескриптор, либо в callback. Память писателя
+ * не зависит от размера heap'а, поэтому снимок из миллионов объектов
+ * не требует промежуточной строки на гигабайты.
+ *
+ * Целые числа форматируются без iostream (таблица пар цифр).
+ */
+class HeapSnapshotWriter {
+public:
+    /** @brief Приёмник готовых порций данных */
+    using ChunkCallback = std::function<void(const char* data, size_t size)>;
+
+    /** @brief Размер буфера по умолчанию (64 KB) */
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    /** @brief Максимальная длина десятичной записи 64-битного числа */
+    static constexpr size_t MAX_INT_CHARS = 20;
+
+    /**
+     * @brief Писать в файловый дескриптор
+     * @param fd Открытый на запись дескриптор (не закрывается писателем)
+     * @param buffer_size Размер буфера в байтах
+     */
+    explicit HeapSnapshotWriter(int fd, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    /**
+     * @brief Писать в callback
+     * @param callback Вызывается для каждой заполненной порции
+     * @param buffer_size Размер буфера в байтах
+     */
+    explicit HeapSnapshotWriter(ChunkCallback callback, size_t buffer_size = DEFAULT_BUFFER_SIZE);
+
+    /**
+     * @brief Деструктор сбрасывает остаток буфера
+     */
+    ~HeapSnapshotWriter();
+
+    HeapSnapshotWriter(const HeapSnapshotWriter&) = delete;
+    HeapSnapshotWriter& operator=(const HeapSnapshotWriter&) = delete;
+
+    /** @brief Записать произвольные байты */
+    void write(const char* data, size_t size);
+
+    /** @brief Записать строковый литерал / C-строку */
+    void write(const char* text);
+
+    /** @brief Записать строку */
+    void write(const std::string& text) { write(text.data(), text.size()); }
+
+    /** @brief Записать один символ */
+    void write_char(char c);
+
+    /** @brief Записать знаковое целое */
+    void write_int(long long value);
+
+    /** @brief Записать беззнаковое целое */
+    void write_uint(unsigned long long value);
+
+    /** @brief Записать true/false */
+    void write_bool(bool value) { value ? write("true", 4) : write("false", 5); }
+
+    /**
+     * @brief Отдать накопленные данные приёмнику
+     */
+    void flush();
+
+    /**
+     * @brief Сколько байт принято писателем (включая ещё не сброшенные)
+     */
+    size_t bytes_written() const { return total_bytes; }
+
+    /**
+     * @brief false, если запись в дескриптор завершилась ошибкой
+     */
+    bool ok() const { return !failed; }
+
+    /**
+     * @brief Отформатировать беззнаковое число в десятичный вид
+     * @param out Буфер минимум на MAX_INT_CHARS символов
+     * @return Количество записанных символов
+     */
+    static size_t format_uint(char* out, unsigned long long value);
+
+private:
+    int fd;
+    ChunkCallback callback;
+    std::vector<char> buffer;
+    size_t used;
+    size_t total_bytes;
+    bool failed;
+
+    void emit(const char* data, size_t size);
+};
+
+#endif // HEAP_SNAPSHOT_WRITER_H
@@ -3,7 +3,12 @@
 
 #include "gc_interface.h"
 #include "heap_object.h"
+#include "heap_snapshot_writer.h"
+#include "heap_query.h"
+#include "heap_delta.h"
+#include "heap_checkpoint.h"
 #include <unordered_map>
+#include <set>
 #include <queue>
 #include <fstream>
 #include <memory>
@@ -18,7 +23,7 @@
  * 
  * Сложность: O(n + m), где n - объекты, m - ссылки
  */
-class MarkSweepGC : public GCInterface {
+class MarkSweepGC final : public GCInterface {
 private:
     // === ОСНОВНЫЕ СТРУКТУРЫ ===
     
@@ -31,9 +36,32 @@ private:
     /** @brief Максимальный размер heap'а (в байтах) */
     size_t max_heap_size;
     
-    /** @brief Максимальный пороговый размер до принудительной сборки */
+    /** @brief Максимальный пороговый размер до принудительной сборки (0 — нет порога) */
     size_t collection_threshold;
     
+    /** @brief Занятая память, при которой allocate() запустит сборку (см. update_trigger) */
+    size_t trigger_memory;
+    
+    /** @brief Суммарный размер живых объектов (поддерживается инкрементально) */
+    size_t used_memory;
+    
+    // === ИНДЕКСЫ И АГРЕГАТЫ ДЛЯ ЗАПРОСОВ ===
+    
+    /** @brief ID всех root объектов (упорядочены для постраничного обхода) */
+    std::set<int> root_ids;
+    
+    /** @brief Количество живых объектов */
+    size_t alive_objects;
+    
+    /** @brief Количество рёбер между живыми объектами */
+    size_t edge_count;
+    
+    /** @brief Сколько объектов помечено в последней mark-фазе */
+    size_t marked_objects;
+    
+    /** @brief Изменения с последнего снимка (для дельта-снимков) */
+    HeapDeltaTracker delta_tracker;
+    
     // === ЛОГИРОВАНИЕ ===
     
     /** @brief Все логи операций */
@@ -45,6 +73,9 @@ private:
     /** @brief Поток для записи в файл */
     std::ofstream log_file;
     
+    /** @brief Писать ли логи (для бенчмарков на больших heap'ах отключается) */
+    bool logging_enabled;
+    
     // === СТАТИСТИКА ===
     
     /** @brief Количество запущенных циклов сборки */
@@ -59,6 +90,9 @@ private:
     /** @brief Общее время на сборку (в условных единицах) */
     int total_collection_time;
     
+    /** @brief Паузы и сборки по порогу (collections берётся из collection_count) */
+    GCCollectionStats collection_stats;
+    
     // === ТЕКУЩИЙ ШАГ СИМУЛЯЦИИ ===
     
     /** @brief Номер текущего шага */
@@ -70,12 +104,13 @@ public:
     /**
      * @brief Конструктор
      * @param max_heap_size Максимальный размер heap'а (по умолчанию 1MB)
-     * @param collection_threshold Порог для автоматической сборки (по умолчанию 80%)
+     * @param collection_threshold Порог занятой памяти для автоматической сборки
+     *                             (0 — сборка только при нехватке памяти)
      * @param log_file_path Путь для логирования
      */
     MarkSweepGC(
         size_t max_heap_size = 1024 * 1024,
-        size_t collection_threshold = (1024 * 1024 * 80) / 100,
+        size_t collection_threshold = 0,
         const std::string& log_file_path = "ms_trace.log"
     );
     
@@ -109,6 +144,16 @@ public:
      */
     bool remove_reference(int from_id, int to_id) override;
 
+    /**
+     * @brief Выделить count объектов (см. GCInterface::allocate_many)
+     */
+    ObjectIdRange allocate_many(size_t count, size_t size) override;
+
+    /**
+     * @brief Создать ссылки пачкой (см. GCInterface::add_references)
+     */
+    size_t add_references(const ReferencePair* refs, size_t count) override;
+
     /**
      * @brief Запустить цикл Mark-and-Sweep
      * @return Количество освобождённой памяти
@@ -121,12 +166,80 @@ public:
      */
     std::string get_heap_info() const override;
 
+    /**
+     * @brief Записать информацию о heap'е потоково (та же схема, что get_heap_info)
+     * @param writer Приёмник снимка (файловый дескриптор или callback)
+     */
+    void write_heap_info(HeapSnapshotWriter& writer) const;
+
+    /**
+     * @brief Начать отслеживать изменения для дельта-снимков
+     * @param keyframe_interval Каждый N-й снимок — полный
+     */
+    void enable_delta_tracking(int keyframe_interval = HeapDeltaTracker::DEFAULT_KEYFRAME_INTERVAL) {
+        delta_tracker.enable(keyframe_interval);
+    }
+
+    /**
+     * @brief Прекратить отслеживание изменений
+     */
+    void disable_delta_tracking() {
+        delta_tracker.disable();
+    }
+
+    /**
+     * @brief Записать снимок: дельту с прошлого вызова или keyframe
+     *
+     * Без включённого отслеживания всегда пишется keyframe.
+     * Формат см. heap_delta.h.
+     */
+    void write_heap_delta(HeapSnapshotWriter& writer);
+
+    /**
+     * @brief Трекер изменений (счётчики, запрос keyframe)
+     */
+    HeapDeltaTracker& get_delta_tracker() {
+        return delta_tracker;
+    }
+
+    // === CHECKPOINT ===
+
+    /**
+     * @brief Записать полное состояние в бинарном формате (heap_checkpoint.h)
+     */
+    void write_checkpoint(HeapSnapshotWriter& writer) const override;
+
+    /**
+     * @brief Восстановить состояние из буфера с checkpoint'ом
+     *
+     * При ошибке текущее состояние не меняется. Логи не сохраняются
+     * в checkpoint и не сбрасываются.
+     *
+     * @return false, если данные повреждены или записаны другим коллектором
+     */
+    bool read_checkpoint(const uint8_t* data, size_t size) override;
+
+    /**
+     * @brief Сохранить checkpoint в файл
+     */
+    bool save_checkpoint(const std::string& path) const;
+
+    /**
+     * @brief Загрузить checkpoint из файла (через mmap)
+     */
+    bool load_checkpoint(const std::string& path);
+
     /**
      * @brief Получить статистику сборки
      * @return Строка со статистикой
      */
     std::string get_gc_stats() const override;
 
+    /**
+     * @brief Счётчики сборок и пауз (см. GCInterface::get_collection_stats)
+     */
+    GCCollectionStats get_collection_stats() const override;
+
     /**
      * @brief Получить последний лог операции
      */
@@ -149,6 +262,20 @@ public:
         last_operation = "";
     }
 
+    /**
+     * @brief Включить/выключить логирование операций
+     */
+    void set_logging_enabled(bool enabled) {
+        logging_enabled = enabled;
+    }
+
+    /**
+     * @brief Включено ли логирование
+     */
+    bool is_logging_enabled() const {
+        return logging_enabled;
+    }
+
     /**
      * @brief Получить общий размер выделенной памяти
      */
@@ -165,13 +292,13 @@ public:
      * @brief Сделать объект root (всегда достижимым)
      * @param object_id ID объекта
      */
-    void make_root(int object_id);
+    void make_root(int object_id) override;
 
     /**
      * @brief Удалить статус root у объекта
      * @param object_id ID объекта
      */
-    void remove_root(int object_id);
+    void remove_root(int object_id) override;
 
     /**
      * @brief Получить объект по ID
@@ -192,7 +319,31 @@ public:
     /**
      * @brief Получить количество живых объектов
      */
-    int get_alive_objects_count() const;
+    int get_alive_objects_count() const override;
+
+    // === ЗАПРОСЫ К HEAP'У ===
+
+    /**
+     * @brief Постраничный запрос объектов с фильтрами
+     * @param query Диапазон ID, размер страницы и фильтры
+     * @return Страница объектов и курсор следующей страницы
+     */
+    HeapQueryResult query_objects(const HeapQuery& query) const;
+
+    /**
+     * @brief k-окрестность объекта
+     * @param object_id Центральный объект
+     * @param hops Радиус в рёбрах
+     * @param max_nodes Максимум объектов в ответе
+     * @param direction По каким рёбрам идти
+     */
+    HeapNeighborhood get_neighborhood(int object_id, int hops, size_t max_nodes = 1000,
+                                      NeighborDirection direction = NeighborDirection::BOTH) const;
+
+    /**
+     * @brief Сводные показатели heap'а за O(1)
+     */
+    HeapSummary get_summary() const;
 
     /**
      * @brief Получить все объекты (для визуализации)
@@ -204,20 +355,25 @@ public:
     /**
      * @brief Установить текущий шаг симуляции
      */
-    void set_current_step(int step) {
+    void set_current_step(int step) override {
         current_step = step;
     }
 
     /**
      * @brief Получить текущий шаг симуляции
      */
-    int get_current_step() const {
+    int get_current_step() const override {
         return current_step;
     }
 
 private:
     // === ВНУТРЕННИЕ МЕТОДЫ ===
 
+    /**
+     * @brief Пересчитать индексы и агрегаты по heap'у (после загрузки)
+     */
+    void rebuild_indexes();
+
     /**
      * @brief Mark фаза: пометить все достижимые объекты
      */
@@ -250,6 +406,16 @@ private:
      * @brief Проверить, достаточно ли памяти для выделения
      */
     bool has_enough_memory(size_t size) const;
+
+    /**
+     * @brief Пройден ли порог автоматической сборки с учётом size байт
+     */
+    bool threshold_reached(size_t size) const;
+
+    /**
+     * @brief Пересчитать trigger_memory после сборки
+     */
+    void update_trigger();
 };
 
 #endif // MARK_SWEEP_GC_H
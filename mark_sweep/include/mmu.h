@@ -0,0 +1,73 @@
+#ifndef MMU_H
+#define MMU_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Интервал, когда работал сборщик (мс от начала прогона)
+ */
+struct PauseInterval {
+    double start_ms;
+    double end_ms;
+};
+
+/**
+ * @brief Точка кривой MMU
+ */
+struct MMUPoint {
+    double window_ms;
+    double utilization;   // 0..1
+};
+
+/**
+ * @brief Минимальная утилизация мутатора (MMU)
+ *
+ * MMU(w) — наименьшая доля времени, доставшаяся программе, по всем
+ * окнам длины w внутри прогона [0, total_ms]. Средняя пауза этого не
+ * показывает: две паузы по 40 мс подряд дают MMU(100 мс) = 0.2 при
+ * сколь угодно малой средней загрузке сборщика.
+ *
+ * Худшее окно всегда начинается в начале паузы или заканчивается в
+ * её конце, поэтому перебираются только такие окна; время сборки
+ * в окне считается по префиксным суммам. Сложность — O(P log P)
+ * на одно окно для P пауз.
+ */
+class MMUCalculator {
+public:
+    /**
+     * @param pauses Паузы в любом порядке; перекрывающиеся сливаются,
+     *               выходящие за [0, total_ms] обрезаются
+     * @param total_ms Длительность прогона
+     */
+    MMUCalculator(std::vector<PauseInterval> pauses, double total_ms);
+
+    /**
+     * @brief MMU для окна window_ms (окно длиннее прогона сжимается до прогона)
+     */
+    double utilization(double window_ms) const;
+
+    /**
+     * @brief Кривая MMU по окнам; окна длиннее прогона пропускаются
+     */
+    std::vector<MMUPoint> curve(const std::vector<double>& windows_ms) const;
+
+    /** @brief Доля времени мутатора за весь прогон */
+    double overall_utilization() const;
+
+    double get_total_ms() const { return total_ms; }
+    double get_pause_ms() const { return prefix.empty() ? 0.0 : prefix.back(); }
+
+    /** @brief Окна от 1 мс до 1 с (1-2-5) */
+    static std::vector<double> default_windows();
+
+private:
+    std::vector<PauseInterval> pauses;   // Упорядочены, не перекрываются
+    std::vector<double> prefix;          // prefix[i] — сборка в pauses[0..i]
+    double total_ms;
+
+    /** @brief Время сборки в [0, t] */
+    double collector_time_before(double t) const;
+};
+
+#endif // MMU_H
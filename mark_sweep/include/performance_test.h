@@ -2,6 +2,8 @@
 #define PERFORMANCE_TEST_H
 
 #include "mark_sweep_gc.h"
+#include "replay_engine.h"
+#include "benchmark_harness.h"
 #include <chrono>
 #include <vector>
 #include <string>
@@ -27,6 +29,11 @@ struct PerfTestResult {
     size_t memory_used_bytes;
     size_t memory_freed_bytes;
     int collection_runs;
+    double throughput_mb_per_s = 0.0; // только для тестов снимков heap'а
+    double ops_per_second = 0.0;      // только для тестов исполнения сценариев
+    json details;                     // развёрнутые метрики (паузы, график heap'а); null — нет
+    std::vector<double> samples_ms;   // повторные замеры (benchmark_collect); пусто — один прогон
+    SampleStats stats;                // сводка по samples_ms
     std::string timestamp;
     
     json to_json() const {
@@ -41,6 +48,19 @@ struct PerfTestResult {
         j["memory_used_mb"] = std::round((memory_used_bytes / (1024.0 * 1024.0)) * 100) / 100.0;
         j["memory_freed_mb"] = std::round((memory_freed_bytes / (1024.0 * 1024.0)) * 100) / 100.0;
         j["collection_runs"] = collection_runs;
+        if (throughput_mb_per_s > 0.0) {
+            j["throughput_mb_per_s"] = std::round(throughput_mb_per_s * 100) / 100.0;
+        }
+        if (ops_per_second > 0.0) {
+            j["ops_per_second"] = std::round(ops_per_second);
+        }
+        if (!details.is_null()) {
+            j["details"] = details;
+        }
+        if (!samples_ms.empty()) {
+            j["samples_ms"] = samples_ms;
+            j["stats"] = stats.to_json();
+        }
         j["timestamp"] = timestamp;
         return j;
     }
@@ -69,9 +89,10 @@ public:
      * После Mark-Sweep all удаляются, т.к. достижимы из root
      * 
      * @param num_objects Количество объектов в цепи
+     * @param backend Имя из gc_backend_names()
      * @return PerfTestResult с результатами
      */
-    PerfTestResult test_simple_linear(int num_objects);
+    PerfTestResult test_simple_linear(int num_objects, const std::string& backend = "mark_sweep");
     
     /**
      * @brief Сценарий 2: Циклический граф
@@ -84,9 +105,11 @@ public:
      * 
      * @param num_objects Количество объектов с циклами
      * @param cycle_length Длина каждого цикла (по умолчанию 3)
+     * @param backend Имя из gc_backend_names(); что не собрано — в objects_leaked
      * @return PerfTestResult с результатами
      */
-    PerfTestResult test_cyclic_graph(int num_objects, int cycle_length = 3);
+    PerfTestResult test_cyclic_graph(int num_objects, int cycle_length = 3,
+                                     const std::string& backend = "mark_sweep");
     
     /**
      * @brief Сценарий 3: Древовидная структура с каскадным удалением
@@ -102,19 +125,356 @@ public:
      * @param num_objects Количество объектов (распределяются по дереву)
      * @param branches Количество ветвей из каждого узла
      * @param depth Глубина дерева
+     * @param backend Имя из gc_backend_names()
      * @return PerfTestResult с результатами
      */
-    PerfTestResult test_cascade_tree(int num_objects);
+    PerfTestResult test_cascade_tree(int num_objects, const std::string& backend = "mark_sweep");
+    
+    /**
+     * @brief Пропускная способность потокового снимка heap'а
+     * 
+     * Строит линейную цепь (логирование выключено) и пишет снимок
+     * через HeapSnapshotWriter в /dev/null. Для сравнения на размерах
+     * до compare_limit замеряется и старый путь через get_heap_info().
+     * 
+     * @param num_objects Количество объектов в heap'е
+     * @param compare_limit Максимальный размер для замера get_heap_info()
+     * @return PerfTestResult с throughput_mb_per_s
+     */
+    PerfTestResult test_snapshot_throughput(int num_objects, int compare_limit = 1000000);
+    
+    /**
+     * @brief Запустить бенчмарк снимков на нескольких размерах
+     * @param sizes Размеры heap'а в объектах (по умолчанию 1M и 10M)
+     */
+    void run_snapshot_benchmarks(const std::vector<int>& sizes = {1000000, 10000000});
+    
+    /**
+     * @brief Объём дельта-снимков против полных
+     * 
+     * На цепи из num_objects объектов делается steps шагов по
+     * changes_per_step изменений; после каждого шага пишется
+     * дельта-снимок. Для сравнения замеряется полный снимок
+     * итогового heap'а (в счётчик, без вывода).
+     * 
+     * @param num_objects Исходный размер heap'а
+     * @param steps Количество шагов
+     * @param changes_per_step Изменений (выделений + рёбер) за шаг
+     * @return PerfTestResult: memory_used_bytes — суммарный объём дельт
+     */
+    PerfTestResult test_delta_snapshots(int num_objects, int steps = 100, int changes_per_step = 10);
+    
+    /**
+     * @brief Построение heap'а через API против загрузки checkpoint'а
+     * 
+     * Строит дерево (fanout 4) вызовами allocate/add_reference,
+     * сохраняет checkpoint в output_dir и загружает его в новый
+     * коллектор. Для размеров до verify_limit снимки до и после
+     * сравниваются побайтно.
+     * 
+     * @param num_objects Количество объектов
+     * @param verify_limit Максимальный размер для сверки снимков
+     * @return PerfTestResult: execution_time_ms — время загрузки
+     */
+    PerfTestResult test_checkpoint_restore(int num_objects, int verify_limit = 100000);
+    
+    /**
+     * @brief Запустить бенчмарк checkpoint'ов на нескольких размерах
+     */
+    void run_checkpoint_benchmarks(const std::vector<int>& sizes = {1000000, 10000000});
+    
+    /**
+     * @brief Перемотка записанного сценария к произвольному шагу
+     * 
+     * Записывает случайный поток из num_ops операций (выделения,
+     * рёбра, корни, периодические сборки), проигрывает его до конца
+     * и делает num_seeks перемоток в случайные шаги. Результат одной
+     * перемотки сверяется с прямым выполнением на новом коллекторе.
+     * 
+     * @param num_ops Длина потока операций
+     * @param checkpoint_interval Шагов между checkpoint'ами
+     * @param num_seeks Количество случайных перемоток
+     * @return PerfTestResult: execution_time_ms — среднее время seek
+     */
+    PerfTestResult test_replay_seek(int num_ops, int checkpoint_interval = 1000, int num_seeks = 20);
+    
+    /**
+     * @brief Скорость разбора JSON-сценария (MB/s)
+     * 
+     * Генерирует сценарий из num_ops операций и разбирает его
+     * потоковым ScenarioParser. На размерах до compare_limit для
+     * сравнения замеряются прежние парсеры: find('{') + sscanf по
+     * строке со всем файлом и DOM nlohmann::json; результат первого
+     * сверяется операция за операцией.
+     * 
+     * @param num_ops Количество операций в сценарии
+     * @param compare_limit Максимальный размер для прежних парсеров
+     * @return PerfTestResult: throughput_mb_per_s, memory_used_bytes — размер файла
+     */
+    PerfTestResult test_scenario_parse(int num_ops, int compare_limit = 1000000);
+    
+    /**
+     * @brief Запуск сценария из JSON против бинарного файла (mmap)
+     * 
+     * Генерирует JSON из num_ops операций, замеряет его открытие
+     * (разбор), конвертирует в бинарный формат и замеряет открытие
+     * отображением. Оба варианта проходятся целиком и сверяются
+     * по контрольной сумме.
+     * 
+     * @param num_ops Количество операций
+     * @return PerfTestResult: execution_time_ms — открытие бинарного файла
+     */
+    PerfTestResult test_binary_scenario_load(int num_ops);
+    
+    /**
+     * @brief Скорость цикла исполнения сценария (операций в секунду)
+     * 
+     * Один и тот же сценарий (случайное дерево с обрывом ссылок,
+     * временными корнями и редкими сборками) исполняется дважды на
+     * коллекторе backend без логирования: прежним циклом драйвера
+     * (сравнение строк, вызовы через GCInterface, dynamic_cast для
+     * корней) и execute_scenario по массиву CompactOp. Итоговые кучи
+     * сверяются.
+     * 
+     * @param num_ops Количество операций
+     * @param backend Имя из gc_backend_names()
+     * @return PerfTestResult: ops_per_second — скомпилированный цикл
+     */
+    PerfTestResult test_scenario_dispatch(int num_ops, const std::string& backend = "mark_sweep");
+    
+    /**
+     * @brief Построение графа: поштучные вызовы против пакетных
+     * 
+     * Одно и то же 4-арное дерево строится на MarkSweepGC с логированием
+     * дважды: allocate/add_reference на каждый объект и ребро и
+     * allocate_many/add_references одним вызовом каждого. Итоговые
+     * кучи сверяются.
+     * 
+     * @param num_objects Количество объектов
+     * @return PerfTestResult: ops_per_second — пакетное построение
+     */
+    PerfTestResult test_bulk_construction(int num_objects);
+    
+    /**
+     * @brief Синтетическая нагрузка из workload_generator.h на MarkSweepGC
+     * 
+     * Генератор исполняет профиль прямо на коллекторе без логирования;
+     * сборка запускается каждые collect_every выделений. Позволяет
+     * сравнить стоимость сборки на прежних формах (профиль "uniform")
+     * и на нагрузке, похожей на настоящий heap ("production").
+     * 
+     * @param preset Имя профиля (см. workload_preset())
+     * @param num_allocations Количество выделений
+     * @param collect_every Период явной сборки в выделениях
+     * @return PerfTestResult: ops_per_second — операций генератора в секунду
+     */
+    PerfTestResult test_workload(const std::string& preset, int num_allocations, int collect_every = 100000);
+    
+    /**
+     * @brief Установившийся режим: непрерывное выделение со сборками по порогу
+     * 
+     * Профиль "churn" из workload_generator.h держит live_objects живых
+     * объектов: каждое выделение сопровождается смертью другого объекта
+     * и перестановками ссылок. Явных collect() нет — сборки запускает
+     * сам коллектор, когда занятая память проходит порог (80% heap'а);
+     * варианты RC порога не имеют и освобождают объекты сами.
+     * 
+     * В details: доля времени в сборке, перцентили пауз (p50/p90/p99/max),
+     * число сборок по порогу, кривая MMU и график heap'а — пик занятой
+     * памяти и число живых объектов по интервалам.
+     * 
+     * @param backend Имя из gc_backend_names()
+     * @param live_objects Размер поддерживаемого живого множества
+     * @param num_allocations Количество выделений
+     * @param heap_bytes Размер heap'а
+     * @return PerfTestResult: ops_per_second — операций генератора в секунду
+     */
+    PerfTestResult test_churn(const std::string& backend, int live_objects, int num_allocations,
+                              size_t heap_bytes);
+    
+    /**
+     * @brief Запустить test_churn для каждого коллектора GCInterface
+     */
+    void run_churn_benchmarks(int live_objects = 100000, int num_allocations = 1000000,
+                              size_t heap_bytes = 32 * 1024 * 1024);
+    
+    /**
+     * @brief Задержки операций при сбросе большого дерева в RCHeap
+     * 
+     * Строится 4-арное дерево из num_objects объектов, затем снимается
+     * корень и мутатор выделяет объекты, пока отложенная работа не
+     * закончится (не меньше 1000 операций). Каждая операция замеряется
+     * отдельно: без отложенного режима весь каскад приходится на
+     * remove_root(), с ним — размазан по выделениям.
+     * 
+     * @param num_objects Размер дерева
+     * @param budget Уменьшений ref_count на выделение; 0 — синхронный каскад
+     * @return PerfTestResult: execution_time_ms — от сброса корня до
+     *         освобождения всего дерева, в details — задержки операций
+     */
+    PerfTestResult test_rc_teardown(int num_objects, size_t budget);
+    
+    /**
+     * @brief test_rc_teardown для синхронного каскада и нескольких порций
+     */
+    void run_rc_teardown_benchmarks(int num_objects = 1000000,
+                                    const std::vector<size_t>& budgets = {0, 16, 64, 256});
+    
+    /**
+     * @brief Часто перезаписываемые ссылки в RCHeap с слиянием и без
+     * 
+     * У num_holders корневых объектов одна ссылка, которую мутатор по
+     * кругу перенаправляет между 64 целями (remove + add); каждые
+     * 100000 записей — collect(). Без слияния каждая запись меняет
+     * ref_count; со слиянием за эпоху — только чистая разница.
+     * 
+     * @param num_holders Объектов с перезаписываемой ссылкой
+     * @param writes Всего перенаправлений ссылки
+     * @param epoch_buffer Порог журнала эпохи; 0 — без слияния
+     * @return PerfTestResult: execution_time_ms — все записи и сборки,
+     *         в details — число изменений ref_count на запись
+     */
+    PerfTestResult test_rc_coalescing(int num_holders, int writes, size_t epoch_buffer);
+    
+    /**
+     * @brief test_rc_coalescing без слияния и с несколькими порогами журнала
+     */
+    void run_rc_coalescing_benchmarks(int num_holders = 1000, int writes = 1000000,
+                                      const std::vector<size_t>& epoch_buffers = {0, 256, 4096});
+    
+    /**
+     * @brief Доля байт, освобождённых каскадом RC и резервной трассировкой
+     * 
+     * Поток операций матрицы (см. test_backend_matrix_cell) исполняется
+     * на RCHeap с резервной трассировкой. В "cyclic" кольца может
+     * освободить только трассировка, в "tree" всё освобождает каскад.
+     * 
+     * @param scenario "cyclic", "tree" или "workload"
+     * @param num_objects Размер сценария в объектах
+     * @param trace_interval Байт выделений между трассировками
+     * @return PerfTestResult: memory_freed_bytes — всё освобождённое,
+     *         в details — разбивка по RC и трассировке
+     */
+    PerfTestResult test_rc_hybrid(const std::string& scenario, int num_objects, size_t trace_interval);
+    
+    /**
+     * @brief test_rc_hybrid на циклах, дереве и смешанной нагрузке
+     */
+    void run_rc_hybrid_benchmarks(const std::vector<int>& sizes = {10000, 100000},
+                                  size_t trace_interval = 1048576);
+    
+    /**
+     * @brief Объект RCHeap с num_edges исходящими ссылками
+     * 
+     * Корневой объект по одной ссылке через add_reference() связывается
+     * с num_edges целями, затем каждая ссылка добавляется повторно
+     * (только проверка, что она уже есть), каждая вторая снимается, и
+     * наконец снимается корень — каскад освобождает остальное. Каждая
+     * фаза замеряется отдельно; со списком ссылок без индекса связывание
+     * и снятие квадратичны по числу ссылок.
+     * 
+     * @param num_edges Исходящих ссылок у объекта
+     * @return PerfTestResult: execution_time_ms — все фазы, в details —
+     *         время и нс на ссылку по фазам
+     */
+    PerfTestResult test_rc_fanout(int num_edges);
+    
+    /**
+     * @brief test_rc_fanout для нескольких степеней
+     */
+    void run_rc_fanout_benchmarks(const std::vector<int>& edge_counts = {1000, 100000, 1000000});
+    
+    /**
+     * @brief Взятие и снятие корней из нескольких потоков в ConcurrentRCHeap
+     * 
+     * Каждый поток выделяет 1024 своих объекта, затем по сигналу делает
+     * ops_per_thread пар add_root/release_root: с вероятностью
+     * remote_fraction — над объектом другого потока, иначе над своим.
+     * Замеряется только эта фаза. После неё каждый поток снимает корни
+     * объектов соседа (в режиме BIASED они уходят в очередь владельца),
+     * владельцы разбирают очереди, и куча должна опустеть.
+     * 
+     * @param biased true — смещённые счётчики, false — атомарные
+     * @param num_threads Потоков-мутаторов
+     * @param ops_per_thread Пар add_root/release_root на поток
+     * @param remote_fraction Доля операций над чужими объектами
+     * @return PerfTestResult: ops_per_second — пары за секунду по всем потокам
+     */
+    PerfTestResult test_concurrent_rc(bool biased, int num_threads, int ops_per_thread,
+                                      double remote_fraction);
+    
+    /**
+     * @brief test_concurrent_rc в обоих режимах для нескольких чисел потоков
+     */
+    void run_concurrent_rc_benchmarks(const std::vector<int>& thread_counts = {1, 2, 4},
+                                      int ops_per_thread = 1000000, double remote_fraction = 0.1);
+    
+    /**
+     * @brief Повторные замеры сборки на графе заданной формы
+     * 
+     * Граф строится в setup() без логирования и не попадает в замер;
+     * измеряется полный цикл: collect() при живом графе (разметка),
+     * remove_root() и collect(), освобождающий всё (очистка).
+     * execution_time_ms — медиана, в samples_ms и stats — все замеры.
+     * 
+     * @param shape "linear", "cyclic" или "tree" (4-арное дерево)
+     * @param num_objects Количество объектов
+     * @param harness Параметры прогрева и повторов
+     * @return PerfTestResult с samples_ms и stats
+     */
+    PerfTestResult benchmark_collect(const std::string& shape, int num_objects,
+                                     const BenchmarkHarness& harness);
+    
+    /**
+     * @brief Запустить benchmark_collect для всех форм и размеров
+     * 
+     * При options.pin_cpu >= 0 поток закрепляется за CPU. Сведения о
+     * машине и сборке попадают в поле "environment" файлов результатов.
+     */
+    void run_benchmark_suite(const std::vector<int>& sizes = {1000, 10000},
+                             const BenchmarkOptions& options = BenchmarkOptions());
+    
+    /**
+     * @brief Одна клетка матрицы: сценарий на коллекторе
+     * 
+     * Поток операций сценария строится один раз и исполняется через
+     * GCInterface на свежем коллекторе из make_gc_backend() в каждом
+     * повторе; замер — всё исполнение (мутатор и сборки). В конце
+     * потока корни снимаются и запускается сборка, так что оставшиеся
+     * объекты — утечки.
+     * 
+     * @param backend Имя из gc_backend_names()
+     * @param scenario "linear", "cyclic", "tree" или "workload"
+     * @param num_objects Размер сценария в объектах
+     * @param harness Параметры прогрева и повторов
+     * @return PerfTestResult: memory_used_bytes — пик heap'а,
+     *         objects_leaked — объекты после снятия корней
+     */
+    PerfTestResult test_backend_matrix_cell(const std::string& backend, const std::string& scenario,
+                                            int num_objects, const BenchmarkHarness& harness);
+    
+    /**
+     * @brief Матрица "сценарий x размер x коллектор" с общей таблицей
+     */
+    void run_backend_matrix(const std::vector<int>& sizes = {1000, 10000},
+                            const BenchmarkOptions& options = BenchmarkOptions());
+    
+    /**
+     * @brief Запустить бенчмарк разбора сценариев на нескольких размерах
+     */
+    void run_parse_benchmarks(const std::vector<int>& sizes = {1000000, 10000000});
     
     /**
      * @brief Запустить все три сценария с тремя размерами
      * @param small_size Маленький набор (~1K объектов)
      * @param medium_size Средний набор (~10K объектов)
      * @param large_size Большой набор (~100K объектов)
+     * @param backend Имя из gc_backend_names()
      */
     void run_all_tests(int small_size = 100, 
                        int medium_size = 1000, 
-                       int large_size = 10000);
+                       int large_size = 10000,
+                       const std::string& backend = "mark_sweep");
     
     /**
      * @brief Получить все результаты тестов
@@ -129,6 +489,26 @@ public:
      */
     void save_results_to_json(const std::string& filename = "performance_results.json");
     
+    /**
+     * @brief Сохранить кривые MMU (см. mmu.h) всех прогонов test_churn
+     * 
+     * Для каждого коллектора — MMU для окон от 1 мс до 1 с, общая доля
+     * времени мутатора и число пауз. Без прогонов test_churn файл не пишется.
+     * 
+     * @param filename Имя файла в output_dir
+     */
+    void save_mmu_to_json(const std::string& filename = "mmu_results.json");
+    
+    /**
+     * @brief Сохранить сводку результатов в CSV (одна строка на тест)
+     * 
+     * Для тестов без повторных замеров статистика считается по
+     * единственному execution_time_ms.
+     * 
+     * @param filename Имя файла в output_dir
+     */
+    void save_results_to_csv(const std::string& filename = "performance_results.csv");
+    
     /**
      * @brief Вывести краткую таблицу результатов в консоль
      */
@@ -137,6 +517,8 @@ public:
 private:
     std::string output_dir;
     std::vector<PerfTestResult> results;
+    json mmu_results;   // Кривые MMU по коллекторам (test_churn)
+    json environment;   // Машина и сборка (run_benchmark_suite); null — не записывается
     
     /**
      * @brief Получить текущее время в ISO формате
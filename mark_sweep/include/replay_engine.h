@@ -0,0 +1,118 @@
+#ifndef REPLAY_ENGINE_H
+#define REPLAY_ENGINE_H
+
+#include "gc_interface.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/**
+ * @brief Тип записанной операции
+ */
+enum class ReplayOpType : uint8_t {
+    ALLOCATE,
+    ADD_REF,
+    REMOVE_REF,
+    MAKE_ROOT,
+    REMOVE_ROOT,
+    COLLECT
+};
+
+/**
+ * @brief Одна операция записанного потока
+ */
+struct ReplayOp {
+    ReplayOpType type;
+    int a;   // ALLOCATE: размер; ADD_REF/REMOVE_REF: from; MAKE_ROOT/REMOVE_ROOT: id
+    int b;   // ADD_REF/REMOVE_REF: to
+
+    static ReplayOp allocate(int size) { return {ReplayOpType::ALLOCATE, size, 0}; }
+    static ReplayOp add_ref(int from, int to) { return {ReplayOpType::ADD_REF, from, to}; }
+    static ReplayOp remove_ref(int from, int to) { return {ReplayOpType::REMOVE_REF, from, to}; }
+    static ReplayOp make_root(int id) { return {ReplayOpType::MAKE_ROOT, id, 0}; }
+    static ReplayOp remove_root(int id) { return {ReplayOpType::REMOVE_ROOT, id, 0}; }
+    static ReplayOp collect() { return {ReplayOpType::COLLECT, 0, 0}; }
+};
+
+/**
+ * @brief Счётчики движка воспроизведения
+ */
+struct ReplayStats {
+    size_t checkpoints = 0;          // Сколько checkpoint'ов хранится
+    size_t raw_bytes = 0;            // Их размер до сжатия
+    size_t compressed_bytes = 0;     // Их размер после сжатия
+    size_t ops_executed = 0;         // Всего выполнено операций
+    size_t restores = 0;             // Сколько раз восстанавливались из checkpoint'а
+    size_t last_seek_replayed = 0;   // Операций выполнено при последнем seek
+    double last_seek_ms = 0.0;       // Время последнего seek
+};
+
+/**
+ * @brief Воспроизведение потока операций с перемоткой
+ *
+ * Движок выполняет записанные операции на любом GCInterface и каждые
+ * checkpoint_interval шагов сохраняет сжатый checkpoint. seek(N)
+ * восстанавливает ближайший checkpoint не позже N и доигрывает
+ * остаток, поэтому после первого прохода перемотка стоит не больше
+ * checkpoint_interval операций независимо от N.
+ *
+ * Шаг N — состояние после выполнения первых N операций; шаг 0 —
+ * состояние коллектора на момент создания движка.
+ */
+class ReplayEngine {
+public:
+    /** @brief Интервал checkpoint'ов по умолчанию */
+    static constexpr size_t DEFAULT_CHECKPOINT_INTERVAL = 1000;
+
+    /**
+     * @param gc Коллектор, на котором воспроизводятся операции
+     * @param checkpoint_interval Шагов между checkpoint'ами
+     */
+    explicit ReplayEngine(GCInterface& gc,
+                          size_t checkpoint_interval = DEFAULT_CHECKPOINT_INTERVAL);
+
+    /** @brief Дописать операцию в конец потока (без выполнения) */
+    void record(const ReplayOp& op) { ops.push_back(op); }
+
+    /** @brief Дописать несколько операций */
+    void record(const std::vector<ReplayOp>& more) {
+        ops.insert(ops.end(), more.begin(), more.end());
+    }
+
+    /**
+     * @brief Перейти к состоянию после step операций
+     * @return false, если step за концом потока или checkpoint повреждён
+     */
+    bool seek(size_t step);
+
+    /** @brief Выполнить поток до конца */
+    bool run_to_end() { return seek(ops.size()); }
+
+    /** @brief Текущий шаг */
+    size_t get_position() const { return position; }
+
+    /** @brief Длина записанного потока */
+    size_t get_length() const { return ops.size(); }
+
+    /** @brief Интервал checkpoint'ов */
+    size_t get_checkpoint_interval() const { return interval; }
+
+    const ReplayStats& get_stats() const { return stats; }
+
+    const std::vector<ReplayOp>& get_ops() const { return ops; }
+
+private:
+    GCInterface& gc;
+    size_t interval;
+    std::vector<ReplayOp> ops;
+    size_t position;
+    std::map<size_t, std::vector<uint8_t>> checkpoints;  // шаг -> сжатый checkpoint
+    ReplayStats stats;
+
+    void apply(const ReplayOp& op);
+    void take_checkpoint();
+    bool restore_checkpoint(size_t step);
+};
+
+#endif // REPLAY_ENGINE_H
@@ -0,0 +1,169 @@
+#ifndef SCENARIO_BINARY_H
+#define SCENARIO_BINARY_H
+
+#include "scenario_parser.h"
+#include "heap_checkpoint.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * @brief Бинарный формат сценария
+ *
+ * Операции лежат в файле в том же виде, что и CompactOp в памяти,
+ * поэтому отображённый через mmap файл исполняется на месте — без
+ * разбора и без копирования:
+ *
+ *   BinaryScenarioHeader              64 байта
+ *   CompactOp[op_count]               по 12 байт (байты выравнивания — нули)
+ *   char[name_length]                 имя сценария (без завершающего нуля)
+ *
+ * Имя лежит после операций, чтобы конвертер мог писать операции
+ * потоком и дописать заголовок в конце. Порядок байт — родной.
+ */
+
+/** @brief "GCSC" */
+constexpr uint32_t SCENARIO_MAGIC = 0x43534347;
+
+/**
+ * @brief Версия формата
+ *
+ * 2 — добавлены макрооперации (CHAIN, TREE, ...); файлы версии 1
+ * их не содержат и читаются без изменений.
+ */
+constexpr uint32_t SCENARIO_VERSION = 2;
+
+/**
+ * @brief Заголовок бинарного сценария
+ */
+struct BinaryScenarioHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t collector;           // CheckpointKind
+    uint32_t op_size;             // sizeof(CompactOp)
+    uint32_t name_length;
+    uint64_t heap_size;
+    uint64_t op_count;
+    uint64_t name_offset;
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(BinaryScenarioHeader) == 64, "BinaryScenarioHeader layout changed");
+static_assert(sizeof(CompactOp) == 12, "CompactOp layout changed");
+
+/**
+ * @brief Тип коллектора из "collection_type" JSON-сценария
+ */
+CheckpointKind scenario_collector_from_name(const std::string& collection_type);
+
+/**
+ * @brief Обратное преобразование ("mark_sweep", "cascade", "reference_counting")
+ */
+const char* scenario_collector_name(CheckpointKind kind);
+
+/**
+ * @brief Потоковая запись бинарного сценария
+ *
+ * Операции дописываются по одной через буфер stdio; заголовок и имя
+ * записываются в finish(), когда известно их количество.
+ */
+class BinaryScenarioWriter {
+public:
+    BinaryScenarioWriter();
+    ~BinaryScenarioWriter();
+
+    BinaryScenarioWriter(const BinaryScenarioWriter&) = delete;
+    BinaryScenarioWriter& operator=(const BinaryScenarioWriter&) = delete;
+
+    /** @brief Создать файл (заголовок пока пустой) */
+    bool open(const std::string& path);
+
+    /** @brief Дописать операцию */
+    void append(const CompactOp& op);
+
+    /**
+     * @brief Записать имя и заголовок, закрыть файл
+     * @return false, если какая-либо запись не удалась
+     */
+    bool finish(const std::string& name, const std::string& collection_type, size_t heap_size);
+
+    uint64_t get_op_count() const { return op_count; }
+
+private:
+    std::FILE* file;
+    uint64_t op_count;
+    bool failed;
+};
+
+/**
+ * @brief Записать разобранный сценарий в бинарный файл
+ */
+bool write_binary_scenario(const std::string& path, const CompactScenario& scenario);
+
+/**
+ * @brief Конвертировать JSON-сценарий в бинарный
+ *
+ * JSON разбирается потоково, операции сразу уходят в файл, поэтому
+ * память не зависит от длины сценария.
+ *
+ * @param error Описание ошибки (если не nullptr)
+ * @param op_count Количество записанных операций (если не nullptr)
+ */
+bool convert_json_scenario(const std::string& json_path,
+                           const std::string& binary_path,
+                           std::string* error = nullptr,
+                           uint64_t* op_count = nullptr);
+
+/**
+ * @brief Сценарий для драйверов: бинарный (mmap) или JSON
+ *
+ * open() смотрит на magic: бинарный файл отображается в память и
+ * операции читаются прямо из отображения, JSON разбирается
+ * ScenarioParser'ом в массив. Дальше оба варианта выглядят одинаково.
+ */
+class ScenarioFile {
+public:
+    ScenarioFile();
+
+    ScenarioFile(const ScenarioFile&) = delete;
+    ScenarioFile& operator=(const ScenarioFile&) = delete;
+
+    /**
+     * @brief Открыть сценарий любого формата
+     * @return false при ошибке (см. get_error())
+     */
+    bool open(const std::string& path);
+
+    const CompactOp* ops() const { return op_data; }
+    size_t size() const { return op_count; }
+    bool empty() const { return op_count == 0; }
+    const CompactOp& operator[](size_t i) const { return op_data[i]; }
+    const CompactOp* begin() const { return op_data; }
+    const CompactOp* end() const { return op_data + op_count; }
+
+    size_t heap_size() const { return heap_bytes; }
+    const std::string& collection_type() const { return collector; }
+    const std::string& name() const { return scenario_name; }
+
+    /** @brief true, если сценарий исполняется из отображённого файла */
+    bool is_binary() const { return binary; }
+
+    const std::string& get_error() const { return error; }
+
+private:
+    MappedCheckpointFile mapping;
+    CompactScenario parsed;
+    const CompactOp* op_data;
+    size_t op_count;
+    size_t heap_bytes;
+    std::string collector;
+    std::string scenario_name;
+    bool binary;
+    std::string error;
+
+    bool open_binary(const std::string& path);
+};
+
+#endif // SCENARIO_BINARY_H
@@ -0,0 +1,278 @@
+#ifndef SCENARIO_EXECUTOR_H
+#define SCENARIO_EXECUTOR_H
+
+#include "scenario_parser.h"
+#include "gc_interface.h"
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Исполнитель скомпилированных сценариев
+ *
+ * Сценарий заранее превращён в массив CompactOp (ScenarioParser или
+ * бинарный файл), поэтому шаг исполнения — один switch по коду без
+ * сравнения строк. Исполнитель — шаблон по конкретному коллектору:
+ * MarkSweepGC и CascadeDeletionGC объявлены final, и вызовы
+ * allocate/make_root/add_reference/... в цикле не виртуальные и
+ * встраиваются. Корни — часть общего контракта GCInterface, так что
+ * dynamic_cast на шаге не нужен.
+ *
+ * Макрооперации (CHAIN, TREE, ...) разворачиваются здесь же, без
+ * промежуточных записей: все объекты выделяются одним allocate_many(),
+ * затем связи из for_each_macro_edge() уходят пачками в add_references().
+ *
+ * Наблюдатель получает (step, op, result) после каждой операции;
+ * result — id нового объекта для ALLOCATE и id первого объекта для
+ * макроопераций, освобождённые байты для COLLECT, успех (1/0) для
+ * ADD_REF/REMOVE_REF и 0 для остальных. Для макрооперации op — её
+ * первая запись, а step — её индекс в массиве.
+ */
+
+/**
+ * @brief Наблюдатель, который ничего не делает (для замеров)
+ */
+struct NullScenarioObserver {
+    void operator()(size_t, const CompactOp&, int64_t) const {}
+};
+
+/**
+ * @brief Перебрать связи макрооперации
+ *
+ * edge(from, to) получает локальные номера объектов 0..count-1.
+ * RANDOM_GRAPH перебирает только выпавшие пары (геометрические
+ * пропуски), поэтому стоимость — O(n + число связей), а результат
+ * зависит лишь от seed.
+ */
+template<typename Edge>
+void for_each_macro_edge(const ScenarioMacro& macro, Edge&& edge) {
+    const int32_t n = macro.count;
+
+    switch (macro.code) {
+        case ScenarioOpCode::CHAIN:
+            for (int32_t i = 1; i < n; ++i) {
+                edge(i - 1, i);
+            }
+            break;
+
+        case ScenarioOpCode::RING:
+            for (int32_t i = 1; i < n; ++i) {
+                edge(i - 1, i);
+            }
+            if (n > 0) {
+                edge(n - 1, 0);
+            }
+            break;
+
+        case ScenarioOpCode::TREE:
+            // Узлы пронумерованы по уровням: родитель узла k — (k-1)/fanout
+            for (int32_t k = 1; k < n; ++k) {
+                edge((k - 1) / macro.fanout, k);
+            }
+            break;
+
+        case ScenarioOpCode::RANDOM_GRAPH: {
+            if (n < 2 || macro.probability <= 0.0f) {
+                break;
+            }
+            const uint64_t row = static_cast<uint64_t>(n - 1);
+            const uint64_t pairs = static_cast<uint64_t>(n) * row;
+            auto emit_pair = [&edge, row](uint64_t index) {
+                int32_t from = static_cast<int32_t>(index / row);
+                int32_t to = static_cast<int32_t>(index % row);
+                edge(from, to >= from ? to + 1 : to);
+            };
+
+            if (macro.probability >= 1.0f) {
+                for (uint64_t index = 0; index < pairs; ++index) {
+                    emit_pair(index);
+                }
+                break;
+            }
+
+            std::mt19937 rng(macro.seed);
+            const double log_q = std::log1p(-static_cast<double>(macro.probability));
+            uint64_t index = 0;
+            for (;;) {
+                double u = (static_cast<double>(rng()) + 0.5) / 4294967296.0;
+                double skip = std::floor(std::log(u) / log_q);
+                if (skip >= static_cast<double>(pairs - index)) {
+                    break;
+                }
+                index += static_cast<uint64_t>(skip);
+                emit_pair(index);
+                if (++index >= pairs) {
+                    break;
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Итоги исполнения сценария
+ */
+struct ScenarioExecutionStats {
+    uint64_t executed = 0;          // Исполнено операций
+    uint64_t skipped = 0;           // ALLOCATE с размером <= 0, повреждённые макрооперации
+    uint64_t allocated_bytes = 0;
+    uint64_t freed_bytes = 0;
+    uint64_t collections = 0;
+    size_t peak_memory = 0;         // Максимум get_total_memory() после ALLOCATE
+};
+
+/** @brief Сколько связей макрооперации копится перед add_references() */
+constexpr size_t MACRO_EDGE_BATCH = 64 * 1024;
+
+/**
+ * @brief Собрать связи макрооперации в пачки и отдать их flush(pairs, count)
+ *
+ * Локальные номера переводятся в id first_id + i; связи с объектами
+ * за пределами allocated (не хватило памяти) отбрасываются.
+ */
+template<typename Flush>
+void batch_macro_edges(const ScenarioMacro& macro, int first_id, int allocated,
+                       std::vector<ReferencePair>& edges, Flush&& flush) {
+    edges.clear();
+    for_each_macro_edge(macro, [&](int32_t from, int32_t to) {
+        if (from >= allocated || to >= allocated) {
+            return;
+        }
+        edges.push_back(ReferencePair{first_id + from, first_id + to});
+        if (edges.size() == MACRO_EDGE_BATCH) {
+            flush(edges.data(), edges.size());
+            edges.clear();
+        }
+    });
+    if (!edges.empty()) {
+        flush(edges.data(), edges.size());
+        edges.clear();
+    }
+}
+
+/**
+ * @brief Развернуть макрооперацию на коллекторе
+ *
+ * Объекты выделяются одним allocate_many(), связи уходят пачками
+ * в add_references().
+ *
+ * @param edges Рабочий буфер под пачку связей
+ * @return id первого объекта или -1, если ничего не выделено
+ */
+template<typename GC>
+int64_t expand_scenario_macro(GC& gc, const ScenarioMacro& macro, std::vector<ReferencePair>& edges,
+                              ScenarioExecutionStats& stats) {
+    if (macro.size <= 0 || macro.count == 0) {
+        return -1;
+    }
+
+    ObjectIdRange range = gc.allocate_many(static_cast<size_t>(macro.count),
+                                           static_cast<size_t>(macro.size));
+    stats.allocated_bytes += static_cast<uint64_t>(macro.count) * static_cast<uint64_t>(macro.size);
+    size_t current = gc.get_total_memory();
+    if (current > stats.peak_memory) {
+        stats.peak_memory = current;
+    }
+    if (range.empty()) {
+        return -1;
+    }
+
+    batch_macro_edges(macro, range.first, range.count, edges,
+                      [&gc](const ReferencePair* pairs, size_t n) { gc.add_references(pairs, n); });
+    return range.first;
+}
+
+/**
+ * @brief Исполнить сценарий на конкретном коллекторе
+ *
+ * @tparam GC Класс коллектора (не GCInterface — иначе вызовы снова виртуальные)
+ * @param observer Вызывается после каждой исполненной операции
+ */
+template<typename GC, typename Observer>
+ScenarioExecutionStats execute_scenario(GC& gc, const CompactOp* ops, size_t count,
+                                        Observer&& observer) {
+    ScenarioExecutionStats stats;
+    std::vector<ReferencePair> edges;
+    size_t length = 1;
+
+    for (size_t step = 0; step < count; step += length) {
+        const CompactOp& op = ops[step];
+        gc.set_current_step(static_cast<int>(step));
+        int64_t result = 0;
+        length = 1;
+
+        switch (op.code) {
+            case ScenarioOpCode::ALLOCATE: {
+                if (op.a <= 0) {
+                    stats.skipped++;
+                    continue;
+                }
+                result = gc.allocate(static_cast<size_t>(op.a));
+                stats.allocated_bytes += static_cast<uint64_t>(op.a);
+                size_t current = gc.get_total_memory();
+                if (current > stats.peak_memory) {
+                    stats.peak_memory = current;
+                }
+                break;
+            }
+            case ScenarioOpCode::MAKE_ROOT:
+                gc.make_root(op.a);
+                break;
+            case ScenarioOpCode::REMOVE_ROOT:
+                gc.remove_root(op.a);
+                break;
+            case ScenarioOpCode::ADD_REF:
+                result = gc.add_reference(op.a, op.b) ? 1 : 0;
+                break;
+            case ScenarioOpCode::REMOVE_REF:
+                result = gc.remove_reference(op.a, op.b) ? 1 : 0;
+                break;
+            case ScenarioOpCode::COLLECT: {
+                size_t freed = gc.collect();
+                stats.freed_bytes += freed;
+                stats.collections++;
+                result = static_cast<int64_t>(freed);
+                break;
+            }
+            case ScenarioOpCode::ALLOCATE_RANGE:
+            case ScenarioOpCode::CHAIN:
+            case ScenarioOpCode::RING:
+            case ScenarioOpCode::TREE:
+            case ScenarioOpCode::RANDOM_GRAPH: {
+                ScenarioMacro macro;
+                length = scenario_op_length(op.code);
+                if (!decode_scenario_macro(&op, count - step, macro)) {
+                    stats.skipped++;
+                    continue;
+                }
+                result = expand_scenario_macro(gc, macro, edges, stats);
+                break;
+            }
+            case ScenarioOpCode::MACRO_ARGS:
+                // Осиротевшее продолжение (повреждённый файл)
+                stats.skipped++;
+                continue;
+        }
+
+        stats.executed++;
+        observer(step, op, result);
+    }
+
+    return stats;
+}
+
+/**
+ * @brief Исполнить сценарий без наблюдателя
+ */
+template<typename GC>
+ScenarioExecutionStats execute_scenario(GC& gc, const CompactOp* ops, size_t count) {
+    return execute_scenario(gc, ops, count, NullScenarioObserver());
+}
+
+#endif // SCENARIO_EXECUTOR_H
@@ -0,0 +1,231 @@
+#ifndef SCENARIO_PARSER_H
+#define SCENARIO_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Код операции сценария
+ */
+enum class ScenarioOpCode : uint8_t {
+    ALLOCATE,
+    MAKE_ROOT,
+    REMOVE_ROOT,
+    ADD_REF,
+    REMOVE_REF,
+    COLLECT,
+
+    // Макрооперации: строят граф целиком, исполнитель разворачивает их сам
+    ALLOCATE_RANGE,   // count объектов без связей
+    CHAIN,            // i -> i+1
+    RING,             // i -> (i+1) % count
+    TREE,             // полное дерево: узел k -> k*fanout+1 .. k*fanout+fanout
+    RANDOM_GRAPH,     // G(n, p): каждая упорядоченная пара i != j с вероятностью p
+    MACRO_ARGS        // Продолжение параметров предыдущей макрооперации
+};
+
+/**
+ * @brief Одна операция сценария в компактном виде (12 байт)
+ *
+ * Макрооперация занимает несколько записей: основную и следом
+ * одну-две записи MACRO_ARGS (см. scenario_op_length()):
+ *
+ *   ALLOCATE_RANGE/CHAIN/RING  {a=count, b=size}  {a=first_id}
+ *   TREE                       {a=fanout, b=depth} {a=first_id, b=size}
+ *   RANDOM_GRAPH               {a=n, b=size} {a=first_id, b=seed} {a=p (биты float)}
+ */
+struct CompactOp {
+    ScenarioOpCode code;
+    int32_t a;   // ALLOCATE: размер; MAKE_ROOT/REMOVE_ROOT: id; ADD_REF/REMOVE_REF: from
+    int32_t b;   // ALLOCATE: id объекта; ADD_REF/REMOVE_REF: to
+};
+
+/**
+ * @brief Макрооперация в развёрнутом виде
+ *
+ * Объекты макрооперации нумеруются локально 0..count-1; в сценарии
+ * им соответствуют id first_id..first_id+count-1.
+ */
+struct ScenarioMacro {
+    ScenarioOpCode code = ScenarioOpCode::ALLOCATE_RANGE;
+    int32_t count = 0;          // Объектов (для TREE вычисляется из fanout и depth)
+    int32_t size = 0;           // Размер каждого объекта
+    int32_t first_id = 0;
+    int32_t fanout = 2;         // TREE
+    int32_t depth = 0;          // TREE: 0 — только корень
+    uint32_t seed = 0;          // RANDOM_GRAPH
+    float probability = 0.0f;   // RANDOM_GRAPH
+};
+
+/** @brief Максимум записей на одну операцию */
+constexpr size_t SCENARIO_MAX_OP_RECORDS = 3;
+
+/**
+ * @brief true для ALLOCATE_RANGE, CHAIN, RING, TREE, RANDOM_GRAPH
+ */
+bool scenario_is_macro(ScenarioOpCode code);
+
+/**
+ * @brief Сколько записей CompactOp занимает операция (1..3)
+ */
+size_t scenario_op_length(ScenarioOpCode code);
+
+/**
+ * @brief Количество узлов полного дерева или -1, если больше INT32_MAX
+ */
+int64_t scenario_tree_size(int32_t fanout, int32_t depth);
+
+/**
+ * @brief Упаковать макрооперацию в записи
+ * @return Количество записанных записей
+ */
+size_t encode_scenario_macro(const ScenarioMacro& macro, CompactOp out[SCENARIO_MAX_OP_RECORDS]);
+
+/**
+ * @brief Подпись макрооперации для вывода по её первой записи
+ *
+ * "CHAIN 1000 x 64 bytes", "TREE fanout 2, depth 10" и т.п.
+ */
+std::string scenario_macro_label(const CompactOp& op);
+
+/**
+ * @brief Распаковать макрооперацию, начинающуюся с ops[0]
+ * @param available Сколько записей доступно начиная с ops
+ * @return false, если записей не хватает или параметры некорректны
+ */
+bool decode_scenario_macro(const CompactOp* ops, size_t available, ScenarioMacro& macro);
+
+/**
+ * @brief Разобранный сценарий
+ */
+struct CompactScenario {
+    std::string name;
+    std::string description;
+    std::string collection_type = "mark_sweep";
+    size_t heap_size = 104857600;
+    std::vector<CompactOp> ops;
+    uint64_t bytes_parsed = 0;     // Размер входа в байтах
+    uint64_t skipped_ops = 0;      // Операции с неизвестным "op"
+};
+
+/**
+ * @brief Имя операции для вывода ("allocate", "add_ref", ...)
+ */
+const char* scenario_op_name(ScenarioOpCode code);
+
+/**
+ * @brief Распознать имя операции
+ *
+ * Регистр, '_' и '-' не учитываются, поэтому принимаются оба
+ * стиля сценариев: make_root / add_root / addroot, add_ref / addref,
+ * remove_root / removeroot / delete_root, remove_ref / removeref,
+ * allocate / alloc, collect / gc.
+ */
+bool scenario_op_from_name(const char* name, size_t length, ScenarioOpCode& code);
+
+/**
+ * @brief Потоковый парсер JSON-сценариев
+ *
+ * Файл читается порциями фиксированного размера и разбирается за
+ * один проход без построения дерева документа: каждая операция из
+ * массива "operations" сразу превращается в CompactOp. Память парсера
+ * не зависит от размера файла (кроме токенов длиннее буфера), поэтому
+ * сценарии на сотни миллионов операций разбираются без копии файла
+ * в памяти; с приёмником операций не хранится и сам массив.
+ *
+ * Корнем может быть объект сценария или сразу массив операций.
+ * Поля верхнего уровня: "heap_size" (приоритетнее) или "max_heap_size",
+ * "collection_type", "scenario_name" / "name", "description"; прочие
+ * пропускаются. Поля операции: "op" (или "type"), "id", "size", "from",
+ * "to". Если у allocate нет "id", ему присваивается порядковый номер
+ * выделения — так же нумеруют объекты коллекторы Mark-Sweep.
+ *
+ * Макрооперации описывают граф одной строкой:
+ *   {"op": "allocate_range", "count": N, "size": S}
+ *   {"op": "chain", "count": N, "size": S}
+ *   {"op": "ring", "count": N, "size": S}
+ *   {"op": "tree", "fanout": F, "depth": D, "size": S}
+ *   {"op": "random_graph", "n": N, "p": 0.01, "seed": 7, "size": S}
+ * "id" задаёт id первого объекта, по умолчанию — следующий порядковый
+ * номер; счётчик выделений сдвигается на число объектов макрооперации.
+ * allocate и макросы с size <= 0 исполнитель пропускает, поэтому
+ * счётчик они не сдвигают.
+ */
+class ScenarioParser {
+public:
+    /** @brief Приёмник операций при потоковом разборе */
+    using OpSink = std::function<void(const CompactOp&)>;
+
+    /** @brief Размер буфера чтения по умолчанию (1 MB) */
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 1024 * 1024;
+
+    explicit ScenarioParser(size_t buffer_size = DEFAULT_BUFFER_SIZE);
+    ~ScenarioParser();
+
+    ScenarioParser(const ScenarioParser&) = delete;
+    ScenarioParser& operator=(const ScenarioParser&) = delete;
+
+    /**
+     * @brief Разобрать файл, операции складываются в out.ops
+     * @return false при ошибке чтения или синтаксиса (см. get_error())
+     */
+    bool parse_file(const std::string& path, CompactScenario& out);
+
+    /**
+     * @brief Разобрать файл, отдавая операции в sink
+     *
+     * out.ops не заполняется — подходит для конвертеров и файлов,
+     * массив операций которых не нужен в памяти целиком.
+     */
+    bool parse_file(const std::string& path, CompactScenario& out, const OpSink& sink);
+
+    /**
+     * @brief Разобрать сценарий из строки
+     */
+    bool parse_string(const std::string& text, CompactScenario& out);
+
+    /** @brief Описание последней ошибки (со смещением в байтах) */
+    const std::string& get_error() const { return error; }
+
+private:
+    enum class Key : uint8_t;
+
+    std::vector<char> buffer;
+    const char* base;         // Начало текущего окна (буфер или строка)
+    const char* cur;
+    const char* end;
+    std::FILE* file;
+    uint64_t consumed;        // Байт отброшено из начала буфера
+    int32_t allocations;      // id следующего allocate (с size > 0 — прочие пропускаются)
+    const OpSink* sink;
+    CompactScenario* target;
+    std::string scratch;      // Строки с escape-последовательностями
+    std::string error;
+
+    bool run(CompactScenario& out);
+    bool refill();
+    bool skip_ws();
+    bool expect(char c);
+    bool fail(const std::string& message);
+    void emit(const CompactOp& op);
+
+    bool scan_string(size_t& length, bool& escaped);
+    bool read_string(std::string* out);
+    bool read_view(const char*& text, size_t& length);
+    bool read_key(Key& key);
+    bool scan_bare(size_t& length);
+    bool read_integer(int64_t& result);
+    bool read_int32(int32_t& result);
+    bool read_number(double& result);
+    bool skip_value();
+
+    bool parse_root_object();
+    bool parse_operations();
+    bool parse_operation();
+};
+
+#endif // SCENARIO_PARSER_H
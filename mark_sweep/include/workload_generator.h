@@ -0,0 +1,371 @@
+#ifndef WORKLOAD_GENERATOR_H
+#define WORKLOAD_GENERATOR_H
+
+#include "scenario_parser.h"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Распределение размеров объектов
+ */
+enum class SizeDistribution : uint8_t {
+    FIXED,          // Всегда size
+    UNIFORM,        // Равномерно в [min_size, max_size]
+    LOG_NORMAL,     // Медиана size, разброс size_sigma, обрезка по [min_size, max_size]
+    SIZE_CLASSES    // Гистограмма size_classes: (размер, вес)
+};
+
+/**
+ * @brief Параметры синтетической нагрузки
+ *
+ * Время измеряется в выделениях: время жизни 100 — объект умирает
+ * через 100 выделений после своего рождения.
+ */
+struct WorkloadConfig {
+    uint64_t seed = 42;
+
+    // === РАЗМЕРЫ ===
+    SizeDistribution size_distribution = SizeDistribution::LOG_NORMAL;
+    size_t size = 48;                  // FIXED: размер; LOG_NORMAL: медиана
+    size_t min_size = 16;
+    size_t max_size = 4096;
+    double size_sigma = 1.0;           // LOG_NORMAL: sigma логарифма размера
+    std::vector<std::pair<size_t, double>> size_classes;
+
+    // === СВЯЗИ ===
+    double degree_exponent = 2.0;      // P(k) ~ (k+1)^-alpha, k = 0..max_out_degree; 0 — равномерно
+    int max_out_degree = 32;
+    double preferential_fraction = 0.8; // Доля связей по предпочтительному присоединению
+    double back_edge_fraction = 0.05;  // Доля связей старый -> новый (циклы, old-to-young)
+
+    // === ВРЕМЯ ЖИЗНИ ===
+    double long_lived_fraction = 0.05; // Доля объектов, живущих до конца
+    double mean_lifetime = 1000.0;     // Среднее время жизни остальных (экспонента)
+
+    // === УСТАНОВИВШИЙСЯ РЕЖИМ ===
+    size_t steady_state_live = 0;      // Держать не больше N живых объектов (0 — без ограничения)
+    double mutations_per_allocation = 0.0; // Перестановок ссылок на одно выделение
+    int anchor_count = 64;             // Корней-якорей, на которых держатся объекты
+    uint64_t collect_every = 0;        // Явная сборка каждые N выделений (0 — только сам коллектор)
+};
+
+/**
+ * @brief Проверить параметры нагрузки
+ * @param error Описание ошибки, если параметры некорректны
+ */
+bool validate_workload_config(const WorkloadConfig& config, std::string& error);
+
+/**
+ * @brief Готовые профили нагрузки
+ *
+ *   production   — log-normal размеры, степенные степени, предпочтительное
+ *                  присоединение, 5% долгоживущих
+ *   generational — как production, но почти все объекты умирают молодыми
+ *   uniform      — как прежние тесты: объекты по 64 байта, не больше
+ *                  одной ссылки, все живут до конца
+ *   churn        — production с постоянным живым множеством 100K объектов
+ *                  и перестановкой ссылок
+ *
+ * @return false, если профиль неизвестен
+ */
+bool workload_preset(const std::string& name, WorkloadConfig& config);
+
+/** @brief Имена профилей для справки ("production", "generational", ...) */
+std::vector<std::string> workload_preset_names();
+
+/**
+ * @brief Итоги генерации
+ */
+struct WorkloadStats {
+    uint64_t operations = 0;           // Всего операций, отданных коллектору
+    uint64_t allocations = 0;
+    uint64_t failed_allocations = 0;   // allocate() вернул -1
+    uint64_t allocated_bytes = 0;
+    uint64_t edges_added = 0;          // Без учёта ссылок от якорей
+    uint64_t edges_removed = 0;
+    uint64_t deaths = 0;               // Объектов, отцепленных от якоря
+    uint64_t mutations = 0;
+    uint64_t collections = 0;
+    uint64_t freed_bytes = 0;
+    double collect_ms = 0.0;           // Время явных сборок (collect_every)
+    size_t peak_memory = 0;            // Максимум get_total_memory() после выделения
+    size_t live_objects = 0;           // Живых по модели генератора (без якорей)
+};
+
+/**
+ * @brief Коллектор-заглушка для записи нагрузки в поток операций
+ *
+ * Выдаёт id подряд с нуля, как MarkSweepGC, и никогда не отказывает,
+ * поэтому записанные операции на свежем коллекторе получают те же id.
+ */
+struct WorkloadRecordingHeap {
+    int next_id = 0;
+    size_t used = 0;
+
+    int allocate(size_t size) { used += size; return next_id++; }
+    bool add_reference(int, int) { return true; }
+    bool remove_reference(int, int) { return true; }
+    void make_root(int) {}
+    size_t collect() { return 0; }
+    size_t get_total_memory() const { return used; }
+    void set_current_step(int) {}
+};
+
+/**
+ * @brief Генератор синтетической нагрузки
+ *
+ * Операции не записываются в сценарий, а сразу исполняются на
+ * коллекторе: run() — шаблон по классу коллектора, как
+ * execute_scenario(), поэтому вызовы не виртуальные. Генератор
+ * держит собственную модель живого множества и выбирает только
+ * объекты, которые по модели живы, так что ссылки на освобождённые
+ * объекты не появляются.
+ *
+ * Модель нагрузки:
+ *  - в начале создаются anchor_count корней-якорей; каждый новый объект
+ *    прицепляется ссылкой к случайному якорю;
+ *  - смерть объекта — удаление ссылки от якоря; станет ли он мусором,
+ *    решает граф: на него могут ссылаться другие живые объекты;
+ *  - число исходящих связей нового объекта — степенное распределение;
+ *    цель выбирается пропорционально входящей степени + 1
+ *    (предпочтительное присоединение) или равномерно среди живых;
+ *  - время жизни — экспонента со средним mean_lifetime, доля
+ *    long_lived_fraction живёт до конца (слабая гипотеза поколений);
+ *  - в установившемся режиме при превышении steady_state_live умирает
+ *    объект с ближайшим сроком смерти.
+ *
+ * Все случайные величины считаются из mt19937_64 без стандартных
+ * распределений, поэтому последовательность операций при одинаковом
+ * seed совпадает на любой стандартной библиотеке.
+ *
+ * Генератор привязан к одному коллектору: повторные run() продолжают
+ * нагрузку с того же состояния.
+ *
+ * Наблюдатель получает (step, op, result) — как в execute_scenario():
+ * ALLOCATE {a=размер, b=id}, ADD_REF/REMOVE_REF {a=from, b=to},
+ * MAKE_ROOT {a=id}, COLLECT. Записанные операции можно исполнить на
+ * другом коллекторе с той же нумерацией id.
+ */
+class WorkloadGenerator {
+public:
+    explicit WorkloadGenerator(const WorkloadConfig& config);
+
+    /**
+     * @brief Выполнить num_allocations выделений вместе со связями,
+     *        смертями, перестановками и сборками между ними
+     */
+    template<typename GC, typename Observer>
+    WorkloadStats run(GC& gc, uint64_t num_allocations, Observer&& observer);
+
+    template<typename GC>
+    WorkloadStats run(GC& gc, uint64_t num_allocations) {
+        return run(gc, num_allocations, NullWorkloadObserver());
+    }
+
+    const WorkloadConfig& get_config() const { return config; }
+
+    /** @brief Живых объектов по модели (без якорей) */
+    size_t live_count() const { return live.size(); }
+
+    /** @brief Выделений с начала работы (часы генератора) */
+    uint64_t get_clock() const { return clock; }
+
+private:
+    struct NullWorkloadObserver {
+        void operator()(size_t, const CompactOp&, int64_t) const {}
+    };
+
+    /** @brief Объект модели */
+    struct ModelObject {
+        int anchor = -1;               // id якоря; -1 — сам якорь
+        uint32_t live_pos = 0;         // Позиция в live
+        std::vector<int> out;          // Связи, созданные генератором
+    };
+
+    /** @brief Запланированная смерть */
+    struct Death {
+        uint64_t time;
+        int id;
+        bool operator>(const Death& other) const { return time > other.time; }
+    };
+
+    static constexpr uint64_t IMMORTAL = std::numeric_limits<uint64_t>::max();
+
+    WorkloadConfig config;
+    std::mt19937_64 rng;
+    std::vector<double> degree_cdf;      // P(степень <= k)
+    std::vector<double> size_class_cdf;
+    double log_median_size;
+
+    std::unordered_map<int, ModelObject> objects;
+    std::vector<int> anchors;
+    std::vector<int> live;               // Живые не-якоря
+    std::vector<int> attachment;         // Id с кратностью входящая степень + 1
+    size_t attachment_limit;             // Размер, после которого attachment чистится
+    std::vector<Death> deaths;           // Min-heap по времени
+    std::vector<int> targets;            // Рабочий буфер целей нового объекта
+    uint64_t clock;
+    size_t step;
+
+    // === СЛУЧАЙНЫЕ ВЕЛИЧИНЫ ===
+    double uniform();
+    uint64_t uniform_index(uint64_t n);
+    size_t sample_size();
+    int sample_out_degree();
+    uint64_t sample_death_time();
+
+    // === МОДЕЛЬ ===
+    void add_anchor(int id);
+    int pick_anchor();
+    void add_object(int id, int anchor, uint64_t death_time);
+    void remove_object(int id);
+    void compact_attachment();
+    bool is_live(int id) const;
+    int pick_target(int exclude);
+    void pick_targets(int new_id, int degree);
+    void note_edge(int from, int to);
+    bool pop_due_death(int& id, int& anchor);
+    bool pop_churn_victim(int& id, int& anchor);
+    bool pick_mutation(int& from, int& old_to, int& new_to);
+};
+
+template<typename GC, typename Observer>
+WorkloadStats WorkloadGenerator::run(GC& gc, uint64_t num_allocations, Observer&& observer) {
+    WorkloadStats stats;
+
+    auto emit = [&](ScenarioOpCode code, int a, int b, int64_t result) {
+        CompactOp op;
+        op.code = code;
+        op.a = a;
+        op.b = b;
+        observer(step, op, result);
+        step++;
+        stats.operations++;
+    };
+    auto add_ref = [&](int from, int to, bool counted) {
+        gc.set_current_step(static_cast<int>(step));
+        bool ok = gc.add_reference(from, to);
+        emit(ScenarioOpCode::ADD_REF, from, to, ok ? 1 : 0);
+        if (counted) {
+            stats.edges_added++;
+        }
+    };
+    auto remove_ref = [&](int from, int to, bool counted) {
+        gc.set_current_step(static_cast<int>(step));
+        bool ok = gc.remove_reference(from, to);
+        emit(ScenarioOpCode::REMOVE_REF, from, to, ok ? 1 : 0);
+        if (counted) {
+            stats.edges_removed++;
+        }
+    };
+    auto allocate = [&]() {
+        size_t size = sample_size();
+        gc.set_current_step(static_cast<int>(step));
+        int id = gc.allocate(size);
+        emit(ScenarioOpCode::ALLOCATE, static_cast<int>(size), id, id);
+        if (id < 0) {
+            stats.failed_allocations++;
+            return id;
+        }
+        stats.allocations++;
+        stats.allocated_bytes += size;
+        size_t current = gc.get_total_memory();
+        if (current > stats.peak_memory) {
+            stats.peak_memory = current;
+        }
+        return id;
+    };
+    auto kill = [&](int id, int anchor) {
+        remove_ref(anchor, id, false);
+        remove_object(id);
+        stats.deaths++;
+    };
+
+    // Якоря создаются при первом запуске
+    while (static_cast<int>(anchors.size()) < config.anchor_count) {
+        int id = allocate();
+        if (id < 0) {
+            break;
+        }
+        gc.set_current_step(static_cast<int>(step));
+        gc.make_root(id);
+        emit(ScenarioOpCode::MAKE_ROOT, id, 0, 0);
+        add_anchor(id);
+    }
+
+    double pending_mutations = 0.0;
+    int id = -1;
+    int anchor = -1;
+
+    for (uint64_t i = 0; i < num_allocations && !anchors.empty(); ++i) {
+        clock++;
+
+        // Смерти, срок которых наступил
+        while (pop_due_death(id, anchor)) {
+            kill(id, anchor);
+        }
+
+        // Перестановки ссылок в уже живом графе
+        pending_mutations += config.mutations_per_allocation;
+        while (pending_mutations >= 1.0) {
+            pending_mutations -= 1.0;
+            int from = -1;
+            int old_to = -1;
+            int new_to = -1;
+            if (pick_mutation(from, old_to, new_to)) {
+                remove_ref(from, old_to, true);
+                add_ref(from, new_to, true);
+                stats.mutations++;
+            }
+        }
+
+        // Новый объект, его якорь и связи
+        int new_id = allocate();
+        if (new_id >= 0) {
+            int new_anchor = pick_anchor();
+            add_ref(new_anchor, new_id, false);
+            add_object(new_id, new_anchor, sample_death_time());
+
+            pick_targets(new_id, sample_out_degree());
+            for (int target : targets) {
+                if (uniform() < config.back_edge_fraction) {
+                    add_ref(target, new_id, true);
+                    note_edge(target, new_id);
+                } else {
+                    add_ref(new_id, target, true);
+                    note_edge(new_id, target);
+                }
+            }
+        }
+
+        // Установившийся режим: живое множество не растёт
+        if (config.steady_state_live > 0) {
+            while (live.size() > config.steady_state_live && pop_churn_victim(id, anchor)) {
+                kill(id, anchor);
+            }
+        }
+
+        if (config.collect_every > 0 && clock % config.collect_every == 0) {
+            gc.set_current_step(static_cast<int>(step));
+            auto start = std::chrono::high_resolution_clock::now();
+            size_t freed = gc.collect();
+            stats.collect_ms += std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            emit(ScenarioOpCode::COLLECT, 0, 0, static_cast<int64_t>(freed));
+            stats.collections++;
+            stats.freed_bytes += freed;
+        }
+    }
+
+    stats.live_objects = live.size();
+    return stats;
+}
+
+#endif // WORKLOAD_GENERATOR_H
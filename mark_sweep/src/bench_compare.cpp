@@ -0,0 +1,216 @@
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "benchmark_harness.h"
+
+namespace {
+
+/**
+ * @brief Замеры одного теста из файла результатов perf_test
+ */
+struct BenchEntry {
+    std::string test_name;
+    int total_objects = 0;
+    std::vector<double> samples_ms;   // Без повторов — один execution_time_ms
+};
+
+/**
+ * @brief Прочитать файл save_results_to_json; ключ — имя теста и размер
+ */
+bool load_results(const std::string& path, std::map<std::string, BenchEntry>& entries,
+                  std::vector<std::string>& order, json& environment) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: cannot open " << path << "\n";
+        return false;
+    }
+
+    json document;
+    try {
+        file >> document;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << path << ": " << e.what() << "\n";
+        return false;
+    }
+    if (!document.contains("tests") || !document["tests"].is_array()) {
+        std::cerr << "Error: " << path << ": no \"tests\" array\n";
+        return false;
+    }
+    environment = document.value("environment", json());
+
+    const json& tests = document["tests"];
+    for (size_t i = 0; i < tests.size(); ++i) {
+        const json& test = tests[i];
+        BenchEntry entry;
+        // Поле не того типа (строка вместо числа, объект вместо теста) —
+        // ошибка входного файла, а не исключение из main
+        try {
+            entry.test_name = test.value("test_name", "");
+            entry.total_objects = test.value("total_objects", 0);
+            if (test.contains("samples_ms") && test["samples_ms"].is_array()) {
+                entry.samples_ms = test["samples_ms"].get<std::vector<double>>();
+            } else if (test.contains("execution_time_ms")) {
+                entry.samples_ms.push_back(test["execution_time_ms"].get<double>());
+            }
+        } catch (const json::exception& e) {
+            std::cerr << "Error: " << path << ": test #" << i;
+            if (!entry.test_name.empty()) {
+                std::cerr << " (" << entry.test_name << ")";
+            }
+            std::cerr << ": " << e.what() << "\n";
+            return false;
+        }
+
+        // Повтор того же теста того же размера — берётся первый
+        std::string key = entry.test_name + "|" + std::to_string(entry.total_objects);
+        if (entries.emplace(key, entry).second) {
+            order.push_back(key);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Предупредить, если прогоны сделаны на разных машинах или сборках
+ */
+void warn_environment_mismatch(const json& baseline, const json& candidate) {
+    if (baseline.is_null() || candidate.is_null()) {
+        return;
+    }
+    for (const char* field : {"host", "cpu_model", "compiler", "build_type", "optimized"}) {
+        json a = baseline.value(field, json());
+        json b = candidate.value(field, json());
+        if (a != b) {
+            std::cerr << "Warning: " << field << " differs: " << a.dump() << " vs " << b.dump() << "\n";
+        }
+    }
+}
+
+double mean_of(const std::vector<double>& samples) {
+    return compute_sample_stats(samples).mean;
+}
+
+} // namespace
+
+/**
+ * @brief bench_compare baseline.json candidate.json [--alpha A] [--threshold PERCENT]
+ *
+ * Сопоставляет тесты по имени и размеру и сравнивает повторные замеры
+ * t-критерием Уэлча. Регрессия — среднее выросло, p < alpha и рост не
+ * меньше threshold процентов. Коды выхода: 0 — регрессий нет,
+ * 1 — есть значимая регрессия, 2 — ошибка аргументов или файлов.
+ */
+int main(int argc, char* argv[]) {
+    std::vector<std::string> files;
+    double alpha = 0.05;
+    double threshold_percent = 5.0;
+    try {
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--alpha" && i + 1 < argc) {
+                alpha = std::stod(argv[++i]);
+            } else if (arg == "--threshold" && i + 1 < argc) {
+                threshold_percent = std::stod(argv[++i]);
+            } else {
+                files.push_back(arg);
+            }
+        }
+    } catch (...) {
+        std::cerr << "Error: invalid number\n";
+        return 2;
+    }
+    if (files.size() != 2 || !(alpha > 0.0 && alpha < 1.0) || threshold_percent < 0.0) {
+        std::cerr << "Usage: " << argv[0]
+                  << " baseline.json candidate.json [--alpha 0.05] [--threshold 5]\n";
+        return 2;
+    }
+
+    std::map<std::string, BenchEntry> baseline;
+    std::map<std::string, BenchEntry> candidate;
+    std::vector<std::string> baseline_order;
+    std::vector<std::string> candidate_order;
+    json baseline_environment;
+    json candidate_environment;
+    if (!load_results(files[0], baseline, baseline_order, baseline_environment) ||
+        !load_results(files[1], candidate, candidate_order, candidate_environment)) {
+        return 2;
+    }
+    warn_environment_mismatch(baseline_environment, candidate_environment);
+
+    std::cout << "\n" << std::left
+              << std::setw(32) << "Test"
+              << std::setw(10) << "Objects"
+              << std::setw(14) << "Base (ms)"
+              << std::setw(14) << "New (ms)"
+              << std::setw(10) << "Change"
+              << std::setw(10) << "p-value"
+              << "Verdict\n";
+    std::cout << std::string(100, '-') << "\n";
+
+    int regressions = 0;
+    int improvements = 0;
+    int unmatched = 0;
+    for (const std::string& key : candidate_order) {
+        const BenchEntry& entry = candidate[key];
+        auto it = baseline.find(key);
+        if (it == baseline.end()) {
+            unmatched++;
+            std::cout << std::left << std::setw(32) << entry.test_name.substr(0, 31)
+                      << std::setw(10) << entry.total_objects << "new test\n";
+            continue;
+        }
+
+        double base_mean = mean_of(it->second.samples_ms);
+        double new_mean = mean_of(entry.samples_ms);
+        double change = base_mean > 0.0 ? (new_mean - base_mean) / base_mean * 100.0 : 0.0;
+        SampleComparison comparison = welch_t_test(it->second.samples_ms, entry.samples_ms);
+
+        std::string verdict = "same";
+        if (!comparison.valid) {
+            verdict = "single run, not tested";
+        } else if (comparison.p_value < alpha && std::fabs(change) >= threshold_percent) {
+            if (change > 0.0) {
+                verdict = "REGRESSION";
+                regressions++;
+            } else {
+                verdict = "improved";
+                improvements++;
+            }
+        }
+
+        std::ostringstream change_text;
+        change_text << std::showpos << std::fixed << std::setprecision(1) << change << "%";
+        std::ostringstream p_text;
+        if (comparison.valid) {
+            p_text << std::fixed << std::setprecision(4) << comparison.p_value;
+        } else {
+            p_text << "-";
+        }
+
+        std::cout << std::left << std::setw(32) << entry.test_name.substr(0, 31)
+                  << std::setw(10) << entry.total_objects
+                  << std::setw(14) << std::fixed << std::setprecision(3) << base_mean
+                  << std::setw(14) << new_mean
+                  << std::setw(10) << change_text.str()
+                  << std::setw(10) << p_text.str()
+                  << verdict << "\n";
+    }
+    for (const std::string& key : baseline_order) {
+        if (candidate.find(key) == candidate.end()) {
+            unmatched++;
+            std::cout << std::left << std::setw(32) << baseline[key].test_name.substr(0, 31)
+                      << std::setw(10) << baseline[key].total_objects << "missing in candidate\n";
+        }
+    }
+
+    std::cout << std::string(100, '-') << "\n";
+    std::cout << std::defaultfloat << regressions << " regression(s), "
+              << improvements << " improvement(s), " << unmatched << " unmatched (alpha " << alpha << ", threshold "
+              << threshold_percent << "%)\n\n";
+    return regressions > 0 ? 1 : 0;
+}
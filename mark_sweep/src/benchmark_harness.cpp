@@ -0,0 +1,280 @@
+#include "benchmark_harness.h"
+
+#include <cmath>
+#include <fstream>
+#include <thread>
+
+#ifdef __linux__
+#include <cerrno>
+#include <cstring>
+#include <sched.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/utsname.h>
+#endif
+
+// Тип сборки передаётся из CMake; без него — только то, что видно компилятору
+#ifndef GC_BUILD_TYPE
+#define GC_BUILD_TYPE ""
+#endif
+
+// ===========================
+// СТАТИСТИКА
+// ===========================
+
+json SampleStats::to_json() const {
+    auto round4 = [](double value) { return std::round(value * 10000) / 10000.0; };
+    return {
+        {"count", count},
+        {"mean_ms", round4(mean)},
+        {"median_ms", round4(median)},
+        {"stddev_ms", round4(stddev)},
+        {"min_ms", round4(min)},
+        {"max_ms", round4(max)},
+        {"ci_low_ms", round4(ci_low)},
+        {"ci_high_ms", round4(ci_high)},
+        {"confidence", confidence}
+    };
+}
+
+SampleStats compute_sample_stats(const std::vector<double>& samples, double confidence) {
+    SampleStats stats;
+    stats.confidence = confidence;
+    stats.count = samples.size();
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::vector<double> sorted = samples;
+    std::sort(sorted.begin(), sorted.end());
+    size_t n = sorted.size();
+    stats.min = sorted.front();
+    stats.max = sorted.back();
+    stats.median = n % 2 == 1 ? sorted[n / 2] : (sorted[n / 2 - 1] + sorted[n / 2]) / 2.0;
+
+    double sum = 0.0;
+    for (double value : sorted) {
+        sum += value;
+    }
+    stats.mean = sum / n;
+
+    if (n < 2) {
+        stats.ci_low = stats.ci_high = stats.mean;
+        return stats;
+    }
+
+    double squares = 0.0;
+    for (double value : sorted) {
+        squares += (value - stats.mean) * (value - stats.mean);
+    }
+    stats.stddev = std::sqrt(squares / (n - 1));
+
+    double t = student_t_quantile(0.5 + confidence / 2.0, static_cast<double>(n - 1));
+    double half_width = t * stats.stddev / std::sqrt(static_cast<double>(n));
+    stats.ci_low = stats.mean - half_width;
+    stats.ci_high = stats.mean + half_width;
+    return stats;
+}
+
+namespace {
+
+/**
+ * @brief Цепная дробь регуляризованной неполной бета-функции (метод Ленца)
+ */
+double incomplete_beta_fraction(double a, double b, double x) {
+    const double tiny = 1e-300;
+    const double epsilon = 1e-14;
+
+    double c = 1.0;
+    double d = 1.0 - (a + b) * x / (a + 1.0);
+    d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+    double result = d;
+
+    for (int m = 1; m <= 300; ++m) {
+        double m2 = 2.0 * m;
+
+        // Чётный шаг
+        double numerator = m * (b - m) * x / ((a + m2 - 1.0) * (a + m2));
+        d = 1.0 + numerator * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + numerator / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        result *= d * c;
+
+        // Нечётный шаг
+        numerator = -(a + m) * (a + b + m) * x / ((a + m2) * (a + m2 + 1.0));
+        d = 1.0 + numerator * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + numerator / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        double delta = d * c;
+        result *= delta;
+
+        if (std::fabs(delta - 1.0) < epsilon) {
+            break;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Регуляризованная неполная бета-функция I_x(a, b)
+ */
+double regularized_incomplete_beta(double a, double b, double x) {
+    if (x <= 0.0) {
+        return 0.0;
+    }
+    if (x >= 1.0) {
+        return 1.0;
+    }
+    double log_front = std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                       a * std::log(x) + b * std::log(1.0 - x);
+    double front = std::exp(log_front);
+
+    // Цепная дробь сходится быстро при x < (a + 1) / (a + b + 2)
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return front * incomplete_beta_fraction(a, b, x) / a;
+    }
+    return 1.0 - front * incomplete_beta_fraction(b, a, 1.0 - x) / b;
+}
+
+} // namespace
+
+double student_t_cdf(double t, double df) {
+    if (!(df > 0.0)) {
+        return 0.5;
+    }
+    if (std::isinf(t)) {
+        return t > 0.0 ? 1.0 : 0.0;
+    }
+    double tail = 0.5 * regularized_incomplete_beta(df / 2.0, 0.5, df / (df + t * t));
+    return t > 0.0 ? 1.0 - tail : tail;
+}
+
+double student_t_quantile(double p, double df) {
+    if (p <= 0.0) {
+        return -INFINITY;
+    }
+    if (p >= 1.0) {
+        return INFINITY;
+    }
+
+    // Функция распределения монотонна — хватает деления пополам
+    double low = -1e6;
+    double high = 1e6;
+    for (int i = 0; i < 200 && high - low > 1e-12 * std::max(1.0, std::fabs(low)); ++i) {
+        double middle = (low + high) / 2.0;
+        if (student_t_cdf(middle, df) < p) {
+            low = middle;
+        } else {
+            high = middle;
+        }
+    }
+    return (low + high) / 2.0;
+}
+
+SampleComparison welch_t_test(const std::vector<double>& baseline,
+                              const std::vector<double>& candidate) {
+    SampleComparison result;
+    if (baseline.size() < 2 || candidate.size() < 2) {
+        return result;
+    }
+    result.valid = true;
+
+    SampleStats a = compute_sample_stats(baseline);
+    SampleStats b = compute_sample_stats(candidate);
+    double var_a = a.stddev * a.stddev / a.count;
+    double var_b = b.stddev * b.stddev / b.count;
+    double error = var_a + var_b;
+
+    if (!(error > 0.0)) {
+        bool same = a.mean == b.mean;
+        result.t = same ? 0.0 : (b.mean > a.mean ? INFINITY : -INFINITY);
+        result.df = static_cast<double>(a.count + b.count - 2);
+        result.p_value = same ? 1.0 : 0.0;
+        return result;
+    }
+
+    result.t = (b.mean - a.mean) / std::sqrt(error);
+    result.df = error * error /
+                (var_a * var_a / (a.count - 1) + var_b * var_b / (b.count - 1));
+    result.p_value = 2.0 * student_t_cdf(-std::fabs(result.t), result.df);
+    return result;
+}
+
+// ===========================
+// ОКРУЖЕНИЕ
+// ===========================
+
+bool pin_current_thread(int cpu, std::string* error) {
+#ifdef __linux__
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+        if (error) *error = "CPU index out of range";
+        return false;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+        if (error) *error = std::strerror(errno);
+        return false;
+    }
+    return true;
+#else
+    if (error) *error = "thread pinning is only supported on Linux";
+    return false;
+#endif
+}
+
+json benchmark_environment(const BenchmarkOptions& options) {
+    json environment;
+
+#if defined(__unix__) || defined(__APPLE__)
+    struct utsname system_info;
+    if (uname(&system_info) == 0) {
+        environment["host"] = system_info.nodename;
+        environment["os"] = std::string(system_info.sysname) + " " + system_info.release;
+        environment["arch"] = system_info.machine;
+    }
+#endif
+
+    // Модель CPU — из /proc/cpuinfo, где он есть
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.compare(0, 10, "model name") == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                environment["cpu_model"] = line.substr(line.find_first_not_of(' ', colon + 1));
+            }
+            break;
+        }
+    }
+    environment["hardware_threads"] = std::thread::hardware_concurrency();
+
+#if defined(__clang__)
+    environment["compiler"] = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+    environment["compiler"] = std::string("gcc ") + __VERSION__;
+#elif defined(_MSC_VER)
+    environment["compiler"] = "msvc " + std::to_string(_MSC_VER);
+#endif
+    environment["build_type"] = std::string(GC_BUILD_TYPE).empty() ? "unspecified" : GC_BUILD_TYPE;
+#ifdef __OPTIMIZE__
+    environment["optimized"] = true;
+#else
+    environment["optimized"] = false;
+#endif
+#ifdef NDEBUG
+    environment["assertions"] = false;
+#else
+    environment["assertions"] = true;
+#endif
+
+    environment["warmup_runs"] = options.warmup_runs;
+    environment["repetitions"] = options.repetitions;
+    environment["confidence"] = options.confidence;
+    environment["pinned_cpu"] = options.pin_cpu;
+    return environment;
+}
@@ -1,11 +1,13 @@
 #include "cascade_deletion_gc.h"
 #include <chrono>
 #include <sstream>
+#include <algorithm>
+#include <limits>
 #include <iostream>
 
 CascadeDeletionGC::CascadeDeletionGC(size_t max_heap_size, size_t collection_threshold, const std::string& log_file_path)
     : next_object_id(0), max_heap_size(max_heap_size), collection_threshold(collection_threshold),
-      collection_count(0), total_objects_collected(0), total_memory_freed(0), total_collection_time(0), current_step(0)
+      trigger_memory(collection_threshold), used_memory(0), alive_objects(0), edge_count(0), logging_enabled(true), collection_count(0), total_objects_collected(0), total_memory_freed(0), total_collection_time(0), current_step(0)
 {
     log_file.open(log_file_path, std::ios::app);
     if (log_file.is_open()) log_file << "\n=== Cascade Deletion GC Session Started ===" << std::endl;
@@ -27,6 +29,11 @@ int CascadeDeletionGC::allocate(size_t size) {
     
     if (!has_enough_memory(size)) {
         log_operation("ALLOCATE: memory low, triggering collection...");
+        collection_stats.triggered_collections++;
+        collect();
+    } else if (threshold_reached(size)) {
+        log_operation("ALLOCATE: threshold reached, triggering collection...");
+        collection_stats.triggered_collections++;
         collect();
     }
     
@@ -39,14 +46,75 @@ int CascadeDeletionGC::allocate(size_t size) {
     HeapObject obj(object_id, size, false);
     obj.allocation_step = current_step;
     heap[object_id] = obj;
+    used_memory += size;
+    alive_objects++;
+    delta_tracker.on_allocate(object_id);
     
-    std::ostringstream oss;
-    oss << "ALLOCATE: obj_" << object_id << " (size=" << size << " bytes)";
-    log_operation(oss.str());
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << "ALLOCATE: obj_" << object_id << " (size=" << size << " bytes)";
+        log_operation(oss.str());
+    }
     
     return object_id;
 }
 
+ObjectIdRange CascadeDeletionGC::allocate_many(size_t count, size_t size) {
+    ObjectIdRange range;
+    range.first = next_object_id;
+    if (count == 0) {
+        return range;
+    }
+
+    if (size == 0 || size > max_heap_size) {
+        log_operation("ALLOCATE_MANY FAILED: invalid size " + std::to_string(size));
+        return range;
+    }
+
+    size_t fit = get_free_memory() / size;
+    if (fit < count) {
+        log_operation("ALLOCATE_MANY: memory low, triggering collection...");
+        collection_stats.triggered_collections++;
+        collect();
+        fit = get_free_memory() / size;
+    } else if (threshold_reached(count * size)) {
+        log_operation("ALLOCATE_MANY: threshold reached, triggering collection...");
+        collection_stats.triggered_collections++;
+        collect();
+        fit = get_free_memory() / size;
+    }
+
+    size_t id_space = static_cast<size_t>(std::numeric_limits<int>::max() - next_object_id);
+    size_t n = std::min(std::min(count, fit), id_space);
+    if (n == 0) {
+        log_operation("ALLOCATE_MANY FAILED: out of memory");
+        return range;
+    }
+
+    heap.reserve(heap.size() + n);
+    for (size_t i = 0; i < n; ++i) {
+        int object_id = next_object_id++;
+        HeapObject& obj = heap.try_emplace(object_id, object_id, size, false).first->second;
+        obj.allocation_step = current_step;
+        delta_tracker.on_allocate(object_id);
+    }
+    used_memory += n * size;
+    alive_objects += n;
+    range.count = static_cast<int>(n);
+
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << "ALLOCATE_MANY: obj_" << range.first << "..obj_" << (range.end() - 1)
+            << " (" << n << " x " << size << " bytes)";
+        if (n < count) {
+            oss << ", " << (count - n) << " failed: out of memory";
+        }
+        log_operation(oss.str());
+    }
+
+    return range;
+}
+
 bool CascadeDeletionGC::add_reference(int from_id, int to_id) {
     if (!object_exists(from_id)) {
         std::ostringstream oss;
@@ -74,14 +142,57 @@ bool CascadeDeletionGC::add_reference(int from_id, int to_id) {
     
     source.add_reference_to(to_id);
     target.add_reference_from(from_id);
+    edge_count++;
+    delta_tracker.on_edge_added(from_id, to_id);
     
-    std::ostringstream oss;
-    oss << "ADD_REF: obj_" << from_id << " -> obj_" << to_id;
-    log_operation(oss.str());
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << "ADD_REF: obj_" << from_id << " -> obj_" << to_id;
+        log_operation(oss.str());
+    }
     
     return true;
 }
 
+size_t CascadeDeletionGC::add_references(const ReferencePair* refs, size_t count) {
+    size_t added = 0;
+    size_t existing = 0;
+    size_t failed = 0;
+    auto source = heap.end();
+
+    for (size_t i = 0; i < count; ++i) {
+        const ReferencePair& ref = refs[i];
+        if (source == heap.end() || source->first != ref.from) {
+            source = heap.find(ref.from);
+        }
+        auto target = heap.find(ref.to);
+        if (source == heap.end() || !source->second.is_alive ||
+            target == heap.end() || !target->second.is_alive) {
+            failed++;
+            continue;
+        }
+
+        if (!source->second.outgoing_references.insert(ref.to).second) {
+            existing++;
+            continue;
+        }
+        target->second.add_reference_from(ref.from);
+        edge_count++;
+        delta_tracker.on_edge_added(ref.from, ref.to);
+        added++;
+    }
+
+    if (logging_enabled && count > 0) {
+        std::ostringstream oss;
+        oss << "ADD_REFS: " << added << " added";
+        if (existing > 0) oss << ", " << existing << " already existed";
+        if (failed > 0) oss << ", " << failed << " failed: object not found";
+        log_operation(oss.str());
+    }
+
+    return added + existing;
+}
+
 bool CascadeDeletionGC::remove_reference(int from_id, int to_id) {
     if (!object_exists(from_id)) {
         std::ostringstream oss;
@@ -109,6 +220,8 @@ bool CascadeDeletionGC::remove_reference(int from_id, int to_id) {
     
     source.remove_reference_to(to_id);
     target.remove_reference_from(from_id);
+    edge_count--;
+    delta_tracker.on_edge_removed(from_id, to_id);
     
     std::ostringstream oss;
     oss << "REM_REF: obj_" << from_id << " -X-> obj_" << to_id;
@@ -166,6 +279,15 @@ size_t CascadeDeletionGC::collect() {
     ).count();
     total_collection_time += duration;
     
+    uint64_t pause_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+    collection_stats.total_pause_ns += pause_ns;
+    collection_stats.last_pause_ns = pause_ns;
+    collection_stats.last_pause_start_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start_time.time_since_epoch()).count());
+    collection_stats.max_pause_ns = std::max(collection_stats.max_pause_ns, pause_ns);
+    update_trigger();
+    
     std::ostringstream oss_end;
     oss_end << "[COLLECTION #" << collection_count << "] Complete. "
             << "Freed: " << total_freed << " bytes, "
@@ -176,29 +298,134 @@ size_t CascadeDeletionGC::collect() {
 }
 
 std::string CascadeDeletionGC::get_heap_info() const {
-    std::ostringstream oss;
-    oss << "{\n";
-    oss << " \"total_objects\": " << heap.size() << ",\n";
-    oss << " \"alive_objects\": " << get_alive_objects_count() << ",\n";
-    oss << " \"total_memory\": " << get_total_memory() << ",\n";
-    oss << " \"free_memory\": " << get_free_memory() << ",\n";
-    oss << " \"objects\": [\n";
+    std::string result;
+    HeapSnapshotWriter writer([&result](const char* data, size_t size) {
+        result.append(data, size);
+    });
+    write_heap_info(writer);
+    writer.flush();
+    return result;
+}
+
+void CascadeDeletionGC::write_heap_info(HeapSnapshotWriter& w) const {
+    w.write("{\n \"total_objects\": ");
+    w.write_uint(heap.size());
+    w.write(",\n \"alive_objects\": ");
+    w.write_int(get_alive_objects_count());
+    w.write(",\n \"total_memory\": ");
+    w.write_uint(get_total_memory());
+    w.write(",\n \"free_memory\": ");
+    w.write_uint(get_free_memory());
+    w.write(",\n \"objects\": [\n");
     
     bool first = true;
     for (const auto& [id, obj] : heap) {
-        if (!first) oss << ",\n";
+        if (!first) w.write(",\n", 2);
         first = false;
         
-        oss << " {\n";
-        oss << "  \"id\": " << obj.id << ",\n";
-        oss << "  \"size\": " << obj.size << ",\n";
-        oss << "  \"is_root\": " << (obj.is_root ? "true" : "false") << ",\n";
-        oss << "  \"alive\": " << (obj.is_alive ? "true" : "false") << "\n";
-        oss << " }";
+        w.write(" {\n  \"id\": ");
+        w.write_int(obj.id);
+        w.write(",\n  \"size\": ");
+        w.write_uint(obj.size);
+        w.write(",\n  \"is_root\": ");
+        w.write_bool(obj.is_root);
+        w.write(",\n  \"alive\": ");
+        w.write_bool(obj.is_alive);
+        w.write("\n }");
     }
     
-    oss << "\n ]\n}\n";
-    return oss.str();
+    w.write("\n ]\n}\n");
+}
+
+void CascadeDeletionGC::write_heap_delta(HeapSnapshotWriter& w) {
+    if (delta_tracker.keyframe_due()) {
+        delta_tracker.write_keyframe_begin(w, current_step);
+        write_heap_info(w);
+        delta_tracker.write_keyframe_end(w);
+    } else {
+        delta_tracker.write_delta(w, heap, current_step, alive_objects, used_memory);
+    }
+    delta_tracker.commit();
+}
+
+void CascadeDeletionGC::write_checkpoint(HeapSnapshotWriter& w) const {
+    CheckpointHeader header = make_checkpoint_header(CheckpointKind::CASCADE_DELETION);
+    header.next_object_id = next_object_id;
+    header.current_step = current_step;
+    header.max_heap_size = max_heap_size;
+    header.collection_threshold = collection_threshold;
+    header.trigger_memory = trigger_memory;
+    header.collection_count = collection_count;
+    header.total_objects_collected = total_objects_collected;
+    header.total_memory_freed = total_memory_freed;
+    header.total_collection_time = total_collection_time;
+    write_heap_checkpoint(w, header, heap, next_object_id);
+}
+
+bool CascadeDeletionGC::read_checkpoint(const uint8_t* data, size_t size) {
+    CheckpointReader reader(data, size);
+    CheckpointHeader header;
+    std::unordered_map<int, HeapObject> loaded;
+    
+    if (!reader.read_header(CheckpointKind::CASCADE_DELETION, header) ||
+        !read_heap_checkpoint(reader, header, loaded)) {
+        log_operation("LOAD_CHECKPOINT FAILED: invalid or truncated data");
+        return false;
+    }
+    
+    heap.swap(loaded);
+    next_object_id = static_cast<int>(header.next_object_id);
+    current_step = static_cast<int>(header.current_step);
+    max_heap_size = header.max_heap_size;
+    collection_threshold = header.collection_threshold;
+    collection_count = static_cast<int>(header.collection_count);
+    total_objects_collected = static_cast<int>(header.total_objects_collected);
+    total_memory_freed = header.total_memory_freed;
+    total_collection_time = static_cast<int>(header.total_collection_time);
+    rebuild_indexes();
+    // Порог живой кучи на этом шаге; 0 — checkpoint без порога, пересчитать
+    trigger_memory = header.trigger_memory;
+    if (trigger_memory == 0) {
+        update_trigger();
+    }
+    delta_tracker.invalidate();
+    
+    std::ostringstream oss;
+    oss << "LOAD_CHECKPOINT: " << heap.size() << " objects, "
+        << edge_count << " edges, step " << current_step;
+    log_operation(oss.str());
+    return true;
+}
+
+bool CascadeDeletionGC::save_checkpoint(const std::string& path) const {
+    return write_checkpoint_file(path, [this](HeapSnapshotWriter& w) {
+        write_checkpoint(w);
+    });
+}
+
+bool CascadeDeletionGC::load_checkpoint(const std::string& path) {
+    MappedCheckpointFile file;
+    if (!file.open(path)) {
+        log_operation("LOAD_CHECKPOINT FAILED: cannot open " + path);
+        return false;
+    }
+    return read_checkpoint(file.data(), file.size());
+}
+
+void CascadeDeletionGC::rebuild_indexes() {
+    root_ids.clear();
+    used_memory = 0;
+    alive_objects = 0;
+    edge_count = 0;
+    
+    for (const auto& [id, obj] : heap) {
+        if (obj.is_root) root_ids.insert(id);
+        if (obj.is_alive) {
+            used_memory += obj.size;
+            alive_objects++;
+            edge_count += obj.outgoing_references.size();
+        }
+    }
 }
 
 std::string CascadeDeletionGC::get_gc_stats() const {
@@ -224,14 +451,14 @@ std::string CascadeDeletionGC::get_gc_stats() const {
     return oss.str();
 }
 
+GCCollectionStats CascadeDeletionGC::get_collection_stats() const {
+    GCCollectionStats stats = collection_stats;
+    stats.collections = static_cast<uint64_t>(collection_count);
+    return stats;
+}
+
 size_t CascadeDeletionGC::get_total_memory() const {
-    size_t total = 0;
-    for (const auto& [id, obj] : heap) {
-        if (obj.is_alive) {
-            total += obj.size;
-        }
-    }
-    return total;
+    return used_memory;
 }
 
 size_t CascadeDeletionGC::get_free_memory() const {
@@ -241,6 +468,8 @@ size_t CascadeDeletionGC::get_free_memory() const {
 void CascadeDeletionGC::make_root(int object_id) {
     if (object_exists(object_id)) {
         heap[object_id].is_root = true;
+        root_ids.insert(object_id);
+        delta_tracker.on_root_changed(object_id);
         std::ostringstream oss;
         oss << "MAKE_ROOT: obj_" << object_id << " is now a root object";
         log_operation(oss.str());
@@ -250,6 +479,8 @@ void CascadeDeletionGC::make_root(int object_id) {
 void CascadeDeletionGC::remove_root(int object_id) {
     if (object_exists(object_id)) {
         heap[object_id].is_root = false;
+        root_ids.erase(object_id);
+        delta_tracker.on_root_changed(object_id);
         std::ostringstream oss;
         oss << "REMOVE_ROOT: obj_" << object_id << " is no longer a root";
         log_operation(oss.str());
@@ -272,6 +503,29 @@ const HeapObject* CascadeDeletionGC::get_object(int id) const {
     return nullptr;
 }
 
+HeapQueryResult CascadeDeletionGC::query_objects(const HeapQuery& query) const {
+    return run_heap_query(heap, next_object_id, root_ids, query);
+}
+
+HeapNeighborhood CascadeDeletionGC::get_neighborhood(int object_id, int hops, size_t max_nodes,
+                                                     NeighborDirection direction) const {
+    return collect_heap_neighborhood(heap, object_id, hops, max_nodes, direction);
+}
+
+HeapSummary CascadeDeletionGC::get_summary() const {
+    HeapSummary summary;
+    summary.total_objects = heap.size();
+    summary.alive_objects = alive_objects;
+    summary.root_objects = root_ids.size();
+    summary.edge_count = edge_count;
+    summary.used_memory = used_memory;
+    summary.free_memory = get_free_memory();
+    summary.max_heap_size = max_heap_size;
+    summary.next_object_id = next_object_id;
+    summary.collection_count = collection_count;
+    return summary;
+}
+
 bool CascadeDeletionGC::object_exists(int id) const {
     return heap.find(id) != heap.end() && heap.at(id).is_alive;
 }
@@ -312,11 +566,12 @@ size_t CascadeDeletionGC::cascade_delete(int object_id) {
                                           obj.outgoing_references.end());
         
         for (int source_id : obj.incoming_references) {
-            if (object_exists(source_id)) {
-                heap[source_id].remove_reference_to(current_id);
+            if (source_id != current_id && object_exists(source_id)) {
+                edge_count -= heap[source_id].outgoing_references.erase(current_id);
             }
         }
         
+        edge_count -= obj.outgoing_references.size();
         for (int target_id : obj.outgoing_references) {
             if (object_exists(target_id)) {
                 heap[target_id].remove_reference_from(current_id);
@@ -330,13 +585,18 @@ size_t CascadeDeletionGC::cascade_delete(int object_id) {
         obj.is_alive = false;
         obj.collection_step = current_step;
         freed_memory += obj.size;
+        alive_objects--;
         total_objects_collected++;
+        delta_tracker.on_free(current_id);
         
-        std::ostringstream oss;
-        oss << " Cascade deleted obj_" << current_id << " (" << obj.size << " bytes)";
-        log_operation(oss.str());
+        if (logging_enabled) {
+            std::ostringstream oss;
+            oss << " Cascade deleted obj_" << current_id << " (" << obj.size << " bytes)";
+            log_operation(oss.str());
+        }
     }
     
+    used_memory -= freed_memory;
     return freed_memory;
 }
 
@@ -355,6 +615,8 @@ bool CascadeDeletionGC::should_be_deleted(int object_id) const {
 }
 
 void CascadeDeletionGC::log_operation(const std::string& operation) {
+    if (!logging_enabled) return;
+    
     operation_logs.push_back(operation);
     last_operation = operation;
     
@@ -369,3 +631,15 @@ void CascadeDeletionGC::log_operation(const std::string& operation) {
 bool CascadeDeletionGC::has_enough_memory(size_t size) const {
     return get_free_memory() >= size;
 }
+
+bool CascadeDeletionGC::threshold_reached(size_t size) const {
+    return collection_threshold > 0 && used_memory + size > trigger_memory;
+}
+
+// Как в MarkSweepGC: если выжившие уже за порогом, следующая сборка —
+// после заполнения половины оставшегося места
+void CascadeDeletionGC::update_trigger() {
+    size_t free_memory = max_heap_size > used_memory ? max_heap_size - used_memory : 0;
+    trigger_memory = used_memory >= collection_threshold ? used_memory + free_memory / 2
+                                                         : collection_threshold;
+}
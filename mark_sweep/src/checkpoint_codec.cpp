@@ -0,0 +1,127 @@
+#include "checkpoint_codec.h"
+
+#include <cstring>
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr int HASH_BITS = 16;
+constexpr size_t MAX_OFFSET = 1u << 20;
+
+uint32_t load_u32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+uint32_t hash_u32(uint32_t value) {
+    return (value * 2654435761u) >> (32 - HASH_BITS);
+}
+
+void put_varint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end) return false;
+        uint8_t byte = *p++;
+        value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+std::vector<uint8_t> compress_checkpoint(const uint8_t* data, size_t size) {
+    std::vector<uint8_t> out;
+    out.reserve(size / 2 + 16);
+
+    uint64_t original = size;
+    out.insert(out.end(), reinterpret_cast<const uint8_t*>(&original),
+               reinterpret_cast<const uint8_t*>(&original) + sizeof(original));
+
+    // Позиция + 1 последнего вхождения хэша (0 = не было)
+    std::vector<size_t> table(size_t(1) << HASH_BITS, 0);
+
+    size_t literal_start = 0;
+    size_t pos = 0;
+
+    while (pos + MIN_MATCH <= size) {
+        uint32_t h = hash_u32(load_u32(data + pos));
+        size_t candidate = table[h];
+        table[h] = pos + 1;
+
+        if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET ||
+            load_u32(data + candidate - 1) != load_u32(data + pos)) {
+            pos++;
+            continue;
+        }
+
+        size_t match_pos = candidate - 1;
+        size_t length = MIN_MATCH;
+        while (pos + length < size && data[match_pos + length] == data[pos + length]) {
+            length++;
+        }
+
+        put_varint(out, pos - literal_start);
+        out.insert(out.end(), data + literal_start, data + pos);
+        put_varint(out, length);
+        put_varint(out, pos - match_pos);
+
+        pos += length;
+        literal_start = pos;
+    }
+
+    put_varint(out, size - literal_start);
+    out.insert(out.end(), data + literal_start, data + size);
+    put_varint(out, 0);
+    return out;
+}
+
+bool decompress_checkpoint(const uint8_t* data, size_t size, std::vector<uint8_t>& out) {
+    out.clear();
+    uint64_t original;
+    if (size < sizeof(original)) return false;
+    std::memcpy(&original, data, sizeof(original));
+
+    const uint8_t* p = data + sizeof(original);
+    const uint8_t* end = data + size;
+    out.resize(original);
+    size_t pos = 0;
+
+    while (true) {
+        uint64_t literal_len;
+        if (!get_varint(p, end, literal_len)) return false;
+        if (literal_len > static_cast<uint64_t>(end - p) || literal_len > original - pos) return false;
+        std::memcpy(out.data() + pos, p, literal_len);
+        p += literal_len;
+        pos += literal_len;
+
+        uint64_t match_len;
+        if (!get_varint(p, end, match_len)) return false;
+        if (match_len == 0) break;
+
+        uint64_t offset;
+        if (!get_varint(p, end, offset)) return false;
+        if (offset == 0 || offset > pos || match_len > original - pos) return false;
+
+        // Источник может перекрываться с приёмником — копируем по байту
+        const uint8_t* src = out.data() + pos - offset;
+        uint8_t* dst = out.data() + pos;
+        if (offset >= match_len) {
+            std::memcpy(dst, src, match_len);
+        } else {
+            for (uint64_t i = 0; i < match_len; ++i) dst[i] = src[i];
+        }
+        pos += match_len;
+    }
+
+    return pos == original && p == end;
+}
@@ -0,0 +1,65 @@
+#include "gc_backends.h"
+#include "mark_sweep_gc.h"
+#include "cascade_deletion_gc.h"
+#include "rc_heap.h"
+
+std::vector<std::string> gc_backend_names() {
+    return {"mark_sweep", "cascade", "reference_counting", "rc_deferred", "rc_cycles", "rc_zct", "rc_coalesced", "rc_hybrid"};
+}
+
+std::unique_ptr<GCInterface> make_gc_backend(const std::string& name, size_t heap_bytes,
+                                             size_t collection_threshold,
+                                             const std::string& log_file) {
+    if (name == "mark_sweep") {
+        auto gc = std::make_unique<MarkSweepGC>(heap_bytes, collection_threshold, log_file);
+        gc->set_logging_enabled(false);
+        return gc;
+    }
+    if (name == "cascade") {
+        auto gc = std::make_unique<CascadeDeletionGC>(heap_bytes, collection_threshold, log_file);
+        gc->set_logging_enabled(false);
+        return gc;
+    }
+    if (name == "reference_counting") {
+        // Сборки по порогу у RC нет: объекты освобождаются каскадом сразу
+        auto gc = std::make_unique<RCHeap>(heap_bytes, log_file);
+        gc->set_logging_enabled(false);
+        return gc;
+    }
+    if (name == "rc_deferred") {
+        // Каскад порциями при выделениях; collect() доделывает остаток
+        auto gc = std::make_unique<RCHeap>(heap_bytes, log_file);
+        gc->set_logging_enabled(false);
+        gc->set_deferred_freeing(true);
+        return gc;
+    }
+    if (name == "rc_cycles") {
+        // Синхронный сборщик циклов по порогу буфера кандидатов
+        auto gc = std::make_unique<RCHeap>(heap_bytes, log_file);
+        gc->set_logging_enabled(false);
+        gc->set_cycle_collection(true);
+        return gc;
+    }
+    if (name == "rc_zct") {
+        // Корни не считаются; нулевые счётчики сверяются с корнями по порогу ZCT
+        auto gc = std::make_unique<RCHeap>(heap_bytes, log_file);
+        gc->set_logging_enabled(false);
+        gc->set_zero_count_table(true);
+        return gc;
+    }
+    if (name == "rc_coalesced") {
+        // ref_count меняется на чистую разницу в конце эпохи
+        auto gc = std::make_unique<RCHeap>(heap_bytes, log_file);
+        gc->set_logging_enabled(false);
+        gc->set_coalescing(true);
+        return gc;
+    }
+    if (name == "rc_hybrid") {
+        // Каскад RC сразу, циклы — резервной трассировкой по объёму выделений
+        auto gc = std::make_unique<RCHeap>(heap_bytes, log_file);
+        gc->set_logging_enabled(false);
+        gc->set_backup_tracing(true);
+        return gc;
+    }
+    return nullptr;
+}
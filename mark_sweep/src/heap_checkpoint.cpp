@@ -0,0 +1,275 @@
+#include "heap_checkpoint.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#ifdef _WIN32
+#include <io.h>
+#define CHECKPOINT_OPEN _open
+#define CHECKPOINT_READ _read
+#define CHECKPOINT_CLOSE _close
+#define CHECKPOINT_WRITE_FLAGS (_O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY)
+#define CHECKPOINT_READ_FLAGS (_O_RDONLY | _O_BINARY)
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#define CHECKPOINT_OPEN ::open
+#define CHECKPOINT_READ ::read
+#define CHECKPOINT_CLOSE ::close
+#define CHECKPOINT_WRITE_FLAGS (O_WRONLY | O_CREAT | O_TRUNC)
+#define CHECKPOINT_READ_FLAGS (O_RDONLY)
+#endif
+
+// ===========================
+// ЗАГОЛОВОК
+// ===========================
+
+CheckpointHeader make_checkpoint_header(CheckpointKind kind) {
+    CheckpointHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = CHECKPOINT_MAGIC;
+    header.version = CHECKPOINT_VERSION;
+    header.kind = static_cast<uint32_t>(kind);
+    header.header_size = sizeof(CheckpointHeader);
+    return header;
+}
+
+bool CheckpointReader::read_header(CheckpointKind expected, CheckpointHeader& header) {
+    if (!read(header)) return false;
+
+    if (header.magic != CHECKPOINT_MAGIC ||
+        header.version != CHECKPOINT_VERSION ||
+        header.kind != static_cast<uint32_t>(expected) ||
+        header.header_size != sizeof(CheckpointHeader)) {
+        return false;
+    }
+
+    // Секции должны целиком помещаться в буфер — дальше читаем без сюрпризов
+    size_t remaining = size - offset;
+    if (header.object_count > remaining / sizeof(CheckpointObject)) return false;
+    remaining -= header.object_count * sizeof(CheckpointObject);
+    if (header.edge_count > remaining / sizeof(int32_t)) return false;
+    remaining -= header.edge_count * sizeof(int32_t);
+    if (header.incoming_count > remaining / sizeof(int32_t)) return false;
+
+    return true;
+}
+
+// ===========================
+// HEAP ИЗ HEAPOBJECT
+// ===========================
+
+void write_heap_checkpoint(HeapSnapshotWriter& w,
+                           CheckpointHeader header,
+                           const std::unordered_map<int, HeapObject>& heap,
+                           int id_limit) {
+    // Каждый объект посещается один раз: записи и рёбра собираются
+    // в непрерывные блоки и пишутся целиком. ID выдаются подряд,
+    // поэтому порядок по возрастанию получается без сортировки.
+    std::vector<CheckpointObject> records;
+    std::vector<int32_t> edges;
+    std::vector<int32_t> incoming;
+    records.reserve(heap.size());
+
+    for (int id = 0; id < id_limit; ++id) {
+        auto it = heap.find(id);
+        if (it == heap.end()) continue;
+        const HeapObject& obj = it->second;
+
+        CheckpointObject record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = obj.id;
+        record.flags = (obj.is_root ? CHECKPOINT_ROOT : 0) |
+                       (obj.is_alive ? CHECKPOINT_ALIVE : 0) |
+                       (obj.is_marked ? CHECKPOINT_MARKED : 0);
+        record.size = obj.size;
+        record.allocation_step = obj.allocation_step;
+        record.collection_step = obj.collection_step;
+        record.reference_count = obj.reference_count;
+        record.out_degree = static_cast<uint32_t>(obj.outgoing_references.size());
+        edges.insert(edges.end(), obj.outgoing_references.begin(), obj.outgoing_references.end());
+        if (!obj.is_alive) {
+            record.in_degree = static_cast<uint32_t>(obj.incoming_references.size());
+            incoming.insert(incoming.end(), obj.incoming_references.begin(),
+                            obj.incoming_references.end());
+        }
+        records.push_back(record);
+    }
+
+    header.object_count = records.size();
+    header.edge_count = edges.size();
+    header.incoming_count = incoming.size();
+
+    write_checkpoint_pod(w, header);
+    w.write(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(CheckpointObject));
+    w.write(reinterpret_cast<const char*>(edges.data()), edges.size() * sizeof(int32_t));
+    w.write(reinterpret_cast<const char*>(incoming.data()), incoming.size() * sizeof(int32_t));
+}
+
+bool read_heap_checkpoint(CheckpointReader& reader,
+                          const CheckpointHeader& header,
+                          std::unordered_map<int, HeapObject>& heap) {
+    const CheckpointObject* records =
+        reader.read_array<CheckpointObject>(header.object_count);
+    const int32_t* edges = reader.read_array<int32_t>(header.edge_count);
+    const int32_t* incoming = reader.read_array<int32_t>(header.incoming_count);
+    if (!records || !edges || !incoming) {
+        return false;
+    }
+
+    heap.reserve(header.object_count);
+
+    // Проход 1: объекты и исходящие рёбра (уже отсортированы — вставка в конец)
+    uint64_t edge_pos = 0;
+    for (uint64_t i = 0; i < header.object_count; ++i) {
+        const CheckpointObject& record = records[i];
+        if (record.out_degree > header.edge_count - edge_pos) {
+            return false;
+        }
+
+        HeapObject& obj = heap[record.id];
+        obj.id = record.id;
+        obj.size = record.size;
+        obj.is_root = (record.flags & CHECKPOINT_ROOT) != 0;
+        obj.is_alive = (record.flags & CHECKPOINT_ALIVE) != 0;
+        obj.is_marked = (record.flags & CHECKPOINT_MARKED) != 0;
+        obj.reference_count = record.reference_count;
+        obj.allocation_step = record.allocation_step;
+        obj.collection_step = record.collection_step;
+
+        for (uint32_t e = 0; e < record.out_degree; ++e) {
+            obj.outgoing_references.insert(obj.outgoing_references.end(), edges[edge_pos++]);
+        }
+    }
+    if (edge_pos != header.edge_count || heap.size() != header.object_count) {
+        return false;
+    }
+
+    // Проход 2: refs_from живых объектов — источники идут по возрастанию ID
+    edge_pos = 0;
+    for (uint64_t i = 0; i < header.object_count; ++i) {
+        const CheckpointObject& record = records[i];
+        bool source_alive = (record.flags & CHECKPOINT_ALIVE) != 0;
+        for (uint32_t e = 0; e < record.out_degree; ++e) {
+            int target = edges[edge_pos++];
+            if (!source_alive) continue;
+            auto it = heap.find(target);
+            if (it == heap.end()) {
+                return false;
+            }
+            if (it->second.is_alive) {
+                auto& refs = it->second.incoming_references;
+                refs.insert(refs.end(), record.id);
+            }
+        }
+    }
+
+    // Проход 3: сохранённые refs_from удалённых объектов
+    uint64_t incoming_pos = 0;
+    for (uint64_t i = 0; i < header.object_count; ++i) {
+        const CheckpointObject& record = records[i];
+        if (record.in_degree == 0) continue;
+        if (record.in_degree > header.incoming_count - incoming_pos) {
+            return false;
+        }
+        auto& refs = heap[record.id].incoming_references;
+        for (uint32_t e = 0; e < record.in_degree; ++e) {
+            refs.insert(refs.end(), incoming[incoming_pos++]);
+        }
+    }
+
+    return incoming_pos == header.incoming_count;
+}
+
+// ===========================
+// ОТОБРАЖЕНИЕ ФАЙЛА
+// ===========================
+
+MappedCheckpointFile::MappedCheckpointFile()
+    : mapping(nullptr),
+      length(0)
+{}
+
+MappedCheckpointFile::~MappedCheckpointFile() {
+    close();
+}
+
+bool MappedCheckpointFile::open(const std::string& path) {
+    close();
+
+    int fd = CHECKPOINT_OPEN(path.c_str(), CHECKPOINT_READ_FLAGS);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        CHECKPOINT_CLOSE(fd);
+        return false;
+    }
+    length = static_cast<size_t>(st.st_size);
+
+#ifndef _WIN32
+    void* mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+        // Читаем строго последовательно — подсказка ядру для readahead
+        madvise(mapped, length, MADV_SEQUENTIAL);
+        mapping = static_cast<const uint8_t*>(mapped);
+        CHECKPOINT_CLOSE(fd);
+        return true;
+    }
+#endif
+
+    // mmap недоступен — читаем целиком
+    fallback.resize(length);
+    size_t done = 0;
+    while (done < length) {
+        auto n = CHECKPOINT_READ(fd, fallback.data() + done, static_cast<unsigned>(length - done));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            CHECKPOINT_CLOSE(fd);
+            close();
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+
+    CHECKPOINT_CLOSE(fd);
+    return true;
+}
+
+void MappedCheckpointFile::close() {
+#ifndef _WIN32
+    if (mapping) {
+        munmap(const_cast<uint8_t*>(mapping), length);
+    }
+#endif
+    mapping = nullptr;
+    length = 0;
+    fallback.clear();
+}
+
+// ===========================
+// ЗАПИСЬ ФАЙЛА
+// ===========================
+
+bool write_checkpoint_file(const std::string& path,
+                           const std::function<void(HeapSnapshotWriter&)>& write_body) {
+    int fd = CHECKPOINT_OPEN(path.c_str(), CHECKPOINT_WRITE_FLAGS, 0644);
+    if (fd < 0) {
+        return false;
+    }
+
+    bool ok;
+    {
+        HeapSnapshotWriter writer(fd, 1024 * 1024);
+        write_body(writer);
+        writer.flush();
+        ok = writer.ok();
+    }
+
+    return CHECKPOINT_CLOSE(fd) == 0 && ok;
+}
@@ -0,0 +1,153 @@
+#include "heap_delta.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+// Ребро видно потребителю, только если оба конца живы.
+// Рёбра удалённых объектов потребитель убирает сам по "freed".
+bool edge_visible(const std::unordered_map<int, HeapObject>& heap, uint64_t key) {
+    int from = static_cast<int>(static_cast<uint32_t>(key >> 32));
+    int to = static_cast<int>(static_cast<uint32_t>(key));
+    auto from_it = heap.find(from);
+    auto to_it = heap.find(to);
+    return from_it != heap.end() && from_it->second.is_alive &&
+           to_it != heap.end() && to_it->second.is_alive;
+}
+
+template <typename T>
+std::vector<T> sorted(const std::unordered_set<T>& values) {
+    std::vector<T> result(values.begin(), values.end());
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void write_edges(HeapSnapshotWriter& writer,
+                 const std::unordered_map<int, HeapObject>& heap,
+                 const std::unordered_set<uint64_t>& edges) {
+    writer.write_char('[');
+    bool first = true;
+    for (uint64_t key : sorted(edges)) {
+        if (!edge_visible(heap, key)) continue;
+        if (!first) writer.write(", ", 2);
+        first = false;
+        writer.write_char('[');
+        writer.write_int(static_cast<int>(static_cast<uint32_t>(key >> 32)));
+        writer.write(", ", 2);
+        writer.write_int(static_cast<int>(static_cast<uint32_t>(key)));
+        writer.write_char(']');
+    }
+    writer.write_char(']');
+}
+
+} // namespace
+
+HeapDeltaTracker::HeapDeltaTracker()
+    : enabled(false),
+      force_keyframe(false),
+      keyframe_interval(DEFAULT_KEYFRAME_INTERVAL),
+      sequence(0)
+{}
+
+void HeapDeltaTracker::enable(int keyframe_interval_) {
+    clear();
+    enabled = true;
+    keyframe_interval = keyframe_interval_ > 0 ? keyframe_interval_ : 1;
+    // Накопленного до включения нет — начинаем с полного снимка
+    force_keyframe = true;
+}
+
+void HeapDeltaTracker::disable() {
+    clear();
+    enabled = false;
+}
+
+bool HeapDeltaTracker::keyframe_due() const {
+    return !enabled || force_keyframe || sequence % keyframe_interval == 0;
+}
+
+void HeapDeltaTracker::write_keyframe_begin(HeapSnapshotWriter& writer, int step) const {
+    writer.write("{\"type\": \"keyframe\", \"sequence\": ");
+    writer.write_int(sequence);
+    writer.write(", \"step\": ");
+    writer.write_int(step);
+    writer.write(", \"heap\": ");
+}
+
+void HeapDeltaTracker::write_keyframe_end(HeapSnapshotWriter& writer) const {
+    writer.write("}\n");
+}
+
+void HeapDeltaTracker::write_delta(HeapSnapshotWriter& writer,
+                                   const std::unordered_map<int, HeapObject>& heap,
+                                   int step, size_t alive_objects, size_t used_memory) const {
+    writer.write("{\"type\": \"delta\", \"sequence\": ");
+    writer.write_int(sequence);
+    writer.write(", \"step\": ");
+    writer.write_int(step);
+    writer.write(", \"alive_objects\": ");
+    writer.write_uint(alive_objects);
+    writer.write(", \"total_memory\": ");
+    writer.write_uint(used_memory);
+
+    writer.write(", \"added\": [");
+    bool first = true;
+    for (int id : sorted(added)) {
+        auto it = heap.find(id);
+        if (it == heap.end() || !it->second.is_alive) continue;
+        if (!first) writer.write(", ", 2);
+        first = false;
+        writer.write("{\"id\": ");
+        writer.write_int(id);
+        writer.write(", \"size\": ");
+        writer.write_uint(it->second.size);
+        writer.write(", \"is_root\": ");
+        writer.write_bool(it->second.is_root);
+        writer.write(", \"allocation_step\": ");
+        writer.write_int(it->second.allocation_step);
+        writer.write_char('}');
+    }
+
+    writer.write("], \"freed\": [");
+    first = true;
+    for (int id : sorted(freed)) {
+        if (!first) writer.write(", ", 2);
+        first = false;
+        writer.write_int(id);
+    }
+
+    writer.write("], \"roots_changed\": [");
+    first = true;
+    for (int id : sorted(roots_changed)) {
+        auto it = heap.find(id);
+        if (it == heap.end() || !it->second.is_alive) continue;
+        if (!first) writer.write(", ", 2);
+        first = false;
+        writer.write("{\"id\": ");
+        writer.write_int(id);
+        writer.write(", \"is_root\": ");
+        writer.write_bool(it->second.is_root);
+        writer.write_char('}');
+    }
+
+    writer.write("], \"edges_added\": ");
+    write_edges(writer, heap, edges_added);
+    writer.write(", \"edges_removed\": ");
+    write_edges(writer, heap, edges_removed);
+    writer.write("}\n");
+}
+
+void HeapDeltaTracker::commit() {
+    clear();
+    force_keyframe = false;
+    sequence++;
+}
+
+void HeapDeltaTracker::clear() {
+    added.clear();
+    freed.clear();
+    roots_changed.clear();
+    edges_added.clear();
+    edges_removed.clear();
+}
@@ -0,0 +1,191 @@
+#include "heap_query.h"
+
+#include <algorithm>
+#include <queue>
+
+// ===========================
+// ПОСТРАНИЧНЫЙ ЗАПРОС
+// ===========================
+
+HeapQueryResult run_heap_query(const std::unordered_map<int, HeapObject>& heap,
+                               int id_limit,
+                               const std::set<int>& root_ids,
+                               const HeapQuery& query) {
+    HeapQueryResult result;
+    int end_id = std::min(query.end_id, id_limit);
+
+    // Запрос по корням — идём по индексу, а не по всему диапазону ID
+    if (query.is_root && *query.is_root) {
+        for (auto it = root_ids.lower_bound(query.start_id);
+             it != root_ids.end() && *it < end_id; ++it) {
+            if (result.objects.size() >= query.limit || result.scanned >= query.max_scan) {
+                result.next_id = *it;
+                return result;
+            }
+            result.scanned++;
+
+            auto obj_it = heap.find(*it);
+            if (obj_it != heap.end() && query.matches(obj_it->second)) {
+                result.objects.push_back(&obj_it->second);
+            }
+        }
+        return result;
+    }
+
+    // ID выдаются подряд, поэтому диапазон перебирается без сортировки
+    for (int id = std::max(query.start_id, 0); id < end_id; ++id) {
+        if (result.objects.size() >= query.limit || result.scanned >= query.max_scan) {
+            result.next_id = id;
+            return result;
+        }
+        result.scanned++;
+
+        auto obj_it = heap.find(id);
+        if (obj_it != heap.end() && query.matches(obj_it->second)) {
+            result.objects.push_back(&obj_it->second);
+        }
+    }
+
+    return result;
+}
+
+// ===========================
+// K-ОКРЕСТНОСТЬ
+// ===========================
+
+HeapNeighborhood collect_heap_neighborhood(const std::unordered_map<int, HeapObject>& heap,
+                                           int center_id,
+                                           int hops,
+                                           size_t max_nodes,
+                                           NeighborDirection direction) {
+    HeapNeighborhood result;
+
+    if (heap.find(center_id) == heap.end() || max_nodes == 0) {
+        return result;
+    }
+
+    std::unordered_map<int, int> distance;
+    std::queue<int> frontier;
+
+    distance[center_id] = 0;
+    frontier.push(center_id);
+    result.nodes.emplace_back(center_id, 0);
+
+    auto visit = [&](int neighbor_id, int dist) {
+        if (distance.count(neighbor_id) > 0) {
+            return;
+        }
+        auto it = heap.find(neighbor_id);
+        if (it == heap.end() || !it->second.is_alive) {
+            return;
+        }
+        if (result.nodes.size() >= max_nodes) {
+            result.truncated = true;
+            return;
+        }
+        distance[neighbor_id] = dist;
+        result.nodes.emplace_back(neighbor_id, dist);
+        frontier.push(neighbor_id);
+    };
+
+    while (!frontier.empty() && !result.truncated) {
+        int current_id = frontier.front();
+        frontier.pop();
+
+        int dist = distance[current_id];
+        if (dist >= hops) {
+            continue;
+        }
+
+        const HeapObject& obj = heap.at(current_id);
+
+        if (direction != NeighborDirection::INCOMING) {
+            for (int target_id : obj.outgoing_references) {
+                visit(target_id, dist + 1);
+            }
+        }
+        if (direction != NeighborDirection::OUTGOING) {
+            for (int source_id : obj.incoming_references) {
+                visit(source_id, dist + 1);
+            }
+        }
+    }
+
+    return result;
+}
+
+// ===========================
+// JSON
+// ===========================
+
+void write_heap_object_json(HeapSnapshotWriter& w, const HeapObject& obj) {
+    w.write(" {\n  \"id\": ");
+    w.write_int(obj.id);
+    w.write(",\n  \"size\": ");
+    w.write_uint(obj.size);
+    w.write(",\n  \"marked\": ");
+    w.write_bool(obj.is_marked);
+    w.write(",\n  \"is_root\": ");
+    w.write_bool(obj.is_root);
+    w.write(",\n  \"alive\": ");
+    w.write_bool(obj.is_alive);
+    w.write(",\n  \"refs_to\": [");
+
+    bool first_ref = true;
+    for (int ref_id : obj.outgoing_references) {
+        if (!first_ref) w.write(", ", 2);
+        first_ref = false;
+        w.write_int(ref_id);
+    }
+
+    w.write("],\n  \"refs_from\": [");
+    first_ref = true;
+    for (int ref_id : obj.incoming_references) {
+        if (!first_ref) w.write(", ", 2);
+        first_ref = false;
+        w.write_int(ref_id);
+    }
+
+    w.write("]\n }");
+}
+
+void write_heap_query_json(HeapSnapshotWriter& w, const HeapQueryResult& result) {
+    w.write("{\n \"next_id\": ");
+    w.write_int(result.next_id);
+    w.write(",\n \"scanned\": ");
+    w.write_uint(result.scanned);
+    w.write(",\n \"objects\": [\n");
+
+    bool first = true;
+    for (const HeapObject* obj : result.objects) {
+        if (!first) w.write(",\n", 2);
+        first = false;
+        write_heap_object_json(w, *obj);
+    }
+
+    w.write("\n ]\n}\n");
+}
+
+void write_heap_summary_json(HeapSnapshotWriter& w, const HeapSummary& summary) {
+    w.write("{\n \"total_objects\": ");
+    w.write_uint(summary.total_objects);
+    w.write(",\n \"alive_objects\": ");
+    w.write_uint(summary.alive_objects);
+    w.write(",\n \"root_objects\": ");
+    w.write_uint(summary.root_objects);
+    w.write(",\n \"marked_objects\": ");
+    w.write_uint(summary.marked_objects);
+    w.write(",\n \"edge_count\": ");
+    w.write_uint(summary.edge_count);
+    w.write(",\n \"total_memory\": ");
+    w.write_uint(summary.used_memory);
+    w.write(",\n \"free_memory\": ");
+    w.write_uint(summary.free_memory);
+    w.write(",\n \"max_heap_size\": ");
+    w.write_uint(summary.max_heap_size);
+    w.write(",\n \"next_object_id\": ");
+    w.write_int(summary.next_object_id);
+    w.write(",\n \"collection_count\": ");
+    w.write_int(summary.collection_count);
+    w.write("\n}\n");
+}
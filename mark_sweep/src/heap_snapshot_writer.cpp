@@ -0,0 +1,159 @@
+#include "heap_snapshot_writer.h"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef _WIN32
+#include <io.h>
+#define SNAPSHOT_WRITE _write
+#else
+#include <unistd.h>
+#define SNAPSHOT_WRITE ::write
+#endif
+
+namespace {
+
+// Пары цифр "00".."99" — делим на 100 вместо 10
+const char DIGIT_PAIRS[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+} // namespace
+
+HeapSnapshotWriter::HeapSnapshotWriter(int fd_, size_t buffer_size)
+    : fd(fd_),
+      buffer(buffer_size > MAX_INT_CHARS ? buffer_size : DEFAULT_BUFFER_SIZE),
+      used(0),
+      total_bytes(0),
+      failed(fd_ < 0)
+{}
+
+HeapSnapshotWriter::HeapSnapshotWriter(ChunkCallback callback_, size_t buffer_size)
+    : fd(-1),
+      callback(std::move(callback_)),
+      buffer(buffer_size > MAX_INT_CHARS ? buffer_size : DEFAULT_BUFFER_SIZE),
+      used(0),
+      total_bytes(0),
+      failed(!callback)
+{}
+
+HeapSnapshotWriter::~HeapSnapshotWriter() {
+    flush();
+}
+
+void HeapSnapshotWriter::write(const char* data, size_t size) {
+    total_bytes += size;
+
+    if (used + size <= buffer.size()) {
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+        return;
+    }
+
+    flush();
+
+    // Крупный кусок отдаём напрямую, минуя буфер
+    if (size >= buffer.size()) {
+        emit(data, size);
+        return;
+    }
+
+    std::memcpy(buffer.data(), data, size);
+    used = size;
+}
+
+void HeapSnapshotWriter::write(const char* text) {
+    write(text, std::strlen(text));
+}
+
+void HeapSnapshotWriter::write_char(char c) {
+    if (used == buffer.size()) {
+        flush();
+    }
+    buffer[used++] = c;
+    total_bytes++;
+}
+
+void HeapSnapshotWriter::write_int(long long value) {
+    if (value < 0) {
+        write_char('-');
+        // Через unsigned, чтобы не переполниться на LLONG_MIN
+        write_uint(0ULL - static_cast<unsigned long long>(value));
+    } else {
+        write_uint(static_cast<unsigned long long>(value));
+    }
+}
+
+void HeapSnapshotWriter::write_uint(unsigned long long value) {
+    if (buffer.size() - used < MAX_INT_CHARS) {
+        flush();
+    }
+    size_t len = format_uint(buffer.data() + used, value);
+    used += len;
+    total_bytes += len;
+}
+
+size_t HeapSnapshotWriter::format_uint(char* out, unsigned long long value) {
+    char tmp[MAX_INT_CHARS];
+    char* p = tmp + MAX_INT_CHARS;
+
+    while (value >= 100) {
+        unsigned idx = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--p = DIGIT_PAIRS[idx + 1];
+        *--p = DIGIT_PAIRS[idx];
+    }
+
+    if (value >= 10) {
+        unsigned idx = static_cast<unsigned>(value) * 2;
+        *--p = DIGIT_PAIRS[idx + 1];
+        *--p = DIGIT_PAIRS[idx];
+    } else {
+        *--p = static_cast<char>('0' + value);
+    }
+
+    size_t len = static_cast<size_t>(tmp + MAX_INT_CHARS - p);
+    std::memcpy(out, p, len);
+    return len;
+}
+
+void HeapSnapshotWriter::flush() {
+    if (used == 0) {
+        return;
+    }
+    emit(buffer.data(), used);
+    used = 0;
+}
+
+void HeapSnapshotWriter::emit(const char* data, size_t size) {
+    if (failed) {
+        return;
+    }
+
+    if (callback) {
+        callback(data, size);
+        return;
+    }
+
+    // write() может записать меньше, чем просили
+    while (size > 0) {
+        auto n = SNAPSHOT_WRITE(fd, data, static_cast<unsigned>(size));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            failed = true;
+            return;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
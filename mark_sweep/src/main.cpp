@@ -2,6 +2,8 @@
 #include "cascade_deletion_gc.h"
 #include "performance_test.h"
 #include "common_utils.h"
+#include "scenario_binary.h"
+#include "scenario_executor.h"
 #include <iostream>
 #include <memory>
 
@@ -27,126 +29,80 @@ void show_ms_menu() {
     std::cout << " [0] Exit\n" << std::endl;
 }
 
-ParsedScenario parse_json_scenario_ms(const std::string& filename) {
-    ParsedScenario result;
-    std::vector<Operation>& operations = result.operations;
-    
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Cannot open: " << filename << std::endl;
-        return result;
-    }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    file.close();
-
-    // Read heap_size from JSON
-    size_t heap_size_pos = content.find("\"heap_size\":");
-    if (heap_size_pos != std::string::npos) {
-        size_t colon_pos = content.find(":", heap_size_pos);
-        size_t comma_pos = content.find(",", colon_pos);
-        if (comma_pos == std::string::npos) {
-            comma_pos = content.find("}", colon_pos);
-        }
-        if (colon_pos != std::string::npos && comma_pos != std::string::npos) {
-            std::string heap_size_str = content.substr(colon_pos + 1, comma_pos - colon_pos - 1);
-            heap_size_str.erase(0, heap_size_str.find_first_not_of(" \t\n\r"));
-            heap_size_str.erase(heap_size_str.find_last_not_of(" \t\n\r") + 1);
-            try {
-                result.heap_size = std::stoull(heap_size_str);
-            } catch (...) {
-                result.heap_size = 1048576;
-            }
-        }
-    }
+/**
+ * @brief Исполнить сценарий на конкретном коллекторе с выводом каждого шага
+ */
+template<typename GC>
+static void execute_ms_scenario(GC& gc, const ScenarioFile& operations) {
+    auto start_time = std::chrono::high_resolution_clock::now();
 
-    std::string collection_type = "mark_sweep";
-    size_t type_pos = content.find("\"collection_type\":");
-    if (type_pos != std::string::npos) {
-        size_t start = content.find("\"", type_pos + 18);
-        size_t end = content.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            collection_type = content.substr(start + 1, end - start - 1);
+    auto print_step = [&gc](size_t step, const CompactOp& op, int64_t result) {
+        std::cout << " [" << std::setw(3) << step << "] ";
+        switch (op.code) {
+            case ScenarioOpCode::ALLOCATE:
+                std::cout << "ALLOCATE " << std::setw(6) << op.a
+                    << " bytes -> object_" << result << std::endl;
+                break;
+            case ScenarioOpCode::MAKE_ROOT:
+                std::cout << "MAKE_ROOT object_" << op.a << std::endl;
+                break;
+            case ScenarioOpCode::REMOVE_ROOT:
+                std::cout << "REMOVE_ROOT object_" << op.a << std::endl;
+                break;
+            case ScenarioOpCode::ADD_REF:
+                std::cout << "ADD_REF object_" << op.a << " -> object_" << op.b << std::endl;
+                break;
+            case ScenarioOpCode::REMOVE_REF:
+                std::cout << "REMOVE_REF object_" << op.a << " -X-> object_" << op.b << std::endl;
+                break;
+            case ScenarioOpCode::COLLECT:
+                std::cout << "COLLECT -> freed " << result << " bytes" << std::endl;
+                std::cout << " Heap: " << gc.get_alive_objects_count()
+                    << " objects, " << gc.get_total_memory() << " bytes" << std::endl;
+                break;
+            default:
+                std::cout << scenario_macro_label(op) << " -> from object_" << result
+                    << ", heap: " << gc.get_alive_objects_count() << " objects" << std::endl;
+                break;
         }
-    }
-
-    size_t pos = 0;
-    while (pos < content.length()) {
-        pos = content.find('{', pos);
-        if (pos == std::string::npos) break;
-        size_t end = content.find('}', pos);
-        if (end == std::string::npos) break;
-        std::string obj = content.substr(pos, end - pos + 1);
-        pos = end + 1;
+    };
 
-        if (obj.find("\"op\"") == std::string::npos) continue;
+    ScenarioExecutionStats stats = execute_scenario(gc, operations.ops(), operations.size(), print_step);
 
-        Operation op;
-        op.collection_type = collection_type;
-
-        if (obj.find("\"op\": \"allocate\"") != std::string::npos ||
-            obj.find("\"op\":\"allocate\"") != std::string::npos) {
-            op.type = "allocate";
-            size_t size_pos = obj.find("\"size\"");
-            if (size_pos != std::string::npos) {
-                sscanf(obj.c_str() + size_pos, "\"size\": %d", &op.param1);
-            }
-            if (op.param1 > 0) operations.push_back(op);
-
-        } else if (obj.find("\"op\": \"make_root\"") != std::string::npos ||
-                   obj.find("\"op\":\"make_root\"") != std::string::npos) {
-            op.type = "make_root";
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos) {
-                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.param1);
-            }
-            operations.push_back(op);
-
-        } else if (obj.find("\"op\": \"add_ref\"") != std::string::npos ||
-                   obj.find("\"op\":\"add_ref\"") != std::string::npos) {
-            op.type = "add_ref";
-            size_t from_pos = obj.find("\"from\"");
-            size_t to_pos = obj.find("\"to\"");
-            if (from_pos != std::string::npos) {
-                sscanf(obj.c_str() + from_pos, "\"from\": %d", &op.param1);
-            }
-            if (to_pos != std::string::npos) {
-                sscanf(obj.c_str() + to_pos, "\"to\": %d", &op.param2);
-            }
-            operations.push_back(op);
-
-        } else if (obj.find("\"op\": \"remove_root\"") != std::string::npos ||
-                   obj.find("\"op\":\"remove_root\"") != std::string::npos) {
-            op.type = "remove_root";
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos) {
-                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.param1);
-            }
-            operations.push_back(op);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double exec_time = std::chrono::duration<double, std::milli>(
+        end_time - start_time).count();
 
-        } else if (obj.find("\"op\": \"collect\"") != std::string::npos ||
-                   obj.find("\"op\":\"collect\"") != std::string::npos) {
-            op.type = "collect";
-            operations.push_back(op);
-        }
-    }
+    MemoryStats mem_stats;
+    mem_stats.total_allocated = stats.allocated_bytes;
+    mem_stats.total_freed = stats.freed_bytes;
+    mem_stats.peak_memory = stats.peak_memory;
+    mem_stats.calculate();
+    mem_stats.print();
 
-    return result;
+    std::cout << std::string(70, '=') << std::endl;
+    std::cout << " GC Statistics" << std::endl;
+    std::cout << std::string(70, '=') << std::endl;
+    std::cout << gc.get_gc_stats();
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "\n Execution Time: " << exec_time << " ms\n" << std::endl;
 }
 
-
 void run_simulation_ms(const std::string& scenario_file, const std::string& scenario_name) {
     std::cout << "\n" << std::string(70, '=') << std::endl;
     std::cout << " Running: " << scenario_name << std::endl;
     std::cout << std::string(70, '=') << "\n" << std::endl;
 
-    ParsedScenario parsed = parse_json_scenario_ms(scenario_file);
-    std::vector<Operation>& operations = parsed.operations;
-    size_t heap_size = parsed.heap_size;
+    ScenarioFile scenario;
+    if (!scenario.open(scenario_file)) {
+        std::cerr << "Cannot load " << scenario_file << ": " << scenario.get_error() << std::endl;
+        return;
+    }
+    const ScenarioFile& operations = scenario;
+    size_t heap_size = scenario.heap_size();
 
-    std::cout << "[*] Parsed " << operations.size() << " operations\n" << std::endl;
+    std::cout << "[*] Loaded " << operations.size() << " operations"
+        << (scenario.is_binary() ? " (binary, memory-mapped)" : "") << "\n" << std::endl;
     std::cout << "[*] Heap Size: " << (heap_size / 1048576) << " MB\n" << std::endl;
 
     if (operations.empty()) {
@@ -154,78 +110,15 @@ void run_simulation_ms(const std::string& scenario_file, const std::string& scen
         return;
     }
 
-    std::string gc_type = operations[0].collection_type;
-    std::unique_ptr<GCInterface> gc;
-
-    if (gc_type == "cascade") {
+    if (scenario_collector_from_name(scenario.collection_type()) == CheckpointKind::CASCADE_DELETION) {
         std::cout << "[*] Garbage Collector: Cascade Deletion\n" << std::endl;
-        gc = std::make_unique<CascadeDeletionGC>(heap_size);
+        CascadeDeletionGC gc(heap_size);
+        execute_ms_scenario(gc, operations);
     } else {
         std::cout << "[*] Garbage Collector: Mark-and-Sweep\n" << std::endl;
-        gc = std::make_unique<MarkSweepGC>(heap_size);
+        MarkSweepGC gc(heap_size);
+        execute_ms_scenario(gc, operations);
     }
-
-    MemoryStats mem_stats;
-    auto start_time = std::chrono::high_resolution_clock::now();
-
-    for (size_t step = 0; step < operations.size(); step++) {
-        const Operation& op = operations[step];
-        gc->set_current_step(step);
-
-        if (op.type == "allocate") {
-            int id = gc->allocate(op.param1);
-            mem_stats.total_allocated += op.param1;
-            size_t current_heap = gc->get_total_memory();
-            if (current_heap > mem_stats.peak_memory) {
-                mem_stats.peak_memory = current_heap;
-            }
-            std::cout << " [" << std::setw(3) << step << "] ALLOCATE "
-                << std::setw(6) << op.param1 << " bytes -> object_" << id << std::endl;
-
-        } else if (op.type == "make_root") {
-            if (auto* ms_gc = dynamic_cast<MarkSweepGC*>(gc.get())) {
-                ms_gc->make_root(op.param1);
-            } else if (auto* c_gc = dynamic_cast<CascadeDeletionGC*>(gc.get())) {
-                c_gc->make_root(op.param1);
-            }
-            std::cout << " [" << std::setw(3) << step << "] MAKE_ROOT object_" << op.param1 << std::endl;
-
-        } else if (op.type == "add_ref") {
-            gc->add_reference(op.param1, op.param2);
-            std::cout << " [" << std::setw(3) << step << "] ADD_REF object_"
-                << op.param1 << " -> object_" << op.param2 << std::endl;
-
-        } else if (op.type == "remove_root") {
-            if (auto* ms_gc = dynamic_cast<MarkSweepGC*>(gc.get())) {
-                ms_gc->remove_root(op.param1);
-            } else if (auto* c_gc = dynamic_cast<CascadeDeletionGC*>(gc.get())) {
-                c_gc->remove_root(op.param1);
-            }
-            std::cout << " [" << std::setw(3) << step << "] REMOVE_ROOT object_" << op.param1 << std::endl;
-
-        } else if (op.type == "collect") {
-            size_t freed = gc->collect();
-            mem_stats.total_freed += freed;
-            std::cout << " [" << std::setw(3) << step << "] COLLECT -> freed "
-                << freed << " bytes" << std::endl;
-            std::cout << " Heap: " << gc->get_alive_objects_count()
-                << " objects, " << gc->get_total_memory() << " bytes" << std::endl;
-        }
-    }
-
-    auto end_time = std::chrono::high_resolution_clock::now();
-    double exec_time = std::chrono::duration<double, std::milli>(
-        end_time - start_time).count();
-
-    mem_stats.calculate();
-    mem_stats.print();
-
-    std::cout << std::string(70, '=') << std::endl;
-    std::cout << " GC Statistics" << std::endl;
-    std::cout << std::string(70, '=') << std::endl;
-    std::cout << gc->get_gc_stats();
-    std::cout << std::fixed << std::setprecision(2);
-    std::cout << "\n Execution Time: " << exec_time << " ms\n" << std::endl;
 }
 
 int ms_main(int argc, char* argv[]) {
@@ -2,6 +2,7 @@
 
 #include <algorithm>
 #include <sstream>
+#include <limits>
 #include <iostream>
 #include <chrono>
 
@@ -16,6 +17,12 @@ MarkSweepGC::MarkSweepGC(
     : next_object_id(0),
       max_heap_size(max_heap_size),
       collection_threshold(collection_threshold),
+      trigger_memory(collection_threshold),
+      used_memory(0),
+      alive_objects(0),
+      edge_count(0),
+      marked_objects(0),
+      logging_enabled(true),
       collection_count(0),
       total_objects_collected(0),
       total_memory_freed(0),
@@ -59,9 +66,14 @@ int MarkSweepGC::allocate(size_t size) {
         return -1;
     }
 
-    // Если мало памяти, запустить сборку
+    // Если мало памяти или пройден порог, запустить сборку
     if (!has_enough_memory(size)) {
         log_operation("ALLOCATE: memory low, triggering collection...");
+        collection_stats.triggered_collections++;
+        collect();
+    } else if (threshold_reached(size)) {
+        log_operation("ALLOCATE: threshold reached, triggering collection...");
+        collection_stats.triggered_collections++;
         collect();
     }
 
@@ -76,15 +88,82 @@ int MarkSweepGC::allocate(size_t size) {
     HeapObject obj(object_id, size, false);
     obj.allocation_step = current_step;
     heap[object_id] = obj;
+    used_memory += size;
+    alive_objects++;
+    delta_tracker.on_allocate(object_id);
 
     // Логирование
-    std::ostringstream oss;
-    oss << "ALLOCATE: obj_" << object_id << " (size=" << size << " bytes)";
-    log_operation(oss.str());
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << "ALLOCATE: obj_" << object_id << " (size=" << size << " bytes)";
+        log_operation(oss.str());
+    }
 
     return object_id;
 }
 
+/**
+ * @brief Выделить count объектов одного размера
+ *
+ * Одна проверка размера и памяти, одно резервирование хеш-таблицы,
+ * одна запись в лог. id идут подряд, как при последовательных allocate().
+ */
+ObjectIdRange MarkSweepGC::allocate_many(size_t count, size_t size) {
+    ObjectIdRange range;
+    range.first = next_object_id;
+    if (count == 0) {
+        return range;
+    }
+
+    if (size == 0 || size > max_heap_size) {
+        log_operation("ALLOCATE_MANY FAILED: invalid size " + std::to_string(size));
+        return range;
+    }
+
+    size_t fit = get_free_memory() / size;
+    if (fit < count) {
+        log_operation("ALLOCATE_MANY: memory low, triggering collection...");
+        collection_stats.triggered_collections++;
+        collect();
+        fit = get_free_memory() / size;
+    } else if (threshold_reached(count * size)) {
+        log_operation("ALLOCATE_MANY: threshold reached, triggering collection...");
+        collection_stats.triggered_collections++;
+        collect();
+        fit = get_free_memory() / size;
+    }
+
+    size_t id_space = static_cast<size_t>(std::numeric_limits<int>::max() - next_object_id);
+    size_t n = std::min(std::min(count, fit), id_space);
+    if (n == 0) {
+        log_operation("ALLOCATE_MANY FAILED: out of memory");
+        return range;
+    }
+
+    heap.reserve(heap.size() + n);
+    for (size_t i = 0; i < n; ++i) {
+        int object_id = next_object_id++;
+        HeapObject& obj = heap.try_emplace(object_id, object_id, size, false).first->second;
+        obj.allocation_step = current_step;
+        delta_tracker.on_allocate(object_id);
+    }
+    used_memory += n * size;
+    alive_objects += n;
+    range.count = static_cast<int>(n);
+
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << "ALLOCATE_MANY: obj_" << range.first << "..obj_" << (range.end() - 1)
+            << " (" << n << " x " << size << " bytes)";
+        if (n < count) {
+            oss << ", " << (count - n) << " failed: out of memory";
+        }
+        log_operation(oss.str());
+    }
+
+    return range;
+}
+
 /**
  * @brief Создать ссылку от одного объекта к другому
  *
@@ -127,15 +206,65 @@ bool MarkSweepGC::add_reference(int from_id, int to_id) {
     // Добавить ссылку
     source.add_reference_to(to_id);
     target.add_reference_from(from_id);
+    edge_count++;
+    delta_tracker.on_edge_added(from_id, to_id);
 
     // Логирование
-    std::ostringstream oss;
-    oss << "ADD_REF: obj_" << from_id << " -> obj_" << to_id;
-    log_operation(oss.str());
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << "ADD_REF: obj_" << from_id << " -> obj_" << to_id;
+        log_operation(oss.str());
+    }
 
     return true;
 }
 
+/**
+ * @brief Создать ссылки пачкой
+ *
+ * Один поиск в хеш-таблице на конец ссылки (источник кешируется
+ * между соседними парами — деревья и цепи строятся по источнику)
+ * и одна запись в лог на всю пачку.
+ */
+size_t MarkSweepGC::add_references(const ReferencePair* refs, size_t count) {
+    size_t added = 0;
+    size_t existing = 0;
+    size_t failed = 0;
+    auto source = heap.end();
+
+    for (size_t i = 0; i < count; ++i) {
+        const ReferencePair& ref = refs[i];
+        if (source == heap.end() || source->first != ref.from) {
+            source = heap.find(ref.from);
+        }
+        auto target = heap.find(ref.to);
+        if (source == heap.end() || !source->second.is_alive ||
+            target == heap.end() || !target->second.is_alive) {
+            failed++;
+            continue;
+        }
+
+        if (!source->second.outgoing_references.insert(ref.to).second) {
+            existing++;
+            continue;
+        }
+        target->second.add_reference_from(ref.from);
+        edge_count++;
+        delta_tracker.on_edge_added(ref.from, ref.to);
+        added++;
+    }
+
+    if (logging_enabled && count > 0) {
+        std::ostringstream oss;
+        oss << "ADD_REFS: " << added << " added";
+        if (existing > 0) oss << ", " << existing << " already existed";
+        if (failed > 0) oss << ", " << failed << " failed: object not found";
+        log_operation(oss.str());
+    }
+
+    return added + existing;
+}
+
 /**
  * @brief Удалить ссылку от одного объекта к другому
  *
@@ -178,6 +307,8 @@ bool MarkSweepGC::remove_reference(int from_id, int to_id) {
     // Удалить ссылку
     source.remove_reference_to(to_id);
     target.remove_reference_from(from_id);
+    edge_count--;
+    delta_tracker.on_edge_removed(from_id, to_id);
 
     // Логирование
     std::ostringstream oss;
@@ -230,12 +361,23 @@ size_t MarkSweepGC::collect() {
     ).count();
     total_collection_time += duration;
 
+    uint64_t pause_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end_time - start_time).count());
+    collection_stats.total_pause_ns += pause_ns;
+    collection_stats.last_pause_ns = pause_ns;
+    collection_stats.last_pause_start_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start_time.time_since_epoch()).count());
+    collection_stats.max_pause_ns = std::max(collection_stats.max_pause_ns, pause_ns);
+    update_trigger();
+
     // Логирование конца сборки
-    std::ostringstream oss_end;
-    oss_end << "[COLLECTION #" << collection_count << "] Complete. "
-            << "Freed: " << freed_memory << " bytes, "
-            << "Live objects: " << get_alive_objects_count();
-    log_operation(oss_end.str());
+    if (logging_enabled) {
+        std::ostringstream oss_end;
+        oss_end << "[COLLECTION #" << collection_count << "] Complete. "
+                << "Freed: " << freed_memory << " bytes, "
+                << "Live objects: " << get_alive_objects_count();
+        log_operation(oss_end.str());
+    }
 
     return freed_memory;
 }
@@ -256,51 +398,157 @@ size_t MarkSweepGC::collect() {
  * }
  */
 std::string MarkSweepGC::get_heap_info() const {
-    std::ostringstream oss;
-    oss << "{\n";
-    oss << " \"total_objects\": " << heap.size() << ",\n";
-    oss << " \"alive_objects\": " << get_alive_objects_count() << ",\n";
-    oss << " \"total_memory\": " << get_total_memory() << ",\n";
-    oss << " \"free_memory\": " << get_free_memory() << ",\n";
-    oss << " \"objects\": [\n";
+    std::string result;
+    HeapSnapshotWriter writer([&result](const char* data, size_t size) {
+        result.append(data, size);
+    });
+    write_heap_info(writer);
+    writer.flush();
+    return result;
+}
+
+/**
+ * @brief Потоковая запись информации о heap'е
+ *
+ * Объекты пишутся по одному прямо в буфер писателя, поэтому
+ * память не растёт с размером heap'а.
+ */
+void MarkSweepGC::write_heap_info(HeapSnapshotWriter& w) const {
+    w.write("{\n");
+    w.write(" \"total_objects\": ");
+    w.write_uint(heap.size());
+    w.write(",\n \"alive_objects\": ");
+    w.write_int(get_alive_objects_count());
+    w.write(",\n \"total_memory\": ");
+    w.write_uint(get_total_memory());
+    w.write(",\n \"free_memory\": ");
+    w.write_uint(get_free_memory());
+    w.write(",\n \"objects\": [\n");
 
     bool first = true;
     for (const auto& [id, obj] : heap) {
-        if (!first) oss << ",\n";
+        if (!first) w.write(",\n", 2);
         first = false;
+        write_heap_object_json(w, obj);
+    }
 
-        oss << " {\n";
-        oss << "  \"id\": " << obj.id << ",\n";
-        oss << "  \"size\": " << obj.size << ",\n";
-        oss << "  \"marked\": " << (obj.is_marked ? "true" : "false") << ",\n";
-        oss << "  \"is_root\": " << (obj.is_root ? "true" : "false") << ",\n";
-        oss << "  \"alive\": " << (obj.is_alive ? "true" : "false") << ",\n";
-        oss << "  \"refs_to\": [";
-
-        bool first_ref = true;
-        for (int ref_id : obj.outgoing_references) {
-            if (!first_ref) oss << ", ";
-            first_ref = false;
-            oss << ref_id;
-        }
+    w.write("\n ]\n}\n");
+}
 
-        oss << "],\n";
-        oss << "  \"refs_from\": [";
-        first_ref = true;
-        for (int ref_id : obj.incoming_references) {
-            if (!first_ref) oss << ", ";
-            first_ref = false;
-            oss << ref_id;
-        }
+/**
+ * @brief Записать дельта-снимок или keyframe
+ *
+ * Дельта стоит O(изменений с прошлого снимка), keyframe — O(heap).
+ */
+void MarkSweepGC::write_heap_delta(HeapSnapshotWriter& w) {
+    if (delta_tracker.keyframe_due()) {
+        delta_tracker.write_keyframe_begin(w, current_step);
+        write_heap_info(w);
+        delta_tracker.write_keyframe_end(w);
+    } else {
+        delta_tracker.write_delta(w, heap, current_step, alive_objects, used_memory);
+    }
+    delta_tracker.commit();
+}
+
+// ===========================
+// CHECKPOINT
+// ===========================
+
+/**
+ * @brief Записать полное состояние в бинарном формате
+ */
+void MarkSweepGC::write_checkpoint(HeapSnapshotWriter& w) const {
+    CheckpointHeader header = make_checkpoint_header(CheckpointKind::MARK_SWEEP);
+    header.next_object_id = next_object_id;
+    header.current_step = current_step;
+    header.max_heap_size = max_heap_size;
+    header.collection_threshold = collection_threshold;
+    header.trigger_memory = trigger_memory;
+    header.collection_count = collection_count;
+    header.total_objects_collected = total_objects_collected;
+    header.total_memory_freed = total_memory_freed;
+    header.total_collection_time = total_collection_time;
+    header.marked_objects = marked_objects;
+    write_heap_checkpoint(w, header, heap, next_object_id);
+}
+
+/**
+ * @brief Восстановить состояние из checkpoint'а
+ *
+ * Heap собирается во временном хранилище и подменяется
+ * только после успешного чтения.
+ */
+bool MarkSweepGC::read_checkpoint(const uint8_t* data, size_t size) {
+    CheckpointReader reader(data, size);
+    CheckpointHeader header;
+    std::unordered_map<int, HeapObject> loaded;
+
+    if (!reader.read_header(CheckpointKind::MARK_SWEEP, header) ||
+        !read_heap_checkpoint(reader, header, loaded)) {
+        log_operation("LOAD_CHECKPOINT FAILED: invalid or truncated data");
+        return false;
+    }
 
-        oss << "]\n";
-        oss << " }";
+    heap.swap(loaded);
+    next_object_id = static_cast<int>(header.next_object_id);
+    current_step = static_cast<int>(header.current_step);
+    max_heap_size = header.max_heap_size;
+    collection_threshold = header.collection_threshold;
+    collection_count = static_cast<int>(header.collection_count);
+    total_objects_collected = static_cast<int>(header.total_objects_collected);
+    total_memory_freed = header.total_memory_freed;
+    total_collection_time = static_cast<int>(header.total_collection_time);
+    marked_objects = header.marked_objects;
+    rebuild_indexes();
+    // Порог живой кучи на этом шаге; 0 — checkpoint без порога, пересчитать
+    trigger_memory = header.trigger_memory;
+    if (trigger_memory == 0) {
+        update_trigger();
     }
+    delta_tracker.invalidate();
+
+    std::ostringstream oss;
+    oss << "LOAD_CHECKPOINT: " << heap.size() << " objects, "
+        << edge_count << " edges, step " << current_step;
+    log_operation(oss.str());
+    return true;
+}
 
-    oss << "\n ]\n";
-    oss << "}\n";
+bool MarkSweepGC::save_checkpoint(const std::string& path) const {
+    return write_checkpoint_file(path, [this](HeapSnapshotWriter& w) {
+        write_checkpoint(w);
+    });
+}
 
-    return oss.str();
+bool MarkSweepGC::load_checkpoint(const std::string& path) {
+    MappedCheckpointFile file;
+    if (!file.open(path)) {
+        log_operation("LOAD_CHECKPOINT FAILED: cannot open " + path);
+        return false;
+    }
+    return read_checkpoint(file.data(), file.size());
+}
+
+/**
+ * @brief Пересчитать root_ids, счётчики и занятую память по heap'у
+ */
+void MarkSweepGC::rebuild_indexes() {
+    root_ids.clear();
+    used_memory = 0;
+    alive_objects = 0;
+    edge_count = 0;
+
+    for (const auto& [id, obj] : heap) {
+        if (obj.is_root) {
+            root_ids.insert(id);
+        }
+        if (obj.is_alive) {
+            used_memory += obj.size;
+            alive_objects++;
+            edge_count += obj.outgoing_references.size();
+        }
+    }
 }
 
 /**
@@ -328,19 +576,17 @@ std::string MarkSweepGC::get_gc_stats() const {
     return oss.str();
 }
 
+GCCollectionStats MarkSweepGC::get_collection_stats() const {
+    GCCollectionStats stats = collection_stats;
+    stats.collections = static_cast<uint64_t>(collection_count);
+    return stats;
+}
+
 /**
  * @brief Получить общий размер выделенной памяти
  */
 size_t MarkSweepGC::get_total_memory() const {
-    size_t total = 0;
-
-    for (const auto& [id, obj] : heap) {
-        if (obj.is_alive) {
-            total += obj.size;
-        }
-    }
-
-    return total;
+    return used_memory;
 }
 
 /**
@@ -360,6 +606,8 @@ size_t MarkSweepGC::get_free_memory() const {
 void MarkSweepGC::make_root(int object_id) {
     if (object_exists(object_id)) {
         heap[object_id].is_root = true;
+        root_ids.insert(object_id);
+        delta_tracker.on_root_changed(object_id);
         std::ostringstream oss;
         oss << "MAKE_ROOT: obj_" << object_id << " is now a root object";
         log_operation(oss.str());
@@ -372,6 +620,8 @@ void MarkSweepGC::make_root(int object_id) {
 void MarkSweepGC::remove_root(int object_id) {
     if (object_exists(object_id)) {
         heap[object_id].is_root = false;
+        root_ids.erase(object_id);
+        delta_tracker.on_root_changed(object_id);
         std::ostringstream oss;
         oss << "REMOVE_ROOT: obj_" << object_id << " is no longer a root";
         log_operation(oss.str());
@@ -413,15 +663,44 @@ bool MarkSweepGC::object_exists(int id) const {
  * @brief Получить количество живых объектов
  */
 int MarkSweepGC::get_alive_objects_count() const {
-    int count = 0;
+    return static_cast<int>(alive_objects);
+}
 
-    for (const auto& [id, obj] : heap) {
-        if (obj.is_alive) {
-            count++;
-        }
-    }
+// ===========================
+// ЗАПРОСЫ К HEAP'У
+// ===========================
 
-    return count;
+/**
+ * @brief Постраничный запрос объектов
+ */
+HeapQueryResult MarkSweepGC::query_objects(const HeapQuery& query) const {
+    return run_heap_query(heap, next_object_id, root_ids, query);
+}
+
+/**
+ * @brief k-окрестность объекта
+ */
+HeapNeighborhood MarkSweepGC::get_neighborhood(int object_id, int hops, size_t max_nodes,
+                                               NeighborDirection direction) const {
+    return collect_heap_neighborhood(heap, object_id, hops, max_nodes, direction);
+}
+
+/**
+ * @brief Сводка heap'а из инкрементальных счётчиков
+ */
+HeapSummary MarkSweepGC::get_summary() const {
+    HeapSummary summary;
+    summary.total_objects = heap.size();
+    summary.alive_objects = alive_objects;
+    summary.root_objects = root_ids.size();
+    summary.marked_objects = marked_objects;
+    summary.edge_count = edge_count;
+    summary.used_memory = used_memory;
+    summary.free_memory = get_free_memory();
+    summary.max_heap_size = max_heap_size;
+    summary.next_object_id = next_object_id;
+    summary.collection_count = collection_count;
+    return summary;
 }
 
 // ===========================
@@ -477,6 +756,8 @@ void MarkSweepGC::mark_phase() {
         }
     }
 
+    marked_objects = marked_count;
+
     std::ostringstream oss_result;
     oss_result << " Mark phase complete. " << marked_count
                << " objects marked as reachable.";
@@ -503,16 +784,18 @@ size_t MarkSweepGC::sweep_phase() {
     }
 
     // Логирование найденных объектов
-    std::ostringstream oss;
-    oss << " Found " << to_delete.size() << " objects to delete: [";
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << " Found " << to_delete.size() << " objects to delete: [";
 
-    for (size_t i = 0; i < to_delete.size(); i++) {
-        if (i > 0) oss << ", ";
-        oss << "obj_" << to_delete[i];
-    }
+        for (size_t i = 0; i < to_delete.size(); i++) {
+            if (i > 0) oss << ", ";
+            oss << "obj_" << to_delete[i];
+        }
 
-    oss << "]";
-    log_operation(oss.str());
+        oss << "]";
+        log_operation(oss.str());
+    }
 
     size_t freed_memory = 0;
 
@@ -522,12 +805,13 @@ size_t MarkSweepGC::sweep_phase() {
 
         // Удалить все ссылки от других объектов на этот
         for (int source_id : obj.incoming_references) {
-            if (object_exists(source_id)) {
-                heap[source_id].remove_reference_to(id);
+            if (source_id != id && object_exists(source_id)) {
+                edge_count -= heap[source_id].outgoing_references.erase(id);
             }
         }
 
         // Удалить все ссылки от этого объекта на другие
+        edge_count -= obj.outgoing_references.size();
         for (int target_id : obj.outgoing_references) {
             if (object_exists(target_id)) {
                 heap[target_id].remove_reference_from(id);
@@ -538,13 +822,18 @@ size_t MarkSweepGC::sweep_phase() {
         obj.is_alive = false;
         obj.collection_step = current_step;
         freed_memory += obj.size;
+        delta_tracker.on_free(id);
 
         // Логирование удаления
-        std::ostringstream oss_del;
-        oss_del << " Deleted obj_" << id << " (" << obj.size << " bytes)";
-        log_operation(oss_del.str());
+        if (logging_enabled) {
+            std::ostringstream oss_del;
+            oss_del << " Deleted obj_" << id << " (" << obj.size << " bytes)";
+            log_operation(oss_del.str());
+        }
     }
 
+    used_memory -= freed_memory;
+    alive_objects -= to_delete.size();
     total_objects_collected += to_delete.size();
 
     std::ostringstream oss_result;
@@ -576,9 +865,11 @@ void MarkSweepGC::dfs_mark(int object_id) {
 
     // Пометить как достижимый
     obj.is_marked = true;
-    std::ostringstream oss;
-    oss << " Mark obj_" << object_id;
-    log_operation(oss.str());
+    if (logging_enabled) {
+        std::ostringstream oss;
+        oss << " Mark obj_" << object_id;
+        log_operation(oss.str());
+    }
 
     // DFS по всем исходящим ссылкам
     for (int target_id : obj.outgoing_references) {
@@ -592,15 +883,7 @@ void MarkSweepGC::dfs_mark(int object_id) {
  * @brief Получить список всех root объектов
  */
 std::vector<int> MarkSweepGC::get_root_objects() const {
-    std::vector<int> roots;
-
-    for (const auto& [id, obj] : heap) {
-        if (obj.is_root && obj.is_alive) {
-            roots.push_back(id);
-        }
-    }
-
-    return roots;
+    return std::vector<int>(root_ids.begin(), root_ids.end());
 }
 
 /**
@@ -610,10 +893,31 @@ bool MarkSweepGC::has_enough_memory(size_t size) const {
     return get_free_memory() >= size;
 }
 
+bool MarkSweepGC::threshold_reached(size_t size) const {
+    return collection_threshold > 0 && used_memory + size > trigger_memory;
+}
+
+/**
+ * @brief Пересчитать порог следующей сборки
+ *
+ * Обычно это collection_threshold. Если выжившие уже занимают больше,
+ * следующая сборка откладывается до заполнения половины оставшегося
+ * места — иначе каждое выделение запускало бы полную сборку.
+ */
+void MarkSweepGC::update_trigger() {
+    size_t free_memory = max_heap_size > used_memory ? max_heap_size - used_memory : 0;
+    trigger_memory = used_memory >= collection_threshold ? used_memory + free_memory / 2
+                                                         : collection_threshold;
+}
+
 /**
  * @brief Логировать операцию
  */
 void MarkSweepGC::log_operation(const std::string& operation) {
+    if (!logging_enabled) {
+        return;
+    }
+
     // Добавить в вектор
     operation_logs.push_back(operation);
     last_operation = operation;
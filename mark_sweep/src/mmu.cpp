@@ -0,0 +1,85 @@
+#include "mmu.h"
+
+#include <algorithm>
+
+MMUCalculator::MMUCalculator(std::vector<PauseInterval> pauses_, double total_ms_)
+    : total_ms(std::max(total_ms_, 0.0))
+{
+    std::sort(pauses_.begin(), pauses_.end(),
+              [](const PauseInterval& a, const PauseInterval& b) { return a.start_ms < b.start_ms; });
+
+    for (PauseInterval pause : pauses_) {
+        pause.start_ms = std::max(pause.start_ms, 0.0);
+        pause.end_ms = std::min(pause.end_ms, total_ms);
+        if (pause.end_ms <= pause.start_ms) {
+            continue;
+        }
+        if (!pauses.empty() && pause.start_ms <= pauses.back().end_ms) {
+            pauses.back().end_ms = std::max(pauses.back().end_ms, pause.end_ms);
+        } else {
+            pauses.push_back(pause);
+        }
+    }
+
+    double sum = 0.0;
+    prefix.reserve(pauses.size());
+    for (const PauseInterval& pause : pauses) {
+        sum += pause.end_ms - pause.start_ms;
+        prefix.push_back(sum);
+    }
+}
+
+double MMUCalculator::collector_time_before(double t) const {
+    // Первая пауза, начавшаяся после t
+    auto it = std::upper_bound(pauses.begin(), pauses.end(), t,
+                               [](double value, const PauseInterval& p) { return value < p.start_ms; });
+    if (it == pauses.begin()) {
+        return 0.0;
+    }
+    size_t last = static_cast<size_t>(it - pauses.begin()) - 1;
+    double before = last > 0 ? prefix[last - 1] : 0.0;
+    return before + std::min(t, pauses[last].end_ms) - pauses[last].start_ms;
+}
+
+double MMUCalculator::utilization(double window_ms) const {
+    if (total_ms <= 0.0) {
+        return 1.0;
+    }
+    double w = std::min(window_ms, total_ms);
+    if (w <= 0.0) {
+        return pauses.empty() ? 1.0 : 0.0;
+    }
+
+    double worst = 0.0;
+    auto check = [&](double t) {
+        t = std::min(std::max(t, 0.0), total_ms - w);
+        worst = std::max(worst, collector_time_before(t + w) - collector_time_before(t));
+    };
+
+    check(0.0);
+    for (const PauseInterval& pause : pauses) {
+        check(pause.start_ms);
+        check(pause.end_ms - w);
+    }
+
+    return std::max(0.0, (w - worst) / w);
+}
+
+std::vector<MMUPoint> MMUCalculator::curve(const std::vector<double>& windows_ms) const {
+    std::vector<MMUPoint> points;
+    for (double window : windows_ms) {
+        if (window > total_ms) {
+            continue;
+        }
+        points.push_back(MMUPoint{window, utilization(window)});
+    }
+    return points;
+}
+
+double MMUCalculator::overall_utilization() const {
+    return total_ms > 0.0 ? (total_ms - get_pause_ms()) / total_ms : 1.0;
+}
+
+std::vector<double> MMUCalculator::default_windows() {
+    return {1, 2, 5, 10, 20, 50, 100, 200, 500, 1000};
+}
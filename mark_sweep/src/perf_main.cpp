@@ -1,7 +1,505 @@
+#include <algorithm>
 #include <iostream>
+#include <string>
 #include "performance_test.h"
 
+/**
+ * @brief Режим "snapshot": perf_test snapshot [size1 size2 ...]
+ */
+int run_snapshot_mode(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; ++i) {
+        try {
+            sizes.push_back(std::stoi(argv[i]));
+        } catch (...) {
+            std::cerr << "Invalid size: " << argv[i] << "\n";
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 10000000};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_snapshot_benchmarks(sizes);
+    perf_test.save_results_to_json("snapshot_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "checkpoint": perf_test checkpoint [size1 size2 ...]
+ */
+int run_checkpoint_mode(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; ++i) {
+        try {
+            sizes.push_back(std::stoi(argv[i]));
+        } catch (...) {
+            std::cerr << "Invalid size: " << argv[i] << "\n";
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 10000000};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_checkpoint_benchmarks(sizes);
+    perf_test.save_results_to_json("checkpoint_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "replay": perf_test replay [num_ops [checkpoint_interval]]
+ */
+int run_replay_mode(int argc, char* argv[]) {
+    int num_ops = 1000000;
+    int interval = 1000;
+    try {
+        if (argc > 2) num_ops = std::stoi(argv[2]);
+        if (argc > 3) interval = std::stoi(argv[3]);
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+    }
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "REPLAY SEEK BENCHMARK\n";
+    std::cout << num_ops << " ops, checkpoint every " << interval << " ops\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.test_replay_seek(num_ops, interval);
+    perf_test.save_results_to_json("replay_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "parse": perf_test parse [num_ops1 num_ops2 ...]
+ */
+int run_parse_mode(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    for (int i = 2; i < argc; ++i) {
+        try {
+            sizes.push_back(std::stoi(argv[i]));
+        } catch (...) {
+            std::cerr << "Invalid size: " << argv[i] << "\n";
+        }
+    }
+    if (sizes.empty()) {
+        sizes = {1000000, 10000000};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_parse_benchmarks(sizes);
+    perf_test.save_results_to_json("parse_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "scenario": perf_test scenario [num_ops]
+ */
+int run_scenario_mode(int argc, char* argv[]) {
+    int num_ops = 10000000;
+    try {
+        if (argc > 2) num_ops = std::stoi(argv[2]);
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+    }
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "SCENARIO STARTUP BENCHMARK\n";
+    std::cout << num_ops << " ops, JSON parse vs memory-mapped binary\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.test_binary_scenario_load(num_ops);
+    perf_test.save_results_to_json("scenario_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "dispatch": perf_test dispatch [num_ops] [backend]
+ */
+int run_dispatch_mode(int argc, char* argv[]) {
+    int num_ops = 10000000;
+    std::string backend = argc > 3 ? argv[3] : "mark_sweep";
+    try {
+        if (argc > 2) num_ops = std::stoi(argv[2]);
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+    }
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "SCENARIO DISPATCH BENCHMARK\n";
+    std::cout << num_ops << " ops on " << backend << ", string/dynamic_cast loop vs compiled executor\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.test_scenario_dispatch(num_ops, backend);
+    perf_test.save_results_to_json("dispatch_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "bulk": perf_test bulk [size1 size2 ...]
+ */
+int run_bulk_mode(int argc, char* argv[]) {
+    std::vector<int> sizes = {100000, 1000000};
+    if (argc > 2) {
+        sizes.clear();
+        try {
+            for (int i = 2; i < argc; ++i) {
+                sizes.push_back(std::stoi(argv[i]));
+            }
+        } catch (...) {
+            std::cerr << "Invalid arguments. Using defaults.\n";
+            sizes = {100000, 1000000};
+        }
+    }
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "BULK GRAPH CONSTRUCTION BENCHMARK\n";
+    std::cout << "allocate/add_reference per object vs allocate_many/add_references\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    PerformanceTest perf_test("./perf_results");
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << sizes.size() << "] "
+                  << sizes[i] << " objects...\n";
+        perf_test.test_bulk_construction(sizes[i]);
+    }
+    perf_test.save_results_to_json("bulk_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "workload": perf_test workload [num_allocations] [preset ...]
+ */
+int run_workload_mode(int argc, char* argv[]) {
+    int num_allocations = 1000000;
+    std::vector<std::string> presets = {"uniform", "production", "generational", "churn"};
+    try {
+        if (argc > 2) num_allocations = std::stoi(argv[2]);
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+    }
+    if (argc > 3) {
+        presets.assign(argv + 3, argv + argc);
+    }
+    
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "SYNTHETIC WORKLOAD BENCHMARK\n";
+    std::cout << num_allocations << " allocations per preset, collect every 100000\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    PerformanceTest perf_test("./perf_results");
+    for (size_t i = 0; i < presets.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << presets.size() << "] "
+                  << presets[i] << "...\n";
+        perf_test.test_workload(presets[i], num_allocations);
+    }
+    perf_test.save_results_to_json("workload_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "churn": perf_test churn [live_objects] [num_allocations] [heap_mb]
+ */
+int run_churn_mode(int argc, char* argv[]) {
+    int live_objects = 100000;
+    int num_allocations = 1000000;
+    int heap_mb = 32;
+    try {
+        if (argc > 2) live_objects = std::stoi(argv[2]);
+        if (argc > 3) num_allocations = std::stoi(argv[3]);
+        if (argc > 4) heap_mb = std::stoi(argv[4]);
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_churn_benchmarks(live_objects, num_allocations,
+                                   static_cast<size_t>(std::max(heap_mb, 1)) * 1024 * 1024);
+    perf_test.save_results_to_json("churn_results.json");
+    perf_test.save_mmu_to_json("mmu_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "bench": perf_test bench [size1 size2 ...] [--warmup N] [--reps N]
+ *                       [--confidence C] [--pin CPU]
+ */
+int run_bench_mode(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    BenchmarkOptions options;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--warmup" && i + 1 < argc) {
+                options.warmup_runs = std::stoi(argv[++i]);
+            } else if (arg == "--reps" && i + 1 < argc) {
+                options.repetitions = std::stoi(argv[++i]);
+            } else if (arg == "--confidence" && i + 1 < argc) {
+                options.confidence = std::stod(argv[++i]);
+            } else if (arg == "--pin" && i + 1 < argc) {
+                options.pin_cpu = std::stoi(argv[++i]);
+            } else {
+                sizes.push_back(std::stoi(arg));
+            }
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        sizes.clear();
+        options = BenchmarkOptions();
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 10000};
+    }
+    if (options.repetitions < 1 || options.warmup_runs < 0 ||
+        !(options.confidence > 0.0 && options.confidence < 1.0)) {
+        std::cerr << "Error: need --reps >= 1, --warmup >= 0 and 0 < --confidence < 1\n";
+        return 1;
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_benchmark_suite(sizes, options);
+    perf_test.save_results_to_json("benchmark_results.json");
+    perf_test.save_results_to_csv("benchmark_results.csv");
+    return 0;
+}
+
+/**
+ * @brief Режим "matrix": perf_test matrix [size1 size2 ...] [--warmup N] [--reps N]
+ */
+int run_matrix_mode(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    BenchmarkOptions options;
+    options.repetitions = 5;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--warmup" && i + 1 < argc) {
+                options.warmup_runs = std::stoi(argv[++i]);
+            } else if (arg == "--reps" && i + 1 < argc) {
+                options.repetitions = std::stoi(argv[++i]);
+            } else {
+                sizes.push_back(std::stoi(arg));
+            }
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        sizes.clear();
+    }
+    if (sizes.empty()) {
+        sizes = {1000, 10000};
+    }
+    if (options.repetitions < 1 || options.warmup_runs < 0) {
+        std::cerr << "Error: need --reps >= 1 and --warmup >= 0\n";
+        return 1;
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_backend_matrix(sizes, options);
+    perf_test.save_results_to_json("matrix_results.json");
+    perf_test.save_results_to_csv("matrix_results.csv");
+    return 0;
+}
+
+/**
+ * @brief Режим "rc-teardown": perf_test rc-teardown [num_objects] [--budget B ...]
+ */
+int run_rc_teardown_mode(int argc, char* argv[]) {
+    int num_objects = 1000000;
+    std::vector<size_t> budgets;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--budget" && i + 1 < argc) {
+                budgets.push_back(static_cast<size_t>(std::stoul(argv[++i])));
+            } else {
+                num_objects = std::stoi(arg);
+            }
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        budgets.clear();
+    }
+    if (budgets.empty()) {
+        budgets = {0, 16, 64, 256};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_rc_teardown_benchmarks(std::max(num_objects, 1), budgets);
+    perf_test.save_results_to_json("rc_teardown_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "rc-coalesce": perf_test rc-coalesce [holders] [writes] [--buffer B ...]
+ */
+int run_rc_coalesce_mode(int argc, char* argv[]) {
+    std::vector<int> positional;
+    std::vector<size_t> buffers;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--buffer" && i + 1 < argc) {
+                buffers.push_back(static_cast<size_t>(std::stoul(argv[++i])));
+            } else {
+                positional.push_back(std::stoi(arg));
+            }
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        positional.clear();
+        buffers.clear();
+    }
+    int num_holders = positional.size() > 0 ? positional[0] : 1000;
+    int writes = positional.size() > 1 ? positional[1] : 1000000;
+    if (buffers.empty()) {
+        buffers = {0, 256, 4096};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_rc_coalescing_benchmarks(std::max(num_holders, 1), std::max(writes, 0), buffers);
+    perf_test.save_results_to_json("rc_coalesce_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "rc-concurrent": perf_test rc-concurrent [ops_per_thread] [--threads N ...] [--remote F]
+ */
+int run_rc_concurrent_mode(int argc, char* argv[]) {
+    int ops_per_thread = 1000000;
+    double remote_fraction = 0.1;
+    std::vector<int> thread_counts;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--threads" && i + 1 < argc) {
+                thread_counts.push_back(std::stoi(argv[++i]));
+            } else if (arg == "--remote" && i + 1 < argc) {
+                remote_fraction = std::stod(argv[++i]);
+            } else {
+                ops_per_thread = std::stoi(arg);
+            }
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        thread_counts.clear();
+    }
+    if (thread_counts.empty()) {
+        thread_counts = {1, 2, 4};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_concurrent_rc_benchmarks(thread_counts, std::max(ops_per_thread, 0),
+                                           std::min(std::max(remote_fraction, 0.0), 1.0));
+    perf_test.save_results_to_json("rc_concurrent_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "rc-hybrid": perf_test rc-hybrid [sizes...] [--interval B]
+ */
+int run_rc_hybrid_mode(int argc, char* argv[]) {
+    std::vector<int> sizes;
+    size_t trace_interval = 1048576;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--interval" && i + 1 < argc) {
+                trace_interval = static_cast<size_t>(std::stoul(argv[++i]));
+            } else {
+                sizes.push_back(std::stoi(arg));
+            }
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        sizes.clear();
+        trace_interval = 1048576;
+    }
+    if (sizes.empty()) {
+        sizes = {10000, 100000};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_rc_hybrid_benchmarks(sizes, trace_interval);
+    perf_test.save_results_to_json("rc_hybrid_results.json");
+    return 0;
+}
+
+/**
+ * @brief Режим "rc-fanout": perf_test rc-fanout [edges...]
+ */
+int run_rc_fanout_mode(int argc, char* argv[]) {
+    std::vector<int> edge_counts;
+    try {
+        for (int i = 2; i < argc; ++i) {
+            edge_counts.push_back(std::max(std::stoi(argv[i]), 0));
+        }
+    } catch (...) {
+        std::cerr << "Invalid arguments. Using defaults.\n";
+        edge_counts.clear();
+    }
+    if (edge_counts.empty()) {
+        edge_counts = {1000, 100000, 1000000};
+    }
+    
+    PerformanceTest perf_test("./perf_results");
+    perf_test.run_rc_fanout_benchmarks(edge_counts);
+    perf_test.save_results_to_json("rc_fanout_results.json");
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "snapshot") {
+        return run_snapshot_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "checkpoint") {
+        return run_checkpoint_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "replay") {
+        return run_replay_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "parse") {
+        return run_parse_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "scenario") {
+        return run_scenario_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "dispatch") {
+        return run_dispatch_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bulk") {
+        return run_bulk_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "workload") {
+        return run_workload_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "churn") {
+        return run_churn_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return run_bench_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "matrix") {
+        return run_matrix_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rc-teardown") {
+        return run_rc_teardown_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rc-coalesce") {
+        return run_rc_coalesce_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rc-concurrent") {
+        return run_rc_concurrent_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rc-hybrid") {
+        return run_rc_hybrid_mode(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "rc-fanout") {
+        return run_rc_fanout_mode(argc, argv);
+    }
+    
     std::cout << "\n";
     std::cout << "====================================================================\n";
     std::cout << "       Mark-Sweep GC Performance Test Suite\n";
@@ -15,6 +513,7 @@ int main(int argc, char* argv[]) {
     int small_size = 1000;
     int medium_size = 10000;
     int large_size = 100000;
+    std::string backend = argc > 4 ? argv[4] : "mark_sweep";
     
     if (argc > 1) {
         try {
@@ -30,19 +529,25 @@ int main(int argc, char* argv[]) {
     std::cout << "  Small:  " << small_size << " objects\n";
     std::cout << "  Medium: " << medium_size << " objects\n";
     std::cout << "  Large:  " << large_size << " objects\n";
+    std::cout << "  Collector: " << backend << "\n";
     std::cout << "\nStarting tests...\n\n";
     
     // Создаём и запускаем тесты
     PerformanceTest perf_test("./perf_results");
-    perf_test.run_all_tests(small_size, medium_size, large_size);
+    perf_test.run_all_tests(small_size, medium_size, large_size, backend);
+    
+    // Паузы под нагрузкой: сборки по порогу, кривые MMU по коллекторам
+    perf_test.run_churn_benchmarks(20000, 200000, 8 * 1024 * 1024);
     
     // Сохраняем результаты
     perf_test.save_results_to_json("performance_results.json");
+    perf_test.save_mmu_to_json("mmu_results.json");
     
     std::cout << std::string(100, '=') << "\n";
     std::cout << "OK All tests completed successfully!\n";
     std::cout << "OK Logs saved to:     ./perf_results/*.log\n";
     std::cout << "OK Results saved to:  ./perf_results/performance_results.json\n";
+    std::cout << "OK MMU curves:        ./perf_results/mmu_results.json\n";
     std::cout << std::string(100, '=') << "\n\n";
     
     return 0;
@@ -1,259 +1,2377 @@
 #include "performance_test.h"
+#include "cascade_deletion_gc.h"
+#include "scenario_parser.h"
+#include "scenario_binary.h"
+#include "scenario_executor.h"
+#include "workload_generator.h"
+#include "mmu.h"
+#include "gc_backends.h"
+#include "rc_heap.h"
+#include "concurrent_rc_heap.h"
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <memory>
 #include <cmath>
 #include <sstream>
 #include <iomanip>
+#include <cstdio>
+#include <random>
 #include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+/**
+ * @brief Построить цепь root -> obj1 -> ... -> objN пакетными вызовами
+ * @return Диапазон id цепи; первый объект уже сделан корнем
+ */
+template<typename GC>
+ObjectIdRange build_rooted_chain(GC& gc, int num_objects, size_t object_size) {
+    if (num_objects <= 0) {
+        return ObjectIdRange();
+    }
+    ObjectIdRange chain = gc.allocate_many(static_cast<size_t>(num_objects), object_size);
+    if (chain.empty()) {
+        return chain;
+    }
+    gc.make_root(chain.first);
+
+    std::vector<ReferencePair> refs;
+    refs.reserve(static_cast<size_t>(chain.count - 1));
+    for (int id = chain.first + 1; id < chain.end(); ++id) {
+        refs.push_back(ReferencePair{id - 1, id});
+    }
+    gc.add_references(refs.data(), refs.size());
+    return chain;
+}
+
+/**
+ * @brief Построить root -> [цикл] -> [цикл] ... пакетными вызовами
+ *
+ * Первый объект каждого цикла подключён к root; внутри цикла
+ * obj0 -> obj1 -> ... -> objK -> obj0.
+ *
+ * @param edge_count Сколько рёбер добавлено (может быть nullptr)
+ * @return Диапазон id: root и все объекты циклов; root уже корень
+ */
+template<typename GC>
+ObjectIdRange build_rooted_cycles(GC& gc, int num_objects, int cycle_length,
+                                  size_t object_size, size_t* edge_count = nullptr) {
+    int root_id = gc.allocate(object_size);
+    if (root_id < 0) {
+        return ObjectIdRange();
+    }
+    gc.make_root(root_id);
+
+    // Все объекты циклов выделяются одним вызовом
+    int num_cycles = std::max(1, (num_objects - 1) / cycle_length);
+    int cycle_total = std::min(num_cycles * cycle_length, std::max(num_objects - 1, 0));
+    ObjectIdRange cycles = gc.allocate_many(static_cast<size_t>(cycle_total), object_size);
+
+    std::vector<ReferencePair> refs;
+    refs.reserve(static_cast<size_t>(cycles.count + num_cycles));
+    for (int base = cycles.first; base < cycles.end(); base += cycle_length) {
+        int cycle_end = std::min(base + cycle_length, cycles.end());
+        refs.push_back(ReferencePair{root_id, base});
+        for (int id = base; id < cycle_end; ++id) {
+            refs.push_back(ReferencePair{id, id + 1 < cycle_end ? id + 1 : base});
+        }
+    }
+    gc.add_references(refs.data(), refs.size());
+    if (edge_count) {
+        *edge_count = refs.size();
+    }
+    return ObjectIdRange{root_id, 1 + cycles.count};
+}
+
+/**
+ * @brief Построить дерево с ветвлением fanout пакетными вызовами
+ * @return Диапазон id дерева; первый объект (корень дерева) уже корень GC
+ */
+template<typename GC>
+ObjectIdRange build_rooted_tree(GC& gc, int num_objects, int fanout, size_t object_size) {
+    ObjectIdRange tree = gc.allocate_many(static_cast<size_t>(std::max(num_objects, 0)), object_size);
+    if (tree.empty()) {
+        return tree;
+    }
+    gc.make_root(tree.first);
+
+    std::vector<ReferencePair> refs;
+    refs.reserve(static_cast<size_t>(tree.count - 1));
+    for (int i = 1; i < tree.count; ++i) {
+        refs.push_back(ReferencePair{tree.first + (i - 1) / fanout, tree.first + i});
+    }
+    gc.add_references(refs.data(), refs.size());
+    return tree;
+}
+
+/** @brief Точек на графике heap'а в test_churn */
+constexpr uint64_t CHURN_TIMELINE_POINTS = 100;
+
+/**
+ * @brief Итоги одного прогона установившегося режима
+ */
+struct ChurnRun {
+    WorkloadStats stats;
+    double total_ms = 0.0;
+    std::vector<PauseInterval> pauses;   // Каждая сборка, мс от начала прогона
+    size_t peak_heap = 0;
+    json timeline = json::array();
+};
+
+/**
+ * @brief Прогнать нагрузку и записать каждую паузу и пики heap'а
+ *
+ * Сборки запускаются изнутри allocate(), поэтому после каждого
+ * выделения опрашивается get_collection_stats(): изменившийся
+ * счётчик означает новую паузу длиной last_pause_ns.
+ */
+template<typename GC>
+ChurnRun run_churn(GC& gc, const WorkloadConfig& config, uint64_t num_allocations) {
+    ChurnRun run;
+    WorkloadGenerator generator(config);
+    uint64_t seen_collections = gc.get_collection_stats().collections;
+    uint64_t sample_every = std::max<uint64_t>(num_allocations / CHURN_TIMELINE_POINTS, 1);
+    uint64_t allocations = 0;
+    size_t window_peak = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    uint64_t start_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count());
+    auto observer = [&](size_t, const CompactOp& op, int64_t) {
+        if (op.code != ScenarioOpCode::ALLOCATE) {
+            return;
+        }
+        GCCollectionStats collections = gc.get_collection_stats();
+        if (collections.collections != seen_collections) {
+            seen_collections = collections.collections;
+            double pause_start = (static_cast<double>(collections.last_pause_start_ns) -
+                                  static_cast<double>(start_ns)) / 1e6;
+            run.pauses.push_back(PauseInterval{pause_start, pause_start + collections.last_pause_ns / 1e6});
+        }
+
+        size_t heap = gc.get_total_memory();
+        window_peak = std::max(window_peak, heap);
+        run.peak_heap = std::max(run.peak_heap, heap);
+
+        if (++allocations % sample_every == 0) {
+            double elapsed = std::chrono::duration<double, std::milli>(
+                std::chrono::high_resolution_clock::now() - start).count();
+            run.timeline.push_back({
+                {"allocations", allocations},
+                {"time_ms", std::round(elapsed * 100) / 100.0},
+                {"peak_heap_bytes", window_peak},
+                {"live_objects", gc.get_alive_objects_count()}
+            });
+            window_peak = 0;
+        }
+    };
+    run.stats = generator.run(gc, num_allocations, observer);
+    run.total_ms = std::chrono::duration<double, std::milli>(
+        std::chrono::high_resolution_clock::now() - start).count();
+    return run;
+}
+
+/**
+ * @brief Перцентиль по упорядоченной выборке (ближайший ранг)
+ */
+double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * sorted.size()));
+    return sorted[std::min(std::max<size_t>(rank, 1), sorted.size()) - 1];
+}
+
+/**
+ * @brief Имя теста на коллекторе backend
+ *
+ * У Mark-Sweep имя прежнее, чтобы bench_compare сопоставлял прогоны
+ * с сохранёнными до появления выбора коллектора.
+ */
+std::string backend_test_name(const std::string& name, const std::string& backend) {
+    return backend == "mark_sweep" ? name : name + " [" + backend + "]";
+}
+
+} // namespace
 
 PerformanceTest::PerformanceTest(const std::string& output_dir_)
     : output_dir(output_dir_) {
     ensure_output_directory();
 }
 
-void PerformanceTest::ensure_output_directory() {
-    std::string mkdir_cmd = "mkdir -p " + output_dir;
-    std::system(mkdir_cmd.c_str());
+void PerformanceTest::ensure_output_directory() {
+    std::string mkdir_cmd = "mkdir -p " + output_dir;
+    std::system(mkdir_cmd.c_str());
+}
+
+std::string PerformanceTest::get_timestamp() const {
+    auto now = std::chrono::system_clock::now();
+    auto time_t_now = std::chrono::system_clock::to_time_t(now);
+    std::stringstream ss;
+    ss << std::put_time(std::localtime(&time_t_now), "%Y-%m-%d %H:%M:%S");
+    return ss.str();
+}
+
+PerfTestResult PerformanceTest::test_simple_linear(int num_objects, const std::string& backend) {
+    PerfTestResult result;
+    result.test_name = backend_test_name("Simple Linear Chain", backend);
+    result.scenario_type = "simple_linear";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    
+    std::string log_file = output_dir + "/simple_linear_" + 
+                          std::to_string(num_objects) + ".log";
+    std::unique_ptr<GCInterface> collector = make_gc_backend(backend,
+                                                             1024 * 1024 * 100, // 100MB heap
+                                                             1024 * 1024 * 80,  // 80% threshold
+                                                             log_file);
+    if (!collector) {
+        std::cerr << "Error: unknown backend '" << backend << "'\n";
+        return result;
+    }
+    GCInterface& gc = *collector;
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    // === ЭТАП 1: СОЗДАНИЕ ЛИНЕЙНОЙ ЦЕПИ ===
+    // root -> obj1 -> obj2 -> ... -> objN, каждый объект 64 байта
+    
+    ObjectIdRange chain = build_rooted_chain(gc, num_objects, 64);
+    int root_id = chain.first;
+    // N выделений, make_root и N-1 ссылок
+    int op_count = chain.count > 0 ? 2 * chain.count : 0;
+    
+    // === ЭТАП 2: СБОРКА МУСОРА ===
+    gc.collect();
+    result.collection_runs = 1;
+    
+    // === ЭТАП 3: УДАЛЕНИЕ ROOT (демонстрация каскада) ===
+    gc.remove_root(root_id);
+    op_count++;
+    
+    // Вторая сборка
+    gc.collect();
+    result.collection_runs = 2;
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    
+    // === ПОДСЧЁТ РЕЗУЛЬТАТОВ ===
+    double exec_time = std::chrono::duration<double, std::milli>(
+        end_time - start_time).count();
+    
+    // Остаток после снятия корня — утечка коллектора
+    int leaked = gc.get_alive_objects_count();
+    result.execution_time_ms = exec_time;
+    result.total_operations = op_count;
+    result.objects_collected = chain.count - leaked;
+    result.objects_leaked = leaked;
+    result.memory_used_bytes = num_objects * 64;
+    result.memory_freed_bytes = static_cast<size_t>(chain.count) * 64 - gc.get_total_memory();
+    
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_cyclic_graph(int num_objects, int cycle_length, const std::string& backend) {
+    PerfTestResult result;
+    result.test_name = backend_test_name("Cyclic Graph (Cycle Detection)", backend);
+    result.scenario_type = "cyclic_graph";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    
+    std::string log_file = output_dir + "/cyclic_graph_" + 
+                          std::to_string(num_objects) + ".log";
+    std::unique_ptr<GCInterface> collector = make_gc_backend(backend,
+                                                             1024 * 1024 * 100,
+                                                             1024 * 1024 * 80,
+                                                             log_file);
+    if (!collector) {
+        std::cerr << "Error: unknown backend '" << backend << "'\n";
+        return result;
+    }
+    GCInterface& gc = *collector;
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    // === ЭТАП 1: СОЗДАНИЕ ЦИКЛИЧЕСКИХ ССЫЛОК ===
+    // Структура: root -> [cycle1] -> [cycle2] -> ...
+    // где каждый cycle имеет циклические ссылки между объектами
+    
+    size_t edge_count = 0;
+    ObjectIdRange graph = build_rooted_cycles(gc, num_objects, cycle_length, 64, &edge_count);
+    int root_id = graph.first;
+    // Выделения, make_root и рёбра
+    int op_count = graph.count + 1 + static_cast<int>(edge_count);
+    
+    // === ЭТАП 2: СБОРКА МУСОРА (ДО УДАЛЕНИЯ ROOT) ===
+    // Mark-Sweep должен НАЙТИ и пометить все циклы как достижимые
+    gc.collect();
+    result.collection_runs = 1;
+    
+    // === ЭТАП 3: УДАЛЕНИЕ ROOT ===
+    // После этого циклы станут недостижимы и будут удалены!
+    gc.remove_root(root_id);
+    op_count++;
+    
+    // Вторая сборка
+    gc.collect();
+    result.collection_runs = 2;
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    
+    // === ПОДСЧЁТ РЕЗУЛЬТАТОВ ===
+    double exec_time = std::chrono::duration<double, std::milli>(
+        end_time - start_time).count();
+    
+    // Mark-Sweep утечек не имеет; у RC без сборщика циклов циклы остаются
+    int leaked = gc.get_alive_objects_count();
+    result.execution_time_ms = exec_time;
+    result.total_operations = op_count;
+    result.objects_collected = graph.count - leaked;
+    result.objects_leaked = leaked;
+    result.memory_used_bytes = num_objects * 64;
+    result.memory_freed_bytes = static_cast<size_t>(graph.count) * 64 - gc.get_total_memory();
+    
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_cascade_tree(int num_objects, const std::string& backend) {
+    PerfTestResult result;
+    result.test_name = backend_test_name("Cascade Tree (Recursive Deletion)", backend);
+    result.scenario_type = "cascade_tree";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    
+    std::string log_file = output_dir + "/cascade_tree_" + 
+                          std::to_string(num_objects) + ".log";
+    std::unique_ptr<GCInterface> collector = make_gc_backend(backend,
+                                                             1024 * 1024 * 100,
+                                                             1024 * 1024 * 80,
+                                                             log_file);
+    if (!collector) {
+        std::cerr << "Error: unknown backend '" << backend << "'\n";
+        return result;
+    }
+    GCInterface& gc = *collector;
+    
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    // === Простая цепь: root -> obj1 -> obj2 -> ... -> objN ===
+    
+    ObjectIdRange chain = build_rooted_chain(gc, num_objects, 64);
+    int root_id = chain.first;
+    int created_count = chain.count;
+    int op_count = chain.count > 0 ? 2 * chain.count : 0;
+    
+    // === СБОРКА МУСОРА ===
+    gc.collect();
+    result.collection_runs = 1;
+    
+    // === УДАЛЕНИЕ ROOT ===
+    gc.remove_root(root_id);
+    op_count++;
+    
+    gc.collect();
+    result.collection_runs = 2;
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    
+    // === РЕЗУЛЬТАТЫ ===
+    double exec_time = std::chrono::duration<double, std::milli>(
+        end_time - start_time).count();
+    
+    int leaked = gc.get_alive_objects_count();
+    result.execution_time_ms = exec_time;
+    result.total_operations = op_count;
+    result.objects_collected = created_count - leaked;
+    result.objects_leaked = leaked;
+    result.memory_used_bytes = created_count * 64;
+    result.memory_freed_bytes = static_cast<size_t>(created_count) * 64 - gc.get_total_memory();
+    
+    results.push_back(result);
+    return result;
+}
+
+
+
+
+
+
+PerfTestResult PerformanceTest::test_snapshot_throughput(int num_objects, int compare_limit) {
+    PerfTestResult result;
+    result.test_name = "Streaming Heap Snapshot";
+    result.scenario_type = "heap_snapshot";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    
+    // Heap с запасом, чтобы allocate() не запускал сборку
+    size_t heap_bytes = static_cast<size_t>(num_objects) * 64 * 2;
+    MarkSweepGC gc(heap_bytes, heap_bytes, output_dir + "/heap_snapshot.log");
+    gc.set_logging_enabled(false);
+    
+    // === ЭТАП 1: ПОСТРОЕНИЕ ЦЕПИ (не измеряется) ===
+    build_rooted_chain(gc, num_objects, 64);
+    
+    // === ЭТАП 2: ПОТОКОВЫЙ СНИМОК В /dev/null ===
+    int fd = ::open("/dev/null", O_WRONLY);
+    auto start_time = std::chrono::high_resolution_clock::now();
+    
+    size_t snapshot_bytes = 0;
+    {
+        HeapSnapshotWriter writer(fd);
+        gc.write_heap_info(writer);
+        writer.flush();
+        snapshot_bytes = writer.bytes_written();
+    }
+    
+    auto end_time = std::chrono::high_resolution_clock::now();
+    if (fd >= 0) {
+        ::close(fd);
+    }
+    
+    double exec_time = std::chrono::duration<double, std::milli>(
+        end_time - start_time).count();
+    
+    result.execution_time_ms = exec_time;
+    result.total_operations = 1;
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.memory_used_bytes = snapshot_bytes;
+    result.memory_freed_bytes = 0;
+    result.throughput_mb_per_s = exec_time > 0.0
+        ? (snapshot_bytes / (1024.0 * 1024.0)) / (exec_time / 1000.0)
+        : 0.0;
+    
+    std::cout << "         stream:        " << std::fixed << std::setprecision(2)
+              << exec_time << " ms | "
+              << (snapshot_bytes / (1024.0 * 1024.0)) << " MB | "
+              << result.throughput_mb_per_s << " MB/s | buffer "
+              << (HeapSnapshotWriter::DEFAULT_BUFFER_SIZE / 1024) << " KB\n";
+    
+    // === ЭТАП 3: СТАРЫЙ ПУТЬ ЧЕРЕЗ get_heap_info() (для сравнения) ===
+    if (num_objects <= compare_limit) {
+        auto legacy_start = std::chrono::high_resolution_clock::now();
+        std::string info = gc.get_heap_info();
+        auto legacy_end = std::chrono::high_resolution_clock::now();
+        
+        double legacy_time = std::chrono::duration<double, std::milli>(
+            legacy_end - legacy_start).count();
+        std::cout << "         get_heap_info: " << std::fixed << std::setprecision(2)
+                  << legacy_time << " ms | "
+                  << (info.size() / (1024.0 * 1024.0)) << " MB held in one string\n";
+    }
+    
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_delta_snapshots(int num_objects, int steps, int changes_per_step) {
+    PerfTestResult result;
+    result.test_name = "Delta Heap Snapshots";
+    result.scenario_type = "heap_delta";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    
+    size_t heap_bytes = static_cast<size_t>(num_objects + steps * changes_per_step) * 64 * 2;
+    MarkSweepGC gc(heap_bytes, heap_bytes, output_dir + "/heap_delta.log");
+    gc.set_logging_enabled(false);
+    
+    // === ЭТАП 1: ПОСТРОЕНИЕ ЦЕПИ (не измеряется) ===
+    int root_id = build_rooted_chain(gc, num_objects, 64).first;
+    
+    // Только первый снимок — keyframe
+    gc.enable_delta_tracking(steps + 1);
+    
+    size_t chunk_bytes = 0;
+    HeapSnapshotWriter::ChunkCallback count_only = [&chunk_bytes](const char*, size_t size) {
+        chunk_bytes += size;
+    };
+    
+    size_t keyframe_bytes = 0;
+    {
+        HeapSnapshotWriter writer(count_only);
+        gc.write_heap_delta(writer);
+        keyframe_bytes = writer.bytes_written();
+    }
+    
+    // === ЭТАП 2: ШАГИ С ДЕЛЬТА-СНИМКАМИ ===
+    size_t delta_bytes = 0;
+    double delta_time = 0.0;
+    int operations = 0;
+    
+    for (int step = 0; step < steps; ++step) {
+        gc.set_current_step(step + 1);
+        
+        // Половина изменений — новые объекты, половина — их рёбра
+        int last_id = root_id;
+        for (int c = 0; c + 1 < changes_per_step; c += 2) {
+            int obj_id = gc.allocate(64);
+            gc.add_reference(last_id, obj_id);
+            last_id = obj_id;
+            operations += 2;
+        }
+        
+        auto delta_start = std::chrono::high_resolution_clock::now();
+        {
+            HeapSnapshotWriter writer(count_only);
+            gc.write_heap_delta(writer);
+            delta_bytes += writer.bytes_written();
+        }
+        auto delta_end = std::chrono::high_resolution_clock::now();
+        delta_time += std::chrono::duration<double, std::milli>(delta_end - delta_start).count();
+    }
+    
+    // Полный снимок почти не меняется от шага к шагу (O(heap)),
+    // поэтому для сравнения достаточно одного замера в конце
+    auto full_start = std::chrono::high_resolution_clock::now();
+    size_t full_bytes = 0;
+    {
+        HeapSnapshotWriter writer(count_only);
+        gc.write_heap_info(writer);
+        full_bytes = writer.bytes_written();
+    }
+    auto full_end = std::chrono::high_resolution_clock::now();
+    double full_time = std::chrono::duration<double, std::milli>(full_end - full_start).count();
+    
+    result.execution_time_ms = delta_time;
+    result.total_operations = operations;
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.memory_used_bytes = delta_bytes;
+    result.memory_freed_bytes = 0;
+    
+    double steps_d = steps > 0 ? steps : 1;
+    std::cout << "         keyframe:   " << keyframe_bytes << " bytes\n";
+    std::cout << "         delta/step: " << std::fixed << std::setprecision(1)
+              << (delta_bytes / steps_d) << " bytes, "
+              << (delta_time / steps_d) << " ms\n";
+    std::cout << "         full/step:  " << full_bytes << " bytes, "
+              << full_time << " ms\n";
+    if (delta_bytes > 0) {
+        std::cout << "         reduction:  " << std::setprecision(0)
+                  << (full_bytes * steps_d / delta_bytes) << "x\n";
+    }
+    
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_checkpoint_restore(int num_objects, int verify_limit) {
+    PerfTestResult result;
+    result.test_name = "Heap Checkpoint Restore";
+    result.scenario_type = "heap_checkpoint";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    
+    size_t heap_bytes = static_cast<size_t>(num_objects) * 64 * 2;
+    std::string path = output_dir + "/heap_checkpoint.bin";
+    
+    // === ЭТАП 1: ПОСТРОЕНИЕ ЧЕРЕЗ API ===
+    MarkSweepGC source(heap_bytes, heap_bytes, output_dir + "/heap_checkpoint.log");
+    source.set_logging_enabled(false);
+    
+    auto build_start = std::chrono::high_resolution_clock::now();
+    ObjectIdRange tree = source.allocate_many(static_cast<size_t>(num_objects), 64);
+    source.make_root(tree.first);
+    std::vector<ReferencePair> tree_refs;
+    tree_refs.reserve(static_cast<size_t>(num_objects));
+    for (int obj_id = tree.first + 1; obj_id < tree.end(); ++obj_id) {
+        tree_refs.push_back(ReferencePair{(obj_id - 1) / 4, obj_id});
+    }
+    source.add_references(tree_refs.data(), tree_refs.size());
+    auto build_end = std::chrono::high_resolution_clock::now();
+    
+    // === ЭТАП 2: СОХРАНЕНИЕ ===
+    auto save_start = std::chrono::high_resolution_clock::now();
+    bool saved = source.save_checkpoint(path);
+    auto save_end = std::chrono::high_resolution_clock::now();
+    
+    // === ЭТАП 3: ЗАГРУЗКА В НОВЫЙ КОЛЛЕКТОР ===
+    MarkSweepGC restored(1024, 1024, output_dir + "/heap_checkpoint.log");
+    restored.set_logging_enabled(false);
+    
+    auto load_start = std::chrono::high_resolution_clock::now();
+    bool loaded = saved && restored.load_checkpoint(path);
+    auto load_end = std::chrono::high_resolution_clock::now();
+    
+    double build_time = std::chrono::duration<double, std::milli>(build_end - build_start).count();
+    double save_time = std::chrono::duration<double, std::milli>(save_end - save_start).count();
+    double load_time = std::chrono::duration<double, std::milli>(load_end - load_start).count();
+    
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    size_t file_bytes = file ? static_cast<size_t>(file.tellg()) : 0;
+    
+    result.execution_time_ms = load_time;
+    result.total_operations = num_objects;
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.memory_used_bytes = file_bytes;
+    result.memory_freed_bytes = 0;
+    result.throughput_mb_per_s = load_time > 0.0
+        ? (file_bytes / (1024.0 * 1024.0)) / (load_time / 1000.0)
+        : 0.0;
+    
+    std::cout << "         build (API): " << std::fixed << std::setprecision(2)
+              << build_time << " ms\n";
+    std::cout << "         save:        " << save_time << " ms | "
+              << (file_bytes / (1024.0 * 1024.0)) << " MB\n";
+    std::cout << "         load:        " << load_time << " ms | "
+              << result.throughput_mb_per_s << " MB/s"
+              << (loaded ? "" : " | FAILED") << "\n";
+    
+    // Порядок обхода unordered_map после загрузки другой,
+    // поэтому сверяем объекты по ID, а не строки снимков
+    if (loaded && num_objects <= verify_limit) {
+        bool same = source.get_all_objects().size() == restored.get_all_objects().size() &&
+                    source.get_total_memory() == restored.get_total_memory() &&
+                    source.get_summary().edge_count == restored.get_summary().edge_count;
+        for (const auto& [id, obj] : source.get_all_objects()) {
+            const HeapObject* copy = restored.get_object(id);
+            if (!same || !copy) {
+                same = false;
+                break;
+            }
+            same = copy->size == obj.size && copy->is_root == obj.is_root &&
+                   copy->is_alive == obj.is_alive &&
+                   copy->outgoing_references == obj.outgoing_references &&
+                   copy->incoming_references == obj.incoming_references;
+        }
+        std::cout << "         verify:      " << (same ? "identical" : "MISMATCH") << "\n";
+    }
+    
+    std::remove(path.c_str());
+    results.push_back(result);
+    return result;
+}
+
+void PerformanceTest::run_checkpoint_benchmarks(const std::vector<int>& sizes) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "HEAP CHECKPOINT BENCHMARK\n";
+    std::cout << "allocate/add_reference vs binary save/load\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << sizes.size() << "] "
+                  << sizes[i] << " objects...\n";
+        test_checkpoint_restore(sizes[i]);
+    }
+    
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::test_replay_seek(int num_ops, int checkpoint_interval, int num_seeks) {
+    PerfTestResult result;
+    result.test_name = "Replay Seek";
+    result.scenario_type = "replay";
+    result.timestamp = get_timestamp();
+    result.total_operations = num_ops;
+    
+    // === ЭТАП 1: ЗАПИСЬ СЛУЧАЙНОГО ПОТОКА ===
+    // Треть операций — выделения, поэтому ID не выходят за num_ops / 3
+    std::mt19937 rng(12345);
+    std::vector<ReplayOp> ops;
+    ops.reserve(num_ops);
+    int allocated = 0;
+    for (int i = 0; i < num_ops; ++i) {
+        int r = static_cast<int>(rng() % 100);
+        if (allocated == 0 || r < 35) {
+            ops.push_back(ReplayOp::allocate(16 + static_cast<int>(rng() % 112)));
+            allocated++;
+        } else if (r < 75) {
+            ops.push_back(ReplayOp::add_ref(rng() % allocated, rng() % allocated));
+        } else if (r < 90) {
+            ops.push_back(ReplayOp::remove_ref(rng() % allocated, rng() % allocated));
+        } else if (r < 95) {
+            ops.push_back(ReplayOp::make_root(rng() % allocated));
+        } else if (r < 99) {
+            ops.push_back(ReplayOp::remove_root(rng() % allocated));
+        } else {
+            ops.push_back(ReplayOp::collect());
+        }
+    }
+    result.total_objects = allocated;
+    
+    size_t heap_bytes = static_cast<size_t>(allocated) * 128 + 1024;
+    MarkSweepGC gc(heap_bytes, heap_bytes, output_dir + "/replay.log");
+    gc.set_logging_enabled(false);
+    
+    ReplayEngine engine(gc, checkpoint_interval);
+    engine.record(ops);
+    
+    // === ЭТАП 2: ПЕРВЫЙ ПРОХОД (создаёт checkpoint'ы) ===
+    auto full_start = std::chrono::high_resolution_clock::now();
+    engine.run_to_end();
+    auto full_end = std::chrono::high_resolution_clock::now();
+    double full_time = std::chrono::duration<double, std::milli>(full_end - full_start).count();
+    
+    // === ЭТАП 3: СЛУЧАЙНЫЕ ПЕРЕМОТКИ ===
+    double total_seek = 0.0;
+    double max_seek = 0.0;
+    size_t max_replayed = 0;
+    for (int i = 0; i < num_seeks; ++i) {
+        engine.seek(rng() % (ops.size() + 1));
+        total_seek += engine.get_stats().last_seek_ms;
+        max_seek = std::max(max_seek, engine.get_stats().last_seek_ms);
+        max_replayed = std::max(max_replayed, engine.get_stats().last_seek_replayed);
+    }
+    
+    // === ЭТАП 4: СВЕРКА С ПРЯМЫМ ВЫПОЛНЕНИЕМ ===
+    size_t target = ops.size() / 2 + 7;
+    engine.seek(target);
+    MarkSweepGC direct(heap_bytes, heap_bytes, output_dir + "/replay.log");
+    direct.set_logging_enabled(false);
+    ReplayEngine direct_engine(direct, ops.size() + 1);
+    direct_engine.record(ops);
+    direct_engine.seek(target);
+    
+    HeapSummary a = gc.get_summary();
+    HeapSummary b = direct.get_summary();
+    bool same = a.alive_objects == b.alive_objects && a.edge_count == b.edge_count &&
+                a.root_objects == b.root_objects && a.used_memory == b.used_memory &&
+                a.next_object_id == b.next_object_id &&
+                a.collection_count == b.collection_count;
+    
+    const ReplayStats& stats = engine.get_stats();
+    double avg_seek = num_seeks > 0 ? total_seek / num_seeks : 0.0;
+    
+    result.execution_time_ms = avg_seek;
+    result.collection_runs = static_cast<int>(b.collection_count);
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.memory_used_bytes = stats.compressed_bytes;
+    result.memory_freed_bytes = 0;
+    
+    std::cout << "         first pass:  " << std::fixed << std::setprecision(2)
+              << full_time << " ms (" << stats.checkpoints << " checkpoints)\n";
+    std::cout << "         checkpoints: " << (stats.raw_bytes / (1024.0 * 1024.0)) << " MB raw, "
+              << (stats.compressed_bytes / (1024.0 * 1024.0)) << " MB compressed\n";
+    std::cout << "         seek:        avg " << avg_seek << " ms, max " << max_seek
+              << " ms, max replayed " << max_replayed << " ops\n";
+    std::cout << "         verify:      " << (same ? "identical" : "MISMATCH") << "\n";
+    
+    results.push_back(result);
+    return result;
+}
+
+namespace {
+
+/**
+ * @brief Операция в представлении прежних парсеров (строка + параметры)
+ */
+struct LegacyScenarioOp {
+    std::string type;
+    int param1 = 0;
+    int param2 = 0;
+    std::string collection_type = "mark_sweep";
+};
+
+/**
+ * @brief Прежний разбор: файл целиком в строку, find('{') + substr + sscanf
+ *
+ * Копия логики parse_json_scenario_ms / parse_json_scenario (все пять
+ * операций) — оставлена только как точка отсчёта для бенчмарка.
+ */
+std::vector<LegacyScenarioOp> legacy_parse_find_sscanf(const std::string& filename) {
+    std::vector<LegacyScenarioOp> operations;
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return operations;
+    }
+
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string content = buffer.str();
+    file.close();
+
+    size_t pos = 0;
+    while (pos < content.length()) {
+        pos = content.find('{', pos);
+        if (pos == std::string::npos) break;
+        size_t end = content.find('}', pos);
+        if (end == std::string::npos) break;
+        std::string obj = content.substr(pos, end - pos + 1);
+        pos = end + 1;
+
+        if (obj.find("\"op\"") == std::string::npos) continue;
+
+        LegacyScenarioOp op;
+        if (obj.find("\"op\": \"allocate\"") != std::string::npos) {
+            op.type = "allocate";
+            size_t size_pos = obj.find("\"size\"");
+            if (size_pos != std::string::npos) {
+                sscanf(obj.c_str() + size_pos, "\"size\": %d", &op.param1);
+            }
+        } else if (obj.find("\"op\": \"make_root\"") != std::string::npos ||
+                   obj.find("\"op\": \"remove_root\"") != std::string::npos) {
+            op.type = obj.find("make_root") != std::string::npos ? "make_root" : "remove_root";
+            size_t id_pos = obj.find("\"id\"");
+            if (id_pos != std::string::npos) {
+                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.param1);
+            }
+        } else if (obj.find("\"op\": \"add_ref\"") != std::string::npos ||
+                   obj.find("\"op\": \"remove_ref\"") != std::string::npos) {
+            op.type = obj.find("add_ref") != std::string::npos ? "add_ref" : "remove_ref";
+            size_t from_pos = obj.find("\"from\"");
+            size_t to_pos = obj.find("\"to\"");
+            if (from_pos != std::string::npos) {
+                sscanf(obj.c_str() + from_pos, "\"from\": %d", &op.param1);
+            }
+            if (to_pos != std::string::npos) {
+                sscanf(obj.c_str() + to_pos, "\"to\": %d", &op.param2);
+            }
+        } else if (obj.find("\"op\": \"collect\"") != std::string::npos) {
+            op.type = "collect";
+        } else {
+            continue;
+        }
+        operations.push_back(op);
+    }
+
+    return operations;
+}
+
+/**
+ * @brief Прежний разбор ScenarioLoader: полное DOM-дерево nlohmann::json
+ */
+std::vector<CompactOp> legacy_parse_dom(const std::string& filename) {
+    std::vector<CompactOp> operations;
+    std::ifstream file(filename);
+    json j;
+    file >> j;
+
+    for (const auto& op_json : j["operations"]) {
+        std::string name = op_json.value("op", "");
+        CompactOp op{ScenarioOpCode::COLLECT, 0, 0};
+        if (!scenario_op_from_name(name.data(), name.size(), op.code)) continue;
+        if (op.code == ScenarioOpCode::ALLOCATE) {
+            op.a = op_json.value("size", 0);
+        } else if (op.code == ScenarioOpCode::ADD_REF || op.code == ScenarioOpCode::REMOVE_REF) {
+            op.a = op_json.value("from", -1);
+            op.b = op_json.value("to", -1);
+        } else if (op.code != ScenarioOpCode::COLLECT) {
+            op.a = op_json.value("id", -1);
+        }
+        operations.push_back(op);
+    }
+    return operations;
+}
+
+/**
+ * @brief Сгенерировать сценарий из num_ops операций в стиле save_generated_json
+ *
+ * Смесь allocate (с description) / add_ref / remove_ref / make_root /
+ * remove_root и collect каждые 1000 операций.
+ */
+size_t write_parse_benchmark_scenario(const std::string& path, int num_ops) {
+    int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        return 0;
+    }
+
+    size_t bytes = 0;
+    {
+        HeapSnapshotWriter w(fd, 1024 * 1024);
+        w.write("{\n  \"scenario_name\": \"Parse Benchmark\",\n"
+                "  \"collection_type\": \"mark_sweep\",\n"
+                "  \"heap_size\": 1073741824,\n"
+                "  \"operations\": [\n");
+
+        int allocated = 0;
+        for (int i = 0; i < num_ops; ++i) {
+            w.write(i == 0 ? "    " : ",\n    ");
+            int kind = (i % 1000 == 999) ? 5 : (i % 5);
+            if (kind == 0 || allocated < 2) {
+                w.write("{\"op\": \"allocate\", \"size\": ");
+                w.write_int(64 + (i % 7) * 8);
+                w.write(", \"description\": \"Allocate object ");
+                w.write_int(allocated);
+                w.write("\"}");
+                allocated++;
+            } else if (kind == 1 || kind == 2) {
+                w.write(kind == 1 ? "{\"op\": \"add_ref\", \"from\": " : "{\"op\": \"remove_ref\", \"from\": ");
+                w.write_int(allocated - 2);
+                w.write(", \"to\": ");
+                w.write_int(allocated - 1);
+                w.write_char('}');
+            } else if (kind == 3 || kind == 4) {
+                w.write(kind == 3 ? "{\"op\": \"make_root\", \"id\": " : "{\"op\": \"remove_root\", \"id\": ");
+                w.write_int(allocated - 1);
+                w.write_char('}');
+            } else {
+                w.write("{\"op\": \"collect\"}");
+            }
+        }
+
+        w.write("\n  ]\n}\n");
+        w.flush();
+        bytes = w.bytes_written();
+    }
+    ::close(fd);
+    return bytes;
+}
+
+/**
+ * @brief Сценарий для бенчмарка исполнения
+ *
+ * Объекты подвешиваются к случайному из ранее выделенных, так что
+ * глубина дерева логарифмическая; каждая восьмая связь обрывается,
+ * каждый сотый объект ненадолго становится корнем, сборка — раз в
+ * миллион операций. id совпадают с порядковыми номерами MarkSweepGC.
+ */
+std::vector<CompactOp> make_dispatch_benchmark_ops(int num_ops) {
+    std::vector<CompactOp> ops;
+    ops.reserve(static_cast<size_t>(num_ops));
+    std::mt19937 rng(42);
+    int32_t allocated = 0;
+    size_t next_collect = 1000000;
+
+    auto push = [&ops, num_ops](ScenarioOpCode code, int32_t a, int32_t b) {
+        if (ops.size() < static_cast<size_t>(num_ops)) {
+            CompactOp op{};
+            op.code = code;
+            op.a = a;
+            op.b = b;
+            ops.push_back(op);
+        }
+    };
+
+    while (ops.size() < static_cast<size_t>(num_ops)) {
+        int32_t id = allocated++;
+        push(ScenarioOpCode::ALLOCATE, 16, id);
+        if (id == 0) {
+            push(ScenarioOpCode::MAKE_ROOT, 0, 0);
+            continue;
+        }
+        int32_t parent = static_cast<int32_t>(rng() % static_cast<uint32_t>(id));
+        push(ScenarioOpCode::ADD_REF, parent, id);
+        if (id % 8 == 0) {
+            push(ScenarioOpCode::REMOVE_REF, parent, id);
+        }
+        if (id % 100 == 0) {
+            push(ScenarioOpCode::MAKE_ROOT, id, 0);
+            push(ScenarioOpCode::REMOVE_ROOT, id, 0);
+        }
+        if (ops.size() >= next_collect) {
+            push(ScenarioOpCode::COLLECT, 0, 0);
+            next_collect += 1000000;
+        }
+    }
+    push(ScenarioOpCode::COLLECT, 0, 0);
+    return ops;
+}
+
+/**
+ * @brief Поток операций для матрицы коллекторов
+ *
+ *   linear   — CHAIN из num_objects объектов, начало цепи — корень
+ *   cyclic   — корень и кольца по 3 объекта, первый объект кольца
+ *              подвешен к корню (у RC кольца остаются в heap'е)
+ *   tree     — ALLOCATE_RANGE и связи 4-арного дерева поштучно
+ *   workload — профиль "production" на num_objects выделений,
+ *              явная сборка каждые num_objects / 4
+ *
+ * Каждый поток заканчивается снятием всех корней и сборкой: всё, что
+ * осталось в heap'е после этого, — утечка. id совпадают с порядковыми
+ * номерами, которые выдают все коллекторы GCInterface.
+ *
+ * @return Пустой вектор для неизвестного сценария
+ */
+std::vector<CompactOp> make_matrix_ops(const std::string& scenario, int num_objects) {
+    std::vector<CompactOp> ops;
+    std::vector<int32_t> roots;
+    CompactOp records[SCENARIO_MAX_OP_RECORDS];
+    int32_t n = std::max(num_objects, 1);
+
+    auto push = [&ops](ScenarioOpCode code, int32_t a, int32_t b) {
+        CompactOp op{};
+        op.code = code;
+        op.a = a;
+        op.b = b;
+        ops.push_back(op);
+    };
+    auto push_macro = [&](ScenarioOpCode code, int32_t first_id, int32_t count) {
+        ScenarioMacro macro;
+        macro.code = code;
+        macro.first_id = first_id;
+        macro.count = count;
+        macro.size = 64;
+        size_t length = encode_scenario_macro(macro, records);
+        ops.insert(ops.end(), records, records + length);
+    };
+
+    if (scenario == "linear") {
+        push_macro(ScenarioOpCode::CHAIN, 0, n);
+        push(ScenarioOpCode::MAKE_ROOT, 0, 0);
+        roots.push_back(0);
+    } else if (scenario == "cyclic") {
+        push(ScenarioOpCode::ALLOCATE, 64, 0);
+        push(ScenarioOpCode::MAKE_ROOT, 0, 0);
+        roots.push_back(0);
+        for (int32_t first = 1; first < n; first += 3) {
+            push_macro(ScenarioOpCode::RING, first, std::min(3, n - first));
+            push(ScenarioOpCode::ADD_REF, 0, first);
+        }
+    } else if (scenario == "tree") {
+        push_macro(ScenarioOpCode::ALLOCATE_RANGE, 0, n);
+        push(ScenarioOpCode::MAKE_ROOT, 0, 0);
+        roots.push_back(0);
+        for (int32_t k = 1; k < n; ++k) {
+            push(ScenarioOpCode::ADD_REF, (k - 1) / 4, k);
+        }
+    } else if (scenario == "workload") {
+        WorkloadConfig config;
+        workload_preset("production", config);
+        config.collect_every = static_cast<uint64_t>(std::max(n / 4, 1));
+        WorkloadRecordingHeap heap;
+        WorkloadGenerator generator(config);
+        generator.run(heap, static_cast<uint64_t>(n), [&](size_t, const CompactOp& op, int64_t) {
+            ops.push_back(op);
+            if (op.code == ScenarioOpCode::MAKE_ROOT) {
+                roots.push_back(op.a);
+            }
+        });
+    } else {
+        return ops;
+    }
+
+    for (int32_t root : roots) {
+        push(ScenarioOpCode::REMOVE_ROOT, root, 0);
+    }
+    push(ScenarioOpCode::COLLECT, 0, 0);
+    return ops;
+}
+
+} // namespace
+
+PerfTestResult PerformanceTest::test_scenario_parse(int num_ops, int compare_limit) {
+    PerfTestResult result;
+    result.test_name = "Streaming Scenario Parse";
+    result.scenario_type = "scenario_parse";
+    result.total_objects = 0;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.memory_freed_bytes = 0;
+
+    // === ЭТАП 1: ГЕНЕРАЦИЯ ФАЙЛА (не измеряется) ===
+    std::string path = output_dir + "/parse_bench_" + std::to_string(num_ops) + ".json";
+    size_t file_bytes = write_parse_benchmark_scenario(path, num_ops);
+    if (file_bytes == 0) {
+        std::cerr << "Error: cannot write " << path << "\n";
+        return result;
+    }
+    double file_mb = file_bytes / (1024.0 * 1024.0);
+
+    auto mb_per_s = [file_mb](double ms) {
+        return ms > 0.0 ? file_mb / (ms / 1000.0) : 0.0;
+    };
+
+    // === ЭТАП 2: ПОТОКОВЫЙ ПАРСЕР ===
+    CompactScenario scenario;
+    ScenarioParser parser;
+    auto start_time = std::chrono::high_resolution_clock::now();
+    bool ok = parser.parse_file(path, scenario);
+    auto end_time = std::chrono::high_resolution_clock::now();
+    double exec_time = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+    if (!ok) {
+        std::cerr << "Error: " << parser.get_error() << "\n";
+    }
+
+    result.execution_time_ms = exec_time;
+    result.total_operations = static_cast<int>(scenario.ops.size());
+    result.memory_used_bytes = file_bytes;
+    result.throughput_mb_per_s = mb_per_s(exec_time);
+
+    std::cout << "         streaming:  " << std::fixed << std::setprecision(2)
+              << exec_time << " ms | " << file_mb << " MB | "
+              << result.throughput_mb_per_s << " MB/s | "
+              << scenario.ops.size() << " ops ("
+              << (scenario.ops.size() * sizeof(CompactOp) / (1024.0 * 1024.0))
+              << " MB op array, " << (ScenarioParser::DEFAULT_BUFFER_SIZE / 1024)
+              << " KB read buffer)\n";
+
+    // === ЭТАП 3: ПРЕЖНИЕ ПАРСЕРЫ (для сравнения) ===
+    if (num_ops <= compare_limit) {
+        PerfTestResult legacy = result;
+        legacy.test_name = "Legacy Scenario Parse (find/sscanf)";
+        legacy.scenario_type = "scenario_parse_legacy";
+
+        start_time = std::chrono::high_resolution_clock::now();
+        std::vector<LegacyScenarioOp> legacy_ops = legacy_parse_find_sscanf(path);
+        end_time = std::chrono::high_resolution_clock::now();
+        legacy.execution_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+        legacy.total_operations = static_cast<int>(legacy_ops.size());
+        legacy.throughput_mb_per_s = mb_per_s(legacy.execution_time_ms);
+
+        // Сверка: те же операции в том же порядке
+        size_t mismatches = legacy_ops.size() == scenario.ops.size() ? 0 : 1;
+        for (size_t i = 0; mismatches == 0 && i < legacy_ops.size(); ++i) {
+            const CompactOp& op = scenario.ops[i];
+            int expected_a = op.code == ScenarioOpCode::COLLECT ? 0 : op.a;
+            int expected_b = (op.code == ScenarioOpCode::ADD_REF ||
+                              op.code == ScenarioOpCode::REMOVE_REF) ? op.b : 0;
+            if (legacy_ops[i].type != scenario_op_name(op.code) ||
+                legacy_ops[i].param1 != expected_a || legacy_ops[i].param2 != expected_b) {
+                mismatches++;
+            }
+        }
+
+        std::cout << "         find/sscanf: " << std::fixed << std::setprecision(2)
+                  << legacy.execution_time_ms << " ms | "
+                  << legacy.throughput_mb_per_s << " MB/s | whole file in one string | "
+                  << (mismatches == 0 ? "same ops" : "MISMATCH") << "\n";
+        results.push_back(legacy);
+        legacy_ops.clear();
+        legacy_ops.shrink_to_fit();
+
+        PerfTestResult dom = result;
+        dom.test_name = "Legacy Scenario Parse (nlohmann DOM)";
+        dom.scenario_type = "scenario_parse_dom";
+
+        start_time = std::chrono::high_resolution_clock::now();
+        std::vector<CompactOp> dom_ops = legacy_parse_dom(path);
+        end_time = std::chrono::high_resolution_clock::now();
+        dom.execution_time_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+        dom.total_operations = static_cast<int>(dom_ops.size());
+        dom.throughput_mb_per_s = mb_per_s(dom.execution_time_ms);
+
+        std::cout << "         DOM:        " << std::fixed << std::setprecision(2)
+                  << dom.execution_time_ms << " ms | "
+                  << dom.throughput_mb_per_s << " MB/s | full document tree\n";
+        results.push_back(dom);
+    }
+
+    std::remove(path.c_str());
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_binary_scenario_load(int num_ops) {
+    PerfTestResult result;
+    result.test_name = "Binary Scenario Load";
+    result.scenario_type = "scenario_binary";
+    result.total_objects = 0;
+    result.timestamp = get_timestamp();
+    result.collection_runs = 0;
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.memory_freed_bytes = 0;
+
+    // === ЭТАП 1: ГЕНЕРАЦИЯ JSON (не измеряется) ===
+    std::string json_path = output_dir + "/scenario_bench_" + std::to_string(num_ops) + ".json";
+    std::string binary_path = output_dir + "/scenario_bench_" + std::to_string(num_ops) + ".gcs";
+    size_t json_bytes = write_parse_benchmark_scenario(json_path, num_ops);
+    if (json_bytes == 0) {
+        std::cerr << "Error: cannot write " << json_path << "\n";
+        return result;
+    }
+
+    // Проход по операциям — чтобы сравнение включало касание данных
+    auto checksum = [](const ScenarioFile& scenario) {
+        uint64_t sum = 0;
+        for (const CompactOp& op : scenario) {
+            sum += static_cast<uint64_t>(op.code) + static_cast<uint32_t>(op.a) + static_cast<uint32_t>(op.b);
+        }
+        return sum;
+    };
+    auto ms_since = [](std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    // === ЭТАП 2: ЗАПУСК С JSON ===
+    uint64_t json_sum = 0;
+    double json_open_ms = 0.0;
+    double json_pass_ms = 0.0;
+    {
+        ScenarioFile scenario;
+        auto start = std::chrono::high_resolution_clock::now();
+        if (!scenario.open(json_path)) {
+            std::cerr << "Error: " << scenario.get_error() << "\n";
+        }
+        json_open_ms = ms_since(start);
+        start = std::chrono::high_resolution_clock::now();
+        json_sum = checksum(scenario);
+        json_pass_ms = ms_since(start);
+    }
+
+    // === ЭТАП 3: КОНВЕРТАЦИЯ ===
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string error;
+    if (!convert_json_scenario(json_path, binary_path, &error)) {
+        std::cerr << "Error: " << error << "\n";
+    }
+    double convert_ms = ms_since(start);
+    std::remove(json_path.c_str());
+
+    // === ЭТАП 4: ЗАПУСК С БИНАРНОГО (mmap) ===
+    ScenarioFile scenario;
+    start = std::chrono::high_resolution_clock::now();
+    if (!scenario.open(binary_path)) {
+        std::cerr << "Error: " << scenario.get_error() << "\n";
+    }
+    double binary_open_ms = ms_since(start);
+    start = std::chrono::high_resolution_clock::now();
+    uint64_t binary_sum = checksum(scenario);
+    double binary_pass_ms = ms_since(start);
+    size_t binary_bytes = scenario.size() * sizeof(CompactOp) + sizeof(BinaryScenarioHeader);
+
+    result.execution_time_ms = binary_open_ms;
+    result.total_operations = static_cast<int>(scenario.size());
+    result.memory_used_bytes = binary_bytes;
+
+    std::cout << "         JSON:    open " << std::fixed << std::setprecision(3) << json_open_ms
+              << " ms + pass " << json_pass_ms << " ms | "
+              << std::setprecision(2) << (json_bytes / (1024.0 * 1024.0)) << " MB\n";
+    std::cout << "         convert: " << std::setprecision(3) << convert_ms << " ms (one-time)\n";
+    std::cout << "         binary:  open " << binary_open_ms
+              << " ms + pass " << binary_pass_ms << " ms | "
+              << std::setprecision(2) << (binary_bytes / (1024.0 * 1024.0)) << " MB | "
+              << (json_sum == binary_sum ? "same ops" : "MISMATCH") << " | startup "
+              << std::setprecision(0) << (binary_open_ms > 0.0 ? json_open_ms / binary_open_ms : 0.0)
+              << "x faster\n";
+
+    std::remove(binary_path.c_str());
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_scenario_dispatch(int num_ops, const std::string& backend) {
+    PerfTestResult result;
+    result.test_name = backend_test_name("Scenario Dispatch", backend);
+    result.scenario_type = "scenario_dispatch";
+    result.timestamp = get_timestamp();
+    result.objects_leaked = 0;
+    result.memory_freed_bytes = 0;
+
+    // === ЭТАП 1: ПОДГОТОВКА (не измеряется) ===
+    std::vector<CompactOp> ops = make_dispatch_benchmark_ops(num_ops);
+    std::vector<LegacyScenarioOp> legacy_ops(ops.size());
+    for (size_t i = 0; i < ops.size(); ++i) {
+        legacy_ops[i].type = scenario_op_name(ops[i].code);
+        legacy_ops[i].param1 = ops[i].a;
+        legacy_ops[i].param2 = ops[i].b;
+    }
+    const size_t heap_size = 1ull << 36;
+    if (!make_gc_backend(backend, heap_size)) {
+        std::cerr << "Error: unknown backend '" << backend << "'\n";
+        return result;
+    }
+
+    auto ms_since = [](std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    // === ЭТАП 2: ПРЕЖНИЙ ЦИКЛ ДРАЙВЕРА ===
+    double legacy_ms = 0.0;
+    int legacy_alive = 0;
+    size_t legacy_memory = 0;
+    {
+        std::unique_ptr<GCInterface> gc = make_gc_backend(backend, heap_size);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        for (size_t step = 0; step < legacy_ops.size(); step++) {
+            const LegacyScenarioOp& op = legacy_ops[step];
+            gc->set_current_step(static_cast<int>(step));
+
+            if (op.type == "allocate") {
+                if (op.param1 > 0) {
+                    gc->allocate(op.param1);
+                }
+            } else if (op.type == "make_root") {
+                if (auto* m = dynamic_cast<MarkSweepGC*>(gc.get())) {
+                    m->make_root(op.param1);
+                } else if (auto* c = dynamic_cast<CascadeDeletionGC*>(gc.get())) {
+                    c->make_root(op.param1);
+                } else {
+                    gc->make_root(op.param1);
+                }
+            } else if (op.type == "add_ref") {
+                gc->add_reference(op.param1, op.param2);
+            } else if (op.type == "remove_ref") {
+                gc->remove_reference(op.param1, op.param2);
+            } else if (op.type == "remove_root") {
+                if (auto* m = dynamic_cast<MarkSweepGC*>(gc.get())) {
+                    m->remove_root(op.param1);
+                } else if (auto* c = dynamic_cast<CascadeDeletionGC*>(gc.get())) {
+                    c->remove_root(op.param1);
+                } else {
+                    gc->remove_root(op.param1);
+                }
+            } else if (op.type == "collect") {
+                gc->collect();
+            }
+        }
+        legacy_ms = ms_since(start);
+        legacy_alive = gc->get_alive_objects_count();
+        legacy_memory = gc->get_total_memory();
+    }
+    legacy_ops.clear();
+    legacy_ops.shrink_to_fit();
+
+    // === ЭТАП 3: СКОМПИЛИРОВАННЫЙ ЦИКЛ ===
+    double compiled_ms = 0.0;
+    ScenarioExecutionStats stats;
+    int compiled_alive = 0;
+    size_t compiled_memory = 0;
+    {
+        std::unique_ptr<GCInterface> gc = make_gc_backend(backend, heap_size);
+
+        auto start = std::chrono::high_resolution_clock::now();
+        stats = execute_scenario(*gc, ops.data(), ops.size());
+        compiled_ms = ms_since(start);
+        compiled_alive = gc->get_alive_objects_count();
+        compiled_memory = gc->get_total_memory();
+    }
+
+    double legacy_rate = legacy_ms > 0.0 ? ops.size() / (legacy_ms / 1000.0) : 0.0;
+    double compiled_rate = compiled_ms > 0.0 ? ops.size() / (compiled_ms / 1000.0) : 0.0;
+    bool same = legacy_alive == compiled_alive && legacy_memory == compiled_memory;
+
+    result.total_operations = static_cast<int>(ops.size());
+    result.total_objects = compiled_alive;
+    result.execution_time_ms = compiled_ms;
+    result.collection_runs = static_cast<int>(stats.collections);
+    result.objects_collected = 0;
+    result.memory_used_bytes = stats.peak_memory;
+    result.memory_freed_bytes = stats.freed_bytes;
+    result.ops_per_second = compiled_rate;
+
+    PerfTestResult legacy = result;
+    legacy.test_name = backend_test_name("Legacy Scenario Dispatch (strings + dynamic_cast)", backend);
+    legacy.scenario_type = "scenario_dispatch_legacy";
+    legacy.total_objects = legacy_alive;
+    legacy.execution_time_ms = legacy_ms;
+    legacy.ops_per_second = legacy_rate;
+
+    std::cout << "         legacy:   " << std::fixed << std::setprecision(1) << legacy_ms
+              << " ms | " << std::setprecision(0) << legacy_rate << " ops/s\n";
+    std::cout << "         compiled: " << std::setprecision(1) << compiled_ms
+              << " ms | " << std::setprecision(0) << compiled_rate << " ops/s | "
+              << std::setprecision(2) << (compiled_ms > 0.0 ? legacy_ms / compiled_ms : 0.0)
+              << "x | " << (same ? "same heap" : "MISMATCH") << "\n";
+
+    results.push_back(legacy);
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_bulk_construction(int num_objects) {
+    PerfTestResult result;
+    result.test_name = "Bulk Graph Construction";
+    result.scenario_type = "bulk_construction";
+    result.timestamp = get_timestamp();
+    result.objects_leaked = 0;
+    result.memory_freed_bytes = 0;
+    result.collection_runs = 0;
+    result.objects_collected = 0;
+
+    const size_t heap_size = 1024 * 1024 * 1024;
+    const int fanout = 4;
+    std::string log_prefix = output_dir + "/bulk_construction_" + std::to_string(num_objects);
+
+    auto ms_since = [](std::chrono::high_resolution_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(
+            std::chrono::high_resolution_clock::now() - start).count();
+    };
+
+    // === ЭТАП 1: ПОШТУЧНЫЕ ВЫЗОВЫ ===
+    double single_ms = 0.0;
+    int single_alive = 0;
+    size_t single_memory = 0;
+    {
+        MarkSweepGC gc(heap_size, heap_size, log_prefix + "_single.log");
+        auto start = std::chrono::high_resolution_clock::now();
+        int root_id = gc.allocate(64);
+        gc.make_root(root_id);
+        for (int i = 1; i < num_objects; ++i) {
+            int obj_id = gc.allocate(64);
+            gc.add_reference(root_id + (i - 1) / fanout, obj_id);
+        }
+        single_ms = ms_since(start);
+        single_alive = gc.get_alive_objects_count();
+        single_memory = gc.get_total_memory();
+    }
+
+    // === ЭТАП 2: ПАКЕТНЫЕ ВЫЗОВЫ ===
+    double bulk_ms = 0.0;
+    int bulk_alive = 0;
+    size_t bulk_memory = 0;
+    {
+        MarkSweepGC gc(heap_size, heap_size, log_prefix + "_bulk.log");
+        auto start = std::chrono::high_resolution_clock::now();
+        build_rooted_tree(gc, num_objects, fanout, 64);
+        bulk_ms = ms_since(start);
+        bulk_alive = gc.get_alive_objects_count();
+        bulk_memory = gc.get_total_memory();
+    }
+
+    // N выделений, make_root и N-1 ссылок
+    int op_count = num_objects > 0 ? 2 * num_objects : 0;
+    double single_rate = single_ms > 0.0 ? op_count / (single_ms / 1000.0) : 0.0;
+    double bulk_rate = bulk_ms > 0.0 ? op_count / (bulk_ms / 1000.0) : 0.0;
+    bool same = single_alive == bulk_alive && single_memory == bulk_memory;
+
+    result.total_objects = bulk_alive;
+    result.total_operations = op_count;
+    result.execution_time_ms = bulk_ms;
+    result.memory_used_bytes = bulk_memory;
+    result.ops_per_second = bulk_rate;
+
+    PerfTestResult single = result;
+    single.test_name = "Per-Call Graph Construction";
+    single.scenario_type = "bulk_construction_single";
+    single.total_objects = single_alive;
+    single.execution_time_ms = single_ms;
+    single.memory_used_bytes = single_memory;
+    single.ops_per_second = single_rate;
+
+    std::cout << "         per-call: " << std::fixed << std::setprecision(1) << single_ms
+              << " ms | " << std::setprecision(0) << single_rate << " ops/s\n";
+    std::cout << "         bulk:     " << std::setprecision(1) << bulk_ms
+              << " ms | " << std::setprecision(0) << bulk_rate << " ops/s | "
+              << std::setprecision(2) << (bulk_ms > 0.0 ? single_ms / bulk_ms : 0.0)
+              << "x | " << (same ? "same heap" : "MISMATCH") << "\n";
+
+    results.push_back(single);
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_workload(const std::string& preset, int num_allocations,
+                                              int collect_every) {
+    PerfTestResult result;
+    result.test_name = "Workload: " + preset;
+    result.scenario_type = "workload_" + preset;
+    result.timestamp = get_timestamp();
+    result.objects_leaked = 0;
+
+    WorkloadConfig config;
+    std::string error;
+    if (!workload_preset(preset, config) || !validate_workload_config(config, error)) {
+        std::cerr << "Error: unknown or invalid workload preset '" << preset << "' " << error << "\n";
+        return result;
+    }
+    config.collect_every = static_cast<uint64_t>(std::max(collect_every, 0));
+
+    MarkSweepGC gc(1ull << 36, 1ull << 36);
+    gc.set_logging_enabled(false);
+    WorkloadGenerator generator(config);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    WorkloadStats stats = generator.run(gc, static_cast<uint64_t>(std::max(num_allocations, 0)));
+    auto end = std::chrono::high_resolution_clock::now();
+    double total_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    int created = static_cast<int>(stats.allocations);
+    result.total_objects = created;
+    result.total_operations = static_cast<int>(stats.operations);
+    result.execution_time_ms = total_ms;
+    result.objects_collected = created - gc.get_alive_objects_count();
+    result.memory_used_bytes = stats.peak_memory;
+    result.memory_freed_bytes = stats.freed_bytes;
+    result.collection_runs = static_cast<int>(stats.collections);
+    result.ops_per_second = total_ms > 0.0 ? stats.operations / (total_ms / 1000.0) : 0.0;
+
+    double per_collect = stats.collections > 0 ? stats.collect_ms / stats.collections : 0.0;
+    std::cout << "         " << std::fixed << std::setprecision(1) << total_ms << " ms | "
+              << stats.operations << " ops | " << stats.edges_added << " edges | "
+              << stats.deaths << " deaths | live " << stats.live_objects << "\n";
+    std::cout << "         collect: " << stats.collections << " x "
+              << std::setprecision(2) << per_collect << " ms ("
+              << std::setprecision(1) << (total_ms > 0.0 ? 100.0 * stats.collect_ms / total_ms : 0.0)
+              << "% of run) | peak " << std::setprecision(2)
+              << stats.peak_memory / (1024.0 * 1024.0) << " MB\n";
+
+    results.push_back(result);
+    return result;
+}
+
+PerfTestResult PerformanceTest::test_churn(const std::string& backend, int live_objects,
+                                           int num_allocations, size_t heap_bytes) {
+    PerfTestResult result;
+    result.test_name = "Churn: " + backend;
+    result.scenario_type = "churn_" + backend;
+    result.timestamp = get_timestamp();
+    result.objects_leaked = 0;
+
+    WorkloadConfig config;
+    workload_preset("churn", config);
+    config.steady_state_live = static_cast<size_t>(std::max(live_objects, 0));
+    size_t threshold = heap_bytes / 10 * 8;
+    uint64_t allocations = static_cast<uint64_t>(std::max(num_allocations, 0));
+
+    std::unique_ptr<GCInterface> gc = make_gc_backend(backend, heap_bytes, threshold);
+    if (!gc) {
+        std::cerr << "Error: unknown backend '" << backend << "'\n";
+        return result;
+    }
+    ChurnRun run = run_churn(*gc, config, allocations);
+    GCCollectionStats collections = gc->get_collection_stats();
+    int end_alive = gc->get_alive_objects_count();
+    size_t end_memory = gc->get_total_memory();
+
+    std::vector<double> sorted;
+    for (const PauseInterval& pause : run.pauses) {
+        sorted.push_back(pause.end_ms - pause.start_ms);
+    }
+    std::sort(sorted.begin(), sorted.end());
+    MMUCalculator mmu(run.pauses, run.total_ms);
+    json mmu_curve = json::array();
+    for (const MMUPoint& point : mmu.curve(MMUCalculator::default_windows())) {
+        mmu_curve.push_back({{"window_ms", point.window_ms},
+                             {"utilization", std::round(point.utilization * 10000) / 10000.0}});
+    }
+    double pause_total_ms = collections.total_pause_ns / 1e6;
+    double overhead = run.total_ms > 0.0 ? 100.0 * pause_total_ms / run.total_ms : 0.0;
+
+    int created = static_cast<int>(run.stats.allocations);
+    result.total_objects = created;
+    result.total_operations = static_cast<int>(run.stats.operations);
+    result.execution_time_ms = run.total_ms;
+    result.objects_collected = created - end_alive;
+    result.memory_used_bytes = run.peak_heap;
+    result.memory_freed_bytes = run.stats.allocated_bytes > end_memory
+        ? run.stats.allocated_bytes - end_memory : 0;
+    result.collection_runs = static_cast<int>(collections.collections);
+    result.ops_per_second = run.total_ms > 0.0 ? run.stats.operations / (run.total_ms / 1000.0) : 0.0;
+
+    auto round2 = [](double value) { return std::round(value * 100) / 100.0; };
+    result.details = {
+        {"backend", backend},
+        {"live_target", live_objects},
+        {"heap_bytes", heap_bytes},
+        {"threshold_bytes", threshold},
+        {"gc_overhead_percent", round2(overhead)},
+        {"triggered_collections", collections.triggered_collections},
+        {"failed_allocations", run.stats.failed_allocations},
+        {"peak_heap_bytes", run.peak_heap},
+        {"pause_ms", {
+            {"count", sorted.size()},
+            {"total", round2(pause_total_ms)},
+            {"p50", round2(percentile(sorted, 50))},
+            {"p90", round2(percentile(sorted, 90))},
+            {"p99", round2(percentile(sorted, 99))},
+            {"max", round2(sorted.empty() ? 0.0 : sorted.back())}
+        }},
+        {"mmu", mmu_curve},
+        {"heap_timeline", run.timeline}
+    };
+    mmu_results[backend] = {
+        {"test_name", result.test_name},
+        {"total_ms", round2(run.total_ms)},
+        {"collector_ms", round2(mmu.get_pause_ms())},
+        {"overall_utilization", std::round(mmu.overall_utilization() * 10000) / 10000.0},
+        {"pauses", sorted.size()},
+        {"curve", mmu_curve}
+    };
+
+    std::cout << "         " << std::fixed << std::setprecision(1) << run.total_ms << " ms | "
+              << std::setprecision(0) << result.ops_per_second << " ops/s | GC "
+              << std::setprecision(1) << overhead << "% | "
+              << collections.triggered_collections << " triggered collections\n";
+    std::cout << "         pauses p50/p90/p99/max: " << std::setprecision(2)
+              << percentile(sorted, 50) << " / " << percentile(sorted, 90) << " / "
+              << percentile(sorted, 99) << " / " << (sorted.empty() ? 0.0 : sorted.back())
+              << " ms | peak heap " << run.peak_heap / (1024.0 * 1024.0) << " MB\n";
+    std::cout << "         MMU:";
+    for (const MMUPoint& point : mmu.curve({10, 100, 1000})) {
+        std::cout << " " << std::setprecision(0) << point.window_ms << " ms = "
+                  << std::setprecision(2) << point.utilization;
+    }
+    std::cout << "\n";
+
+    results.push_back(result);
+    return result;
+}
+
+void PerformanceTest::run_churn_benchmarks(int live_objects, int num_allocations, size_t heap_bytes) {
+    const std::vector<std::string> backends = gc_backend_names();
+
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "STEADY-STATE CHURN BENCHMARK\n";
+    std::cout << live_objects << " live objects, " << num_allocations << " allocations, "
+              << heap_bytes / (1024 * 1024) << " MB heap, collections at 80%\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    for (size_t i = 0; i < backends.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << backends.size() << "] "
+                  << backends[i] << "...\n";
+        test_churn(backends[i], live_objects, num_allocations, heap_bytes);
+    }
+
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::test_rc_teardown(int num_objects, size_t budget) {
+    PerfTestResult result;
+    result.test_name = budget == 0 ? "RC Teardown: synchronous"
+                                   : "RC Teardown: deferred, budget " + std::to_string(budget);
+    result.scenario_type = "rc_teardown";
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+
+    const size_t object_size = 64;
+    // Без отложенной работы мутатор всё равно делает столько операций,
+    // чтобы хвост распределения задержек был сравним
+    const int min_mutator_ops = 1000;
+    RCHeap heap(static_cast<size_t>(num_objects) * object_size * 2 + min_mutator_ops * object_size);
+    heap.set_logging_enabled(false);
+    heap.set_deferred_freeing(budget > 0, budget);
+
+    // 4-арное дерево с корнем в первом объекте; построение не замеряется
+    ObjectIdRange range = heap.allocate_many(static_cast<size_t>(num_objects), object_size);
+    std::vector<ReferencePair> edges;
+    edges.reserve(range.count > 0 ? range.count - 1 : 0);
+    for (int k = 1; k < range.count; ++k) {
+        edges.push_back(ReferencePair{range.first + (k - 1) / 4, range.first + k});
+    }
+    heap.add_references(edges.data(), edges.size());
+    heap.make_root(range.first);
+    std::vector<ReferencePair>().swap(edges);
+
+    // Операция 0 — сброс корня, дальше выделения мутатора; каждая
+    // замеряется отдельно, пока отложенная работа не закончится
+    std::vector<double> latencies_us;
+    auto teardown_start = std::chrono::steady_clock::now();
+    auto op_start = teardown_start;
+    heap.remove_root(range.first);
+    auto op_end = std::chrono::steady_clock::now();
+    latencies_us.push_back(std::chrono::duration<double, std::micro>(op_end - op_start).count());
+
+    int ops = 1;
+    while (heap.has_pending_work() || ops < min_mutator_ops) {
+        op_start = std::chrono::steady_clock::now();
+        int id = heap.allocate(object_size);
+        op_end = std::chrono::steady_clock::now();
+        latencies_us.push_back(std::chrono::duration<double, std::micro>(op_end - op_start).count());
+        ops++;
+        if (id < 0) {
+            break;
+        }
+    }
+    double teardown_ms = std::chrono::duration<double, std::milli>(op_end - teardown_start).count();
+    int mutator_objects = ops - 1;
+    int tree_left = heap.get_alive_objects_count() - mutator_objects;
+
+    std::vector<double> sorted = latencies_us;
+    std::sort(sorted.begin(), sorted.end());
+    double mean_us = 0.0;
+    for (double latency : sorted) {
+        mean_us += latency;
+    }
+    mean_us /= sorted.size();
+
+    result.total_operations = ops;
+    result.execution_time_ms = teardown_ms;
+    result.objects_collected = range.count - std::max(tree_left, 0);
+    result.objects_leaked = std::max(tree_left, 0);
+    result.memory_freed_bytes = static_cast<size_t>(result.objects_collected) * object_size;
+    result.ops_per_second = teardown_ms > 0.0 ? ops / (teardown_ms / 1000.0) : 0.0;
+
+    auto round2 = [](double value) { return std::round(value * 100) / 100.0; };
+    result.details = {
+        {"budget_per_allocation", budget},
+        {"mutator_ops", ops},
+        {"remove_root_us", round2(latencies_us.front())},
+        {"op_latency_us", {
+            {"mean", round2(mean_us)},
+            {"p50", round2(percentile(sorted, 50))},
+            {"p99", round2(percentile(sorted, 99))},
+            {"p999", round2(percentile(sorted, 99.9))},
+            {"max", round2(sorted.back())}
+        }}
+    };
+
+    std::cout << "         max op " << std::fixed << std::setprecision(1) << sorted.back()
+              << " us (remove_root " << latencies_us.front() << " us) | p99 "
+              << std::setprecision(2) << percentile(sorted, 99) << " us | "
+              << ops << " ops, all freed after " << std::setprecision(1) << teardown_ms << " ms\n";
+
+    results.push_back(result);
+    return result;
+}
+
+void PerformanceTest::run_rc_teardown_benchmarks(int num_objects, const std::vector<size_t>& budgets) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "RC TEARDOWN LATENCY\n";
+    std::cout << "Drop the root of a " << num_objects << "-node 4-ary tree, then allocate until all is freed\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    for (size_t i = 0; i < budgets.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << budgets.size() << "] "
+                  << (budgets[i] == 0 ? std::string("synchronous")
+                                      : "deferred, " + std::to_string(budgets[i]) + " decrements per allocation")
+                  << "...\n";
+        test_rc_teardown(num_objects, budgets[i]);
+    }
+
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::test_rc_coalescing(int num_holders, int writes, size_t epoch_buffer) {
+    PerfTestResult result;
+    result.test_name = epoch_buffer == 0 ? "RC Overwrites: immediate"
+                                         : "RC Overwrites: coalesced, epoch " + std::to_string(epoch_buffer);
+    result.scenario_type = "rc_coalescing";
+    result.total_objects = num_holders;
+    result.timestamp = get_timestamp();
+
+    const int num_targets = 64;
+    const int writes_per_collection = 100000;
+    const size_t object_size = 64;
+    RCHeap heap(static_cast<size_t>(num_holders + num_targets + 1) * object_size);
+    heap.set_logging_enabled(false);
+
+    // Цели держит корневой пул, поэтому перенаправление ссылок их не
+    // освобождает; каждый держатель сначала ссылается на цель h % 64
+    int pool = heap.allocate(object_size);
+    ObjectIdRange targets = heap.allocate_many(num_targets, object_size);
+    ObjectIdRange holders = heap.allocate_many(static_cast<size_t>(num_holders), object_size);
+    heap.make_root(pool);
+    std::vector<ReferencePair> edges;
+    for (int t = 0; t < targets.count; ++t) {
+        edges.push_back(ReferencePair{pool, targets.first + t});
+    }
+    for (int h = 0; h < holders.count; ++h) {
+        heap.make_root(holders.first + h);
+        edges.push_back(ReferencePair{holders.first + h, targets.first + h % num_targets});
+    }
+    heap.add_references(edges.data(), edges.size());
+    heap.set_coalescing(epoch_buffer > 0, epoch_buffer);
+
+    std::vector<int> current(static_cast<size_t>(holders.count));
+    for (int h = 0; h < holders.count; ++h) {
+        current[h] = h % num_targets;
+    }
+    size_t updates_before = heap.get_count_updates();
+    size_t epochs_before = heap.get_collection_stats().collections;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int w = 0; w < writes && holders.count > 0; ++w) {
+        int h = w % holders.count;
+        int next = (current[h] + 1 + w / holders.count) % num_targets;
+        if (next == current[h]) {
+            next = (next + 1) % num_targets;
+        }
+        heap.remove_reference(holders.first + h, targets.first + current[h]);
+        heap.add_reference(holders.first + h, targets.first + next);
+        current[h] = next;
+        if ((w + 1) % writes_per_collection == 0) {
+            heap.collect();
+        }
+    }
+    heap.collect();
+    auto end = std::chrono::steady_clock::now();
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    size_t updates = heap.get_count_updates() - updates_before;
+    size_t epochs = heap.get_collection_stats().collections - epochs_before;
+
+    // Счётчики целей после последней эпохи: ссылка пула плюс держатели
+    std::vector<int> expected(num_targets, 1);
+    for (int h = 0; h < holders.count; ++h) {
+        expected[current[h]]++;
+    }
+    bool consistent = true;
+    for (int t = 0; t < targets.count; ++t) {
+        consistent = consistent && heap.get_ref_count(targets.first + t) == expected[t];
+    }
+
+    result.total_operations = writes;
+    result.execution_time_ms = elapsed_ms;
+    result.objects_collected = 0;
+    result.objects_leaked = 0;
+    result.ops_per_second = elapsed_ms > 0.0 ? writes / (elapsed_ms / 1000.0) : 0.0;
+    double per_write = writes > 0 ? static_cast<double>(updates) / writes : 0.0;
+    result.details = {
+        {"epoch_buffer", epoch_buffer},
+        {"reference_writes", writes},
+        {"count_updates", updates},
+        {"count_updates_per_write", std::round(per_write * 1000) / 1000.0},
+        {"collections", epochs},
+        {"counts_consistent", consistent}
+    };
+
+    std::cout << "         " << updates << " ref_count updates (" << std::fixed << std::setprecision(3)
+              << per_write << " per write), " << epochs << " collections, "
+              << std::setprecision(1) << elapsed_ms << " ms"
+              << (consistent ? "" : " | COUNTS MISMATCH") << "\n";
+
+    results.push_back(result);
+    return result;
+}
+
+void PerformanceTest::run_rc_coalescing_benchmarks(int num_holders, int writes,
+                                                   const std::vector<size_t>& epoch_buffers) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "RC COALESCED UPDATES\n";
+    std::cout << "Retarget one reference of " << num_holders << " holders " << writes
+              << " times, collect every 100000 writes\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    for (size_t i = 0; i < epoch_buffers.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << epoch_buffers.size() << "] "
+                  << (epoch_buffers[i] == 0 ? std::string("immediate")
+                                            : "coalesced, epoch ends at " + std::to_string(epoch_buffers[i]) +
+                                                  " logged objects")
+                  << "...\n";
+        test_rc_coalescing(num_holders, writes, epoch_buffers[i]);
+    }
+
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::test_rc_hybrid(const std::string& scenario, int num_objects,
+                                               size_t trace_interval) {
+    PerfTestResult result;
+    result.test_name = "RC Hybrid: " + scenario;
+    result.scenario_type = "rc_hybrid_" + scenario;
+    result.total_objects = num_objects;
+    result.timestamp = get_timestamp();
+
+    std::vector<CompactOp> ops = make_matrix_ops(scenario, num_objects);
+    if (ops.empty()) {
+        std::cerr << "Error: unknown matrix scenario '" << scenario << "'\n";
+        return result;
+    }
+    RCHeap heap(1024ull * 1024 * 1024);
+    heap.set_logging_enabled(false);
+    heap.set_backup_tracing(true, trace_interval);
+
+    auto start = std::chrono::steady_clock::now();
+    ScenarioExecutionStats stats = execute_scenario(heap, ops.data(), ops.size(), NullScenarioObserver());
+    auto end = std::chrono::steady_clock::now();
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    size_t rc_bytes = heap.get_rc_freed_bytes();
+    size_t traced_bytes = heap.get_traced_freed_bytes();
+    size_t freed_bytes = rc_bytes + traced_bytes;
+    double rc_share = freed_bytes > 0 ? static_cast<double>(rc_bytes) / freed_bytes : 0.0;
+
+    result.total_operations = static_cast<int>(stats.executed);
+    result.execution_time_ms = elapsed_ms;
+    result.memory_used_bytes = stats.peak_memory;
+    result.memory_freed_bytes = freed_bytes;
+    result.objects_leaked = heap.get_alive_objects_count();
+    result.collection_runs = static_cast<int>(heap.get_collection_stats().collections);
+    result.ops_per_second = elapsed_ms > 0.0 ? stats.executed / (elapsed_ms / 1000.0) : 0.0;
+    result.details = {
+        {"scenario", scenario},
+        {"trace_interval_bytes", trace_interval},
+        {"allocated_bytes", stats.allocated_bytes},
+        {"rc_freed_bytes", rc_bytes},
+        {"traced_freed_bytes", traced_bytes},
+        {"rc_freed_fraction", std::round(rc_share * 10000) / 10000.0},
+        {"backup_traces", heap.get_backup_traces()},
+        {"repaired_counts", heap.get_repaired_counts()}
+    };
+
+    std::cout << "         RC " << rc_bytes << " bytes (" << std::fixed << std::setprecision(1)
+              << rc_share * 100.0 << "%), trace " << traced_bytes << " bytes ("
+              << (freed_bytes > 0 ? 100.0 - rc_share * 100.0 : 0.0) << "%), "
+              << heap.get_backup_traces() << " traces, " << result.objects_leaked << " leaked, "
+              << elapsed_ms << " ms\n";
+
+    results.push_back(result);
+    return result;
+}
+
+void PerformanceTest::run_rc_hybrid_benchmarks(const std::vector<int>& sizes, size_t trace_interval) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "RC WITH BACKUP TRACING\n";
+    std::cout << "Bytes reclaimed by the RC cascade vs the backup trace (every " << trace_interval
+              << " allocated bytes and at the final collect)\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    const std::vector<std::string> scenarios = {"cyclic", "tree", "workload"};
+    for (const std::string& scenario : scenarios) {
+        for (int size : sizes) {
+            std::cout << "   " << scenario << " (" << size << " objects)...\n";
+            test_rc_hybrid(scenario, size, trace_interval);
+        }
+    }
+
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::test_rc_fanout(int num_edges) {
+    PerfTestResult result;
+    result.test_name = "RC Fan-out";
+    result.scenario_type = "rc_fanout";
+    result.total_objects = num_edges + 1;
+    result.timestamp = get_timestamp();
+
+    const size_t object_size = 64;
+    RCHeap heap(static_cast<size_t>(num_edges + 1) * object_size);
+    heap.set_logging_enabled(false);
+    int hub = heap.allocate(object_size);
+    heap.make_root(hub);
+    ObjectIdRange targets = heap.allocate_many(static_cast<size_t>(num_edges), object_size);
+
+    auto phase = [](auto&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    };
+
+    size_t linked = 0;
+    size_t duplicates = 0;
+    double link_ms = phase([&]() {
+        for (int i = 0; i < targets.count; ++i) {
+            linked += heap.add_reference(hub, targets.first + i) ? 1 : 0;
+        }
+    });
+    double lookup_ms = phase([&]() {
+        for (int i = 0; i < targets.count; ++i) {
+            duplicates += heap.add_reference(hub, targets.first + i) ? 0 : 1;
+        }
+    });
+    double unlink_ms = phase([&]() {
+        for (int i = 0; i < targets.count; i += 2) {
+            heap.remove_reference(hub, targets.first + i);
+        }
+    });
+    double teardown_ms = phase([&]() { heap.remove_root(hub); });
+
+    int unlinked = (targets.count + 1) / 2;
+    auto per_edge_ns = [](double ms, int edges) { return edges > 0 ? ms * 1e6 / edges : 0.0; };
+
+    result.total_operations = targets.count * 2 + unlinked + 1;
+    result.execution_time_ms = link_ms + lookup_ms + unlink_ms + teardown_ms;
+    result.objects_collected = static_cast<int>(targets.count) + 1 - heap.get_alive_objects_count();
+    result.objects_leaked = heap.get_alive_objects_count();
+    result.ops_per_second = result.execution_time_ms > 0.0
+        ? result.total_operations / (result.execution_time_ms / 1000.0) : 0.0;
+    result.details = {
+        {"edges", targets.count},
+        {"linked", linked},
+        {"duplicates_rejected", duplicates},
+        {"link_ms", link_ms},
+        {"lookup_ms", lookup_ms},
+        {"unlink_ms", unlink_ms},
+        {"teardown_ms", teardown_ms},
+        {"link_ns_per_edge", per_edge_ns(link_ms, targets.count)},
+        {"lookup_ns_per_edge", per_edge_ns(lookup_ms, targets.count)},
+        {"unlink_ns_per_edge", per_edge_ns(unlink_ms, unlinked)},
+        {"teardown_ns_per_edge", per_edge_ns(teardown_ms, targets.count - unlinked)}
+    };
+
+    std::cout << "         link " << std::fixed << std::setprecision(1) << per_edge_ns(link_ms, targets.count)
+              << " ns/edge, lookup " << per_edge_ns(lookup_ms, targets.count)
+              << " ns/edge, unlink " << per_edge_ns(unlink_ms, unlinked)
+              << " ns/edge, teardown " << per_edge_ns(teardown_ms, targets.count - unlinked)
+              << " ns/edge | total " << result.execution_time_ms << " ms"
+              << (result.objects_leaked == 0 ? "" : " | LEAKED") << "\n";
+
+    results.push_back(result);
+    return result;
 }
 
-std::string PerformanceTest::get_timestamp() const {
-    auto now = std::chrono::system_clock::now();
-    auto time_t_now = std::chrono::system_clock::to_time_t(now);
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t_now), "%Y-%m-%d %H:%M:%S");
-    return ss.str();
+void PerformanceTest::run_rc_fanout_benchmarks(const std::vector<int>& edge_counts) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "RC FAN-OUT\n";
+    std::cout << "One object linked to N targets: link, duplicate link, unlink half, cascade the rest\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    for (size_t i = 0; i < edge_counts.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << edge_counts.size() << "] "
+                  << edge_counts[i] << " edges...\n";
+        test_rc_fanout(edge_counts[i]);
+    }
+
+    std::cout << "\n";
 }
 
-PerfTestResult PerformanceTest::test_simple_linear(int num_objects) {
+PerfTestResult PerformanceTest::test_concurrent_rc(bool biased, int num_threads, int ops_per_thread,
+                                                   double remote_fraction) {
     PerfTestResult result;
-    result.test_name = "Simple Linear Chain";
-    result.scenario_type = "simple_linear";
-    result.total_objects = num_objects;
+    result.test_name = std::string("Concurrent RC: ") + (biased ? "biased" : "atomic") + ", " +
+                       std::to_string(num_threads) + " threads";
+    result.scenario_type = biased ? "concurrent_rc_biased" : "concurrent_rc_atomic";
     result.timestamp = get_timestamp();
-    result.collection_runs = 0;
-    
-    // Создаём GC с логированием
-    std::string log_file = output_dir + "/simple_linear_" + 
-                          std::to_string(num_objects) + ".log";
-    MarkSweepGC gc(1024 * 1024 * 100, // 100MB heap
-                   1024 * 1024 * 80,  // 80% threshold
-                   log_file);
-    
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // === ЭТАП 1: СОЗДАНИЕ ЛИНЕЙНОЙ ЦЕПИ ===
-    // root -> obj1 -> obj2 -> ... -> objN
-    
-    int root_id = gc.allocate(64); // root объект
-    int op_count = 1;
-    
-    int prev_id = root_id;
-    gc.make_root(root_id);
-    op_count++;
-    
-    for (int i = 1; i < num_objects; ++i) {
-        int obj_id = gc.allocate(64); // каждый объект 64 байта
-        op_count++;
-        
-        gc.add_reference(prev_id, obj_id);
-        op_count++;
-        
-        prev_id = obj_id;
+
+    const int objects_per_thread = 1024;
+    const size_t object_size = 64;
+    num_threads = std::max(num_threads, 1);
+    ConcurrentRCHeap heap(static_cast<size_t>(num_threads) * objects_per_thread * object_size,
+                          biased ? ConcurrentRCMode::BIASED : ConcurrentRCMode::ATOMIC);
+    result.total_objects = num_threads * objects_per_thread;
+
+    std::vector<std::vector<int>> owned(static_cast<size_t>(num_threads));
+    std::atomic<int> allocated{0};
+    std::atomic<bool> go{false};
+    std::atomic<int> finished{0};
+    std::atomic<int> handed_off{0};
+    auto wait_for = [](const std::atomic<int>& counter, int value) {
+        while (counter.load() < value) {
+            std::this_thread::yield();
+        }
+    };
+
+    auto mutator = [&](int t) {
+        std::vector<int>& mine = owned[t];
+        for (int k = 0; k < objects_per_thread; ++k) {
+            mine.push_back(heap.allocate(object_size));
+        }
+        allocated.fetch_add(1);
+        while (!go.load()) {
+            std::this_thread::yield();
+        }
+
+        // Замеряемая фаза: свои объекты — быстрый путь владельца в BIASED
+        std::mt19937 rng(static_cast<unsigned>(1000 + t));
+        std::uniform_real_distribution<double> coin(0.0, 1.0);
+        for (int op = 0; op < ops_per_thread; ++op) {
+            int owner = t;
+            if (num_threads > 1 && coin(rng) < remote_fraction) {
+                owner = (t + 1 + static_cast<int>(rng() % (num_threads - 1))) % num_threads;
+            }
+            int id = owned[owner][rng() % objects_per_thread];
+            heap.add_root(id);
+            heap.release_root(id);
+        }
+        finished.fetch_add(1);
+
+        // Корни, выданные при выделении, снимает сосед: в BIASED общий
+        // счётчик уходит в минус, и объект ждёт слияния у владельца
+        wait_for(finished, num_threads);
+        for (int id : owned[(t + 1) % num_threads]) {
+            heap.release_root(id);
+        }
+        handed_off.fetch_add(1);
+        wait_for(handed_off, num_threads);
+        heap.process_queued();
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back(mutator, t);
     }
-    
-    // === ЭТАП 2: СБОРКА МУСОРА ===
-    size_t freed = gc.collect();
-    result.collection_runs = 1;
-    
-    // === ЭТАП 3: УДАЛЕНИЕ ROOT (демонстрация каскада) ===
-    gc.remove_root(root_id);
-    op_count++;
-    
-    // Вторая сборка
-    freed += gc.collect();
-    result.collection_runs = 2;
-    
-    auto end_time = std::chrono::high_resolution_clock::now();
-    
-    // === ПОДСЧЁТ РЕЗУЛЬТАТОВ ===
-    double exec_time = std::chrono::duration<double, std::milli>(
-        end_time - start_time).count();
-    
-    result.execution_time_ms = exec_time;
-    result.total_operations = op_count;
-    result.objects_collected = num_objects;
-    result.objects_leaked = 0;
-    result.memory_used_bytes = num_objects * 64;
-    result.memory_freed_bytes = freed;
-    
+    wait_for(allocated, num_threads);
+    auto start = std::chrono::steady_clock::now();
+    go.store(true);
+    wait_for(finished, num_threads);
+    auto end = std::chrono::steady_clock::now();
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    heap.collect();
+
+    double elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    long long pairs = static_cast<long long>(num_threads) * ops_per_thread;
+    size_t left = heap.get_alive_objects_count();
+
+    result.total_operations = static_cast<int>(std::min<long long>(pairs, std::numeric_limits<int>::max()));
+    result.execution_time_ms = elapsed_ms;
+    result.objects_collected = result.total_objects - static_cast<int>(left);
+    result.objects_leaked = static_cast<int>(left);
+    result.ops_per_second = elapsed_ms > 0.0 ? pairs / (elapsed_ms / 1000.0) : 0.0;
+    result.details = {
+        {"mode", biased ? "biased" : "atomic"},
+        {"threads", num_threads},
+        {"ops_per_thread", ops_per_thread},
+        {"remote_fraction", remote_fraction},
+        {"ns_per_pair", pairs > 0 ? std::round(elapsed_ms * 1e6 / pairs * 100) / 100.0 : 0.0},
+        {"hardware_threads", std::thread::hardware_concurrency()}
+    };
+
+    std::cout << "         " << std::fixed << std::setprecision(1) << elapsed_ms << " ms, "
+              << std::setprecision(2) << (pairs > 0 ? elapsed_ms * 1e6 / pairs : 0.0) << " ns per pair, "
+              << std::setprecision(0) << result.ops_per_second << " pairs/s"
+              << (left == 0 ? "" : " | " + std::to_string(left) + " objects left") << "\n";
+
     results.push_back(result);
     return result;
 }
 
-PerfTestResult PerformanceTest::test_cyclic_graph(int num_objects, int cycle_length) {
+void PerformanceTest::run_concurrent_rc_benchmarks(const std::vector<int>& thread_counts, int ops_per_thread,
+                                                   double remote_fraction) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "CONCURRENT RC: ATOMIC vs BIASED COUNTS\n";
+    std::cout << ops_per_thread << " add_root/release_root pairs per thread, "
+              << std::setprecision(0) << std::fixed << remote_fraction * 100 << "% on other threads' objects, "
+              << std::thread::hardware_concurrency() << " hardware threads\n";
+    std::cout << std::string(80, '=') << "\n\n";
+
+    for (int threads : thread_counts) {
+        for (bool biased : {false, true}) {
+            std::cout << "   " << threads << " thread(s), " << (biased ? "biased" : "atomic") << "...\n";
+            test_concurrent_rc(biased, threads, ops_per_thread, remote_fraction);
+        }
+    }
+
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::benchmark_collect(const std::string& shape, int num_objects,
+                                                  const BenchmarkHarness& harness) {
     PerfTestResult result;
-    result.test_name = "Cyclic Graph (Cycle Detection)";
-    result.scenario_type = "cyclic_graph";
+    result.scenario_type = "bench_collect_" + shape;
     result.total_objects = num_objects;
     result.timestamp = get_timestamp();
-    result.collection_runs = 0;
-    
-    std::string log_file = output_dir + "/cyclic_graph_" + 
-                          std::to_string(num_objects) + ".log";
-    MarkSweepGC gc(1024 * 1024 * 100,
-                   1024 * 1024 * 80,
-                   log_file);
-    
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // === ЭТАП 1: СОЗДАНИЕ ЦИКЛИЧЕСКИХ ССЫЛОК ===
-    // Структура: root -> [cycle1] -> [cycle2] -> ...
-    // где каждый cycle имеет циклические ссылки между объектами
-    
-    int root_id = gc.allocate(64);
-    int op_count = 1;
-    
-    gc.make_root(root_id);
-    op_count++;
-    
-    int num_cycles = std::max(1, (num_objects - 1) / cycle_length);
-    int current_id_base = 1;
-    
-    for (int cycle_idx = 0; cycle_idx < num_cycles; ++cycle_idx) {
-        std::vector<int> cycle_objects;
+    result.objects_leaked = 0;
+    result.collection_runs = 2;
+    // collect(), remove_root(), collect()
+    result.total_operations = 3;
+
+    if (shape == "linear") {
+        result.test_name = "Collect: Linear Chain";
+    } else if (shape == "cyclic") {
+        result.test_name = "Collect: Cyclic Graph";
+    } else if (shape == "tree") {
+        result.test_name = "Collect: 4-ary Tree";
+    } else {
+        std::cerr << "Error: unknown graph shape '" << shape << "'\n";
+        return result;
+    }
+
+    struct Fixture {
+        MarkSweepGC gc;
+        int root_id = -1;
         
-        // Создаём объекты в этом цикле
-        for (int j = 0; j < cycle_length && 
-             (current_id_base + j) < num_objects; ++j) {
-            int obj_id = gc.allocate(64);
-            op_count++;
-            cycle_objects.push_back(obj_id);
-            
-            // Первый объект цикла подключаем к root
-            if (j == 0) {
-                gc.add_reference(root_id, obj_id);
-                op_count++;
-            }
+        Fixture(size_t heap_bytes, const std::string& log_file)
+            : gc(heap_bytes, heap_bytes, log_file) {
+            gc.set_logging_enabled(false);
         }
-        
-        // Создаём циклические ссылки: obj0 -> obj1 -> ... -> objN -> obj0
-        for (size_t j = 0; j < cycle_objects.size(); ++j) {
-            int from_id = cycle_objects[j];
-            int to_id = cycle_objects[(j + 1) % cycle_objects.size()];
-            
-            gc.add_reference(from_id, to_id);
-            op_count++;
+    };
+
+    const size_t heap_bytes = 1024ull * 1024 * 1024;
+    std::string log_file = output_dir + "/bench_collect.log";
+
+    auto setup = [&]() {
+        std::unique_ptr<Fixture> fixture(new Fixture(heap_bytes, log_file));
+        if (shape == "linear") {
+            fixture->root_id = build_rooted_chain(fixture->gc, num_objects, 64).first;
+        } else if (shape == "cyclic") {
+            fixture->root_id = build_rooted_cycles(fixture->gc, num_objects, 3, 64).first;
+        } else {
+            fixture->root_id = build_rooted_tree(fixture->gc, num_objects, 4, 64).first;
         }
-        
-        current_id_base += cycle_length;
-    }
-    
-    // === ЭТАП 2: СБОРКА МУСОРА (ДО УДАЛЕНИЯ ROOT) ===
-    // Mark-Sweep должен НАЙТИ и пометить все циклы как достижимые
-    size_t freed = gc.collect();
-    result.collection_runs = 1;
-    
-    // === ЭТАП 3: УДАЛЕНИЕ ROOT ===
-    // После этого циклы станут недостижимы и будут удалены!
-    gc.remove_root(root_id);
-    op_count++;
-    
-    // Вторая сборка
-    freed += gc.collect();
-    result.collection_runs = 2;
-    
-    auto end_time = std::chrono::high_resolution_clock::now();
-    
-    // === ПОДСЧЁТ РЕЗУЛЬТАТОВ ===
-    double exec_time = std::chrono::duration<double, std::milli>(
-        end_time - start_time).count();
-    
-    result.execution_time_ms = exec_time;
-    result.total_operations = op_count;
-    result.objects_collected = num_objects;
-    result.objects_leaked = 0; // Mark-Sweep НЕ имеет утечек!
-    result.memory_used_bytes = num_objects * 64;
+        result.memory_used_bytes = fixture->gc.get_total_memory();
+        return fixture;
+    };
+
+    size_t freed = 0;
+    int collected = 0;
+    auto body = [&](Fixture& fixture) {
+        int alive = fixture.gc.get_alive_objects_count();
+        freed = fixture.gc.collect();
+        fixture.gc.remove_root(fixture.root_id);
+        freed += fixture.gc.collect();
+        collected = alive - fixture.gc.get_alive_objects_count();
+    };
+
+    result.samples_ms = harness.measure(setup, body);
+    result.stats = compute_sample_stats(result.samples_ms, harness.get_options().confidence);
+    result.execution_time_ms = result.stats.median;
+    result.objects_collected = collected;
     result.memory_freed_bytes = freed;
-    
+
+    double half_width = (result.stats.ci_high - result.stats.ci_low) / 2.0;
+    std::cout << "         " << std::fixed << std::setprecision(3) << result.stats.mean
+              << " ms +- " << half_width << " (" << std::setprecision(0)
+              << result.stats.confidence * 100 << "% CI) | median " << std::setprecision(3)
+              << result.stats.median << " | stddev " << result.stats.stddev
+              << " | min " << result.stats.min << " | n=" << result.stats.count << "\n";
+
     results.push_back(result);
     return result;
 }
 
-PerfTestResult PerformanceTest::test_cascade_tree(int num_objects) {
+void PerformanceTest::run_benchmark_suite(const std::vector<int>& sizes, const BenchmarkOptions& options) {
+    BenchmarkOptions effective = options;
+    if (options.pin_cpu >= 0) {
+        std::string error;
+        if (!pin_current_thread(options.pin_cpu, &error)) {
+            std::cerr << "Error: cannot pin to CPU " << options.pin_cpu << ": " << error << "\n";
+            effective.pin_cpu = -1;
+        }
+    }
+    environment = benchmark_environment(effective);
+    BenchmarkHarness harness(effective);
+
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "COLLECTION BENCHMARK\n";
+    std::cout << effective.warmup_runs << " warmup + " << effective.repetitions
+              << " measured runs per test";
+    if (effective.pin_cpu >= 0) {
+        std::cout << ", pinned to CPU " << effective.pin_cpu;
+    }
+    std::cout << "\n" << std::string(80, '=') << "\n\n";
+
+    const std::vector<std::string> shapes = {"linear", "cyclic", "tree"};
+    for (const std::string& shape : shapes) {
+        for (int size : sizes) {
+            std::cout << "   " << shape << " (" << size << " objects)...\n";
+            benchmark_collect(shape, size, harness);
+        }
+    }
+    std::cout << "\n";
+}
+
+PerfTestResult PerformanceTest::test_backend_matrix_cell(const std::string& backend,
+                                                         const std::string& scenario, int num_objects,
+                                                         const BenchmarkHarness& harness) {
     PerfTestResult result;
-    result.test_name = "Cascade Tree (Recursive Deletion)";
-    result.scenario_type = "cascade_tree";
+    result.test_name = "Matrix: " + scenario + " / " + backend;
+    result.scenario_type = "matrix_" + scenario + "_" + backend;
     result.total_objects = num_objects;
     result.timestamp = get_timestamp();
-    result.collection_runs = 0;
-    
-    std::string log_file = output_dir + "/cascade_tree_" + 
-                          std::to_string(num_objects) + ".log";
-    MarkSweepGC gc(1024 * 1024 * 100,
-                   1024 * 1024 * 80,
-                   log_file);
-    
-    auto start_time = std::chrono::high_resolution_clock::now();
-    
-    // === Простая цепь: root -> obj1 -> obj2 -> ... -> objN ===
-    
-    int root_id = gc.allocate(64);
-    int op_count = 1;
-    
-    gc.make_root(root_id);
-    op_count++;
-    
-    int prev_id = root_id;
-    int created_count = 1;
-    
-    for (int i = 1; i < num_objects; ++i) {
-        int obj_id = gc.allocate(64);
-        op_count++;
-        
-        gc.add_reference(prev_id, obj_id);
-        op_count++;
-        
-        prev_id = obj_id;
-        created_count++;
+
+    std::vector<CompactOp> ops = make_matrix_ops(scenario, num_objects);
+    if (ops.empty()) {
+        std::cerr << "Error: unknown matrix scenario '" << scenario << "'\n";
+        return result;
     }
-    
-    // === СБОРКА МУСОРА ===
-    size_t freed = gc.collect();
-    result.collection_runs = 1;
-    
-    // === УДАЛЕНИЕ ROOT ===
-    gc.remove_root(root_id);
-    op_count++;
-    
-    freed += gc.collect();
-    result.collection_runs = 2;
-    
-    auto end_time = std::chrono::high_resolution_clock::now();
-    
-    // === РЕЗУЛЬТАТЫ ===
-    double exec_time = std::chrono::duration<double, std::milli>(
-        end_time - start_time).count();
-    
-    result.execution_time_ms = exec_time;
-    result.total_operations = op_count;
-    result.objects_collected = created_count;
-    result.objects_leaked = 0;
-    result.memory_used_bytes = created_count * 64;
-    result.memory_freed_bytes = freed;
-    
+    const size_t heap_bytes = 1024ull * 1024 * 1024;
+    if (!make_gc_backend(backend, heap_bytes)) {
+        std::cerr << "Error: unknown backend '" << backend << "'\n";
+        return result;
+    }
+
+    // Итоги последнего прогона: после снятия корней и сборки в heap'е
+    // остаются только утечки
+    ScenarioExecutionStats stats;
+    int leaked_objects = 0;
+    size_t leaked_bytes = 0;
+    uint64_t collections = 0;
+
+    auto setup = [&]() { return make_gc_backend(backend, heap_bytes); };
+    auto body = [&](GCInterface& gc) {
+        stats = execute_scenario(gc, ops.data(), ops.size(), NullScenarioObserver());
+        leaked_objects = gc.get_alive_objects_count();
+        leaked_bytes = gc.get_total_memory();
+        collections = gc.get_collection_stats().collections;
+    };
+
+    result.samples_ms = harness.measure(setup, body);
+    result.stats = compute_sample_stats(result.samples_ms, harness.get_options().confidence);
+    result.execution_time_ms = result.stats.median;
+    result.total_operations = static_cast<int>(stats.executed);
+    result.memory_used_bytes = stats.peak_memory;
+    result.memory_freed_bytes = stats.allocated_bytes >= leaked_bytes
+        ? static_cast<size_t>(stats.allocated_bytes) - leaked_bytes : 0;
+    result.objects_leaked = leaked_objects;
+    result.collection_runs = static_cast<int>(collections);
+    result.ops_per_second = result.execution_time_ms > 0.0
+        ? stats.executed / (result.execution_time_ms / 1000.0) : 0.0;
+    result.details = {
+        {"backend", backend},
+        {"scenario", scenario},
+        {"allocated_bytes", stats.allocated_bytes},
+        {"peak_memory_bytes", stats.peak_memory},
+        {"leaked_objects", leaked_objects},
+        {"leaked_bytes", leaked_bytes},
+        {"collections", collections}
+    };
+
     results.push_back(result);
     return result;
 }
 
+void PerformanceTest::run_backend_matrix(const std::vector<int>& sizes, const BenchmarkOptions& options) {
+    const std::vector<std::string> scenarios = {"linear", "cyclic", "tree", "workload"};
+    const std::vector<std::string> backends = gc_backend_names();
+    environment = benchmark_environment(options);
+    BenchmarkHarness harness(options);
+
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "COLLECTOR MATRIX\n";
+    std::cout << "Same op stream per scenario, end-to-end time (mutator + collector), "
+              << options.warmup_runs << " warmup + " << options.repetitions << " runs\n";
+    std::cout << std::string(80, '=') << "\n\n";
 
+    std::vector<PerfTestResult> cells;
+    for (const std::string& scenario : scenarios) {
+        for (int size : sizes) {
+            for (const std::string& backend : backends) {
+                std::cout << "   " << scenario << " (" << size << ") on " << backend << "...\n";
+                cells.push_back(test_backend_matrix_cell(backend, scenario, size, harness));
+            }
+        }
+    }
 
+    std::cout << "\n" << std::left
+              << std::setw(12) << "Scenario"
+              << std::setw(10) << "Objects"
+              << std::setw(20) << "Backend"
+              << std::setw(14) << "Median (ms)"
+              << std::setw(12) << "+- CI (ms)"
+              << std::setw(12) << "Peak (MB)"
+              << std::setw(14) << "Leaked objs"
+              << "Leaked (MB)\n";
+    std::cout << std::string(106, '-') << "\n";
+    for (const PerfTestResult& cell : cells) {
+        if (cell.details.is_null()) {
+            continue;
+        }
+        std::cout << std::left
+                  << std::setw(12) << cell.details["scenario"].get<std::string>()
+                  << std::setw(10) << cell.total_objects
+                  << std::setw(20) << cell.details["backend"].get<std::string>()
+                  << std::setw(14) << std::fixed << std::setprecision(3) << cell.stats.median
+                  << std::setw(12) << (cell.stats.ci_high - cell.stats.ci_low) / 2.0
+                  << std::setw(12) << std::setprecision(2) << cell.memory_used_bytes / (1024.0 * 1024.0)
+                  << std::setw(14) << cell.objects_leaked
+                  << cell.details["leaked_bytes"].get<size_t>() / (1024.0 * 1024.0) << "\n";
+    }
+    std::cout << "\n";
+}
 
+void PerformanceTest::run_parse_benchmarks(const std::vector<int>& sizes) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "SCENARIO PARSE THROUGHPUT BENCHMARK\n";
+    std::cout << "Streaming parser vs find/sscanf vs nlohmann DOM\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << sizes.size() << "] "
+                  << sizes[i] << " operations...\n";
+        test_scenario_parse(sizes[i]);
+    }
+    
+    std::cout << "\n";
+}
 
+void PerformanceTest::run_snapshot_benchmarks(const std::vector<int>& sizes) {
+    std::cout << "\n" << std::string(80, '=') << "\n";
+    std::cout << "HEAP SNAPSHOT THROUGHPUT BENCHMARK\n";
+    std::cout << "Streaming writer vs get_heap_info() string, delta vs full\n";
+    std::cout << std::string(80, '=') << "\n\n";
+    
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        std::cout << "   [" << (i + 1) << "/" << sizes.size() << "] "
+                  << sizes[i] << " objects...\n";
+        test_snapshot_throughput(sizes[i]);
+        test_delta_snapshots(sizes[i]);
+    }
+    
+    std::cout << "\n";
+}
 
 void PerformanceTest::run_all_tests(int small_size, 
                                     int medium_size, 
-                                    int large_size) {
+                                    int large_size,
+                                    const std::string& backend) {
     std::cout << "\n" << std::string(80, '=') << "\n";
     std::cout << "MARK-SWEEP GARBAGE COLLECTOR PERFORMANCE TEST SUITE v1.0\n";
     std::cout << "Testing: Simple Linear, Cyclic Graphs, Cascade Trees\n";
+    std::cout << "Collector: " << backend << "\n";
     std::cout << std::string(80, '=') << "\n\n";
     
     // === ТЕСТ 1: ПРОСТАЯ ЛИНЕЙНАЯ ЦЕПЬ ===
@@ -262,17 +2380,17 @@ void PerformanceTest::run_all_tests(int small_size,
     std::cout << "   " << std::string(70, '-') << "\n";
     
     std::cout << "   [1/3] Small (" << small_size << " objects)...\n";
-    auto r1 = test_simple_linear(small_size);
+    auto r1 = test_simple_linear(small_size, backend);
     std::cout << "         OK " << r1.execution_time_ms << " ms | " 
               << r1.objects_collected << " collected\n";
     
     std::cout << "   [2/3] Medium (" << medium_size << " objects)...\n";
-    auto r2 = test_simple_linear(medium_size);
+    auto r2 = test_simple_linear(medium_size, backend);
     std::cout << "         OK " << r2.execution_time_ms << " ms | " 
               << r2.objects_collected << " collected\n";
     
     std::cout << "   [3/3] Large (" << large_size << " objects)...\n";
-    auto r3 = test_simple_linear(large_size);
+    auto r3 = test_simple_linear(large_size, backend);
     std::cout << "         OK " << r3.execution_time_ms << " ms | " 
               << r3.objects_collected << " collected\n\n";
     
@@ -283,19 +2401,19 @@ void PerformanceTest::run_all_tests(int small_size,
     std::cout << "   " << std::string(70, '-') << "\n";
     
     std::cout << "   [1/3] Small (" << small_size << " objects)...\n";
-    auto r4 = test_cyclic_graph(small_size, 3);
+    auto r4 = test_cyclic_graph(small_size, 3, backend);
     std::cout << "         OK " << r4.execution_time_ms << " ms | " 
-              << r4.objects_collected << " collected (NO LEAKS!)\n";
+              << r4.objects_collected << " collected, " << r4.objects_leaked << " leaked\n";
     
     std::cout << "   [2/3] Medium (" << medium_size << " objects)...\n";
-    auto r5 = test_cyclic_graph(medium_size, 3);
+    auto r5 = test_cyclic_graph(medium_size, 3, backend);
     std::cout << "         OK " << r5.execution_time_ms << " ms | " 
-              << r5.objects_collected << " collected (NO LEAKS!)\n";
+              << r5.objects_collected << " collected, " << r5.objects_leaked << " leaked\n";
     
     std::cout << "   [3/3] Large (" << large_size << " objects)...\n";
-    auto r6 = test_cyclic_graph(large_size, 3);
+    auto r6 = test_cyclic_graph(large_size, 3, backend);
     std::cout << "         OK " << r6.execution_time_ms << " ms | " 
-              << r6.objects_collected << " collected (NO LEAKS!)\n\n";
+              << r6.objects_collected << " collected, " << r6.objects_leaked << " leaked\n\n";
     
     // === ТЕСТ 3: CASCADE TREE ===
 std::cout << ">> TEST 3: CASCADE TREE (RECURSIVE DELETION)\n";
@@ -304,17 +2422,17 @@ std::cout << "   Demonstrates cascade deletion of all descendants\n";
 std::cout << "   " << std::string(70, '-') << "\n";
 
 std::cout << "   [1/3] Small (" << small_size << " objects)...\n";
-auto r7 = test_cascade_tree(small_size);
+auto r7 = test_cascade_tree(small_size, backend);
 std::cout << "         OK " << r7.execution_time_ms << " ms | " 
           << r7.objects_collected << " collected\n";
 
 std::cout << "   [2/3] Medium (" << medium_size << " objects)...\n";
-auto r8 = test_cascade_tree(medium_size);
+auto r8 = test_cascade_tree(medium_size, backend);
 std::cout << "         OK " << r8.execution_time_ms << " ms | " 
           << r8.objects_collected << " collected\n";
 
 std::cout << "   [3/3] Large (" << large_size << " objects)...\n";
-auto r9 = test_cascade_tree(large_size);
+auto r9 = test_cascade_tree(large_size, backend);
 std::cout << "         OK " << r9.execution_time_ms << " ms | " 
           << r9.objects_collected << " collected\n\n";
 
@@ -322,6 +2440,28 @@ print_summary();
 
 }
 
+void PerformanceTest::save_mmu_to_json(const std::string& filename) {
+    if (mmu_results.is_null()) {
+        return;
+    }
+
+    json output;
+    output["test_suite"] = "Minimum Mutator Utilization";
+    output["timestamp"] = get_timestamp();
+    output["windows_ms"] = MMUCalculator::default_windows();
+    output["backends"] = mmu_results;
+
+    std::string filepath = output_dir + "/" + filename;
+    std::ofstream file(filepath);
+    if (!file.is_open()) {
+        std::cerr << "Error: cannot write " << filepath << "\n";
+        return;
+    }
+    file << output.dump(2);
+    file.close();
+    std::cout << "OK MMU curves saved to: " << filepath << "\n";
+}
+
 void PerformanceTest::print_summary() const {
     std::cout << std::string(100, '=') << "\n";
     std::cout << "PERFORMANCE SUMMARY\n";
@@ -365,6 +2505,9 @@ void PerformanceTest::save_results_to_json(const std::string& filename) {
     json output;
     output["test_suite"] = "Mark-Sweep GC Performance Tests";
     output["timestamp"] = get_timestamp();
+    if (!environment.is_null()) {
+        output["environment"] = environment;
+    }
     output["tests"] = json::array();
     output["statistics"] = json::object();
     
@@ -381,6 +2524,19 @@ void PerformanceTest::save_results_to_json(const std::string& filename) {
         test_obj["memory_used_mb"] = std::round((result.memory_used_bytes / (1024.0 * 1024.0)) * 100) / 100.0;
         test_obj["memory_freed_mb"] = std::round((result.memory_freed_bytes / (1024.0 * 1024.0)) * 100) / 100.0;
         test_obj["collection_runs"] = result.collection_runs;
+        if (result.throughput_mb_per_s > 0.0) {
+            test_obj["throughput_mb_per_s"] = std::round(result.throughput_mb_per_s * 100) / 100.0;
+        }
+        if (result.ops_per_second > 0.0) {
+            test_obj["ops_per_second"] = std::round(result.ops_per_second);
+        }
+        if (!result.details.is_null()) {
+            test_obj["details"] = result.details;
+        }
+        if (!result.samples_ms.empty()) {
+            test_obj["samples_ms"] = result.samples_ms;
+            test_obj["stats"] = result.stats.to_json();
+        }
         test_obj["timestamp"] = result.timestamp;
         
         output["tests"].push_back(test_obj);
@@ -425,3 +2581,35 @@ void PerformanceTest::save_results_to_json(const std::string& filename) {
     }
 }
 
+void PerformanceTest::save_results_to_csv(const std::string& filename) {
+    std::string full_path = output_dir + "/" + filename;
+    std::ofstream file(full_path);
+    if (!file.is_open()) {
+        std::cerr << "ERROR: Cannot open file: " << full_path << "\n";
+        return;
+    }
+
+    file << "test_name,scenario_type,total_objects,samples,mean_ms,median_ms,stddev_ms,"
+            "min_ms,max_ms,ci_low_ms,ci_high_ms,confidence\n";
+    file << std::fixed << std::setprecision(4);
+    for (const auto& result : results) {
+        SampleStats stats = result.samples_ms.empty()
+            ? compute_sample_stats({result.execution_time_ms})
+            : result.stats;
+        // Имена тестов могут содержать запятые
+        file << '"' << result.test_name << "\","
+             << result.scenario_type << ","
+             << result.total_objects << ","
+             << stats.count << ","
+             << stats.mean << ","
+             << stats.median << ","
+             << stats.stddev << ","
+             << stats.min << ","
+             << stats.max << ","
+             << stats.ci_low << ","
+             << stats.ci_high << ","
+             << std::setprecision(2) << stats.confidence << std::setprecision(4) << "\n";
+    }
+    file.close();
+    std::cout << "OK CSV saved to: " << full_path << "\n";
+}
@@ -0,0 +1,107 @@
+#include "replay_engine.h"
+#include "checkpoint_codec.h"
+#include "heap_snapshot_writer.h"
+
+#include <chrono>
+
+ReplayEngine::ReplayEngine(GCInterface& gc_, size_t checkpoint_interval)
+    : gc(gc_),
+      interval(checkpoint_interval > 0 ? checkpoint_interval : 1),
+      position(0)
+{
+    // Шаг 0 — исходное состояние, к нему всегда можно вернуться
+    take_checkpoint();
+}
+
+bool ReplayEngine::seek(size_t step) {
+    if (step > ops.size()) {
+        return false;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    size_t executed = 0;
+
+    // Ближайший checkpoint не позже step (шаг 0 есть всегда)
+    auto it = checkpoints.upper_bound(step);
+    --it;
+
+    // Если текущая позиция между checkpoint'ом и целью — просто идём вперёд
+    if (position > step || position < it->first) {
+        if (!restore_checkpoint(it->first)) {
+            return false;
+        }
+    }
+
+    while (position < step) {
+        gc.set_current_step(static_cast<int>(position));
+        apply(ops[position]);
+        position++;
+        executed++;
+
+        if (position % interval == 0 && checkpoints.count(position) == 0) {
+            take_checkpoint();
+        }
+    }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    stats.ops_executed += executed;
+    stats.last_seek_replayed = executed;
+    stats.last_seek_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    return true;
+}
+
+void ReplayEngine::apply(const ReplayOp& op) {
+    switch (op.type) {
+        case ReplayOpType::ALLOCATE:
+            gc.allocate(static_cast<size_t>(op.a));
+            break;
+        case ReplayOpType::ADD_REF:
+            gc.add_reference(op.a, op.b);
+            break;
+        case ReplayOpType::REMOVE_REF:
+            gc.remove_reference(op.a, op.b);
+            break;
+        case ReplayOpType::MAKE_ROOT:
+            gc.make_root(op.a);
+            break;
+        case ReplayOpType::REMOVE_ROOT:
+            gc.remove_root(op.a);
+            break;
+        case ReplayOpType::COLLECT:
+            gc.collect();
+            break;
+    }
+}
+
+void ReplayEngine::take_checkpoint() {
+    std::vector<uint8_t> raw;
+    {
+        HeapSnapshotWriter writer([&raw](const char* data, size_t size) {
+            raw.insert(raw.end(), data, data + size);
+        });
+        gc.write_checkpoint(writer);
+    }
+
+    std::vector<uint8_t> packed = compress_checkpoint(raw.data(), raw.size());
+    stats.checkpoints++;
+    stats.raw_bytes += raw.size();
+    stats.compressed_bytes += packed.size();
+    checkpoints[position] = std::move(packed);
+}
+
+bool ReplayEngine::restore_checkpoint(size_t step) {
+    auto it = checkpoints.find(step);
+    if (it == checkpoints.end()) {
+        return false;
+    }
+
+    std::vector<uint8_t> raw;
+    if (!decompress_checkpoint(it->second.data(), it->second.size(), raw) ||
+        !gc.read_checkpoint(raw.data(), raw.size())) {
+        return false;
+    }
+
+    position = step;
+    stats.restores++;
+    return true;
+}
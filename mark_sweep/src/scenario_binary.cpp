@@ -0,0 +1,245 @@
+#include "scenario_binary.h"
+
+#include <cstring>
+
+// ===========================
+// ТИП КОЛЛЕКТОРА
+// ===========================
+
+CheckpointKind scenario_collector_from_name(const std::string& collection_type) {
+    if (collection_type == "cascade" || collection_type == "cascade_deletion") {
+        return CheckpointKind::CASCADE_DELETION;
+    }
+    if (collection_type == "reference_counting" || collection_type == "rc") {
+        return CheckpointKind::REFERENCE_COUNTING;
+    }
+    return CheckpointKind::MARK_SWEEP;
+}
+
+const char* scenario_collector_name(CheckpointKind kind) {
+    switch (kind) {
+        case CheckpointKind::CASCADE_DELETION:   return "cascade";
+        case CheckpointKind::REFERENCE_COUNTING: return "reference_counting";
+        case CheckpointKind::MARK_SWEEP:         break;
+    }
+    return "mark_sweep";
+}
+
+// ===========================
+// ЗАПИСЬ
+// ===========================
+
+BinaryScenarioWriter::BinaryScenarioWriter()
+    : file(nullptr),
+      op_count(0),
+      failed(false)
+{}
+
+BinaryScenarioWriter::~BinaryScenarioWriter() {
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool BinaryScenarioWriter::open(const std::string& path) {
+    if (file) {
+        std::fclose(file);
+    }
+    op_count = 0;
+    failed = false;
+
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    std::setvbuf(file, nullptr, _IOFBF, 1024 * 1024);
+
+    // Место под заголовок; настоящий пишется в finish()
+    BinaryScenarioHeader placeholder;
+    std::memset(&placeholder, 0, sizeof(placeholder));
+    failed = std::fwrite(&placeholder, sizeof(placeholder), 1, file) != 1;
+    return !failed;
+}
+
+void BinaryScenarioWriter::append(const CompactOp& op) {
+    // Собираем запись заново, чтобы байты выравнивания были нулями
+    CompactOp record;
+    std::memset(&record, 0, sizeof(record));
+    record.code = op.code;
+    record.a = op.a;
+    record.b = op.b;
+    if (std::fwrite(&record, sizeof(record), 1, file) != 1) {
+        failed = true;
+    }
+    op_count++;
+}
+
+bool BinaryScenarioWriter::finish(const std::string& name,
+                                  const std::string& collection_type,
+                                  size_t heap_size) {
+    if (!file) {
+        return false;
+    }
+
+    BinaryScenarioHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = SCENARIO_MAGIC;
+    header.version = SCENARIO_VERSION;
+    header.header_size = sizeof(BinaryScenarioHeader);
+    header.collector = static_cast<uint32_t>(scenario_collector_from_name(collection_type));
+    header.op_size = sizeof(CompactOp);
+    header.name_length = static_cast<uint32_t>(name.size());
+    header.heap_size = heap_size;
+    header.op_count = op_count;
+    header.name_offset = sizeof(BinaryScenarioHeader) + op_count * sizeof(CompactOp);
+
+    if (!name.empty() && std::fwrite(name.data(), name.size(), 1, file) != 1) {
+        failed = true;
+    }
+    if (std::fseek(file, 0, SEEK_SET) != 0 ||
+        std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        failed = true;
+    }
+    if (std::fclose(file) != 0) {
+        failed = true;
+    }
+    file = nullptr;
+    return !failed;
+}
+
+bool write_binary_scenario(const std::string& path, const CompactScenario& scenario) {
+    BinaryScenarioWriter writer;
+    if (!writer.open(path)) {
+        return false;
+    }
+    for (const CompactOp& op : scenario.ops) {
+        writer.append(op);
+    }
+    return writer.finish(scenario.name, scenario.collection_type, scenario.heap_size);
+}
+
+bool convert_json_scenario(const std::string& json_path,
+                           const std::string& binary_path,
+                           std::string* error,
+                           uint64_t* op_count) {
+    BinaryScenarioWriter writer;
+    if (!writer.open(binary_path)) {
+        if (error) *error = "cannot create " + binary_path;
+        return false;
+    }
+
+    ScenarioParser parser;
+    CompactScenario scenario;
+    bool ok = parser.parse_file(json_path, scenario,
+                                [&writer](const CompactOp& op) { writer.append(op); });
+    if (!ok) {
+        if (error) *error = parser.get_error();
+        writer.finish("", "", 0);
+        std::remove(binary_path.c_str());
+        return false;
+    }
+
+    if (op_count) *op_count = writer.get_op_count();
+    if (!writer.finish(scenario.name, scenario.collection_type, scenario.heap_size)) {
+        if (error) *error = "write error in " + binary_path;
+        return false;
+    }
+    return true;
+}
+
+// ===========================
+// ЧТЕНИЕ
+// ===========================
+
+ScenarioFile::ScenarioFile()
+    : op_data(nullptr),
+      op_count(0),
+      heap_bytes(0),
+      binary(false)
+{}
+
+bool ScenarioFile::open(const std::string& path) {
+    op_data = nullptr;
+    op_count = 0;
+    error.clear();
+
+    uint32_t magic = 0;
+    std::FILE* probe = std::fopen(path.c_str(), "rb");
+    if (!probe) {
+        error = "cannot open " + path;
+        return false;
+    }
+    size_t got = std::fread(&magic, 1, sizeof(magic), probe);
+    std::fclose(probe);
+
+    if (got == sizeof(magic) && magic == SCENARIO_MAGIC) {
+        return open_binary(path);
+    }
+
+    // Не бинарный — разбираем как JSON
+    binary = false;
+    ScenarioParser parser;
+    if (!parser.parse_file(path, parsed)) {
+        error = parser.get_error();
+        return false;
+    }
+    op_data = parsed.ops.data();
+    op_count = parsed.ops.size();
+    heap_bytes = parsed.heap_size;
+    collector = parsed.collection_type;
+    scenario_name = parsed.name;
+    return true;
+}
+
+bool ScenarioFile::open_binary(const std::string& path) {
+    binary = true;
+    parsed = CompactScenario();
+
+    if (!mapping.open(path)) {
+        error = "cannot map " + path;
+        return false;
+    }
+
+    const uint8_t* data = mapping.data();
+    size_t size = mapping.size();
+    BinaryScenarioHeader header;
+    if (size < sizeof(header)) {
+        error = "truncated header in " + path;
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+
+    if (header.magic != SCENARIO_MAGIC ||
+        header.version == 0 || header.version > SCENARIO_VERSION ||
+        header.header_size != sizeof(BinaryScenarioHeader) ||
+        header.op_size != sizeof(CompactOp)) {
+        error = "unsupported scenario format in " + path;
+        return false;
+    }
+
+    // Операции и имя должны целиком лежать в файле
+    size_t available = size - sizeof(header);
+    if (header.op_count > available / sizeof(CompactOp) ||
+        header.name_offset != sizeof(header) + header.op_count * sizeof(CompactOp) ||
+        header.name_length > size - header.name_offset) {
+        error = "truncated scenario " + path;
+        return false;
+    }
+
+    // Исполнитель и печать сценария разбирают только известные коды
+    const CompactOp* ops = reinterpret_cast<const CompactOp*>(data + sizeof(header));
+    for (uint64_t i = 0; i < header.op_count; ++i) {
+        if (static_cast<uint8_t>(ops[i].code) > static_cast<uint8_t>(ScenarioOpCode::MACRO_ARGS)) {
+            error = "invalid opcode " + std::to_string(static_cast<unsigned>(ops[i].code)) +
+                    " at operation " + std::to_string(i) + " in " + path;
+            return false;
+        }
+    }
+
+    op_data = ops;
+    op_count = static_cast<size_t>(header.op_count);
+    heap_bytes = static_cast<size_t>(header.heap_size);
+    collector = scenario_collector_name(static_cast<CheckpointKind>(header.collector));
+    scenario_name.assign(reinterpret_cast<const char*>(data + header.name_offset), header.name_length);
+    return true;
+}
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "scenario_binary.h"
+#include "workload_generator.h"
+
+namespace {
+
+/**
+ * @brief scenario_convert --workload preset allocations [seed] output.gcs
+ */
+int write_workload(int argc, char* argv[]) {
+    if (argc < 5) {
+        std::cerr << "Usage: " << argv[0] << " --workload preset allocations [seed] output.gcs\n";
+        return 1;
+    }
+
+    WorkloadConfig config;
+    uint64_t allocations = 0;
+    try {
+        allocations = std::stoull(argv[3]);
+        if (argc > 5) config.seed = std::stoull(argv[4]);
+    } catch (...) {
+        std::cerr << "Error: invalid number\n";
+        return 1;
+    }
+    std::string error;
+    if (!workload_preset(argv[2], config) || !validate_workload_config(config, error)) {
+        std::cerr << "Error: unknown or invalid workload preset '" << argv[2] << "' " << error << "\n";
+        return 1;
+    }
+
+    std::string output = argv[argc - 1];
+    BinaryScenarioWriter writer;
+    if (!writer.open(output)) {
+        std::cerr << "Error: cannot create " << output << "\n";
+        return 1;
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    WorkloadRecordingHeap heap;
+    WorkloadGenerator generator(config);
+    WorkloadStats stats = generator.run(heap, allocations,
+        [&writer](size_t, const CompactOp& op, int64_t) { writer.append(op); });
+
+    // Куча с запасом на всё выделенное: сценарий не упирается в память
+    size_t heap_size = std::max<size_t>(heap.used * 2, 1024 * 1024);
+    if (!writer.finish(std::string("workload_") + argv[2], "mark_sweep", heap_size)) {
+        std::cerr << "Error: write error in " << output << "\n";
+        return 1;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "[OK] workload " << argv[2] << " (seed " << config.seed << ") -> " << output << ": "
+              << stats.operations << " operations, " << stats.live_objects << " live objects in "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+    return 0;
+}
+
+} // namespace
+
+/**
+ * @brief Конвертер JSON-сценария в бинарный формат
+ *
+ * scenario_convert input.json [output.gcs]
+ * Без второго аргумента расширение .json заменяется на .gcs.
+ *
+ * scenario_convert --workload preset allocations [seed] output.gcs
+ * записывает синтетическую нагрузку (workload_generator.h).
+ */
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "--workload") {
+        return write_workload(argc, argv);
+    }
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " input.json [output.gcs]\n"
+                  << "       " << argv[0] << " --workload preset allocations [seed] output.gcs\n";
+        return 1;
+    }
+
+    std::string input = argv[1];
+    std::string output;
+    if (argc > 2) {
+        output = argv[2];
+    } else {
+        size_t dot = input.rfind(".json");
+        output = (dot != std::string::npos ? input.substr(0, dot) : input) + ".gcs";
+    }
+
+    auto start = std::chrono::high_resolution_clock::now();
+    std::string error;
+    uint64_t op_count = 0;
+    if (!convert_json_scenario(input, output, &error, &op_count)) {
+        std::cerr << "Error: " << input << ": " << error << "\n";
+        return 1;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    std::cout << "[OK] " << input << " -> " << output << ": " << op_count << " operations in "
+              << std::chrono::duration<double, std::milli>(end - start).count() << " ms\n";
+    return 0;
+}
@@ -0,0 +1,923 @@
+#include "scenario_parser.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+// ===========================
+// ИМЕНА ОПЕРАЦИЙ
+// ===========================
+
+const char* scenario_op_name(ScenarioOpCode code) {
+    switch (code) {
+        case ScenarioOpCode::ALLOCATE:    return "allocate";
+        case ScenarioOpCode::MAKE_ROOT:   return "make_root";
+        case ScenarioOpCode::REMOVE_ROOT: return "remove_root";
+        case ScenarioOpCode::ADD_REF:     return "add_ref";
+        case ScenarioOpCode::REMOVE_REF:  return "remove_ref";
+        case ScenarioOpCode::COLLECT:     return "collect";
+        case ScenarioOpCode::ALLOCATE_RANGE: return "allocate_range";
+        case ScenarioOpCode::CHAIN:       return "chain";
+        case ScenarioOpCode::RING:        return "ring";
+        case ScenarioOpCode::TREE:        return "tree";
+        case ScenarioOpCode::RANDOM_GRAPH: return "random_graph";
+        case ScenarioOpCode::MACRO_ARGS:  return "macro_args";
+    }
+    return "unknown";
+}
+
+bool scenario_op_from_name(const char* name, size_t length, ScenarioOpCode& code) {
+    // Быстрый путь: точное каноническое имя
+    switch (length) {
+        case 7:
+            if (std::memcmp(name, "add_ref", 7) == 0) { code = ScenarioOpCode::ADD_REF; return true; }
+            if (std::memcmp(name, "collect", 7) == 0) { code = ScenarioOpCode::COLLECT; return true; }
+            break;
+        case 8:
+            if (std::memcmp(name, "allocate", 8) == 0) { code = ScenarioOpCode::ALLOCATE; return true; }
+            break;
+        case 9:
+            if (std::memcmp(name, "make_root", 9) == 0) { code = ScenarioOpCode::MAKE_ROOT; return true; }
+            break;
+        case 10:
+            if (std::memcmp(name, "remove_ref", 10) == 0) { code = ScenarioOpCode::REMOVE_REF; return true; }
+            break;
+        case 11:
+            if (std::memcmp(name, "remove_root", 11) == 0) { code = ScenarioOpCode::REMOVE_ROOT; return true; }
+            break;
+    }
+
+    // Нормализуем: нижний регистр, без '_' и '-'
+    char norm[16];
+    size_t n = 0;
+    for (size_t i = 0; i < length; ++i) {
+        char c = name[i];
+        if (c == '_' || c == '-') continue;
+        if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+        if (n == sizeof(norm)) return false;
+        norm[n++] = c;
+    }
+
+    struct Alias { const char* text; ScenarioOpCode code; };
+    static const Alias aliases[] = {
+        {"allocate",   ScenarioOpCode::ALLOCATE},
+        {"alloc",      ScenarioOpCode::ALLOCATE},
+        {"addref",     ScenarioOpCode::ADD_REF},
+        {"removeref",  ScenarioOpCode::REMOVE_REF},
+        {"makeroot",   ScenarioOpCode::MAKE_ROOT},
+        {"addroot",    ScenarioOpCode::MAKE_ROOT},
+        {"removeroot", ScenarioOpCode::REMOVE_ROOT},
+        {"deleteroot", ScenarioOpCode::REMOVE_ROOT},
+        {"collect",    ScenarioOpCode::COLLECT},
+        {"gc",         ScenarioOpCode::COLLECT},
+        {"allocaterange", ScenarioOpCode::ALLOCATE_RANGE},
+        {"allocrange", ScenarioOpCode::ALLOCATE_RANGE},
+        {"chain",      ScenarioOpCode::CHAIN},
+        {"ring",       ScenarioOpCode::RING},
+        {"cycle",      ScenarioOpCode::RING},
+        {"tree",       ScenarioOpCode::TREE},
+        {"randomgraph", ScenarioOpCode::RANDOM_GRAPH},
+        {"gnp",        ScenarioOpCode::RANDOM_GRAPH},
+    };
+
+    for (const Alias& alias : aliases) {
+        if (std::strlen(alias.text) == n && std::memcmp(alias.text, norm, n) == 0) {
+            code = alias.code;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ===========================
+// МАКРООПЕРАЦИИ
+// ===========================
+
+bool scenario_is_macro(ScenarioOpCode code) {
+    switch (code) {
+        case ScenarioOpCode::ALLOCATE_RANGE:
+        case ScenarioOpCode::CHAIN:
+        case ScenarioOpCode::RING:
+        case ScenarioOpCode::TREE:
+        case ScenarioOpCode::RANDOM_GRAPH:
+            return true;
+        default:
+            return false;
+    }
+}
+
+size_t scenario_op_length(ScenarioOpCode code) {
+    if (code == ScenarioOpCode::RANDOM_GRAPH) return 3;
+    return scenario_is_macro(code) ? 2 : 1;
+}
+
+int64_t scenario_tree_size(int32_t fanout, int32_t depth) {
+    if (fanout < 1 || depth < 0) {
+        return -1;
+    }
+    const int64_t limit = std::numeric_limits<int32_t>::max();
+    int64_t level = 1;
+    int64_t total = 1;
+    for (int32_t d = 0; d < depth; ++d) {
+        level *= fanout;
+        total += level;
+        if (level > limit || total > limit) {
+            return -1;
+        }
+    }
+    return total;
+}
+
+size_t encode_scenario_macro(const ScenarioMacro& macro, CompactOp out[SCENARIO_MAX_OP_RECORDS]) {
+    for (size_t i = 0; i < SCENARIO_MAX_OP_RECORDS; ++i) {
+        out[i] = CompactOp{ScenarioOpCode::MACRO_ARGS, 0, 0};
+    }
+    out[0].code = macro.code;
+    out[1].a = macro.first_id;
+
+    switch (macro.code) {
+        case ScenarioOpCode::TREE:
+            out[0].a = macro.fanout;
+            out[0].b = macro.depth;
+            out[1].b = macro.size;
+            break;
+        case ScenarioOpCode::RANDOM_GRAPH:
+            out[0].a = macro.count;
+            out[0].b = macro.size;
+            out[1].b = static_cast<int32_t>(macro.seed);
+            std::memcpy(&out[2].a, &macro.probability, sizeof(float));
+            break;
+        default:
+            out[0].a = macro.count;
+            out[0].b = macro.size;
+            break;
+    }
+    return scenario_op_length(macro.code);
+}
+
+std::string scenario_macro_label(const CompactOp& op) {
+    std::string label = scenario_op_name(op.code);
+    for (char& c : label) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    if (op.code == ScenarioOpCode::TREE) {
+        return label + " fanout " + std::to_string(op.a) + ", depth " + std::to_string(op.b);
+    }
+    return label + " " + std::to_string(op.a) + " x " + std::to_string(op.b) + " bytes";
+}
+
+bool decode_scenario_macro(const CompactOp* ops, size_t available, ScenarioMacro& macro) {
+    ScenarioOpCode code = ops[0].code;
+    size_t length = scenario_op_length(code);
+    if (!scenario_is_macro(code) || available < length) {
+        return false;
+    }
+    for (size_t i = 1; i < length; ++i) {
+        if (ops[i].code != ScenarioOpCode::MACRO_ARGS) return false;
+    }
+
+    macro = ScenarioMacro();
+    macro.code = code;
+    macro.first_id = ops[1].a;
+
+    switch (code) {
+        case ScenarioOpCode::TREE: {
+            macro.fanout = ops[0].a;
+            macro.depth = ops[0].b;
+            macro.size = ops[1].b;
+            int64_t nodes = scenario_tree_size(macro.fanout, macro.depth);
+            if (nodes < 0) return false;
+            macro.count = static_cast<int32_t>(nodes);
+            break;
+        }
+        case ScenarioOpCode::RANDOM_GRAPH:
+            macro.count = ops[0].a;
+            macro.size = ops[0].b;
+            macro.seed = static_cast<uint32_t>(ops[1].b);
+            std::memcpy(&macro.probability, &ops[2].a, sizeof(float));
+            if (!(macro.probability >= 0.0f && macro.probability <= 1.0f)) return false;
+            break;
+        default:
+            macro.count = ops[0].a;
+            macro.size = ops[0].b;
+            break;
+    }
+
+    // id всех объектов должны уместиться в int32
+    return macro.count >= 0 && macro.first_id >= 0 &&
+           static_cast<int64_t>(macro.first_id) + macro.count - 1 <= std::numeric_limits<int32_t>::max();
+}
+
+// ===========================
+// ВХОД
+// ===========================
+
+ScenarioParser::ScenarioParser(size_t buffer_size)
+    : buffer(buffer_size > 64 ? buffer_size : 64),
+      base(nullptr),
+      cur(nullptr),
+      end(nullptr),
+      file(nullptr),
+      consumed(0),
+      allocations(0),
+      sink(nullptr),
+      target(nullptr)
+{}
+
+ScenarioParser::~ScenarioParser() {
+    if (file) {
+        std::fclose(file);
+    }
+}
+
+bool ScenarioParser::parse_file(const std::string& path, CompactScenario& out) {
+    return parse_file(path, out, OpSink());
+}
+
+bool ScenarioParser::parse_file(const std::string& path, CompactScenario& out, const OpSink& op_sink) {
+    out = CompactScenario();
+    error.clear();
+
+    file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    // Читаем крупными порциями сами — буфер stdio только лишняя копия
+    std::setvbuf(file, nullptr, _IONBF, 0);
+
+    if (!op_sink) {
+        // Самая короткая запись операции в сгенерированных файлах ~30 байт
+        std::error_code ec;
+        auto file_size = std::filesystem::file_size(path, ec);
+        if (!ec) {
+            out.ops.reserve(static_cast<size_t>(file_size / 32));
+        }
+    }
+
+    base = cur = end = buffer.data();
+    consumed = 0;
+    sink = op_sink ? &op_sink : nullptr;
+
+    bool ok = run(out);
+    if (std::ferror(file)) {
+        error = "read error in " + path;
+        ok = false;
+    }
+
+    std::fclose(file);
+    file = nullptr;
+    sink = nullptr;
+    return ok;
+}
+
+bool ScenarioParser::parse_string(const std::string& text, CompactScenario& out) {
+    out = CompactScenario();
+    error.clear();
+
+    base = cur = text.data();
+    end = text.data() + text.size();
+    consumed = 0;
+    sink = nullptr;
+    return run(out);
+}
+
+bool ScenarioParser::refill() {
+    if (!file) {
+        return false;
+    }
+
+    size_t offset = static_cast<size_t>(cur - buffer.data());
+    size_t pending = static_cast<size_t>(end - cur);
+    if (offset > 0) {
+        // Незаконченный токен переезжает в начало буфера
+        std::memmove(buffer.data(), cur, pending);
+        consumed += offset;
+    } else if (pending == buffer.size()) {
+        // Токен длиннее буфера
+        buffer.resize(buffer.size() * 2);
+    }
+
+    size_t n = std::fread(buffer.data() + pending, 1, buffer.size() - pending, file);
+    base = cur = buffer.data();
+    end = cur + pending + n;
+    return n > 0;
+}
+
+bool ScenarioParser::skip_ws() {
+    for (;;) {
+        while (cur < end) {
+            char c = *cur;
+            if (static_cast<unsigned char>(c) > ' ' ||
+                (c != ' ' && c != '\n' && c != '\r' && c != '\t')) {
+                return true;
+            }
+            ++cur;
+        }
+        if (!refill()) {
+            return false;
+        }
+    }
+}
+
+bool ScenarioParser::expect(char c) {
+    if (!skip_ws()) {
+        return fail(std::string("unexpected end of input, expected '") + c + "'");
+    }
+    if (*cur != c) {
+        return fail(std::string("expected '") + c + "', got '" + *cur + "'");
+    }
+    ++cur;
+    return true;
+}
+
+bool ScenarioParser::fail(const std::string& message) {
+    if (error.empty()) {
+        uint64_t offset = consumed + static_cast<uint64_t>(cur - base);
+        error = "offset " + std::to_string(offset) + ": " + message;
+    }
+    return false;
+}
+
+void ScenarioParser::emit(const CompactOp& op) {
+    if (sink) {
+        (*sink)(op);
+    } else {
+        target->ops.push_back(op);
+    }
+}
+
+// ===========================
+// ТОКЕНЫ
+// ===========================
+
+namespace {
+
+void append_utf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+        out += static_cast<char>(0xC0 | (cp >> 6));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += static_cast<char>(0xE0 | (cp >> 12));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (cp >> 18));
+        out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+}
+
+bool parse_hex4(const char* p, const char* end, uint32_t& value) {
+    if (end - p < 4) return false;
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        char c = p[i];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= static_cast<uint32_t>(c - '0');
+        else if (c >= 'a' && c <= 'f') value |= static_cast<uint32_t>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') value |= static_cast<uint32_t>(c - 'A' + 10);
+        else return false;
+    }
+    return true;
+}
+
+bool decode_escapes(const char* p, const char* end, std::string& out) {
+    out.clear();
+    while (p < end) {
+        char c = *p++;
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        char e = *p++;
+        switch (e) {
+            case '"':  out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/':  out += '/'; break;
+            case 'b':  out += '\b'; break;
+            case 'f':  out += '\f'; break;
+            case 'n':  out += '\n'; break;
+            case 'r':  out += '\r'; break;
+            case 't':  out += '\t'; break;
+            case 'u': {
+                uint32_t cp;
+                if (!parse_hex4(p, end, cp)) return false;
+                p += 4;
+                uint32_t low;
+                if (cp >= 0xD800 && cp < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u' &&
+                    parse_hex4(p + 2, end, low) && low >= 0xDC00 && low < 0xE000) {
+                    cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                    p += 6;
+                }
+                append_utf8(out, cp);
+                break;
+            }
+            default:
+                return false;
+        }
+    }
+    return true;
+}
+
+bool is_bare_char(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           c == '-' || c == '+' || c == '.';
+}
+
+} // namespace
+
+bool ScenarioParser::scan_string(size_t& length, bool& escaped) {
+    // cur указывает на открывающую кавычку; токен не сдвигается
+    size_t i = 1;
+    escaped = false;
+    for (;;) {
+        if (cur + i >= end) {
+            if (!refill()) {
+                return fail("unterminated string");
+            }
+            continue;
+        }
+        const char* p = cur + i;
+        while (p < end && *p != '"' && *p != '\\') {
+            ++p;
+        }
+        i = static_cast<size_t>(p - cur);
+        if (p == end) {
+            continue;
+        }
+        if (*p == '"') {
+            break;
+        }
+        escaped = true;
+        i += 2;
+    }
+    length = i - 1;
+    return true;
+}
+
+bool ScenarioParser::read_string(std::string* out) {
+    size_t length;
+    bool escaped;
+    if (!scan_string(length, escaped)) {
+        return false;
+    }
+
+    if (out) {
+        if (!escaped) {
+            out->assign(cur + 1, length);
+        } else if (!decode_escapes(cur + 1, cur + 1 + length, *out)) {
+            return fail("invalid escape sequence");
+        }
+    }
+    cur += length + 2;
+    return true;
+}
+
+bool ScenarioParser::read_view(const char*& text, size_t& length) {
+    // Без копии: указатель живёт до следующего refill()
+    size_t raw_length;
+    bool escaped;
+    if (!scan_string(raw_length, escaped)) {
+        return false;
+    }
+
+    if (!escaped) {
+        text = cur + 1;
+        length = raw_length;
+    } else {
+        if (!decode_escapes(cur + 1, cur + 1 + raw_length, scratch)) {
+            return fail("invalid escape sequence");
+        }
+        text = scratch.data();
+        length = scratch.size();
+    }
+    cur += raw_length + 2;
+    return true;
+}
+
+enum class ScenarioParser::Key : uint8_t {
+    OTHER,
+    OP,
+    ID,
+    SIZE,
+    FROM,
+    TO,
+    OPERATIONS,
+    HEAP_SIZE,
+    MAX_HEAP_SIZE,
+    COLLECTION_TYPE,
+    NAME,
+    DESCRIPTION,
+    COUNT,
+    FANOUT,
+    DEPTH,
+    PROBABILITY,
+    SEED
+};
+
+bool ScenarioParser::read_key(Key& key) {
+    const char* text;
+    size_t length;
+    if (!read_view(text, length)) {
+        return false;
+    }
+
+    // Ключей немного — сравниваем по длине, без копирования в std::string
+    auto is = [text, length](const char* literal, size_t n) {
+        return length == n && std::memcmp(text, literal, n) == 0;
+    };
+
+    key = Key::OTHER;
+    switch (length) {
+        case 1:
+            if (is("n", 1)) key = Key::COUNT;
+            else if (is("p", 1)) key = Key::PROBABILITY;
+            break;
+        case 2:
+            if (is("op", 2)) key = Key::OP;
+            else if (is("id", 2)) key = Key::ID;
+            else if (is("to", 2)) key = Key::TO;
+            break;
+        case 4:
+            if (is("size", 4)) key = Key::SIZE;
+            else if (is("from", 4)) key = Key::FROM;
+            else if (is("type", 4)) key = Key::OP;
+            else if (is("name", 4)) key = Key::NAME;
+            else if (is("seed", 4)) key = Key::SEED;
+            break;
+        case 5:
+            if (is("count", 5)) key = Key::COUNT;
+            else if (is("depth", 5)) key = Key::DEPTH;
+            break;
+        case 6:
+            if (is("fanout", 6)) key = Key::FANOUT;
+            break;
+        case 9:
+            if (is("heap_size", 9)) key = Key::HEAP_SIZE;
+            break;
+        case 10:
+            if (is("operations", 10)) key = Key::OPERATIONS;
+            break;
+        case 11:
+            if (is("description", 11)) key = Key::DESCRIPTION;
+            else if (is("probability", 11)) key = Key::PROBABILITY;
+            break;
+        case 13:
+            if (is("max_heap_size", 13)) key = Key::MAX_HEAP_SIZE;
+            else if (is("scenario_name", 13)) key = Key::NAME;
+            break;
+        case 15:
+            if (is("collection_type", 15)) key = Key::COLLECTION_TYPE;
+            break;
+    }
+    return true;
+}
+
+bool ScenarioParser::scan_bare(size_t& length) {
+    // Числа и литералы: токен целиком должен оказаться в буфере
+    length = 0;
+    for (;;) {
+        while (cur + length < end && is_bare_char(cur[length])) {
+            ++length;
+        }
+        if (cur + length < end || !refill()) {
+            break;
+        }
+    }
+    if (length == 0) {
+        return fail(cur < end ? std::string("unexpected character '") + *cur + "'"
+                              : std::string("unexpected end of input"));
+    }
+    return true;
+}
+
+bool ScenarioParser::read_integer(int64_t& result) {
+    size_t length;
+    if (!scan_bare(length)) {
+        return false;
+    }
+
+    const char* p = cur;
+    const char* q = cur + length;
+    bool negative = (*p == '-');
+    if (negative) ++p;
+
+    // Быстрый путь: целое без дробной части и экспоненты
+    uint64_t value = 0;
+    bool plain = p < q && (q - p) <= 18;
+    for (const char* d = p; plain && d < q; ++d) {
+        if (*d < '0' || *d > '9') {
+            plain = false;
+        } else {
+            value = value * 10 + static_cast<uint64_t>(*d - '0');
+        }
+    }
+
+    if (plain) {
+        result = negative ? -static_cast<int64_t>(value) : static_cast<int64_t>(value);
+    } else {
+        std::string token(cur, length);
+        char* stop = nullptr;
+        double d = std::strtod(token.c_str(), &stop);
+        if (stop != token.c_str() + length || !std::isfinite(d) ||
+            std::fabs(d) > 9.0e18) {
+            return fail("invalid number '" + token + "'");
+        }
+        result = static_cast<int64_t>(d);
+    }
+
+    cur += length;
+    return true;
+}
+
+bool ScenarioParser::read_int32(int32_t& result) {
+    int64_t value;
+    if (!read_integer(value)) {
+        return false;
+    }
+    if (value < std::numeric_limits<int32_t>::min() || value > std::numeric_limits<int32_t>::max()) {
+        return fail("value out of range: " + std::to_string(value));
+    }
+    result = static_cast<int32_t>(value);
+    return true;
+}
+
+bool ScenarioParser::read_number(double& result) {
+    size_t length;
+    if (!scan_bare(length)) {
+        return false;
+    }
+    std::string token(cur, length);
+    char* stop = nullptr;
+    result = std::strtod(token.c_str(), &stop);
+    if (stop != token.c_str() + length || !std::isfinite(result)) {
+        return fail("invalid number '" + token + "'");
+    }
+    cur += length;
+    return true;
+}
+
+bool ScenarioParser::skip_value() {
+    int depth = 0;
+    do {
+        if (!skip_ws()) {
+            return fail("unexpected end of input");
+        }
+        char c = *cur;
+        if (c == '"') {
+            if (!read_string(nullptr)) return false;
+        } else if (c == '{' || c == '[') {
+            ++depth;
+            ++cur;
+        } else if (c == '}' || c == ']') {
+            if (depth == 0) return fail(std::string("unexpected '") + c + "'");
+            --depth;
+            ++cur;
+        } else if (c == ',' || c == ':') {
+            if (depth == 0) return fail(std::string("unexpected '") + c + "'");
+            ++cur;
+        } else {
+            size_t length;
+            if (!scan_bare(length)) return false;
+            bool number = (c == '-' || (c >= '0' && c <= '9'));
+            bool literal = (length == 4 && (std::memcmp(cur, "true", 4) == 0 ||
+                                            std::memcmp(cur, "null", 4) == 0)) ||
+                           (length == 5 && std::memcmp(cur, "false", 5) == 0);
+            if (!number && !literal) {
+                return fail("invalid literal '" + std::string(cur, length) + "'");
+            }
+            cur += length;
+        }
+    } while (depth > 0);
+    return true;
+}
+
+// ===========================
+// СТРУКТУРА СЦЕНАРИЯ
+// ===========================
+
+bool ScenarioParser::run(CompactScenario& out) {
+    target = &out;
+    allocations = 0;
+
+    bool ok;
+    if (!skip_ws()) {
+        ok = fail("empty input");
+    } else if (*cur == '{') {
+        ok = parse_root_object();
+    } else if (*cur == '[') {
+        ok = parse_operations();
+    } else {
+        ok = fail("scenario must be an object or an array of operations");
+    }
+
+    if (ok && skip_ws()) {
+        ok = fail("trailing data after scenario");
+    }
+
+    out.bytes_parsed = consumed + static_cast<uint64_t>(cur - base);
+    target = nullptr;
+    return ok;
+}
+
+bool ScenarioParser::parse_root_object() {
+    ++cur;  // '{'
+    if (!skip_ws()) return fail("unexpected end of input");
+    if (*cur == '}') {
+        ++cur;
+        return true;
+    }
+
+    bool heap_size_seen = false;
+    for (;;) {
+        Key key;
+        if (!skip_ws() || *cur != '"') return fail("expected key");
+        if (!read_key(key) || !expect(':') || !skip_ws()) {
+            return fail("unexpected end of input");
+        }
+
+        bool is_string = (*cur == '"');
+        if (key == Key::OPERATIONS && *cur == '[') {
+            if (!parse_operations()) return false;
+        } else if ((key == Key::HEAP_SIZE || key == Key::MAX_HEAP_SIZE) && !is_string) {
+            int64_t size;
+            if (!read_integer(size)) return false;
+            if (size < 0) return fail("negative heap size");
+            // "heap_size" важнее "max_heap_size" независимо от порядка
+            if (key == Key::HEAP_SIZE || !heap_size_seen) {
+                target->heap_size = static_cast<size_t>(size);
+            }
+            heap_size_seen = heap_size_seen || key == Key::HEAP_SIZE;
+        } else if (key == Key::COLLECTION_TYPE && is_string) {
+            if (!read_string(&target->collection_type)) return false;
+        } else if (key == Key::NAME && is_string) {
+            if (!read_string(&target->name)) return false;
+        } else if (key == Key::DESCRIPTION && is_string) {
+            if (!read_string(&target->description)) return false;
+        } else if (!skip_value()) {
+            return false;
+        }
+
+        if (!skip_ws()) return fail("unexpected end of input");
+        char c = *cur++;
+        if (c == '}') return true;
+        if (c != ',') {
+            --cur;
+            return fail("expected ',' or '}'");
+        }
+    }
+}
+
+bool ScenarioParser::parse_operations() {
+    ++cur;  // '['
+    if (!skip_ws()) return fail("unexpected end of input");
+    if (*cur == ']') {
+        ++cur;
+        return true;
+    }
+
+    for (;;) {
+        if (!skip_ws()) return fail("unexpected end of input");
+        if (*cur != '{') return fail("operation must be an object");
+        if (!parse_operation()) return false;
+
+        if (!skip_ws()) return fail("unexpected end of input");
+        char c = *cur++;
+        if (c == ']') return true;
+        if (c != ',') {
+            --cur;
+            return fail("expected ',' or ']'");
+        }
+    }
+}
+
+bool ScenarioParser::parse_operation() {
+    ++cur;  // '{'
+
+    bool known = false;
+    bool has_op = false;
+    ScenarioOpCode code = ScenarioOpCode::COLLECT;
+    int32_t id = -1;
+    int32_t size = 0;
+    int32_t from = -1;
+    int32_t to = -1;
+    ScenarioMacro macro;
+    int64_t seed = 0;
+    double probability = 0.0;
+
+    if (!skip_ws()) return fail("unexpected end of input");
+    if (*cur != '}') {
+        for (;;) {
+            Key key;
+            if (!skip_ws() || *cur != '"') return fail("expected key");
+            if (!read_key(key) || !expect(':') || !skip_ws()) {
+                return fail("unexpected end of input");
+            }
+
+            bool is_string = (*cur == '"');
+            if (key == Key::OP && is_string) {
+                const char* name;
+                size_t length;
+                if (!read_view(name, length)) return false;
+                has_op = true;
+                known = scenario_op_from_name(name, length, code);
+            } else if (key == Key::ID && !is_string) {
+                if (!read_int32(id)) return false;
+            } else if (key == Key::SIZE && !is_string) {
+                if (!read_int32(size)) return false;
+            } else if (key == Key::FROM && !is_string) {
+                if (!read_int32(from)) return false;
+            } else if (key == Key::TO && !is_string) {
+                if (!read_int32(to)) return false;
+            } else if (key == Key::COUNT && !is_string) {
+                if (!read_int32(macro.count)) return false;
+            } else if (key == Key::FANOUT && !is_string) {
+                if (!read_int32(macro.fanout)) return false;
+            } else if (key == Key::DEPTH && !is_string) {
+                if (!read_int32(macro.depth)) return false;
+            } else if (key == Key::SEED && !is_string) {
+                if (!read_integer(seed)) return false;
+            } else if (key == Key::PROBABILITY && !is_string) {
+                if (!read_number(probability)) return false;
+            } else if (!skip_value()) {
+                return false;
+            }
+
+            if (!skip_ws()) return fail("unexpected end of input");
+            char c = *cur++;
+            if (c == '}') break;
+            if (c != ',') {
+                --cur;
+                return fail("expected ',' or '}'");
+            }
+        }
+    } else {
+        ++cur;
+    }
+
+    if (!has_op || !known || code == ScenarioOpCode::MACRO_ARGS) {
+        target->skipped_ops++;
+        return true;
+    }
+
+    if (scenario_is_macro(code)) {
+        macro.code = code;
+        macro.size = size;
+        macro.first_id = id >= 0 ? id : allocations;
+        macro.seed = static_cast<uint32_t>(seed);
+        macro.probability = static_cast<float>(probability);
+
+        if (code == ScenarioOpCode::TREE) {
+            int64_t nodes = scenario_tree_size(macro.fanout, macro.depth);
+            if (nodes < 0) return fail("invalid or too large tree");
+            macro.count = static_cast<int32_t>(nodes);
+        }
+        if (macro.count < 0) return fail("negative object count");
+        if (probability < 0.0 || probability > 1.0) return fail("probability must be in [0, 1]");
+        if (static_cast<int64_t>(macro.first_id) + macro.count - 1 > std::numeric_limits<int32_t>::max()) {
+            return fail("object ids out of range");
+        }
+
+        CompactOp records[SCENARIO_MAX_OP_RECORDS];
+        size_t length = encode_scenario_macro(macro, records);
+        for (size_t i = 0; i < length; ++i) {
+            emit(records[i]);
+        }
+        // Макрос с size <= 0 исполнитель пропускает — id он не занимает
+        if (macro.size > 0) {
+            allocations += macro.count;
+        }
+        return true;
+    }
+
+    CompactOp op{code, 0, 0};
+    switch (code) {
+        case ScenarioOpCode::ALLOCATE:
+            op.a = size;
+            op.b = id >= 0 ? id : allocations;
+            // Как и для макросов: пропускаемый allocate не сдвигает id
+            if (size > 0) {
+                allocations++;
+            }
+            break;
+        case ScenarioOpCode::MAKE_ROOT:
+        case ScenarioOpCode::REMOVE_ROOT:
+            op.a = id;
+            break;
+        case ScenarioOpCode::ADD_REF:
+        case ScenarioOpCode::REMOVE_REF:
+            op.a = from;
+            op.b = to;
+            break;
+        default:
+            break;
+    }
+    emit(op);
+    return true;
+}
@@ -1,5 +1,7 @@
 #include "mark_sweep_gc.h"
 #include "cascade_deletion_gc.h"
+#include "scenario_binary.h"
+#include "scenario_executor.h"
 
 #include <iostream>
 #include <fstream>
@@ -9,107 +11,45 @@
 #include <memory>
 #include <algorithm>
 
-struct Operation {
-    std::string type;
-    int param1 = 0;
-    int param2 = 0;
-    std::string collection_type = "mark_sweep";
-};
-
-std::vector<Operation> parse_json_scenario(const std::string& filename) {
-    std::vector<Operation> operations;
-    std::ifstream file(filename);
-    
-    if (!file.is_open()) {
-        std::cerr << "Cannot open: " << filename << std::endl;
-        return operations;
-    }
-    
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    file.close();
-    
-    // Читаем тип сборки
-    std::string collection_type = "mark_sweep";
-    size_t type_pos = content.find("\"collection_type\":");
-    if (type_pos != std::string::npos) {
-        size_t start = content.find("\"", type_pos + 18);
-        size_t end = content.find("\"", start + 1);
-        if (start != std::string::npos && end != std::string::npos) {
-            collection_type = content.substr(start + 1, end - start - 1);
-        }
-    }
-    
-    // Парсим операции
-    size_t pos = 0;
-    while (pos < content.length()) {
-        pos = content.find('{', pos);
-        if (pos == std::string::npos) break;
-        
-        size_t end = content.find('}', pos);
-        if (end == std::string::npos) break;
-        
-        std::string obj = content.substr(pos, end - pos + 1);
-        pos = end + 1;
-        
-        if (obj.find("\"op\"") == std::string::npos) continue;
-        
-        Operation op;
-        op.collection_type = collection_type;
-        
-        if (obj.find("\"op\": \"allocate\"") != std::string::npos ||
-            obj.find("\"op\":\"allocate\"") != std::string::npos) {
-            op.type = "allocate";
-            size_t size_pos = obj.find("\"size\"");
-            if (size_pos != std::string::npos) {
-                sscanf(obj.c_str() + size_pos, "\"size\": %d", &op.param1);
-            }
-            if (op.param1 > 0) operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"make_root\"") != std::string::npos ||
-                 obj.find("\"op\":\"make_root\"") != std::string::npos) {
-            op.type = "make_root";
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos) {
-                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.param1);
-            }
-            operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"add_ref\"") != std::string::npos ||
-                 obj.find("\"op\":\"add_ref\"") != std::string::npos) {
-            op.type = "add_ref";
-            size_t from_pos = obj.find("\"from\"");
-            size_t to_pos = obj.find("\"to\"");
-            if (from_pos != std::string::npos) {
-                sscanf(obj.c_str() + from_pos, "\"from\": %d", &op.param1);
-            }
-            if (to_pos != std::string::npos) {
-                sscanf(obj.c_str() + to_pos, "\"to\": %d", &op.param2);
-            }
-            operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"remove_ref\"") != std::string::npos ||
-                 obj.find("\"op\":\"remove_ref\"") != std::string::npos) {
-            op.type = "remove_ref";
-            size_t from_pos = obj.find("\"from\"");
-            size_t to_pos = obj.find("\"to\"");
-            if (from_pos != std::string::npos) {
-                sscanf(obj.c_str() + from_pos, "\"from\": %d", &op.param1);
-            }
-            if (to_pos != std::string::npos) {
-                sscanf(obj.c_str() + to_pos, "\"to\": %d", &op.param2);
+// Выполняем операции на конкретном коллекторе
+template<typename GC>
+static void simulate_operations(GC& gc, const ScenarioFile& operations) {
+    execute_scenario(gc, operations.ops(), operations.size(),
+        [&gc](size_t step, const CompactOp& op, int64_t result) {
+            std::cout << "\n--- Step " << step << " ---" << std::endl;
+            
+            switch (op.code) {
+                case ScenarioOpCode::ALLOCATE:
+                    std::cout << "ALLOCATE " << op.a << " bytes -> object_" << result << std::endl;
+                    break;
+                case ScenarioOpCode::MAKE_ROOT:
+                    std::cout << "MAKE_ROOT object_" << op.a << std::endl;
+                    break;
+                case ScenarioOpCode::REMOVE_ROOT:
+                    std::cout << "REMOVE_ROOT object_" << op.a << std::endl;
+                    break;
+                case ScenarioOpCode::ADD_REF:
+                    std::cout << "ADD_REF object_" << op.a << " -> object_" << op.b << std::endl;
+                    break;
+                case ScenarioOpCode::REMOVE_REF:
+                    std::cout << "REMOVE_REF object_" << op.a << " -X-> object_" << op.b << std::endl;
+                    break;
+                case ScenarioOpCode::COLLECT:
+                    std::cout << "COLLECT -> freed " << result << " bytes" << std::endl;
+                    break;
+                default:
+                    std::cout << scenario_macro_label(op) << " -> from object_" << result << std::endl;
+                    break;
             }
-            operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"collect\"") != std::string::npos ||
-                 obj.find("\"op\":\"collect\"") != std::string::npos) {
-            op.type = "collect";
-            operations.push_back(op);
-        }
-    }
+            
+            std::cout << "Heap: " << gc.get_alive_objects_count() << " objects, "
+                      << gc.get_total_memory() << " bytes" << std::endl;
+        });
     
-    return operations;
+    std::cout << "\n========================================" << std::endl;
+    std::cout << " Simulation Complete" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+    std::cout << gc.get_gc_stats() << std::endl;
 }
 
 void run_simulation(const std::string& scenario_file) {
@@ -117,7 +57,12 @@ void run_simulation(const std::string& scenario_file) {
     std::cout << " Garbage Collector Simulator" << std::endl;
     std::cout << "========================================\n" << std::endl;
     
-    std::vector<Operation> operations = parse_json_scenario(scenario_file);
+    ScenarioFile scenario;
+    if (!scenario.open(scenario_file)) {
+        std::cerr << "ERROR: " << scenario.get_error() << std::endl;
+        return;
+    }
+    const ScenarioFile& operations = scenario;
     std::cout << "Parsed " << operations.size() << " operations\n" << std::endl;
     
     if (operations.empty()) {
@@ -126,58 +71,15 @@ void run_simulation(const std::string& scenario_file) {
     }
     
     // Определяем тип GC
-    std::string gc_type = operations[0].collection_type;
-    
-    std::unique_ptr<GCInterface> gc;
-    
-    if (gc_type == "cascade") {
+    if (scenario_collector_from_name(scenario.collection_type()) == CheckpointKind::CASCADE_DELETION) {
         std::cout << "Using: Cascade Deletion GC\n" << std::endl;
-        gc = std::make_unique<CascadeDeletionGC>();
+        CascadeDeletionGC gc;
+        simulate_operations(gc, operations);
     } else {
         std::cout << "Using: Mark-and-Sweep GC\n" << std::endl;
-        gc = std::make_unique<MarkSweepGC>();
-    }
-    
-    // Выполняем операции
-    for (size_t step = 0; step < operations.size(); step++) {
-        const Operation& op = operations[step];
-        gc->set_current_step(step);
-        
-        std::cout << "\n--- Step " << step << " ---" << std::endl;
-        
-        if (op.type == "allocate") {
-            int id = gc->allocate(op.param1);
-            std::cout << "ALLOCATE " << op.param1 << " bytes -> object_" << id << std::endl;
-        }
-        else if (op.type == "make_root") {
-            if (auto* ms_gc = dynamic_cast<MarkSweepGC*>(gc.get())) {
-                ms_gc->make_root(op.param1);
-            } else if (auto* c_gc = dynamic_cast<CascadeDeletionGC*>(gc.get())) {
-                c_gc->make_root(op.param1);
-            }
-            std::cout << "MAKE_ROOT object_" << op.param1 << std::endl;
-        }
-        else if (op.type == "add_ref") {
-            gc->add_reference(op.param1, op.param2);
-            std::cout << "ADD_REF object_" << op.param1 << " -> object_" << op.param2 << std::endl;
-        }
-        else if (op.type == "remove_ref") {
-            gc->remove_reference(op.param1, op.param2);
-            std::cout << "REMOVE_REF object_" << op.param1 << " -X-> object_" << op.param2 << std::endl;
-        }
-        else if (op.type == "collect") {
-            size_t freed = gc->collect();
-            std::cout << "COLLECT -> freed " << freed << " bytes" << std::endl;
-        }
-        
-        std::cout << "Heap: " << gc->get_alive_objects_count() << " objects, "
-                  << gc->get_total_memory() << " bytes" << std::endl;
+        MarkSweepGC gc;
+        simulate_operations(gc, operations);
     }
-    
-    std::cout << "\n========================================" << std::endl;
-    std::cout << " Simulation Complete" << std::endl;
-    std::cout << "========================================\n" << std::endl;
-    std::cout << gc->get_gc_stats() << std::endl;
 }
 
 void show_menu() {
@@ -0,0 +1,358 @@
+#include "workload_generator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+// ===========================
+// ПАРАМЕТРЫ И ПРОФИЛИ
+// ===========================
+
+bool validate_workload_config(const WorkloadConfig& config, std::string& error) {
+    auto is_fraction = [](double value) { return value >= 0.0 && value <= 1.0; };
+
+    if (config.min_size == 0 || config.min_size > config.max_size) {
+        error = "size range must satisfy 0 < min_size <= max_size";
+        return false;
+    }
+    if (config.size_distribution == SizeDistribution::FIXED && config.size == 0) {
+        error = "fixed object size must be positive";
+        return false;
+    }
+    if (config.size_distribution == SizeDistribution::LOG_NORMAL &&
+        (config.size == 0 || !(config.size_sigma >= 0.0))) {
+        error = "log-normal sizes need a positive median and sigma >= 0";
+        return false;
+    }
+    if (config.size_distribution == SizeDistribution::SIZE_CLASSES) {
+        double total = 0.0;
+        for (const auto& size_class : config.size_classes) {
+            if (size_class.first == 0 || !(size_class.second >= 0.0)) {
+                error = "size classes need positive sizes and non-negative weights";
+                return false;
+            }
+            total += size_class.second;
+        }
+        if (!(total > 0.0)) {
+            error = "size classes must have a positive total weight";
+            return false;
+        }
+    }
+    if (config.max_out_degree < 0 || !(config.degree_exponent >= 0.0)) {
+        error = "out-degree needs max_out_degree >= 0 and exponent >= 0";
+        return false;
+    }
+    if (!is_fraction(config.preferential_fraction) || !is_fraction(config.back_edge_fraction) ||
+        !is_fraction(config.long_lived_fraction)) {
+        error = "fractions must be in [0, 1]";
+        return false;
+    }
+    if (!(config.mean_lifetime > 0.0)) {
+        error = "mean lifetime must be positive";
+        return false;
+    }
+    if (!(config.mutations_per_allocation >= 0.0)) {
+        error = "mutation rate must be non-negative";
+        return false;
+    }
+    if (config.anchor_count <= 0) {
+        error = "at least one anchor root is required";
+        return false;
+    }
+    return true;
+}
+
+bool workload_preset(const std::string& name, WorkloadConfig& config) {
+    WorkloadConfig preset;
+
+    if (name == "production") {
+        // Значения по умолчанию и есть этот профиль
+    } else if (name == "generational") {
+        preset.long_lived_fraction = 0.02;
+        preset.mean_lifetime = 50.0;
+        preset.degree_exponent = 2.5;
+    } else if (name == "uniform") {
+        preset.size_distribution = SizeDistribution::FIXED;
+        preset.size = 64;
+        preset.degree_exponent = 0.0;
+        preset.max_out_degree = 1;
+        preset.preferential_fraction = 0.0;
+        preset.back_edge_fraction = 0.0;
+        preset.long_lived_fraction = 1.0;
+        preset.anchor_count = 1;
+    } else if (name == "churn") {
+        preset.steady_state_live = 100000;
+        preset.mutations_per_allocation = 0.5;
+        preset.mean_lifetime = 200000.0;
+    } else {
+        return false;
+    }
+
+    preset.seed = config.seed;
+    config = preset;
+    return true;
+}
+
+std::vector<std::string> workload_preset_names() {
+    return {"production", "generational", "uniform", "churn"};
+}
+
+// ===========================
+// ГЕНЕРАТОР
+// ===========================
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig& config_)
+    : config(config_),
+      rng(config_.seed),
+      log_median_size(std::log(static_cast<double>(std::max<size_t>(config_.size, 1)))),
+      attachment_limit(4096),
+      clock(0),
+      step(0)
+{
+    // P(k) ~ (k+1)^-alpha: большинство объектов почти без ссылок,
+    // редкие "хабы" ссылаются на десятки объектов
+    int max_degree = std::max(config.max_out_degree, 0);
+    degree_cdf.resize(static_cast<size_t>(max_degree) + 1);
+    double total = 0.0;
+    for (int k = 0; k <= max_degree; ++k) {
+        total += std::pow(static_cast<double>(k + 1), -config.degree_exponent);
+        degree_cdf[k] = total;
+    }
+    for (double& p : degree_cdf) {
+        p /= total;
+    }
+
+    if (config.size_distribution == SizeDistribution::SIZE_CLASSES) {
+        double weight = 0.0;
+        for (const auto& size_class : config.size_classes) {
+            weight += size_class.second;
+            size_class_cdf.push_back(weight);
+        }
+        for (double& p : size_class_cdf) {
+            p /= weight > 0.0 ? weight : 1.0;
+        }
+    }
+}
+
+double WorkloadGenerator::uniform() {
+    // 53 старших бита — равномерно в [0, 1)
+    return static_cast<double>(rng() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+uint64_t WorkloadGenerator::uniform_index(uint64_t n) {
+    return static_cast<uint64_t>(uniform() * static_cast<double>(n)) % n;
+}
+
+size_t WorkloadGenerator::sample_size() {
+    switch (config.size_distribution) {
+        case SizeDistribution::FIXED:
+            return config.size;
+
+        case SizeDistribution::UNIFORM:
+            return config.min_size + uniform_index(config.max_size - config.min_size + 1);
+
+        case SizeDistribution::LOG_NORMAL: {
+            // Бокс — Мюллер; u1 в (0, 1], чтобы логарифм был конечным
+            double u1 = 1.0 - uniform();
+            double u2 = uniform();
+            double normal = std::sqrt(-2.0 * std::log(u1)) * std::cos(6.283185307179586 * u2);
+            double size = std::exp(log_median_size + config.size_sigma * normal);
+            size = std::min(std::max(size, static_cast<double>(config.min_size)),
+                            static_cast<double>(config.max_size));
+            return static_cast<size_t>(size);
+        }
+
+        case SizeDistribution::SIZE_CLASSES: {
+            double u = uniform();
+            size_t index = std::upper_bound(size_class_cdf.begin(), size_class_cdf.end(), u) -
+                           size_class_cdf.begin();
+            index = std::min(index, config.size_classes.size() - 1);
+            return config.size_classes[index].first;
+        }
+    }
+    return config.size;
+}
+
+int WorkloadGenerator::sample_out_degree() {
+    double u = uniform();
+    size_t k = std::upper_bound(degree_cdf.begin(), degree_cdf.end(), u) - degree_cdf.begin();
+    return static_cast<int>(std::min(k, degree_cdf.size() - 1));
+}
+
+uint64_t WorkloadGenerator::sample_death_time() {
+    if (uniform() < config.long_lived_fraction) {
+        return IMMORTAL;
+    }
+    double lifetime = -std::log(1.0 - uniform()) * config.mean_lifetime;
+    return clock + 1 + static_cast<uint64_t>(lifetime);
+}
+
+// ===========================
+// МОДЕЛЬ ЖИВОГО МНОЖЕСТВА
+// ===========================
+
+void WorkloadGenerator::add_anchor(int id) {
+    objects[id].anchor = -1;
+    anchors.push_back(id);
+}
+
+int WorkloadGenerator::pick_anchor() {
+    return anchors[uniform_index(anchors.size())];
+}
+
+void WorkloadGenerator::add_object(int id, int anchor, uint64_t death_time) {
+    ModelObject& object = objects[id];
+    object.anchor = anchor;
+    object.live_pos = static_cast<uint32_t>(live.size());
+    live.push_back(id);
+    attachment.push_back(id);
+    compact_attachment();
+
+    if (death_time != IMMORTAL) {
+        deaths.push_back(Death{death_time, id});
+        std::push_heap(deaths.begin(), deaths.end(), std::greater<Death>());
+    }
+}
+
+void WorkloadGenerator::remove_object(int id) {
+    auto it = objects.find(id);
+    if (it == objects.end() || it->second.anchor < 0) {
+        return;
+    }
+
+    // Удаление из live перестановкой с последним
+    uint32_t pos = it->second.live_pos;
+    int last = live.back();
+    live[pos] = last;
+    objects[last].live_pos = pos;
+    live.pop_back();
+
+    // Записи в attachment вычищаются лениво в pick_target()
+    objects.erase(it);
+}
+
+void WorkloadGenerator::compact_attachment() {
+    // pick_target() вычищает мёртвые записи, только когда на них попадает;
+    // при редком предпочтительном выборе список чистится здесь целиком
+    if (attachment.size() <= attachment_limit) {
+        return;
+    }
+    attachment.erase(std::remove_if(attachment.begin(), attachment.end(),
+                                    [this](int id) { return !is_live(id); }),
+                     attachment.end());
+
+    // Живые записи (входящие степени хабов) тоже растут; порог от
+    // оставшегося размера держит стоимость чистки амортизированно O(1)
+    attachment_limit = std::max<size_t>(2 * attachment.size(), 4096);
+}
+
+bool WorkloadGenerator::is_live(int id) const {
+    auto it = objects.find(id);
+    return it != objects.end() && it->second.anchor >= 0;
+}
+
+int WorkloadGenerator::pick_target(int exclude) {
+    if (live.empty()) {
+        return -1;
+    }
+
+    if (uniform() < config.preferential_fraction) {
+        // Пропорционально входящей степени + 1; мёртвые записи
+        // убираются по пути перестановкой с последней
+        while (!attachment.empty()) {
+            size_t index = uniform_index(attachment.size());
+            int id = attachment[index];
+            if (is_live(id)) {
+                if (id != exclude) {
+                    return id;
+                }
+                break;
+            }
+            attachment[index] = attachment.back();
+            attachment.pop_back();
+        }
+    }
+
+    int id = live[uniform_index(live.size())];
+    return id != exclude ? id : -1;
+}
+
+void WorkloadGenerator::pick_targets(int new_id, int degree) {
+    targets.clear();
+    for (int k = 0; k < degree; ++k) {
+        int target = pick_target(new_id);
+        if (target >= 0 && std::find(targets.begin(), targets.end(), target) == targets.end()) {
+            targets.push_back(target);
+        }
+    }
+}
+
+void WorkloadGenerator::note_edge(int from, int to) {
+    auto it = objects.find(from);
+    if (it != objects.end()) {
+        it->second.out.push_back(to);
+    }
+    attachment.push_back(to);
+}
+
+bool WorkloadGenerator::pop_due_death(int& id, int& anchor) {
+    while (!deaths.empty() && deaths.front().time <= clock) {
+        std::pop_heap(deaths.begin(), deaths.end(), std::greater<Death>());
+        int candidate = deaths.back().id;
+        deaths.pop_back();
+        if (is_live(candidate)) {
+            id = candidate;
+            anchor = objects[candidate].anchor;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool WorkloadGenerator::pop_churn_victim(int& id, int& anchor) {
+    // Первым умирает объект с ближайшим сроком
+    while (!deaths.empty()) {
+        std::pop_heap(deaths.begin(), deaths.end(), std::greater<Death>());
+        int candidate = deaths.back().id;
+        deaths.pop_back();
+        if (is_live(candidate)) {
+            id = candidate;
+            anchor = objects[candidate].anchor;
+            return true;
+        }
+    }
+
+    // Остались только долгоживущие
+    if (live.empty()) {
+        return false;
+    }
+    id = live[uniform_index(live.size())];
+    anchor = objects[id].anchor;
+    return true;
+}
+
+bool WorkloadGenerator::pick_mutation(int& from, int& old_to, int& new_to) {
+    // Несколько попыток найти живой объект с исходящими связями
+    for (int attempt = 0; attempt < 8 && !live.empty(); ++attempt) {
+        int candidate = live[uniform_index(live.size())];
+        ModelObject& object = objects[candidate];
+        if (object.out.empty()) {
+            continue;
+        }
+
+        size_t index = uniform_index(object.out.size());
+        int target = pick_target(candidate);
+        if (target < 0 ||
+            std::find(object.out.begin(), object.out.end(), target) != object.out.end()) {
+            continue;
+        }
+
+        from = candidate;
+        old_to = object.out[index];
+        new_to = target;
+        object.out[index] = target;
+        attachment.push_back(target);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,74 @@
+#ifndef BACKUP_TRACER_H
+#define BACKUP_TRACER_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "rc_object.h"
+#include "reference_counter.h"
+
+/**
+ * @class BackupTracer
+ * @brief Резервная трассировка для кучи с подсчётом ссылок
+ *
+ * Обычный мусор освобождает каскад RC; трассировка нужна только для
+ * того, что RC не видит. collect() размечает объекты, достижимые из
+ * корней, и освобождает остальные — мусорные циклы и всё, что висит
+ * на них. Попутно ref_count каждого живого объекта пересчитывается по
+ * ссылкам от живых объектов (и корню, если корни входят в счётчик):
+ * так исправляются счётчики, которые разошлись со ссылками.
+ *
+ * Проходы — полные по куче, обход разметки — по явному стеку.
+ */
+class BackupTracer
+{
+public:
+    BackupTracer(std::unordered_map<int, RCObject> &heap, const std::unordered_set<int> &heap_roots,
+                 ReferenceCounter &rc);
+
+    /**
+     * @brief Разметить от корней, пересчитать счётчики живых, освободить прочее
+     *
+     * Отложенный каскад и журнал эпохи слияния должны быть применены до
+     * вызова: иначе их уменьшения пришлись бы на уже пересчитанные счётчики.
+     *
+     * @return Количество освобождённых объектов
+     */
+    std::size_t collect();
+
+    /** @brief Сколько раз вызван collect() */
+    std::size_t get_runs() const { return runs; }
+
+    /** @brief Объектов, размеченных последним collect() */
+    std::size_t get_last_marked() const { return last_marked; }
+
+    /** @brief Освобождено трассировкой за всё время */
+    std::size_t get_freed_objects() const { return freed_objects; }
+    std::size_t get_freed_bytes() const { return freed_bytes; }
+
+    /** @brief Живых объектов, у которых пересчёт изменил ref_count, за всё время */
+    std::size_t get_repaired_counts() const { return repaired_counts; }
+
+    /** @brief Сбросить счётчики освобождённого (после restore кучи) */
+    void reset_freed() { freed_objects = 0; freed_bytes = 0; }
+
+private:
+    std::unordered_map<int, RCObject> &heap;
+    const std::unordered_set<int> &heap_roots;
+    ReferenceCounter &rc;
+    std::vector<int> stack;               ///< Стек разметки; ёмкость переиспользуется
+    std::vector<int> old_counts;          ///< Счётчики живых до пересчёта, в порядке обхода heap
+    std::vector<std::unordered_map<int, RCObject>::iterator> garbage; ///< Неразмеченные
+    std::size_t runs;
+    std::size_t last_marked;
+    std::size_t freed_objects;
+    std::size_t freed_bytes;
+    std::size_t repaired_counts;
+
+    void mark_from_roots();
+    void recount();
+    std::size_t sweep();
+};
+
+#endif // BACKUP_TRACER_H
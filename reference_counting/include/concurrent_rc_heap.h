@@ -0,0 +1,219 @@
+#ifndef CONCURRENT_RC_HEAP_H
+#define CONCURRENT_RC_HEAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Как потоки меняют счётчики ссылок ConcurrentRCHeap
+ *
+ * ATOMIC — один атомарный счётчик на объект, любое изменение — RMW.
+ * BIASED — смещённый подсчёт (Choi, Shull, Torrellas): у объекта есть
+ * поток-владелец (тот, кто его выделил), который меняет свой
+ * неатомарный счётчик; остальные потоки — атомарный общий.
+ */
+enum class ConcurrentRCMode
+{
+    ATOMIC,
+    BIASED
+};
+
+/**
+ * @brief Объект ConcurrentRCHeap
+ *
+ * state упаковывает общий счётчик и флаги, чтобы проверка «счётчик
+ * обнулился после слияния» была одной атомарной операцией:
+ * state = shared_count * 4 + (QUEUED | MERGED).
+ */
+struct ConcurrentRCObject
+{
+    static const int64_t MERGED = 1; ///< Смещённый счётчик влит в общий
+    static const int64_t QUEUED = 2; ///< Стоит в очереди владельца на слияние
+    static const int64_t ONE = 4;    ///< Единица общего счётчика в state
+
+    int id;
+    int size;
+    int owner;                       ///< Поток-владелец; -1 — нет (ATOMIC). Не меняется
+    bool biased;                     ///< Владелец ещё считает сам; только для владельца
+    int biased_count;                ///< Счётчик владельца; только для владельца
+    std::atomic<int64_t> state;      ///< Общий счётчик и флаги
+    std::mutex references_mutex;     ///< Защищает references
+    std::vector<int> references;     ///< Исходящие ссылки
+
+    ConcurrentRCObject(int id_, int size_)
+        : id(id_), size(size_), owner(-1), biased(false), biased_count(0), state(0) {}
+};
+
+/**
+ * @class ConcurrentRCHeap
+ * @brief Куча с подсчётом ссылок, общая для нескольких потоков-мутаторов
+ *
+ * Таблица объектов разбита на шарды со своими мьютексами, поэтому
+ * потоки, работающие с разными объектами, не ждут друг друга; список
+ * ссылок объекта защищён его мьютексом, счётчики — атомарные (или
+ * смещённые, см. ConcurrentRCMode). id выдаются атомарным счётчиком
+ * и не переиспользуются.
+ *
+ * Корни — внешние ссылки потоков: allocate() возвращает объект с одним
+ * корнем выделившего потока, add_root()/release_root() добавляют и
+ * снимают по одному. Как и в RCHeap, объект с нулевым счётчиком
+ * освобождается каскадом сразу (тем потоком, который обнулил счётчик),
+ * а циклы не собираются.
+ *
+ * Вызывающий поток отвечает за то, чтобы объекты, id которых он
+ * передаёт, были живы во время вызова: держал на них корень или
+ * ссылку от живого объекта.
+ *
+ * В режиме BIASED общий счётчик может уйти в минус, если чужие потоки
+ * сняли больше ссылок, чем добавили; такой объект ставится в очередь
+ * владельца, и освободить его можно только после слияния счётчиков
+ * в process_queued() владельца. Владелец вызывает process_queued()
+ * периодически; collect() разбирает очереди всех потоков и допустим,
+ * только когда мутаторы остановлены.
+ */
+class ConcurrentRCHeap
+{
+public:
+    /// Шардов таблицы объектов по умолчанию
+    static const std::size_t DEFAULT_SHARDS = 64;
+
+    /**
+     * @param heap_size_bytes Размер кучи в байтах
+     * @param mode Атомарные или смещённые счётчики
+     * @param shard_count Шардов таблицы объектов
+     */
+    explicit ConcurrentRCHeap(std::size_t heap_size_bytes, ConcurrentRCMode mode = ConcurrentRCMode::ATOMIC,
+                              std::size_t shard_count = DEFAULT_SHARDS);
+    ~ConcurrentRCHeap();
+
+    ConcurrentRCHeap(const ConcurrentRCHeap &) = delete;
+    ConcurrentRCHeap &operator=(const ConcurrentRCHeap &) = delete;
+
+    /**
+     * @brief Выделить объект с одним корнем вызывающего потока
+     * @return ID объекта, или -1, если не хватает памяти
+     */
+    int allocate(std::size_t size);
+
+    bool add_reference(int from, int to);
+    bool remove_reference(int from, int to);
+
+    /**
+     * @brief Добавить корень (внешнюю ссылку) вызывающего потока
+     */
+    bool add_root(int obj_id);
+
+    /**
+     * @brief Снять корень; при нулевом счётчике — каскадное удаление
+     */
+    bool release_root(int obj_id);
+
+    /**
+     * @brief Влить счётчики объектов из очереди вызывающего потока
+     *
+     * Только для режима BIASED; освобождает объекты, у которых после
+     * слияния счётчик нулевой.
+     *
+     * @return Освобождённые объекты
+     */
+    std::size_t process_queued();
+
+    /**
+     * @brief Разобрать очереди слияния всех потоков
+     *
+     * Трогает смещённые счётчики чужих потоков: вызывать, только когда
+     * мутаторы остановлены.
+     *
+     * @return Освобождённые байты
+     */
+    std::size_t collect();
+
+    ConcurrentRCMode get_mode() const { return mode; }
+    std::size_t get_alive_objects_count() const { return alive_objects.load(); }
+    std::size_t get_total_memory() const { return used_bytes.load(); }
+    std::size_t get_heap_size_bytes() const { return heap_size_bytes; }
+
+    /**
+     * @brief Текущий счётчик объекта (смещённый + общий)
+     *
+     * Точен, только когда мутаторы остановлены.
+     *
+     * @return Счётчик, или -1 если объекта нет
+     */
+    int get_ref_count(int obj_id) const;
+
+    std::string get_heap_info() const;
+
+private:
+    /// Шард таблицы объектов; выровнен, чтобы мьютексы не делили строку кэша
+    struct alignas(64) Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<int, std::unique_ptr<ConcurrentRCObject>> objects;
+    };
+
+    /// Очередь слияния потока-владельца
+    struct MergeQueue
+    {
+        std::mutex mutex;
+        std::vector<int> ids;
+    };
+
+    const std::size_t heap_size_bytes;
+    const ConcurrentRCMode mode;
+    const std::size_t shard_count;
+    std::unique_ptr<Shard[]> shards;
+    std::atomic<int> next_object_id;
+    std::atomic<std::size_t> used_bytes;
+    std::atomic<std::size_t> alive_objects;
+
+    std::mutex queues_mutex;                    ///< Защищает queues (не содержимое)
+    std::unordered_map<int, std::unique_ptr<MergeQueue>> queues;
+
+    Shard &shard_for(int id) const { return shards[static_cast<std::size_t>(id) % shard_count]; }
+    ConcurrentRCObject *find(int id) const;
+
+    /**
+     * @brief Номер вызывающего потока (назначается при первом обращении)
+     */
+    static int current_thread();
+
+    void increment(ConcurrentRCObject &obj);
+
+    /**
+     * @brief Уменьшить счётчик
+     * @return true, если объект мёртв и его должен освободить вызывающий
+     */
+    bool decrement(ConcurrentRCObject &obj);
+
+    /**
+     * @brief Влить смещённый счётчик в общий (вызывает владелец или collect)
+     * @return true, если после слияния объект мёртв
+     */
+    bool merge(ConcurrentRCObject &obj);
+
+    void enqueue_for_owner(int owner, int id);
+
+    /**
+     * @brief Освободить объект и всё, что стало недостижимо
+     *
+     * Каскад идёт по явному стеку в вызывающем потоке.
+     *
+     * @return Освобождённые объекты
+     */
+    std::size_t release(ConcurrentRCObject *obj);
+
+    /**
+     * @brief Влить счётчики объектов из очереди
+     * @return Освобождённые объекты
+     */
+    std::size_t drain_queue(MergeQueue &queue);
+};
+
+#endif // CONCURRENT_RC_HEAP_H
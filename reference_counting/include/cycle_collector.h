@@ -0,0 +1,71 @@
+#ifndef CYCLE_COLLECTOR_H
+#define CYCLE_COLLECTOR_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "rc_object.h"
+#include "reference_counter.h"
+
+/**
+ * @class CycleCollector
+ * @brief Синхронный сборщик циклов пробным удалением (Bacon — Rajan)
+ *
+ * ReferenceCounter копит кандидатов: объекты, у которых уменьшение
+ * оставило ref_count > 0 (только так может появиться мусорный цикл).
+ * collect() обходит только подграфы, достижимые из кандидатов:
+ *
+ *   mark_gray     — пробно снять внутренние ссылки подграфа (GRAY)
+ *   scan          — у кого счётчик остался > 0, тот достижим снаружи:
+ *                   вернуть ему и всему достижимому ссылки (BLACK),
+ *                   остальные — мусор (WHITE)
+ *   collect_white — освободить WHITE
+ *
+ * Стоимость пропорциональна размеру подозрительных подграфов, а не
+ * кучи. Все обходы — по явному стеку. Корни кучи считаются внешними
+ * ссылками, даже если не входят в ref_count (режим ZCT у RCHeap).
+ */
+class CycleCollector
+{
+public:
+    CycleCollector(std::unordered_map<int, RCObject> &heap, const std::unordered_set<int> &heap_roots,
+                   ReferenceCounter &rc);
+
+    /**
+     * @brief Собрать мусорные циклы среди подграфов кандидатов
+     *
+     * Отложенная работа каскада должна быть выполнена до вызова:
+     * иначе завышенные счётчики только не дадут собрать часть циклов.
+     *
+     * @return Количество освобождённых объектов
+     */
+    std::size_t collect();
+
+    /** @brief Сколько объектов обошёл последний collect() */
+    std::size_t get_last_traced() const { return last_traced; }
+
+    /** @brief Сколько раз вызван collect() */
+    std::size_t get_runs() const { return runs; }
+
+private:
+    std::unordered_map<int, RCObject> &heap;
+    const std::unordered_set<int> &heap_roots;
+    ReferenceCounter &rc;
+    std::vector<int> roots;     ///< Кандидаты, прошедшие mark_roots
+    std::vector<int> stack;     ///< Стек обходов; ёмкость переиспользуется
+    std::vector<int> black;     ///< Стек scan_black (вложен в обход scan)
+    std::vector<int> garbage;   ///< WHITE-объекты на освобождение
+    std::size_t last_traced;
+    std::size_t runs;
+
+    RCObject *find(int id);
+
+    void mark_roots();
+    void mark_gray(int id);
+    void scan(int id);
+    void scan_black(RCObject &obj);
+    void collect_white(int id);
+};
+
+#endif // CYCLE_COLLECTOR_H
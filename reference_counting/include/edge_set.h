@@ -0,0 +1,89 @@
+#ifndef EDGE_SET_H
+#define EDGE_SET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+/**
+ * @class EdgeSet
+ * @brief Множество исходящих ссылок объекта (id целей без повторов)
+ *
+ * Цели лежат подряд в одном массиве, поэтому каскад и обходы сборщиков
+ * идут по непрерывной памяти. Первые INLINE_CAPACITY целей хранятся
+ * внутри самого объекта — у большинства объектов ссылок мало, и
+ * отдельное выделение памяти им не нужно.
+ *
+ * Пока целей не больше INDEX_THRESHOLD, поиск линейный, а удаление
+ * сохраняет порядок. Дальше строится хеш-индекс «цель → позиция»:
+ * contains(), insert() и erase() становятся O(1), а erase() переносит
+ * на место удалённой последнюю цель. Индекс снимается, когда целей
+ * становится вдвое меньше порога.
+ */
+class EdgeSet
+{
+public:
+    /// Целей, хранимых без выделения памяти
+    static const std::size_t INLINE_CAPACITY = 4;
+
+    /// Больше стольких целей — поиск по хеш-индексу
+    static const std::size_t INDEX_THRESHOLD = 32;
+
+    EdgeSet() noexcept : items(inline_items), count(0), capacity(INLINE_CAPACITY) {}
+    EdgeSet(const EdgeSet &other);
+    EdgeSet(EdgeSet &&other) noexcept;
+    EdgeSet &operator=(const EdgeSet &other);
+    EdgeSet &operator=(EdgeSet &&other) noexcept;
+    ~EdgeSet();
+
+    bool contains(int target) const;
+
+    /**
+     * @brief Добавить цель в конец
+     * @return false, если цель уже есть
+     */
+    bool insert(int target);
+
+    /**
+     * @brief Удалить цель
+     * @return false, если цели нет
+     */
+    bool erase(int target);
+
+    /**
+     * @brief Заменить содержимое целями [first, last)
+     *
+     * Повторы отбрасываются, остаётся первое вхождение: вход может
+     * прийти из файла (checkpoint), и повтор сломал бы хеш-индекс.
+     */
+    void assign(const int *first, const int *last);
+
+    void clear();
+
+    const int *begin() const { return items; }
+    const int *end() const { return items + count; }
+    int operator[](std::size_t i) const { return items[i]; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /** @brief Построен ли хеш-индекс */
+    bool is_indexed() const { return index != nullptr; }
+
+private:
+    int *items;                       ///< inline_items или массив в куче
+    uint32_t count;
+    uint32_t capacity;
+    int inline_items[INLINE_CAPACITY];
+    std::unique_ptr<std::unordered_map<int, uint32_t>> index; ///< Цель -> позиция в items
+
+    bool is_inline() const { return items == inline_items; }
+    void reserve(std::size_t min_capacity);
+
+    /** @brief assign() для заведомо уникальных целей (копия другого EdgeSet) */
+    void copy_unique(const int *first, const int *last);
+    void build_index();
+    void release_storage();
+};
+
+#endif // EDGE_SET_H
@@ -12,7 +12,9 @@ public:
 
     bool is_open() const;
     void log_allocate(int obj_id, int size = 0);
+    void log_allocate_range(int first_id, int count, int size);
     void log_add_ref(int from, int to, int ref_count);
+    void log_add_refs(size_t added, size_t failed);
     void log_remove_ref(int from, int to, int ref_count);
     void log_delete(int obj_id);
     void log_leak(int obj_id);
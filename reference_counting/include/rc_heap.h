@@ -4,11 +4,19 @@
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
+#include <chrono>
 #include <cstddef>
+#include <memory>
+#include <string>
 #include "rc_object.h"
 #include "reference_counter.h"
+#include "cycle_collector.h"
+#include "backup_tracer.h"
 #include "event_logger.h"
 #include "rc_logger.h"
+#include "heap_checkpoint.h"
+#include "gc_interface.h"
+#include "scenario_parser.h"
 
 /**
  * @struct ScenarioOp
@@ -34,9 +42,23 @@ struct ScenarioOp
  * Инкапсулирует управление памятью, добавление/удаление ссылок,
  * управление корнями (roots) и визуализацию состояния кучи.
  *
+ * Реализует GCInterface: выделение через allocate(size) выдаёт id
+ * подряд с нуля, как у Mark-Sweep, и отказывает сверх размера кучи,
+ * поэтому бенчмарки и исполнители сценариев запускают RC без особых
+ * случаев. Сценарии со своими id используют allocate_at().
+ *
  * **ВАЖНО: RC ONLY! Только объекты с ref_count == 0 удаляются!**
+ * Объекты освобождаются каскадом сразу; в отложенном режиме
+ * (set_deferred_freeing) каскад идёт порциями при выделениях и в
+ * step(), а collect() доделывает его целиком. Циклы остаются в куче,
+ * если не включён сборщик циклов (set_cycle_collection). В режиме
+ * таблицы нулевых счётчиков (set_zero_count_table) корни не входят
+ * в ref_count, а объекты с нулевым счётчиком освобождаются сверкой.
+ * В режиме слияния (set_coalescing) запись ссылок не меняет счётчики
+ * до конца эпохи. С резервной трассировкой (set_backup_tracing) циклы
+ * освобождает периодическая разметка от корней.
  */
-class RCHeap
+class RCHeap final : public GCInterface
 {
 public:
     /**
@@ -48,12 +70,118 @@ public:
     explicit RCHeap(EventLogger &logger, RCLogger &rc_logger, std::size_t heap_size_bytes = 10485760);
 
     /**
-     * @brief Выделить новый объект в куче
+     * @brief Конструктор с собственными логгерами (для фабрик коллекторов)
+     * @param heap_size_bytes Размер кучи в байтах
+     * @param log_file_path Лог RCLogger; пустой — без файла
+     */
+    explicit RCHeap(std::size_t heap_size_bytes, const std::string &log_file_path = "");
+
+    // ========== GCInterface ==========
+
+    /**
+     * @brief Выделить объект со следующим свободным id
+     * @return ID объекта, или -1, если не хватает памяти
+     */
+    int allocate(size_t size) override;
+    bool add_reference(int from_id, int to_id) override;
+    bool remove_reference(int from_id, int to_id) override;
+
+    /**
+     * @brief Выделить count объектов подряд со следующего свободного id
+     *
+     * Сборки нет, поэтому при нехватке памяти выделяется столько,
+     * сколько помещается.
+     */
+    ObjectIdRange allocate_many(size_t count, size_t size) override;
+
+    /**
+     * @brief Добавить ссылки пачкой
+     *
+     * Те же проверки, что в add_reference(), но одна запись в лог на пачку.
+     *
+     * @return Количество применённых пар (уже существующие ссылки тоже считаются)
+     */
+    size_t add_references(const ReferencePair *refs, size_t count) override;
+
+    /**
+     * @brief Выполнить всю отложенную работу: сверку ZCT, каскад и сборку циклов
+     *
+     * Без отложенного режима и сборщика циклов работы нет, и вызов
+     * учитывается в get_collection_stats() как сборка с нулевой
+     * паузой, чтобы счётчики совпадали по смыслу с Mark-Sweep.
+     *
+     * @return Освобождённые байты
+     */
+    size_t collect() override;
+
+    /** @brief Отчёт о heap'е в той же JSON-схеме, что у Mark-Sweep и Cascade Deletion */
+    std::string get_heap_info() const override;
+
+    /** @brief Записать get_heap_info() потоково */
+    void write_heap_info(HeapSnapshotWriter &writer) const;
+
+    std::string get_gc_stats() const override;
+    GCCollectionStats get_collection_stats() const override { return collection_stats; }
+    std::string get_last_operation_log() const override;
+    std::vector<std::string> get_all_logs() const override { return rc_logger.get_history(); }
+    void clear_logs() override { rc_logger.clear_history(); }
+
+    /**
+     * @brief Занятая память: размеры живых объектов в байтах
+     * @return Выделено минус освобождено каскадом
+     */
+    size_t get_total_memory() const override;
+    size_t get_free_memory() const override;
+
+    void set_current_step(int step) override { current_step = step; }
+    int get_current_step() const override { return current_step; }
+    int get_alive_objects_count() const override { return static_cast<int>(objects.size()); }
+
+    void make_root(int object_id) override { add_root(object_id); }
+    void remove_root(int object_id) override { release_root(object_id); }
+
+    /**
+     * @brief Записать полное состояние кучи в бинарном формате
+     *
+     * Формат общий с Mark-Sweep (см. heap_checkpoint.h); ref_count
+     * хранится в reference_count, корни — флагом CHECKPOINT_ROOT.
+     * Отложенная работа и журнал эпохи слияния не сохраняются (счётчики
+     * в режиме слияния отстают от ссылок): перед записью — collect().
+     * Иначе read_checkpoint() отвергнет файл: счётчик каждого объекта
+     * должен совпадать с числом входящих ссылок плюс корень.
+     * Шаг, число сборок, их суммарное время и освобождённое сохраняются;
+     * разбивка освобождённого на RC и трассировку — нет.
+     */
+    void write_checkpoint(HeapSnapshotWriter &writer) const override;
+
+    /**
+     * @brief Восстановить кучу из буфера с checkpoint'ом
+     * @return false, если данные повреждены; текущее состояние не меняется
+     */
+    bool read_checkpoint(const uint8_t *data, size_t size) override;
+
+    // ========== ВЫДЕЛЕНИЕ С ЗАДАННЫМ ID ==========
+
+    /**
+     * @brief Выделить объект с заданным id (сценарии RC)
      * @param obj_id ID выделяемого объекта
      * @param size Размер объекта в байтах (по умолчанию 8)
      * @return true, если объект успешно выделен
      */
-    bool allocate(int obj_id, size_t size = 8);
+    bool allocate_at(int obj_id, size_t size = 8);
+
+    /**
+     * @brief Выделить count объектов с id first_id..first_id+count-1
+     *
+     * Все id и место в куче проверяются одним проходом до выделения:
+     * если хоть один id занят, не помещается в int или не хватает
+     * памяти, не выделяется ничего. Одна запись в лог на всю пачку.
+     *
+     * @return Количество выделенных объектов (count или 0)
+     */
+    std::size_t allocate_many_at(int first_id, std::size_t count, std::size_t size = 8);
+
+    // ========== КОРНИ ==========
 
     /**
      * @brief Добавить объект в корни (root)
@@ -63,27 +191,11 @@ public:
     bool add_root(int obj_id);
 
     /**
-     * @brief Удалить объект из корней (root)
+     * @brief Удалить объект из корней (root); при ref_count == 0 — каскад
      * @param obj_id ID объекта для удаления из корней
      * @return true, если объект удалён из корней
      */
-    bool remove_root(int obj_id);
-
-    /**
-     * @brief Добавить ссылку от одного объекта к другому
-     * @param from ID объекта-источника
-     * @param to ID объекта-цели
-     * @return true, если ссылка успешно добавлена
-     */
-    bool add_ref(int from, int to);
-
-    /**
-     * @brief Удалить ссылку между объектами
-     * @param from ID объекта-источника
-     * @param to ID объекта-цели
-     * @return true, если ссылка успешно удалена
-     */
-    bool remove_ref(int from, int to);
+    bool release_root(int obj_id);
 
     /**
      * @brief Вывести текущее состояние кучи в консоль
@@ -92,16 +204,24 @@ public:
 
     /**
      * @brief Выполнить последовательность операций из сценария
+     *
+     * Имена операций переводятся в коды один раз, затем исполняется
+     * скомпилированный вариант.
+     *
      * @param ops Массив операций сценария
      * @param size Размер массива операций
      */
     void run_scenario(const ScenarioOp ops[], int size);
 
     /**
-     * @brief Получить количество объектов в куче
-     * @return Размер кучи
+     * @brief Выполнить скомпилированный сценарий (switch по коду операции)
+     *
+     * id берутся из сценария (allocate_at); COLLECT вызывает collect().
+     *
+     * @param ops Массив операций (ALLOCATE: a = размер, b = id)
+     * @param count Количество операций
      */
-    std::size_t get_heap_size() const { return objects.size(); }
+    void run_scenario(const CompactOp *ops, std::size_t count);
 
     /**
      * @brief Проверить, существует ли объект в куче
@@ -135,29 +255,297 @@ public:
      * @brief Получить размер кучи в байтах
      * @return Размер кучи, переданный в конструктор
      */
-    std::size_t get_heap_size_bytes() const;
+    std::size_t get_heap_size_bytes() const { return heap_size_bytes; }
+
+    /**
+     * @brief Включить/выключить логирование (файлы, консоль, вывод каскада)
+     *
+     * Для замеров: без логирования операции не строят строк.
+     */
+    void set_logging_enabled(bool enabled);
+
+    bool is_logging_enabled() const { return logging_enabled; }
+
+    // ========== ОТЛОЖЕННОЕ ОСВОБОЖДЕНИЕ ==========
+
+    /// Порция отложенной работы на одно выделение по умолчанию
+    static const std::size_t DEFAULT_DEFERRED_BUDGET = 64;
+
+    /**
+     * @brief Включить/выключить отложенное освобождение
+     *
+     * Когда ref_count падает до нуля, освобождается только сам объект,
+     * а снятие его ссылок (и освобождение детей) откладывается. Каждое
+     * выделение выполняет не больше budget_per_allocation уменьшений
+     * ref_count; при нехватке памяти отложенная работа доделывается
+     * целиком. Так пауза при сбросе большой структуры ограничена, а
+     * память детей возвращается с задержкой.
+     *
+     * При выключении накопленная работа выполняется сразу.
+     */
+    void set_deferred_freeing(bool enabled, std::size_t budget_per_allocation = DEFAULT_DEFERRED_BUDGET);
+
+    bool is_deferred_freeing() const { return rc.deferred; }
+
+    /**
+     * @brief Выполнить порцию отложенной работы
+     * @param budget Не больше стольких уменьшений ref_count
+     * @return Освобождённые байты
+     */
+    size_t step(std::size_t budget);
+
+    /**
+     * @brief Осталась ли отложенная работа
+     */
+    bool has_pending_work() const { return rc.has_pending(); }
+
+    // ========== СБОРКА ЦИКЛОВ ==========
+
+    /// Размер буфера кандидатов, при котором сборка циклов запускается сама
+    static const std::size_t DEFAULT_CYCLE_BUFFER = 4096;
+
+    /**
+     * @brief Включить/выключить сборщик циклов (см. CycleCollector)
+     *
+     * Объект становится кандидатом, когда уменьшение оставляет его
+     * ref_count > 0. Сборка циклов запускается сама, когда в буфере
+     * набирается buffer_threshold кандидатов, при нехватке памяти и
+     * из collect().
+     */
+    void set_cycle_collection(bool enabled, std::size_t buffer_threshold = DEFAULT_CYCLE_BUFFER);
+
+    bool is_cycle_collection_enabled() const { return rc.buffer_candidates; }
+
+    /**
+     * @brief Собрать циклы среди кандидатов, не трогая отложенный каскад
+     * @return Освобождённые байты
+     */
+    size_t collect_cycles();
+
+    /** @brief Кандидатов в буфере (включая устаревшие id) */
+    std::size_t get_cycle_candidates_count() const { return rc.candidates.size(); }
+
+    /** @brief Объектов, обойдённых последней сборкой циклов */
+    std::size_t get_last_cycle_traced() const { return cycles.get_last_traced(); }
+
+    // ========== ТАБЛИЦА НУЛЕВЫХ СЧЁТЧИКОВ ==========
+
+    /// Размер ZCT, при котором сверка запускается сама
+    static const std::size_t DEFAULT_ZCT_THRESHOLD = 4096;
+
+    /**
+     * @brief Включить/выключить отложенный подсчёт ссылок с ZCT (Deutsch — Bobrow)
+     *
+     * Корни не входят в ref_count: add_root()/release_root() только
+     * меняют множество корней. Объект, у которого счётчик стал нулевым
+     * (в том числе только что выделенный), не освобождается, а попадает
+     * в таблицу нулевых счётчиков. Сверка (reconcile) освобождает записи
+     * ZCT, которые не являются корнями, и каскадом — то, что стало
+     * недостижимо. Так освобождаются и объекты, на которые никогда не
+     * ссылались. Сверка запускается сама, когда в ZCT набирается
+     * threshold записей, при нехватке памяти и из collect().
+     *
+     * При включении счётчики корней уменьшаются на единицу, при
+     * выключении — сначала сверка, затем счётчики корней восстанавливаются.
+     * Checkpoint всегда хранит счётчики с учётом корней.
+     */
+    void set_zero_count_table(bool enabled, std::size_t threshold = DEFAULT_ZCT_THRESHOLD);
+
+    bool is_zero_count_table() const { return rc.zero_count_table; }
+
+    /**
+     * @brief Сверить ZCT с корнями и освободить мёртвые записи
+     * @return Освобождённые байты
+     */
+    size_t reconcile();
+
+    /** @brief Записей в ZCT (включая устаревшие id) */
+    std::size_t get_zct_size() const { return rc.zct.size(); }
+
+    // ========== СЛИЯНИЕ ОБНОВЛЕНИЙ СЧЁТЧИКОВ ==========
+
+    /// Объектов в журнале эпохи, при котором эпоха заканчивается сама
+    static const std::size_t DEFAULT_EPOCH_BUFFER = 4096;
+
+    /**
+     * @brief Включить/выключить слияние обновлений ref_count (Levanoni — Petrank)
+     *
+     * Запись или снятие ссылки меняет только список ссылок источника;
+     * первое изменение объекта в эпохе запоминает его прежние ссылки.
+     * В конце эпохи ref_count меняется на чистую разницу, поэтому поле,
+     * перезаписанное много раз, стоит одного уменьшения и одного
+     * увеличения. Решения об освобождении тоже ждут конца эпохи.
+     * Эпоха заканчивается, когда в журнале набирается buffer_threshold
+     * объектов, при нехватке памяти, в end_epoch() и перед любой
+     * сборкой (collect, сверка ZCT, сборка циклов).
+     *
+     * При выключении текущая эпоха завершается.
+     */
+    void set_coalescing(bool enabled, std::size_t buffer_threshold = DEFAULT_EPOCH_BUFFER);
+
+    bool is_coalescing() const { return rc.coalescing; }
+
+    /**
+     * @brief Завершить эпоху: применить журнал и освободить обнулённое
+     * @return Освобождённые байты
+     */
+    size_t end_epoch();
+
+    /** @brief Объектов в журнале текущей эпохи */
+    std::size_t get_epoch_log_size() const { return rc.modified.size(); }
+
+    /** @brief Изменений ref_count от записи ссылок за всё время */
+    std::size_t get_count_updates() const { return rc.count_updates; }
+
+    // ========== РЕЗЕРВНАЯ ТРАССИРОВКА ==========
+
+    /// Выделено байт, после которых трассировка запускается сама
+    static const std::size_t DEFAULT_TRACE_INTERVAL = 1048576;
+
+    /**
+     * @brief Включить/выключить резервную трассировку (см. BackupTracer)
+     *
+     * Гибрид RC и Mark-Sweep: каскад по-прежнему освобождает объекты
+     * сразу, а трассировка от корней собирает мусорные циклы и
+     * пересчитывает счётчики живых объектов. Она запускается сама после
+     * каждых interval_bytes выделенных байт, при нехватке памяти и из
+     * collect(); перед ней доделывается вся отложенная работа (каскад,
+     * эпоха слияния, сверка ZCT), так что в отложенном режиме такая
+     * сборка не ограничена порцией.
+     */
+    void set_backup_tracing(bool enabled, std::size_t interval_bytes = DEFAULT_TRACE_INTERVAL);
+
+    bool is_backup_tracing() const { return backup_tracing; }
+
+    /**
+     * @brief Доделать отложенную работу и выполнить трассировку сейчас
+     * @return Освобождённые байты (каскадом и трассировкой); 0, если
+     *         резервная трассировка выключена
+     */
+    size_t backup_trace();
+
+    /** @brief Сколько раз выполнена трассировка */
+    std::size_t get_backup_traces() const { return tracer.get_runs(); }
+
+    /** @brief Освобождено трассировкой (с последнего restore) */
+    std::size_t get_traced_freed_bytes() const { return tracer.get_freed_bytes(); }
+
+    /**
+     * @brief Освобождено подсчётом ссылок: каскадом, сверкой ZCT и сборщиком циклов
+     *
+     * После restore сюда входит и освобождённое трассировкой до записи checkpoint'а.
+     */
+    std::size_t get_rc_freed_bytes() const { return rc.freed_bytes - tracer.get_freed_bytes(); }
 
-    // ========== СОВМЕСТИМОСТЬ С MAIN.CPP ==========
-    // Методы без подчёркивания для старого кода
+    /** @brief Живых объектов, у которых трассировка исправила ref_count */
+    std::size_t get_repaired_counts() const { return tracer.get_repaired_counts(); }
 
-    bool addroot(int obj_id);
-    bool removeroot(int obj_id);
-    bool addref(int from, int to);
-    bool removeref(int from, int to);
-    int getrefcount(int obj_id) const;
-    bool objectexists(int obj_id) const;
-    std::size_t getheapsize() const;
-    std::size_t getrootscount() const;
+    // ========== CHECKPOINT ==========
+
+    /**
+     * @brief Сохранить checkpoint в файл
+     */
+    bool save_checkpoint(const std::string &path) const;
+
+    /**
+     * @brief Загрузить checkpoint из файла (через mmap)
+     */
+    bool load_checkpoint(const std::string &path);
 
 private:
+    std::unique_ptr<EventLogger> owned_logger;    ///< Логгеры второго конструктора;
+    std::unique_ptr<RCLogger> owned_rc_logger;    ///< объявлены до ссылок на них
     std::size_t heap_size_bytes;                  ///< Размер кучи в байтах
+    std::size_t allocated_bytes;                  ///< Выделено за всё время (с последнего restore)
+    bool logging_enabled;                         ///< Логировать операции
+    int next_object_id;                           ///< Следующий id для allocate(size)
+    int current_step;                             ///< Шаг симуляции (GCInterface)
+    std::size_t deferred_budget;                  ///< Порция отложенной работы на выделение
+    std::size_t cycle_threshold;                  ///< Порог буфера кандидатов
+    std::size_t zct_threshold;                    ///< Порог роста ZCT
+    std::size_t zct_retained;                     ///< Записей в ZCT после прошлой сверки (корни)
+    std::size_t epoch_threshold;                  ///< Порог журнала эпохи слияния
+    bool backup_tracing;                          ///< Резервная трассировка включена
+    std::size_t trace_interval;                   ///< Байт выделений между трассировками
+    std::size_t allocated_at_trace;               ///< allocated_bytes на момент прошлой трассировки
+    GCCollectionStats collection_stats;           ///< Вызовы collect() и паузы
     std::unordered_map<int, RCObject> objects;    ///< Куча объектов
-    std::unordered_map<int, size_t> object_sizes; ///< Размеры объектов
     std::unordered_set<int> roots;                ///< Корни (root объекты)
     ReferenceCounter rc;                          ///< Управление ссылками
+    CycleCollector cycles;                        ///< Сборщик циклов (после rc и roots)
+    BackupTracer tracer;                          ///< Резервная трассировка (после rc и roots)
+    std::vector<int> zct_scan;                    ///< Записи ZCT текущего прохода сверки
     EventLogger &logger;                          ///< Логгер событий
     RCLogger &rc_logger;                          ///< RC-специфичный логгер
 
+    /**
+     * @brief Сборка: отложенный каскад (если drain), циклы и трассировка; учитывается в статистике
+     *
+     * Трассировка — только при drain: ей нужна доделанная отложенная работа.
+     *
+     * @param triggered Запущено самой кучей (порог буфера, нехватка памяти)
+     * @return Освобождённые байты
+     */
+    size_t run_collection(bool drain, bool triggered);
+
+    /**
+     * @brief Учесть сборку, начатую в start, в collection_stats
+     */
+    void record_pause(std::chrono::high_resolution_clock::time_point start, bool triggered);
+
+    /**
+     * @brief Сверка ZCT без учёта в статистике
+     * @param drain_children Доделывать каскад и сверять освободившихся детей
+     * @return Освобождённые объекты
+     */
+    std::size_t reconcile_zct(bool drain_children);
+
+    /**
+     * @brief Сверить ZCT, если она достигла порога
+     */
+    void maybe_reconcile();
+
+    /**
+     * @brief Конец эпохи слияния без учёта в статистике
+     *
+     * Без ZCT обнулённые за эпоху объекты, которые не являются
+     * корнями, тут же освобождаются каскадом.
+     */
+    void flush_updates();
+
+    /**
+     * @brief Завершить эпоху, если журнал достиг порога
+     */
+    void maybe_end_epoch();
+
+    /**
+     * @brief Собрать циклы, если буфер кандидатов достиг порога
+     */
+    void maybe_collect_cycles();
+
+    /**
+     * @brief Трассировать, если с прошлой трассировки выделено trace_interval байт
+     */
+    void maybe_backup_trace();
+
+    /**
+     * @brief Порция отложенной работы перед выделением и проверка места
+     * @return true, если bytes помещаются в кучу
+     */
+    bool reserve_memory(std::size_t bytes);
+
+    /**
+     * @brief Проверить, что id first_id..first_id+count-1 допустимы и свободны
+     * @param count Не меньше 1
+     */
+    bool check_id_range(int first_id, std::size_t count) const;
+
+    /**
+     * @brief Создать объекты проверенного диапазона, место уже зарезервировано
+     * @return count
+     */
+    std::size_t emplace_range(int first_id, std::size_t count, std::size_t size);
+
     /**
      * @brief Получить объект по ID (внутренняя функция)
      * @param obj_id ID объекта
@@ -173,4 +561,4 @@ private:
     const RCObject *get_object(int obj_id) const;
 };
 
-#endif // RC_HEAP_H
\ No newline at end of file
+#endif // RC_HEAP_H
@@ -5,6 +5,7 @@
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <vector>
 
 /**
  * @class RCLogger
@@ -24,6 +25,7 @@ class RCLogger
 private:
     std::ofstream log_file;
     int current_step;
+    std::vector<std::string> history;   // Записанные операции (без номера шага)
 
 public:
     /**
@@ -106,6 +108,16 @@ public:
      */
     void increment_step() { current_step++; }
 
+    /**
+     * @brief Все записанные операции с создания или clear_history()
+     */
+    const std::vector<std::string>& get_history() const { return history; }
+
+    /**
+     * @brief Забыть записанные операции (файл не меняется)
+     */
+    void clear_history() { history.clear(); }
+
     /**
      * @brief Проверить, открыт ли файл
      * @return true если файл открыт
@@ -1,15 +1,31 @@
 #ifndef RC_OBJECT_H
 #define RC_OBJECT_H
 
-#include <vector>
-#include <algorithm>
+#include "edge_set.h"
+
+/**
+ * @brief Цвет объекта для сборщика циклов (Bacon — Rajan)
+ *
+ * BLACK — используется, GRAY — возможный член мусорного цикла,
+ * WHITE — мусор, PURPLE — возможный корень цикла.
+ */
+enum class RCColor : unsigned char {
+    BLACK,
+    GRAY,
+    WHITE,
+    PURPLE
+};
 
 struct RCObject {
     int id;
     int ref_count = 0;
     int size = 0;
-    std::vector<int> references;
+    EdgeSet references;          // Исходящие ссылки; поиск O(1) у больших объектов
     bool marked = false;
+    RCColor color = RCColor::BLACK;
+    bool buffered = false;       // Лежит в буфере кандидатов сборщика циклов
+    bool in_zct = false;         // Лежит в таблице нулевых счётчиков
+    bool logged = false;         // Ссылки уже менялись в текущей эпохе слияния
 
     RCObject() : id(-1), ref_count(0), size(0), marked(false) {}
     
@@ -17,24 +33,15 @@ struct RCObject {
         : id(id_), ref_count(0), size(size_), marked(false) {}
 
     bool has_reference_to(int target_id) const {
-        return std::find(references.begin(), references.end(), target_id) != references.end();
+        return references.contains(target_id);
     }
 
     bool add_outgoing_ref(int target_id) {
-        if (!has_reference_to(target_id)) {
-            references.push_back(target_id);
-            return true;
-        }
-        return false;
+        return references.insert(target_id);
     }
 
     bool remove_outgoing_ref(int target_id) {
-        auto it = std::find(references.begin(), references.end(), target_id);
-        if (it != references.end()) {
-            references.erase(it);
-            return true;
-        }
-        return false;
+        return references.erase(target_id);
     }
 
     size_t get_outgoing_count() const {
@@ -1,7 +1,9 @@
 #ifndef REFERENCE_COUNTER_H
 #define REFERENCE_COUNTER_H
 
+#include <cstddef>
 #include <unordered_map>
+#include <vector>
 #include "rc_object.h"
 #include "event_logger.h"
 
@@ -11,15 +13,131 @@ public:
     ReferenceCounter(std::unordered_map<int, RCObject> &heap, EventLogger &logger);
 
     bool add_ref(int from, int to);
+    /**
+     * @brief Снять ссылку from -> to без каскада
+     *
+     * Обнулённый объект не освобождается: каскад запускает
+     * вызывающий (RCHeap::remove_ref).
+     */
     bool remove_ref(int from, int to);
+
+    /**
+     * @brief Удалить объект с ref_count == 0 и всё, что стало недостижимо
+     *
+     * Сам объект удаляется сразу, его исходящие ссылки становятся
+     * отложенной работой. Без отложенного режима работа выполняется
+     * тут же целиком; в отложенном — порциями в process_pending().
+     * Обход идёт по явному стеку, а не рекурсией: глубина цепи не
+     * ограничена стеком потока.
+     */
     void cascade_delete(int obj_id);
-    bool remove_ref_no_cascade(int from, int to);
+
+    /**
+     * @brief Выполнить отложенную работу каскада
+     * @param budget Не больше стольких уменьшений ref_count
+     * @return Сколько уменьшений выполнено
+     */
+    std::size_t process_pending(std::size_t budget);
+
+    /**
+     * @brief Есть ли невыполненная работа каскада
+     */
+    bool has_pending() const { return !pending.empty(); }
+
+    /**
+     * @brief Уменьшение оставило ref_count > 0: объект — возможный корень цикла
+     *
+     * Объект красится в PURPLE и, если ещё не в буфере, добавляется
+     * в candidates. Без сборщика циклов (buffer_candidates == false)
+     * ничего не делает.
+     */
+    void possible_root(RCObject &obj);
+
+    /**
+     * @brief Счётчик объекта стал нулевым в режиме таблицы нулевых счётчиков
+     *
+     * Объект не освобождается, а попадает в zct (если ещё не там):
+     * корни не входят в ref_count, и решить, жив ли он, может только
+     * сверка с корнями (RCHeap::reconcile).
+     */
+    void zero_count(RCObject &obj);
+
+    /**
+     * @brief Первое изменение ссылок объекта в эпохе: запомнить старые ссылки
+     *
+     * Повторные изменения в той же эпохе не пишутся в журнал и не
+     * трогают ref_count (Levanoni — Petrank).
+     */
+    void log_modification(RCObject &obj);
+
+    /**
+     * @brief Конец эпохи слияния: применить чистую разницу ссылок
+     *
+     * Для каждого объекта из журнала сравниваются ссылки на начало
+     * эпохи и текущие; ref_count меняется только у целей, которые
+     * появились или пропали. Сначала все увеличения, затем уменьшения,
+     * чтобы перенесённая ссылка не обнулила счётчик по пути. Обнулённые
+     * объекты попадают в zct — освобождает их RCHeap.
+     */
+    void apply_coalesced();
 
 private:
     std::unordered_map<int, RCObject> &heap;
     EventLogger &logger;
+    bool logging_enabled = true;   ///< Лог событий и вывод каскада в консоль
+    std::size_t freed_objects = 0; ///< Удалено каскадом за всё время
+    std::size_t freed_bytes = 0;   ///< Освобождено каскадом (RCObject::size)
+    bool deferred = false;         ///< Не выполнять каскад сразу (см. process_pending)
+    bool buffer_candidates = false; ///< Копить кандидатов для сборщика циклов
+    std::vector<int> candidates;   ///< Возможные корни циклов (id могут устареть)
+    bool zero_count_table = false; ///< Нулевой счётчик — в zct, а не освобождение
+    std::vector<int> zct;          ///< Таблица нулевых счётчиков и обнуления, ждущие конца эпохи
+    bool coalescing = false;       ///< Копить изменения ссылок до конца эпохи
+    std::size_t count_updates = 0; ///< Изменений ref_count от записи ссылок
+
+    /**
+     * @brief Освобождённый объект, ссылки которого ещё не сняты
+     *
+     * Список ссылок переносится из объекта без копирования; next —
+     * первая ещё не обработанная ссылка, так что большой объект
+     * обрабатывается по частям.
+     */
+    struct PendingFrame
+    {
+        int id;
+        EdgeSet children;
+        std::size_t next;
+    };
+
+    /**
+     * @brief Запись журнала эпохи: ссылки объекта до первого изменения
+     */
+    struct ModifiedEntry
+    {
+        int id;
+        std::vector<int> old_references;
+    };
+
+    std::vector<ModifiedEntry> modified; ///< Журнал изменённых объектов эпохи
+    std::vector<int> current_refs;       ///< Рабочие буферы apply_coalesced()
+    std::vector<int> decrements;
+
+    std::vector<PendingFrame> pending; ///< Стек каскада; ёмкость переиспользуется
+    std::vector<std::unordered_map<int, RCObject>::iterator> dead; ///< Пачка на удаление
+
+    /**
+     * @brief Учесть объект как освобождённый и положить его ссылки в pending
+     */
+    void free_object(std::unordered_map<int, RCObject>::iterator it);
+
+    /**
+     * @brief Удалить накопленную пачку из heap
+     */
+    void erase_dead();
 
     friend class RCHeap;
+    friend class CycleCollector;
+    friend class BackupTracer;
 };
 
 #endif
@@ -0,0 +1,134 @@
+#include "backup_tracer.h"
+#include <iostream>
+
+BackupTracer::BackupTracer(std::unordered_map<int, RCObject> &heap_, const std::unordered_set<int> &heap_roots_,
+                           ReferenceCounter &rc_)
+    : heap(heap_), heap_roots(heap_roots_), rc(rc_), runs(0), last_marked(0), freed_objects(0), freed_bytes(0),
+      repaired_counts(0) {}
+
+std::size_t BackupTracer::collect()
+{
+    runs++;
+    mark_from_roots();
+    recount();
+    return sweep();
+}
+
+void BackupTracer::mark_from_roots()
+{
+    // marked восстанавливается из checkpoint'а — начинаем с чистой разметки
+    for (auto &entry : heap)
+    {
+        entry.second.marked = false;
+    }
+
+    last_marked = 0;
+    for (int root : heap_roots)
+    {
+        auto it = heap.find(root);
+        if (it == heap.end() || it->second.marked)
+        {
+            continue;
+        }
+        it->second.marked = true;
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            RCObject &obj = heap.find(stack.back())->second;
+            stack.pop_back();
+            last_marked++;
+            for (int child : obj.references)
+            {
+                auto child_it = heap.find(child);
+                if (child_it != heap.end() && !child_it->second.marked)
+                {
+                    child_it->second.marked = true;
+                    stack.push_back(child);
+                }
+            }
+        }
+    }
+}
+
+void BackupTracer::recount()
+{
+    // Между проходами heap не меняется, поэтому порядок обхода один и
+    // тот же, и old_counts сопоставляется с объектами по позиции
+    old_counts.clear();
+    garbage.clear();
+    for (auto it = heap.begin(); it != heap.end(); ++it)
+    {
+        RCObject &obj = it->second;
+        if (!obj.marked)
+        {
+            garbage.push_back(it);
+            continue;
+        }
+        old_counts.push_back(obj.ref_count);
+        obj.ref_count = (!rc.zero_count_table && heap_roots.count(obj.id) > 0) ? 1 : 0;
+    }
+
+    // Ссылки мусора на живые объекты в счётчики не входят
+    for (auto &entry : heap)
+    {
+        if (!entry.second.marked)
+        {
+            continue;
+        }
+        for (int child : entry.second.references)
+        {
+            heap.find(child)->second.ref_count++;
+        }
+    }
+
+    std::size_t position = 0;
+    for (auto &entry : heap)
+    {
+        RCObject &obj = entry.second;
+        if (!obj.marked)
+        {
+            continue;
+        }
+        obj.marked = false;
+        int old_count = old_counts[position++];
+        if (obj.ref_count != old_count)
+        {
+            repaired_counts++;
+            if (rc.logging_enabled)
+            {
+                std::cout << "  [TRACE] Repaired ref_count of obj_" << obj.id << " (" << old_count << " -> "
+                          << obj.ref_count << ")" << std::endl;
+            }
+        }
+        // Живой объект с нулевым счётчиком в режиме ZCT — корень: ждёт в таблице
+        if (obj.ref_count == 0 && rc.zero_count_table)
+        {
+            rc.zero_count(obj);
+        }
+    }
+}
+
+std::size_t BackupTracer::sweep()
+{
+    // Ссылки мусора уже не в счётчиках живых: освобождение без каскада
+    for (auto it : garbage)
+    {
+        RCObject &obj = it->second;
+        freed_objects++;
+        freed_bytes += static_cast<std::size_t>(obj.size);
+        rc.freed_objects++;
+        rc.freed_bytes += static_cast<std::size_t>(obj.size);
+        if (rc.logging_enabled)
+        {
+            rc.logger.log_delete(obj.id);
+            std::cout << "  [TRACE] Deleted obj_" << obj.id << " (" << obj.size << " bytes)" << std::endl;
+        }
+    }
+    for (auto it : garbage)
+    {
+        heap.erase(it);
+    }
+    std::size_t freed = garbage.size();
+    garbage.clear();
+    return freed;
+}
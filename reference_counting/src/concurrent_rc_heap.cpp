@@ -0,0 +1,376 @@
+#include "concurrent_rc_heap.h"
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+ConcurrentRCHeap::ConcurrentRCHeap(std::size_t heap_size_bytes_, ConcurrentRCMode mode_, std::size_t shard_count_)
+    : heap_size_bytes(heap_size_bytes_),
+      mode(mode_),
+      shard_count(std::max<std::size_t>(shard_count_, 1)),
+      shards(new Shard[std::max<std::size_t>(shard_count_, 1)]),
+      next_object_id(0),
+      used_bytes(0),
+      alive_objects(0) {}
+
+ConcurrentRCHeap::~ConcurrentRCHeap() = default;
+
+int ConcurrentRCHeap::current_thread()
+{
+    static std::atomic<int> next_thread{0};
+    thread_local int thread_id = next_thread.fetch_add(1);
+    return thread_id;
+}
+
+ConcurrentRCObject *ConcurrentRCHeap::find(int id) const
+{
+    Shard &shard = shard_for(id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.objects.find(id);
+    return it != shard.objects.end() ? it->second.get() : nullptr;
+}
+
+// ============================================
+// ВЫДЕЛЕНИЕ И ССЫЛКИ
+// ============================================
+
+int ConcurrentRCHeap::allocate(std::size_t size)
+{
+    std::size_t used = used_bytes.load(std::memory_order_relaxed);
+    do
+    {
+        if (size > heap_size_bytes - std::min(used, heap_size_bytes))
+        {
+            std::cerr << "Error: Out of memory allocating " << size << " bytes\n";
+            return -1;
+        }
+    } while (!used_bytes.compare_exchange_weak(used, used + size, std::memory_order_relaxed));
+
+    int id = next_object_id.fetch_add(1, std::memory_order_relaxed);
+    auto obj = std::make_unique<ConcurrentRCObject>(id, static_cast<int>(size));
+    // Единственная ссылка — корень выделившего потока
+    if (mode == ConcurrentRCMode::BIASED)
+    {
+        obj->owner = current_thread();
+        obj->biased = true;
+        obj->biased_count = 1;
+    }
+    else
+    {
+        obj->state.store(ConcurrentRCObject::ONE | ConcurrentRCObject::MERGED, std::memory_order_relaxed);
+    }
+
+    Shard &shard = shard_for(id);
+    {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.objects.emplace(id, std::move(obj));
+    }
+    alive_objects.fetch_add(1, std::memory_order_relaxed);
+    return id;
+}
+
+bool ConcurrentRCHeap::add_reference(int from, int to)
+{
+    if (from == to)
+    {
+        std::cerr << "Error: Self-reference not allowed\n";
+        return false;
+    }
+    ConcurrentRCObject *src = find(from);
+    ConcurrentRCObject *dst = find(to);
+    if (!src || !dst)
+    {
+        std::cerr << "Error: Object " << (src ? to : from) << " does not exist\n";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(src->references_mutex);
+        if (std::find(src->references.begin(), src->references.end(), to) != src->references.end())
+        {
+            return false;
+        }
+        src->references.push_back(to);
+    }
+    increment(*dst);
+    return true;
+}
+
+bool ConcurrentRCHeap::remove_reference(int from, int to)
+{
+    ConcurrentRCObject *src = find(from);
+    ConcurrentRCObject *dst = find(to);
+    if (!src || !dst)
+    {
+        std::cerr << "Error: Object " << (src ? to : from) << " does not exist\n";
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(src->references_mutex);
+        auto it = std::find(src->references.begin(), src->references.end(), to);
+        if (it == src->references.end())
+        {
+            return false;
+        }
+        src->references.erase(it);
+    }
+    if (decrement(*dst))
+    {
+        release(dst);
+    }
+    return true;
+}
+
+bool ConcurrentRCHeap::add_root(int obj_id)
+{
+    ConcurrentRCObject *obj = find(obj_id);
+    if (!obj)
+    {
+        std::cerr << "Error: Object " << obj_id << " does not exist\n";
+        return false;
+    }
+    increment(*obj);
+    return true;
+}
+
+bool ConcurrentRCHeap::release_root(int obj_id)
+{
+    ConcurrentRCObject *obj = find(obj_id);
+    if (!obj)
+    {
+        std::cerr << "Error: Object " << obj_id << " does not exist\n";
+        return false;
+    }
+    if (decrement(*obj))
+    {
+        release(obj);
+    }
+    return true;
+}
+
+// ============================================
+// СЧЁТЧИКИ
+// ============================================
+
+void ConcurrentRCHeap::increment(ConcurrentRCObject &obj)
+{
+    if (obj.owner == current_thread() && obj.biased)
+    {
+        obj.biased_count++;
+        return;
+    }
+    // Увеличение ничего не публикует: вызывающий уже держит ссылку
+    obj.state.fetch_add(ConcurrentRCObject::ONE, std::memory_order_relaxed);
+}
+
+bool ConcurrentRCHeap::decrement(ConcurrentRCObject &obj)
+{
+    if (obj.owner == current_thread() && obj.biased)
+    {
+        if (--obj.biased_count > 0)
+        {
+            return false;
+        }
+        // Владелец снял последнюю свою ссылку — дальше только общий счётчик
+        return merge(obj);
+    }
+
+    // acq_rel: поток, который освободит объект, должен видеть все
+    // изменения, сделанные до уменьшений в других потоках
+    int64_t old_state = obj.state.load(std::memory_order_relaxed);
+    int64_t new_state;
+    bool queue = false;
+    do
+    {
+        new_state = old_state - ConcurrentRCObject::ONE;
+        queue = !(old_state & (ConcurrentRCObject::MERGED | ConcurrentRCObject::QUEUED)) &&
+                (new_state >> 2) < 0;
+        if (queue)
+        {
+            new_state |= ConcurrentRCObject::QUEUED;
+        }
+    } while (!obj.state.compare_exchange_weak(old_state, new_state, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+
+    if (queue)
+    {
+        enqueue_for_owner(obj.owner, obj.id);
+    }
+    return (new_state & ConcurrentRCObject::MERGED) && (new_state >> 2) == 0;
+}
+
+bool ConcurrentRCHeap::merge(ConcurrentRCObject &obj)
+{
+    int64_t biased = static_cast<int64_t>(obj.biased_count) * ConcurrentRCObject::ONE;
+    obj.biased = false;
+    obj.biased_count = 0;
+
+    int64_t old_state = obj.state.load(std::memory_order_relaxed);
+    int64_t new_state;
+    do
+    {
+        new_state = (old_state + biased) | ConcurrentRCObject::MERGED;
+    } while (!obj.state.compare_exchange_weak(old_state, new_state, std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+    return (new_state >> 2) == 0;
+}
+
+void ConcurrentRCHeap::enqueue_for_owner(int owner, int id)
+{
+    std::lock_guard<std::mutex> lock(queues_mutex);
+    std::unique_ptr<MergeQueue> &queue = queues[owner];
+    if (!queue)
+    {
+        queue = std::make_unique<MergeQueue>();
+    }
+    std::lock_guard<std::mutex> queue_lock(queue->mutex);
+    queue->ids.push_back(id);
+}
+
+// ============================================
+// ОСВОБОЖДЕНИЕ
+// ============================================
+
+std::size_t ConcurrentRCHeap::release(ConcurrentRCObject *obj)
+{
+    // Объект с нулевым счётчиком недостижим: никто, кроме этого потока,
+    // его больше не трогает
+    std::size_t freed = 0;
+    std::vector<ConcurrentRCObject *> stack{obj};
+    while (!stack.empty())
+    {
+        ConcurrentRCObject *current = stack.back();
+        stack.pop_back();
+
+        std::unique_ptr<ConcurrentRCObject> owned;
+        Shard &shard = shard_for(current->id);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.objects.find(current->id);
+            owned = std::move(it->second);
+            shard.objects.erase(it);
+        }
+        used_bytes.fetch_sub(static_cast<std::size_t>(owned->size), std::memory_order_relaxed);
+        alive_objects.fetch_sub(1, std::memory_order_relaxed);
+        freed++;
+
+        // Ссылка освобождаемого объекта держит ребёнка живым до уменьшения
+        for (int child : owned->references)
+        {
+            ConcurrentRCObject *target = find(child);
+            if (target && decrement(*target))
+            {
+                stack.push_back(target);
+            }
+        }
+    }
+    return freed;
+}
+
+std::size_t ConcurrentRCHeap::drain_queue(MergeQueue &queue)
+{
+    std::vector<int> ids;
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        ids.swap(queue.ids);
+    }
+
+    std::size_t freed = 0;
+    for (int id : ids)
+    {
+        // Уже слитый объект могут освободить другие потоки — biased
+        // читается под мьютексом шарда, пока объект точно в таблице.
+        // Неслитый не освобождает никто, кроме владельца.
+        ConcurrentRCObject *dead = nullptr;
+        Shard &shard = shard_for(id);
+        {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            auto it = shard.objects.find(id);
+            if (it != shard.objects.end() && it->second->biased && merge(*it->second))
+            {
+                dead = it->second.get();
+            }
+        }
+        if (dead)
+        {
+            freed += release(dead);
+        }
+    }
+    return freed;
+}
+
+std::size_t ConcurrentRCHeap::process_queued()
+{
+    MergeQueue *queue = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(queues_mutex);
+        auto it = queues.find(current_thread());
+        if (it == queues.end())
+        {
+            return 0;
+        }
+        queue = it->second.get();
+    }
+    return drain_queue(*queue);
+}
+
+std::size_t ConcurrentRCHeap::collect()
+{
+    // Каскад из одной очереди ставит объекты в уже разобранные очереди
+    // других владельцев — повторять, пока проход что-то находит
+    std::size_t used_before = used_bytes.load();
+    bool progress = true;
+    while (progress)
+    {
+        std::vector<MergeQueue *> all;
+        {
+            std::lock_guard<std::mutex> lock(queues_mutex);
+            for (auto &entry : queues)
+            {
+                all.push_back(entry.second.get());
+            }
+        }
+        progress = false;
+        for (MergeQueue *queue : all)
+        {
+            bool pending;
+            {
+                std::lock_guard<std::mutex> lock(queue->mutex);
+                pending = !queue->ids.empty();
+            }
+            if (pending)
+            {
+                drain_queue(*queue);
+                progress = true;
+            }
+        }
+    }
+    return used_before - used_bytes.load();
+}
+
+// ============================================
+// СОСТОЯНИЕ
+// ============================================
+
+int ConcurrentRCHeap::get_ref_count(int obj_id) const
+{
+    Shard &shard = shard_for(obj_id);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.objects.find(obj_id);
+    if (it == shard.objects.end())
+    {
+        return -1;
+    }
+    const ConcurrentRCObject &obj = *it->second;
+    return obj.biased_count + static_cast<int>(obj.state.load() >> 2);
+}
+
+std::string ConcurrentRCHeap::get_heap_info() const
+{
+    std::ostringstream oss;
+    oss << "Concurrent RC heap (" << (mode == ConcurrentRCMode::BIASED ? "biased" : "atomic") << "): "
+        << get_alive_objects_count() << " objects, "
+        << get_total_memory() << " / " << heap_size_bytes << " bytes, "
+        << shard_count << " shards";
+    return oss.str();
+}
@@ -0,0 +1,186 @@
+#include "cycle_collector.h"
+#include <iostream>
+
+CycleCollector::CycleCollector(std::unordered_map<int, RCObject> &heap_, const std::unordered_set<int> &heap_roots_,
+                               ReferenceCounter &rc_)
+    : heap(heap_), heap_roots(heap_roots_), rc(rc_), last_traced(0), runs(0) {}
+
+RCObject *CycleCollector::find(int id)
+{
+    auto it = heap.find(id);
+    return it != heap.end() ? &it->second : nullptr;
+}
+
+std::size_t CycleCollector::collect()
+{
+    runs++;
+    last_traced = 0;
+
+    mark_roots();
+    for (int id : roots)
+    {
+        scan(id);
+    }
+
+    // Кандидат снимается с буфера до collect_white: WHITE-объекты,
+    // ещё лежащие в буфере, собираются, когда до них дойдёт очередь
+    garbage.clear();
+    for (int id : roots)
+    {
+        RCObject *obj = find(id);
+        if (obj)
+        {
+            obj->buffered = false;
+            collect_white(id);
+        }
+    }
+    roots.clear();
+
+    // Ссылки WHITE-объектов сняты ещё в mark_gray: освобождение без каскада
+    for (int id : garbage)
+    {
+        auto it = heap.find(id);
+        RCObject &obj = it->second;
+        rc.freed_objects++;
+        rc.freed_bytes += static_cast<std::size_t>(obj.size);
+        if (rc.logging_enabled)
+        {
+            rc.logger.log_delete(id);
+            std::cout << "  [CYCLE] Deleted obj_" << id << " (" << obj.size << " bytes)" << std::endl;
+        }
+        heap.erase(it);
+    }
+    return garbage.size();
+}
+
+void CycleCollector::mark_roots()
+{
+    roots.clear();
+    for (int id : rc.candidates)
+    {
+        // id устаревает, если объект освобождён каскадом (и, возможно,
+        // id занят новым объектом — у него buffered == false)
+        RCObject *obj = find(id);
+        if (!obj || !obj->buffered)
+        {
+            continue;
+        }
+        if (obj->color == RCColor::PURPLE && obj->ref_count > 0)
+        {
+            mark_gray(id);
+            roots.push_back(id);
+        }
+        else
+        {
+            obj->buffered = false;
+        }
+    }
+    rc.candidates.clear();
+}
+
+void CycleCollector::mark_gray(int id)
+{
+    RCObject *start = find(id);
+    if (!start || start->color == RCColor::GRAY)
+    {
+        return;
+    }
+    start->color = RCColor::GRAY;
+    stack.push_back(id);
+    while (!stack.empty())
+    {
+        RCObject &obj = heap.find(stack.back())->second;
+        stack.pop_back();
+        last_traced++;
+        for (int child : obj.references)
+        {
+            RCObject *target = find(child);
+            if (!target)
+            {
+                continue;
+            }
+            target->ref_count--;
+            if (target->color != RCColor::GRAY)
+            {
+                target->color = RCColor::GRAY;
+                stack.push_back(child);
+            }
+        }
+    }
+}
+
+void CycleCollector::scan(int id)
+{
+    stack.push_back(id);
+    while (!stack.empty())
+    {
+        RCObject *obj = find(stack.back());
+        stack.pop_back();
+        if (!obj || obj->color != RCColor::GRAY)
+        {
+            continue;
+        }
+        if (obj->ref_count > 0 || heap_roots.count(obj->id) > 0)
+        {
+            scan_black(*obj);
+            continue;
+        }
+        obj->color = RCColor::WHITE;
+        for (int child : obj->references)
+        {
+            stack.push_back(child);
+        }
+    }
+}
+
+void CycleCollector::scan_black(RCObject &start)
+{
+    // Свой стек: scan() продолжает обход по stack после возврата
+    start.color = RCColor::BLACK;
+    black.push_back(start.id);
+    while (!black.empty())
+    {
+        RCObject &obj = heap.find(black.back())->second;
+        black.pop_back();
+        for (int child : obj.references)
+        {
+            RCObject *target = find(child);
+            if (!target)
+            {
+                continue;
+            }
+            target->ref_count++;
+            if (target->color != RCColor::BLACK)
+            {
+                target->color = RCColor::BLACK;
+                black.push_back(child);
+            }
+        }
+    }
+}
+
+void CycleCollector::collect_white(int id)
+{
+    RCObject *start = find(id);
+    if (!start || start->color != RCColor::WHITE || start->buffered)
+    {
+        return;
+    }
+    start->color = RCColor::BLACK;
+    stack.push_back(id);
+    while (!stack.empty())
+    {
+        int current = stack.back();
+        stack.pop_back();
+        garbage.push_back(current);
+        for (int child : heap.find(current)->second.references)
+        {
+            RCObject *target = find(child);
+            if (target && target->color == RCColor::WHITE && !target->buffered)
+            {
+                target->color = RCColor::BLACK;
+                stack.push_back(child);
+            }
+        }
+    }
+}
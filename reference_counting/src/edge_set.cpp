@@ -0,0 +1,211 @@
+#include "edge_set.h"
+#include <algorithm>
+#include <cstring>
+
+EdgeSet::EdgeSet(const EdgeSet &other) : EdgeSet()
+{
+    copy_unique(other.begin(), other.end());
+}
+
+EdgeSet::EdgeSet(EdgeSet &&other) noexcept : EdgeSet()
+{
+    *this = std::move(other);
+}
+
+EdgeSet &EdgeSet::operator=(const EdgeSet &other)
+{
+    if (this != &other)
+    {
+        copy_unique(other.begin(), other.end());
+    }
+    return *this;
+}
+
+EdgeSet &EdgeSet::operator=(EdgeSet &&other) noexcept
+{
+    if (this == &other)
+    {
+        return *this;
+    }
+    release_storage();
+    if (other.is_inline())
+    {
+        // Встроенные цели копируются: указатель на чужой буфер не переносится
+        items = inline_items;
+        capacity = INLINE_CAPACITY;
+        std::memcpy(inline_items, other.inline_items, other.count * sizeof(int));
+    }
+    else
+    {
+        items = other.items;
+        capacity = other.capacity;
+        other.items = other.inline_items;
+        other.capacity = INLINE_CAPACITY;
+    }
+    count = other.count;
+    index = std::move(other.index);
+    other.count = 0;
+    return *this;
+}
+
+EdgeSet::~EdgeSet()
+{
+    release_storage();
+}
+
+bool EdgeSet::contains(int target) const
+{
+    if (index)
+    {
+        return index->count(target) > 0;
+    }
+    return std::find(begin(), end(), target) != end();
+}
+
+bool EdgeSet::insert(int target)
+{
+    if (contains(target))
+    {
+        return false;
+    }
+    if (count == capacity)
+    {
+        reserve(static_cast<std::size_t>(capacity) * 2);
+    }
+    items[count] = target;
+    if (index)
+    {
+        index->emplace(target, count);
+    }
+    count++;
+    if (!index && count > INDEX_THRESHOLD)
+    {
+        build_index();
+    }
+    return true;
+}
+
+bool EdgeSet::erase(int target)
+{
+    if (!index)
+    {
+        int *it = std::find(items, items + count, target);
+        if (it == end())
+        {
+            return false;
+        }
+        std::memmove(it, it + 1, (end() - it - 1) * sizeof(int));
+        count--;
+        return true;
+    }
+
+    auto found = index->find(target);
+    if (found == index->end())
+    {
+        return false;
+    }
+    uint32_t position = found->second;
+    index->erase(found);
+    count--;
+    if (position != count)
+    {
+        items[position] = items[count];
+        (*index)[items[position]] = position;
+    }
+    if (count <= INDEX_THRESHOLD / 2)
+    {
+        index.reset();
+    }
+    return true;
+}
+
+void EdgeSet::assign(const int *first, const int *last)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    index.reset();
+    count = 0;
+    reserve(n);
+    if (n <= INDEX_THRESHOLD)
+    {
+        for (; first != last; ++first)
+        {
+            if (std::find(items, items + count, *first) == items + count)
+            {
+                items[count++] = *first;
+            }
+        }
+        return;
+    }
+
+    // Повторы отсеивает индекс, который для такого размера всё равно нужен
+    index = std::make_unique<std::unordered_map<int, uint32_t>>();
+    index->reserve(n * 2);
+    for (; first != last; ++first)
+    {
+        if (index->emplace(*first, count).second)
+        {
+            items[count++] = *first;
+        }
+    }
+    if (count <= INDEX_THRESHOLD)
+    {
+        index.reset();
+    }
+}
+
+void EdgeSet::copy_unique(const int *first, const int *last)
+{
+    std::size_t n = static_cast<std::size_t>(last - first);
+    index.reset();
+    count = 0;
+    reserve(n);
+    std::copy(first, last, items);
+    count = static_cast<uint32_t>(n);
+    if (count > INDEX_THRESHOLD)
+    {
+        build_index();
+    }
+}
+
+void EdgeSet::clear()
+{
+    release_storage();
+    count = 0;
+}
+
+void EdgeSet::reserve(std::size_t min_capacity)
+{
+    if (min_capacity <= capacity)
+    {
+        return;
+    }
+    int *grown = new int[min_capacity];
+    std::copy(items, items + count, grown);
+    if (!is_inline())
+    {
+        delete[] items;
+    }
+    items = grown;
+    capacity = static_cast<uint32_t>(min_capacity);
+}
+
+void EdgeSet::build_index()
+{
+    index = std::make_unique<std::unordered_map<int, uint32_t>>();
+    index->reserve(count * 2);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        index->emplace(items[i], i);
+    }
+}
+
+void EdgeSet::release_storage()
+{
+    if (!is_inline())
+    {
+        delete[] items;
+        items = inline_items;
+        capacity = INLINE_CAPACITY;
+    }
+    index.reset();
+}
@@ -22,6 +22,14 @@ void EventLogger::log_allocate(int obj_id, int size) {
     }
 }
 
+void EventLogger::log_allocate_range(int first_id, int count, int size) {
+    if (log_stream.is_open()) {
+        log_stream << "[ALLOCATE] obj_" << first_id << "..obj_" << (first_id + count - 1)
+                   << " (" << count << " x size=" << size << ")\n";
+        log_stream.flush();
+    }
+}
+
 void EventLogger::log_add_ref(int from, int to, int ref_count) {
     if (log_stream.is_open()) {
         log_stream << "[ADD_REF] obj_" << from << " -> obj_" << to << " (rc=" << ref_count << ")\n";
@@ -29,6 +37,17 @@ void EventLogger::log_add_ref(int from, int to, int ref_count) {
     }
 }
 
+void EventLogger::log_add_refs(size_t added, size_t failed) {
+    if (log_stream.is_open()) {
+        log_stream << "[ADD_REF] " << added << " refs";
+        if (failed > 0) {
+            log_stream << ", " << failed << " failed";
+        }
+        log_stream << "\n";
+        log_stream.flush();
+    }
+}
+
 void EventLogger::log_remove_ref(int from, int to, int ref_count) {
     if (log_stream.is_open()) {
         log_stream << "[REMOVE_REF] obj_" << from << " -> obj_" << to << " (rc=" << ref_count << ")\n";
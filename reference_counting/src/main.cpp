@@ -12,6 +12,8 @@
 #include "event_logger.h"
 #include "common_utils.h"
 #include "rc_logger.h"
+#include "scenario_binary.h"
+#include "scenario_executor.h"
 
 // ============================================
 // REFERENCE COUNTING SPECIFIC STRUCTURES
@@ -73,133 +75,6 @@ void show_rc_menu()
               << std::endl;
 }
 
-ParsedScenario parse_json_scenario_rc(const std::string &filename)
-{
-    ParsedScenario result;
-    std::ifstream file(filename);
-    if (!file.is_open())
-    {
-        std::cerr << "Cannot open: " << filename << std::endl;
-        return result;
-    }
-
-    std::stringstream buffer;
-    buffer << file.rdbuf();
-    std::string content = buffer.str();
-    file.close();
-
-    size_t heap_size_pos = content.find("\"heap_size\":");
-    if (heap_size_pos != std::string::npos)
-    {
-        size_t colon_pos = content.find(":", heap_size_pos);
-        size_t comma_pos = content.find(",", colon_pos);
-        if (comma_pos == std::string::npos)
-        {
-            comma_pos = content.find("}", colon_pos);
-        }
-        if (colon_pos != std::string::npos && comma_pos != std::string::npos)
-        {
-            std::string heap_size_str = content.substr(colon_pos + 1, comma_pos - colon_pos - 1);
-            heap_size_str.erase(0, heap_size_str.find_first_not_of(" \t\n\r"));
-            heap_size_str.erase(heap_size_str.find_last_not_of(" \t\n\r") + 1);
-            try
-            {
-                result.heap_size = std::stoull(heap_size_str);
-            }
-            catch (...)
-            {
-                result.heap_size = 104857600;
-            }
-        }
-    }
-
-    size_t pos = 0;
-    while (pos < content.length())
-    {
-        pos = content.find('{', pos);
-        if (pos == std::string::npos)
-            break;
-        size_t end = content.find('}', pos);
-        if (end == std::string::npos)
-            break;
-        std::string obj = content.substr(pos, end - pos + 1);
-        pos = end + 1;
-
-        if (obj.find("\"op\"") == std::string::npos)
-            continue;
-
-        Operation op;
-
-        if (obj.find("\"op\": \"allocate\"") != std::string::npos ||
-            obj.find("\"op\":\"allocate\"") != std::string::npos)
-        {
-            op.type = "allocate";
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.id);
-            }
-            result.operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"addroot\"") != std::string::npos ||
-                 obj.find("\"op\":\"addroot\"") != std::string::npos)
-        {
-            op.type = "addroot";
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.id);
-            }
-            result.operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"addref\"") != std::string::npos ||
-                 obj.find("\"op\":\"addref\"") != std::string::npos)
-        {
-            op.type = "addref";
-            size_t from_pos = obj.find("\"from\"");
-            size_t to_pos = obj.find("\"to\"");
-            if (from_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + from_pos, "\"from\": %d", &op.from);
-            }
-            if (to_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + to_pos, "\"to\": %d", &op.to);
-            }
-            result.operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"removeroot\"") != std::string::npos ||
-                 obj.find("\"op\":\"removeroot\"") != std::string::npos)
-        {
-            op.type = "removeroot";
-            size_t id_pos = obj.find("\"id\"");
-            if (id_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + id_pos, "\"id\": %d", &op.id);
-            }
-            result.operations.push_back(op);
-        }
-        else if (obj.find("\"op\": \"removeref\"") != std::string::npos ||
-                 obj.find("\"op\":\"removeref\"") != std::string::npos)
-        {
-            op.type = "removeref";
-            size_t from_pos = obj.find("\"from\"");
-            size_t to_pos = obj.find("\"to\"");
-            if (from_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + from_pos, "\"from\": %d", &op.from);
-            }
-            if (to_pos != std::string::npos)
-            {
-                sscanf(obj.c_str() + to_pos, "\"to\": %d", &op.to);
-            }
-            result.operations.push_back(op);
-        }
-    }
-
-    return result;
-}
-
 // ============================================
 // REFERENCE COUNTING SIMULATION FUNCTION
 // ============================================
@@ -212,11 +87,17 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
     std::cout << std::string(70, '=') << "\n"
               << std::endl;
 
-    ParsedScenario parsed = parse_json_scenario_rc(scenario_file);
-    std::vector<Operation> &operations = parsed.operations;
-    size_t heap_size = parsed.heap_size;
+    ScenarioFile scenario;
+    if (!scenario.open(scenario_file))
+    {
+        std::cerr << "Cannot load " << scenario_file << ": " << scenario.get_error() << std::endl;
+        return;
+    }
+    const ScenarioFile &operations = scenario;
+    size_t heap_size = scenario.heap_size();
 
-    std::cout << "[*] Parsed " << operations.size() << " operations\n"
+    std::cout << "[*] Loaded " << operations.size() << " operations"
+              << (scenario.is_binary() ? " (binary, memory-mapped)" : "") << "\n"
               << std::endl;
     size_t heap_size_megabits = (heap_size * 8) / 1000000;
     std::cout << "[*] Heap Size: " << heap_size_megabits << " Mbits\n"
@@ -241,19 +122,19 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
 
     for (size_t step = 0; step < operations.size(); step++)
     {
-        const Operation &op = operations[step];
+        const CompactOp &op = operations[step];
 
-        if (op.type == "allocate")
+        if (op.code == ScenarioOpCode::ALLOCATE)
         {
-            bool success = heap.allocate(op.id, object_size);
+            bool success = heap.allocate_at(op.b, object_size);
             if (success)
             {
                 objects_created++;
                 mem_stats.total_allocated += object_size;
             }
-            size_t current_heap_bytes = heap.getheapsize() * object_size;
+            size_t current_heap_bytes = heap.get_total_memory();
             mem_stats.peak_memory = std::max(mem_stats.peak_memory, current_heap_bytes);
-            std::cout << " [" << std::setw(3) << step << "] ALLOCATE object_" << op.id;
+            std::cout << " [" << std::setw(3) << step << "] ALLOCATE object_" << op.b;
             if (success)
             {
                 std::cout << " ✓" << std::endl;
@@ -263,13 +144,13 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
                 std::cout << " ✗ FAILED" << std::endl;
             }
         }
-        else if (op.type == "addroot")
+        else if (op.code == ScenarioOpCode::MAKE_ROOT)
         {
-            bool success = heap.addroot(op.id);
-            std::cout << " [" << std::setw(3) << step << "] ADDROOT object_" << op.id;
+            bool success = heap.add_root(op.a);
+            std::cout << " [" << std::setw(3) << step << "] ADDROOT object_" << op.a;
             if (success)
             {
-                int refcount = heap.getrefcount(op.id);
+                int refcount = heap.get_ref_count(op.a);
                 std::cout << " ✓ (refcount: " << refcount << ")" << std::endl;
             }
             else
@@ -277,25 +158,25 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
                 std::cout << " ✗ FAILED" << std::endl;
             }
         }
-        else if (op.type == "removeroot")
+        else if (op.code == ScenarioOpCode::REMOVE_ROOT)
         {
-            int old_refcount = heap.getrefcount(op.id);
-            bool success = heap.removeroot(op.id);
-            std::cout << " [" << std::setw(3) << step << "] REMOVEROOT object_" << op.id;
+            int old_refcount = heap.get_ref_count(op.a);
+            bool success = heap.release_root(op.a);
+            std::cout << " [" << std::setw(3) << step << "] REMOVEROOT object_" << op.a;
             if (success)
             {
                 // ТОЛЬКО логирование, НЕ подсчет памяти
-                if (!heap.objectexists(op.id))
+                if (!heap.object_exists(op.a))
                 {
                     // Объект был удален каскадом - только сообщаем об этом
-                    size_t current_heap_bytes = heap.getheapsize() * object_size;
+                    size_t current_heap_bytes = heap.get_total_memory();
                     mem_stats.peak_memory = std::max(mem_stats.peak_memory, current_heap_bytes);
                     std::cout << " ✓ (refcount: " << old_refcount << " -> 0) [CASCADE DELETED]" << std::endl;
                 }
                 else
                 {
                     // Объект остался (все еще имеет другие ссылки)
-                    int new_refcount = heap.getrefcount(op.id);
+                    int new_refcount = heap.get_ref_count(op.a);
                     std::cout << " ✓ (refcount: " << old_refcount << " -> " << new_refcount << ")" << std::endl;
                 }
             }
@@ -304,14 +185,14 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
                 std::cout << " ✗ FAILED" << std::endl;
             }
         }
-        else if (op.type == "addref")
+        else if (op.code == ScenarioOpCode::ADD_REF)
         {
-            bool success = heap.addref(op.from, op.to);
+            bool success = heap.add_reference(op.a, op.b);
             std::cout << " [" << std::setw(3) << step << "] ADDREF object_"
-                      << op.from << " -> object_" << op.to;
+                      << op.a << " -> object_" << op.b;
             if (success)
             {
-                int refcount = heap.getrefcount(op.to);
+                int refcount = heap.get_ref_count(op.b);
                 std::cout << " ✓ (refcount: " << refcount << ")" << std::endl;
             }
             else
@@ -319,26 +200,26 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
                 std::cout << " ✗ FAILED" << std::endl;
             }
         }
-        else if (op.type == "removeref")
+        else if (op.code == ScenarioOpCode::REMOVE_REF)
         {
-            int old_refcount = heap.getrefcount(op.to);
-            bool success = heap.removeref(op.from, op.to);
+            int old_refcount = heap.get_ref_count(op.b);
+            bool success = heap.remove_reference(op.a, op.b);
             std::cout << " [" << std::setw(3) << step << "] REMOVEREF object_"
-                      << op.from << " -> object_" << op.to;
+                      << op.a << " -> object_" << op.b;
             if (success)
             {
                 // ТОЛЬКО логирование, НЕ подсчет памяти
-                if (!heap.objectexists(op.to))
+                if (!heap.object_exists(op.b))
                 {
                     // Объект был удален каскадом - только сообщаем об этом
-                    size_t current_heap_bytes = heap.getheapsize() * object_size;
+                    size_t current_heap_bytes = heap.get_total_memory();
                     mem_stats.peak_memory = std::max(mem_stats.peak_memory, current_heap_bytes);
                     std::cout << " ✓ (refcount: " << old_refcount << " -> 0) [DELETED]" << std::endl;
                 }
                 else
                 {
                     // Объект остался
-                    int new_refcount = heap.getrefcount(op.to);
+                    int new_refcount = heap.get_ref_count(op.b);
                     std::cout << " ✓ (refcount: " << old_refcount << " -> " << new_refcount << ")" << std::endl;
                 }
             }
@@ -347,6 +228,42 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
                 std::cout << " ✗ FAILED" << std::endl;
             }
         }
+        else if (op.code == ScenarioOpCode::COLLECT)
+        {
+            // RC освобождает объекты сразу; collect() — только отложенная работа
+            size_t freed = heap.collect();
+            std::cout << " [" << std::setw(3) << step << "] COLLECT (" << freed
+                      << " bytes of deferred work)" << std::endl;
+        }
+        else if (scenario_is_macro(op.code))
+        {
+            // Макрооперация: все объекты, затем все связи
+            ScenarioMacro macro;
+            size_t length = scenario_op_length(op.code);
+            std::cout << " [" << std::setw(3) << step << "] " << scenario_macro_label(op);
+            if (!decode_scenario_macro(&op, operations.size() - step, macro))
+            {
+                std::cout << " ✗ FAILED" << std::endl;
+                step += length - 1;
+                continue;
+            }
+
+            int created = static_cast<int>(heap.allocate_many_at(macro.first_id, macro.count, object_size));
+            size_t linked = 0;
+            std::vector<ReferencePair> edges;
+            batch_macro_edges(macro, macro.first_id, created, edges,
+                              [&heap, &linked](const ReferencePair *pairs, size_t n)
+                              { linked += heap.add_references(pairs, n); });
+
+            objects_created += created;
+            mem_stats.total_allocated += created * object_size;
+            size_t current_heap_bytes = heap.get_total_memory();
+            mem_stats.peak_memory = std::max(mem_stats.peak_memory, current_heap_bytes);
+            std::cout << " -> object_" << macro.first_id << "..object_"
+                      << (macro.first_id + macro.count - 1) << " ✓ (" << created
+                      << " objects, " << linked << " refs)" << std::endl;
+            step += length - 1;
+        }
     }
 
     auto end_time = std::chrono::high_resolution_clock::now();
@@ -355,7 +272,7 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
                            .count();
 
     // КОРРЕКТНЫЙ подсчет освобожденной памяти (основной метод)
-    size_t objects_left = heap.getheapsize();
+    size_t objects_left = heap.get_alive_objects_count();
     size_t live_bytes = objects_left * object_size;
 
     // Всего выделено памяти
@@ -386,11 +303,11 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
     std::cout << " Heap Statistics" << std::endl;
     std::cout << std::string(70, '=') << std::endl;
     std::cout << " Objects created: " << std::setw(12) << objects_created << std::endl;
-    std::cout << " Objects in heap: " << std::setw(12) << heap.getheapsize() << std::endl;
-    std::cout << " Active roots: " << std::setw(15) << heap.getrootscount() << std::endl;
+    std::cout << " Objects in heap: " << std::setw(12) << heap.get_alive_objects_count() << std::endl;
+    std::cout << " Active roots: " << std::setw(15) << heap.get_roots_count() << std::endl;
     std::cout << " Heap size configured: " << std::setw(4) << (heap.get_heap_size_bytes() / 1048576) << " MB" << std::endl;
 
-    size_t used_bytes = heap.getheapsize() * object_size;
+    size_t used_bytes = heap.get_total_memory();
     size_t total_bytes = heap.get_heap_size_bytes();
     size_t used_megabits = (used_bytes * 8) / 1000000;
     size_t total_megabits = (total_bytes * 8) / 1000000;
@@ -403,20 +320,20 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
               << std::endl;
 
     // ========== FINAL CHECK ==========
-    if (heap.getheapsize() > 0)
+    if (heap.get_alive_objects_count() > 0)
     {
         std::cout << "\n"
                   << std::string(70, '!') << std::endl;
-        std::cout << "! TEST RESULT - " << heap.getheapsize() << " OBJECTS REMAIN IN HEAP!" << std::endl;
+        std::cout << "! TEST RESULT - " << heap.get_alive_objects_count() << " OBJECTS REMAIN IN HEAP!" << std::endl;
 
         // Определяем тип утечки
-        if (heap.getheapsize() == objects_created)
+        if (heap.get_alive_objects_count() == objects_created)
         {
             std::cout << "! ALL objects leaked - проверьте логику каскадного удаления!" << std::endl;
         }
-        else if (heap.getrootscount() > 0)
+        else if (heap.get_roots_count() > 0)
         {
-            std::cout << "! " << heap.getrootscount() << " root objects still exist" << std::endl;
+            std::cout << "! " << heap.get_roots_count() << " root objects still exist" << std::endl;
         }
 
         std::cout << "! This is EXPECTED for cyclic reference tests!" << std::endl;
@@ -427,11 +344,11 @@ void run_simulation_rc(const std::string &scenario_file, const std::string &scen
         std::cout << "\nRemaining objects details:" << std::endl;
         for (int i = 0; i < objects_created; i++)
         {
-            if (heap.objectexists(i))
+            if (heap.object_exists(i))
             {
-                int refcount = heap.getrefcount(i);
+                int refcount = heap.get_ref_count(i);
                 std::cout << "  Object " << i << ": ref_count = " << refcount;
-                if (heap.getrootscount() > 0)
+                if (heap.get_roots_count() > 0)
                 {
                     // Проверяем, является ли объект корнем
                     std::cout << " (ROOT)" << std::endl;
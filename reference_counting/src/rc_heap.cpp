@@ -1,7 +1,10 @@
 #include "rc_heap.h"
+#include "scenario_executor.h"
 #include <iostream>
 #include <algorithm>
 #include <sstream>
+#include <limits>
+#include <chrono>
 
 // ============================================
 // КОНСТРУКТОР
@@ -9,18 +12,68 @@
 
 RCHeap::RCHeap(EventLogger &logger_, RCLogger &rc_logger_, std::size_t heap_size_bytes_)
     : heap_size_bytes(heap_size_bytes_),
+      allocated_bytes(0),
+      logging_enabled(true),
+      next_object_id(0),
+      current_step(0),
+      deferred_budget(DEFAULT_DEFERRED_BUDGET),
+      cycle_threshold(DEFAULT_CYCLE_BUFFER),
+      zct_threshold(DEFAULT_ZCT_THRESHOLD),
+      zct_retained(0),
+      epoch_threshold(DEFAULT_EPOCH_BUFFER),
+      backup_tracing(false),
+      trace_interval(DEFAULT_TRACE_INTERVAL),
+      allocated_at_trace(0),
       rc(objects, logger_),
+      cycles(objects, roots, rc),
+      tracer(objects, roots, rc),
       logger(logger_),
       rc_logger(rc_logger_)
 {
     rc_logger.log_init(heap_size_bytes);
 }
 
+RCHeap::RCHeap(std::size_t heap_size_bytes_, const std::string &log_file_path)
+    : owned_logger(std::make_unique<EventLogger>("")),
+      owned_rc_logger(std::make_unique<RCLogger>(log_file_path)),
+      heap_size_bytes(heap_size_bytes_),
+      allocated_bytes(0),
+      logging_enabled(true),
+      next_object_id(0),
+      current_step(0),
+      deferred_budget(DEFAULT_DEFERRED_BUDGET),
+      cycle_threshold(DEFAULT_CYCLE_BUFFER),
+      zct_threshold(DEFAULT_ZCT_THRESHOLD),
+      zct_retained(0),
+      epoch_threshold(DEFAULT_EPOCH_BUFFER),
+      backup_tracing(false),
+      trace_interval(DEFAULT_TRACE_INTERVAL),
+      allocated_at_trace(0),
+      rc(objects, *owned_logger),
+      cycles(objects, roots, rc),
+      tracer(objects, roots, rc),
+      logger(*owned_logger),
+      rc_logger(*owned_rc_logger)
+{
+    rc_logger.log_init(heap_size_bytes);
+}
+
 // ============================================
 // ALLOCATE - выделить новый объект
 // ============================================
 
-bool RCHeap::allocate(int obj_id, size_t size)
+int RCHeap::allocate(size_t size)
+{
+    // id могли занять через allocate_at()
+    while (objects.count(next_object_id) > 0)
+    {
+        next_object_id++;
+    }
+    int id = next_object_id;
+    return allocate_at(id, size) ? id : -1;
+}
+
+bool RCHeap::allocate_at(int obj_id, size_t size)
 {
     // Проверить, не существует ли уже объект с таким ID
     if (objects.count(obj_id) > 0)
@@ -36,13 +89,28 @@ bool RCHeap::allocate(int obj_id, size_t size)
         return false;
     }
 
-    // Выделить новый объект
-    objects.emplace(obj_id, RCObject(obj_id));
-    object_sizes[obj_id] = size;
+    // Память возвращается только каскадом (в том числе отложенным)
+    if (!reserve_memory(size))
+    {
+        std::cerr << "Error: Out of memory allocating " << size << " bytes\n";
+        return false;
+    }
+
+    // Выделить новый объект; в режиме ZCT на него ещё никто не ссылается
+    auto inserted = objects.emplace(obj_id, RCObject(obj_id, static_cast<int>(size))).first;
+    if (rc.zero_count_table)
+    {
+        rc.zero_count(inserted->second);
+    }
+    allocated_bytes += size;
+    next_object_id = std::max(next_object_id, obj_id + 1);
 
     // Логировать с размером объекта
-    rc_logger.log_allocate(obj_id, size);
-    logger.log_allocate(obj_id, static_cast<int>(size));
+    if (logging_enabled)
+    {
+        rc_logger.log_allocate(obj_id, size);
+        logger.log_allocate(obj_id, static_cast<int>(size));
+    }
 
     return true;
 }
@@ -67,13 +135,20 @@ bool RCHeap::add_root(int obj_id)
         return false;
     }
 
-    // Добавить в корни и увеличить ref_count
+    // Добавить в корни и увеличить ref_count (в режиме ZCT корни не считаются)
     roots.insert(obj_id);
-    objects[obj_id].ref_count++;
+    if (!rc.zero_count_table)
+    {
+        objects[obj_id].ref_count++;
+        objects[obj_id].color = RCColor::BLACK;
+    }
 
     // Логировать
-    rc_logger.log_make_root(obj_id);
-    logger.log_add_ref(0, obj_id, objects[obj_id].ref_count);
+    if (logging_enabled)
+    {
+        rc_logger.log_make_root(obj_id);
+        logger.log_add_ref(0, obj_id, objects[obj_id].ref_count);
+    }
 
     return true;
 }
@@ -82,7 +157,7 @@ bool RCHeap::add_root(int obj_id)
 // ADD_REF - добавить ссылку от объекта к объекту
 // ============================================
 
-bool RCHeap::add_ref(int from, int to)
+bool RCHeap::add_reference(int from, int to)
 {
     // Валидация ID'ов
     if (from < 0 || to < 0)
@@ -114,19 +189,191 @@ bool RCHeap::add_ref(int from, int to)
     // Делегировать ReferenceCounter
     bool result = rc.add_ref(from, to);
 
-    if (result)
+    if (result && logging_enabled)
     {
         rc_logger.log_add_ref(from, to);
     }
 
+    maybe_end_epoch();
     return result;
 }
 
+// ============================================
+// ALLOCATE_MANY - выделить диапазон объектов
+// ============================================
+
+ObjectIdRange RCHeap::allocate_many(size_t count, size_t size)
+{
+    ObjectIdRange range;
+    if (size > 0)
+    {
+        std::size_t wanted = count > std::numeric_limits<std::size_t>::max() / size
+                                 ? std::numeric_limits<std::size_t>::max()
+                                 : count * size;
+        reserve_memory(wanted);
+        count = std::min(count, get_free_memory() / size);
+    }
+    if (count == 0)
+    {
+        return range;
+    }
+
+    // Первый свободный участок из count id подряд
+    int first = next_object_id;
+    for (int id = first; id - first < static_cast<int>(count) && id < std::numeric_limits<int>::max(); ++id)
+    {
+        if (objects.count(id) > 0)
+        {
+            first = id + 1;
+        }
+    }
+    // Место уже зарезервировано выше — второй reserve_memory() снова
+    // запустил бы отложенную работу и проверки триггеров
+    if (!check_id_range(first, count))
+    {
+        return range;
+    }
+    range.first = first;
+    range.count = static_cast<int>(emplace_range(first, count, size));
+    return range;
+}
+
+std::size_t RCHeap::allocate_many_at(int first_id, std::size_t count, std::size_t size)
+{
+    if (count == 0)
+    {
+        return 0;
+    }
+
+    // Один проход проверки до каких-либо изменений
+    if (!check_id_range(first_id, count))
+    {
+        return 0;
+    }
+    if (size > 0 && (count > std::numeric_limits<std::size_t>::max() / size || !reserve_memory(count * size)))
+    {
+        std::cerr << "Error: Out of memory allocating " << count << " x " << size << " bytes\n";
+        return 0;
+    }
+    return emplace_range(first_id, count, size);
+}
+
+bool RCHeap::check_id_range(int first_id, std::size_t count) const
+{
+    if (first_id < 0 ||
+        count - 1 > static_cast<std::size_t>(std::numeric_limits<int>::max() - first_id))
+    {
+        std::cerr << "Error: Invalid object ID range " << first_id << " + " << count << "\n";
+        return false;
+    }
+    const int last_id = first_id + static_cast<int>(count - 1);
+    for (int id = first_id; id <= last_id; ++id)
+    {
+        if (objects.count(id) > 0)
+        {
+            std::cerr << "Error: Object " << id << " already exists\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::size_t RCHeap::emplace_range(int first_id, std::size_t count, std::size_t size)
+{
+    const int last_id = first_id + static_cast<int>(count - 1);
+    objects.reserve(objects.size() + count);
+    for (int id = first_id; id <= last_id; ++id)
+    {
+        auto inserted = objects.emplace(id, RCObject(id, static_cast<int>(size))).first;
+        if (rc.zero_count_table)
+        {
+            rc.zero_count(inserted->second);
+        }
+    }
+    allocated_bytes += count * size;
+    next_object_id = std::max(next_object_id, last_id + 1);
+
+    if (logging_enabled)
+    {
+        std::ostringstream oss;
+        oss << "ALLOCATE_MANY: obj_" << first_id << "..obj_" << last_id
+            << " (" << count << " x " << size << " bytes)";
+        rc_logger.log_operation(oss.str());
+        logger.log_allocate_range(first_id, static_cast<int>(count), static_cast<int>(size));
+    }
+
+    return count;
+}
+
+// ============================================
+// ADD_REFERENCES - добавить ссылки пачкой
+// ============================================
+
+std::size_t RCHeap::add_references(const ReferencePair *refs, std::size_t count)
+{
+    std::size_t added = 0;
+    std::size_t failed = 0;
+    auto source = objects.end();
+
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const ReferencePair &ref = refs[i];
+        // Цепи и деревья идут по источнику — его поиск кешируется
+        if (source == objects.end() || source->first != ref.from)
+        {
+            source = objects.find(ref.from);
+        }
+        auto target = objects.find(ref.to);
+        if (source == objects.end() || target == objects.end() || ref.from == ref.to)
+        {
+            failed++;
+            continue;
+        }
+
+        // Уже существующая ссылка считается применённой, но не
+        // увеличивает ref_count повторно
+        if (rc.coalescing)
+        {
+            if (!source->second.has_reference_to(ref.to))
+            {
+                rc.log_modification(source->second);
+                source->second.add_outgoing_ref(ref.to);
+                if (target->second.ref_count == 0)
+                {
+                    rc.zero_count(target->second);
+                }
+            }
+        }
+        else if (source->second.add_outgoing_ref(ref.to))
+        {
+            target->second.ref_count++;
+            target->second.color = RCColor::BLACK;
+            rc.count_updates++;
+        }
+        added++;
+    }
+
+    if (count > 0 && logging_enabled)
+    {
+        std::ostringstream oss;
+        oss << "ADD_REFS: " << added << " applied";
+        if (failed > 0)
+        {
+            oss << ", " << failed << " failed";
+        }
+        rc_logger.log_operation(oss.str());
+        logger.log_add_refs(added, failed);
+    }
+
+    maybe_end_epoch();
+    return added;
+}
+
 // ============================================
 // REMOVE_REF - удалить ссылку между объектами
 // ============================================
 
-bool RCHeap::remove_ref(int from, int to)
+bool RCHeap::remove_reference(int from, int to)
 {
     // Валидация ID'ов
     if (from < 0 || to < 0)
@@ -150,13 +397,16 @@ bool RCHeap::remove_ref(int from, int to)
     }
 
     // Логировать удаление ссылки
-    rc_logger.log_remove_ref(from, to);
+    if (logging_enabled)
+    {
+        rc_logger.log_remove_ref(from, to);
+    }
 
     // Получить текущий ref_count перед удалением для логирования
     int old_ref_count = objects[to].ref_count;
 
-    // Делегировать ReferenceCounter - УДАЛИТЬ ССЫЛКУ БЕЗ КАСКАДА
-    if (!rc.remove_ref_no_cascade(from, to))
+    // Делегировать ReferenceCounter - ссылка снимается без каскада
+    if (!rc.remove_ref(from, to))
     {
         return false;
     }
@@ -164,16 +414,25 @@ bool RCHeap::remove_ref(int from, int to)
     // Получить новый ref_count после удаления
     int new_ref_count = objects[to].ref_count;
 
-    // Проверить, стал ли ref_count целевого объекта 0
-    if (new_ref_count == 0)
+    // Проверить, стал ли ref_count целевого объекта 0 (при слиянии
+    // счётчик не изменился — решит конец эпохи)
+    if (new_ref_count == 0 && !rc.coalescing)
     {
+        // В режиме ZCT жив ли объект, решит сверка с корнями
+        if (rc.zero_count_table)
+        {
+            rc.zero_count(objects[to]);
+        }
         // Если объект стал недостижим (не корень), запустить каскад
-        if (roots.count(to) == 0)
+        else if (roots.count(to) == 0)
         {
             rc.cascade_delete(to);
         }
     }
 
+    maybe_end_epoch();
+    maybe_reconcile();
+    maybe_collect_cycles();
     return true;
 }
 
@@ -181,7 +440,7 @@ bool RCHeap::remove_ref(int from, int to)
 // REMOVE_ROOT - удалить объект из корней
 // ============================================
 
-bool RCHeap::remove_root(int obj_id)
+bool RCHeap::release_root(int obj_id)
 {
     // Проверить, существует ли объект
     if (!object_exists(obj_id))
@@ -203,8 +462,11 @@ bool RCHeap::remove_root(int obj_id)
     // Удалить из корней
     roots.erase(obj_id);
 
-    // Уменьшить ref_count (корень считался как +1 к ref_count)
-    objects[obj_id].ref_count--;
+    // Уменьшить ref_count (корень считался как +1 к ref_count, кроме режима ZCT)
+    if (!rc.zero_count_table)
+    {
+        objects[obj_id].ref_count--;
+    }
 
     // Получить новый ref_count
     int new_ref_count = objects[obj_id].ref_count;
@@ -217,15 +479,30 @@ bool RCHeap::remove_root(int obj_id)
     }
 
     // Логировать удаление корня
-    rc_logger.log_remove_root(obj_id);
-    logger.log_remove_ref(0, obj_id, new_ref_count);
+    if (logging_enabled)
+    {
+        rc_logger.log_remove_root(obj_id);
+        logger.log_remove_ref(0, obj_id, new_ref_count);
+    }
 
-    // Если ref_count == 0, начать каскадное удаление
-    if (new_ref_count == 0)
+    // Если ref_count == 0, начать каскадное удаление (в режиме ZCT —
+    // отложить до сверки, при слиянии — до конца эпохи); иначе объект
+    // может держаться только циклом
+    if (new_ref_count == 0 && (rc.zero_count_table || rc.coalescing))
+    {
+        rc.zero_count(objects[obj_id]);
+    }
+    else if (new_ref_count == 0)
     {
         rc.cascade_delete(obj_id);
     }
+    else
+    {
+        rc.possible_root(objects[obj_id]);
+    }
 
+    maybe_reconcile();
+    maybe_collect_cycles();
     return true;
 }
 
@@ -289,32 +566,101 @@ void RCHeap::dump_state() const
 
 void RCHeap::run_scenario(const ScenarioOp ops[], int size)
 {
+    std::vector<CompactOp> compiled;
+    compiled.reserve(size > 0 ? size : 0);
+
     for (int i = 0; i < size; ++i)
     {
         const ScenarioOp &op = ops[i];
-        if (op.op == "allocate")
+        CompactOp compact{};
+        if (!scenario_op_from_name(op.op.data(), op.op.size(), compact.code))
         {
-            allocate(op.id, op.size);
-        }
-        else if (op.op == "add_root" || op.op == "addroot" || op.op == "make_root")
-        {
-            add_root(op.id);
+            std::cerr << "Unknown operation: " << op.op << "\n";
+            continue;
         }
-        else if (op.op == "remove_root" || op.op == "removeroot")
+
+        switch (compact.code)
         {
-            remove_root(op.id);
+        case ScenarioOpCode::ALLOCATE:
+            compact.a = static_cast<int32_t>(op.size);
+            compact.b = op.id;
+            break;
+        case ScenarioOpCode::MAKE_ROOT:
+        case ScenarioOpCode::REMOVE_ROOT:
+            compact.a = op.id;
+            break;
+        case ScenarioOpCode::ADD_REF:
+        case ScenarioOpCode::REMOVE_REF:
+            compact.a = op.from;
+            compact.b = op.to;
+            break;
+        case ScenarioOpCode::COLLECT:
+            break;
+        default:
+            // Макрооперации не выражаются через поля ScenarioOp
+            std::cerr << "Unsupported operation: " << op.op << "\n";
+            continue;
         }
-        else if (op.op == "add_ref" || op.op == "addref")
+        compiled.push_back(compact);
+    }
+
+    run_scenario(compiled.data(), compiled.size());
+}
+
+void RCHeap::run_scenario(const CompactOp *ops, std::size_t count)
+{
+    std::vector<ReferencePair> edges;
+    std::size_t length = 1;
+    for (std::size_t i = 0; i < count; i += length)
+    {
+        const CompactOp &op = ops[i];
+        length = 1;
+        switch (op.code)
         {
-            add_ref(op.from, op.to);
-        }
-        else if (op.op == "remove_ref" || op.op == "removeref")
+        case ScenarioOpCode::ALLOCATE:
+            // Как и execute_scenario: allocate без размера пропускается
+            if (op.a > 0)
+            {
+                allocate_at(op.b, static_cast<std::size_t>(op.a));
+            }
+            break;
+        case ScenarioOpCode::MAKE_ROOT:
+            add_root(op.a);
+            break;
+        case ScenarioOpCode::REMOVE_ROOT:
+            release_root(op.a);
+            break;
+        case ScenarioOpCode::ADD_REF:
+            add_reference(op.a, op.b);
+            break;
+        case ScenarioOpCode::REMOVE_REF:
+            remove_reference(op.a, op.b);
+            break;
+        case ScenarioOpCode::COLLECT:
+            collect();
+            break;
+        case ScenarioOpCode::ALLOCATE_RANGE:
+        case ScenarioOpCode::CHAIN:
+        case ScenarioOpCode::RING:
+        case ScenarioOpCode::TREE:
+        case ScenarioOpCode::RANDOM_GRAPH:
         {
-            remove_ref(op.from, op.to);
+            ScenarioMacro macro;
+            length = scenario_op_length(op.code);
+            if (!decode_scenario_macro(&op, count - i, macro))
+            {
+                std::cerr << "Error: Malformed " << scenario_op_name(op.code) << " at " << i << "\n";
+                break;
+            }
+            std::size_t created = allocate_many_at(macro.first_id, static_cast<std::size_t>(macro.count),
+                                                static_cast<std::size_t>(macro.size));
+            batch_macro_edges(macro, macro.first_id, static_cast<int>(created), edges,
+                              [this](const ReferencePair *pairs, std::size_t n)
+                              { add_references(pairs, n); });
+            break;
         }
-        else
-        {
-            std::cerr << "Unknown operation: " << op.op << "\n";
+        case ScenarioOpCode::MACRO_ARGS:
+            break;
         }
     }
 
@@ -381,50 +727,716 @@ const RCObject *RCHeap::get_object(int obj_id) const
 }
 
 // ============================================
-// ДОПОЛНИТЕЛЬНЫЕ МЕТОДЫ (для совместимости с main.cpp)
+// CHECKPOINT - бинарное сохранение/загрузка
+// ============================================
+
+void RCHeap::write_checkpoint(HeapSnapshotWriter &w) const
+{
+    // ID задаются сценарием и могут идти с пропусками — сортируем
+    std::vector<int> ids;
+    ids.reserve(objects.size());
+    for (const auto &[id, _] : objects)
+    {
+        ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+
+    CheckpointHeader header = make_checkpoint_header(CheckpointKind::REFERENCE_COUNTING);
+    header.object_count = ids.size();
+    // Не max(id) + 1: allocate(size) не переиспользует id освобождённых объектов
+    header.next_object_id = next_object_id;
+    header.current_step = current_step;
+    header.max_heap_size = heap_size_bytes;
+    // Счётчики в тех же полях и единицах, что у Mark-Sweep (время — мкс)
+    header.collection_count = collection_stats.collections;
+    header.total_objects_collected = rc.freed_objects;
+    header.total_memory_freed = rc.freed_bytes;
+    header.total_collection_time = collection_stats.total_pause_ns / 1000;
+    for (int id : ids)
+    {
+        header.edge_count += objects.at(id).references.size();
+    }
+    write_checkpoint_pod(w, header);
+
+    for (int id : ids)
+    {
+        const RCObject &obj = objects.at(id);
+
+        CheckpointObject record;
+        std::memset(&record, 0, sizeof(record));
+        record.id = id;
+        record.flags = CHECKPOINT_ALIVE |
+                       (roots.count(id) ? CHECKPOINT_ROOT : 0) |
+                       (obj.marked ? CHECKPOINT_MARKED : 0);
+        record.size = static_cast<uint64_t>(obj.size);
+        record.allocation_step = -1;
+        record.collection_step = -1;
+        // В режиме ZCT корни не входят в ref_count; в файле — входят всегда
+        record.reference_count = obj.ref_count + (rc.zero_count_table && roots.count(id) ? 1 : 0);
+        record.out_degree = static_cast<uint32_t>(obj.references.size());
+        write_checkpoint_pod(w, record);
+    }
+
+    // Порядок ссылок сохраняется как есть — от него зависит порядок каскада
+    for (int id : ids)
+    {
+        for (int target : objects.at(id).references)
+        {
+            write_checkpoint_pod(w, static_cast<int32_t>(target));
+        }
+    }
+}
+
+bool RCHeap::read_checkpoint(const uint8_t *data, size_t size)
+{
+    CheckpointReader reader(data, size);
+    CheckpointHeader header;
+    if (!reader.read_header(CheckpointKind::REFERENCE_COUNTING, header))
+    {
+        std::cerr << "Error: Invalid RC checkpoint header\n";
+        return false;
+    }
+
+    const CheckpointObject *records = reader.read_array<CheckpointObject>(header.object_count);
+    const int32_t *edges = reader.read_array<int32_t>(header.edge_count);
+    if (!records || !edges)
+    {
+        std::cerr << "Error: Truncated RC checkpoint\n";
+        return false;
+    }
+
+    if (header.next_object_id < 0 || header.next_object_id > std::numeric_limits<int>::max())
+    {
+        std::cerr << "Error: Invalid RC checkpoint next object id\n";
+        return false;
+    }
+
+    std::unordered_map<int, RCObject> loaded_objects;
+    std::unordered_set<int> loaded_roots;
+    std::size_t loaded_bytes = 0;
+    loaded_objects.reserve(header.object_count);
+
+    uint64_t edge_pos = 0;
+    std::vector<int32_t> sorted_targets;
+    for (uint64_t i = 0; i < header.object_count; ++i)
+    {
+        const CheckpointObject &record = records[i];
+        if (record.out_degree > header.edge_count - edge_pos)
+        {
+            std::cerr << "Error: Corrupted RC checkpoint edges\n";
+            return false;
+        }
+        // Иначе allocate(size) выдал бы id живого объекта
+        if (record.id < 0 || record.id >= header.next_object_id)
+        {
+            std::cerr << "Error: RC checkpoint object " << record.id << " is outside next object id "
+                      << header.next_object_id << "\n";
+            return false;
+        }
+
+        // EdgeSet::assign() требует целей без повторов
+        sorted_targets.assign(edges + edge_pos, edges + edge_pos + record.out_degree);
+        std::sort(sorted_targets.begin(), sorted_targets.end());
+        auto duplicate = std::adjacent_find(sorted_targets.begin(), sorted_targets.end());
+        if (duplicate != sorted_targets.end())
+        {
+            std::cerr << "Error: RC checkpoint object " << record.id << " references object " << *duplicate
+                      << " twice\n";
+            return false;
+        }
+
+        RCObject &obj = loaded_objects.emplace(record.id,
+                                               RCObject(record.id, static_cast<int>(record.size)))
+                            .first->second;
+        obj.ref_count = record.reference_count;
+        obj.marked = (record.flags & CHECKPOINT_MARKED) != 0;
+        obj.references.assign(edges + edge_pos, edges + edge_pos + record.out_degree);
+        edge_pos += record.out_degree;
+
+        loaded_bytes += static_cast<size_t>(record.size);
+        if (record.flags & CHECKPOINT_ROOT)
+        {
+            loaded_roots.insert(record.id);
+        }
+    }
+
+    if (edge_pos != header.edge_count || loaded_objects.size() != header.object_count)
+    {
+        std::cerr << "Error: Corrupted RC checkpoint\n";
+        return false;
+    }
+
+    // Каскад и трассировка разыменовывают цели ссылок без проверки
+    std::unordered_map<int, int> incoming;
+    incoming.reserve(loaded_objects.size());
+    for (const auto &entry : loaded_objects)
+    {
+        for (int target : entry.second.references)
+        {
+            if (loaded_objects.count(target) == 0)
+            {
+                std::cerr << "Error: RC checkpoint object " << entry.first << " references missing object "
+                          << target << "\n";
+                return false;
+            }
+            incoming[target]++;
+        }
+    }
+
+    // Счётчик в файле — входящие ссылки плюс корень. Расхождение
+    // освободило бы живой объект раньше времени или оставило мусор
+    for (const auto &entry : loaded_objects)
+    {
+        auto found = incoming.find(entry.first);
+        int expected = (found != incoming.end() ? found->second : 0) + (loaded_roots.count(entry.first) ? 1 : 0);
+        if (entry.second.ref_count != expected)
+        {
+            std::cerr << "Error: RC checkpoint object " << entry.first << " has ref_count " << entry.second.ref_count
+                      << ", but " << expected << " references\n";
+            return false;
+        }
+    }
+
+    // Отложенная работа относится к заменяемой куче
+    rc.pending.clear();
+    rc.candidates.clear();
+    rc.zct.clear();
+    rc.modified.clear();
+
+    // ReferenceCounter держит ссылку на objects — меняем содержимое, не объект
+    objects.swap(loaded_objects);
+    roots.swap(loaded_roots);
+    heap_size_bytes = header.max_heap_size;
+    next_object_id = static_cast<int>(header.next_object_id);
+    current_step = static_cast<int>(header.current_step);
+
+    // Выделено за всё время — живые плюс освобождённые, чтобы
+    // get_total_memory() совпадал с кучей на момент записи
+    rc.freed_objects = header.total_objects_collected;
+    rc.freed_bytes = header.total_memory_freed;
+    allocated_bytes = loaded_bytes + rc.freed_bytes;
+    allocated_at_trace = allocated_bytes;
+    tracer.reset_freed();
+    collection_stats = GCCollectionStats();
+    collection_stats.collections = header.collection_count;
+    collection_stats.total_pause_ns = header.total_collection_time * 1000;
+
+    if (rc.zero_count_table)
+    {
+        for (int id : roots)
+        {
+            objects[id].ref_count--;
+        }
+        for (auto &[id, obj] : objects)
+        {
+            if (obj.ref_count == 0)
+            {
+                rc.zero_count(obj);
+            }
+        }
+    }
+    zct_retained = 0;
+    return true;
+}
+
+bool RCHeap::save_checkpoint(const std::string &path) const
+{
+    return write_checkpoint_file(path, [this](HeapSnapshotWriter &w)
+                                 { write_checkpoint(w); });
+}
+
+bool RCHeap::load_checkpoint(const std::string &path)
+{
+    MappedCheckpointFile file;
+    if (!file.open(path))
+    {
+        std::cerr << "Error: Cannot open checkpoint " << path << "\n";
+        return false;
+    }
+    return read_checkpoint(file.data(), file.size());
+}
+
+// ============================================
+// COLLECT И СТАТИСТИКА (GCInterface)
 // ============================================
 
-bool RCHeap::addroot(int obj_id)
+size_t RCHeap::collect()
 {
-    return add_root(obj_id);
+    size_t freed = run_collection(true, false);
+    if (logging_enabled)
+    {
+        std::ostringstream oss;
+        oss << "COLLECT: " << freed << " bytes freed";
+        rc_logger.log_operation(oss.str());
+    }
+    return freed;
 }
 
-bool RCHeap::removeroot(int obj_id)
+size_t RCHeap::run_collection(bool drain, bool triggered)
 {
-    return remove_root(obj_id);
+    auto start = std::chrono::high_resolution_clock::now();
+
+    std::size_t freed_before = rc.freed_bytes;
+    flush_updates();
+    if (drain && rc.zero_count_table)
+    {
+        reconcile_zct(true);
+    }
+    while (drain && rc.has_pending())
+    {
+        // При слиянии обнулённые каскадом дети ждут в zct
+        rc.process_pending(std::numeric_limits<std::size_t>::max());
+        flush_updates();
+    }
+    if (rc.buffer_candidates)
+    {
+        cycles.collect();
+    }
+    if (drain && backup_tracing)
+    {
+        tracer.collect();
+        allocated_at_trace = allocated_bytes;
+    }
+    size_t freed = rc.freed_bytes - freed_before;
+
+    record_pause(start, triggered);
+    return freed;
+}
+
+void RCHeap::record_pause(std::chrono::high_resolution_clock::time_point start, bool triggered)
+{
+    auto end = std::chrono::high_resolution_clock::now();
+    uint64_t pause = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    collection_stats.collections++;
+    if (triggered)
+    {
+        collection_stats.triggered_collections++;
+    }
+    collection_stats.last_pause_ns = pause;
+    collection_stats.last_pause_start_ns = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count());
+    collection_stats.total_pause_ns += pause;
+    collection_stats.max_pause_ns = std::max(collection_stats.max_pause_ns, pause);
+}
+
+bool RCHeap::reserve_memory(std::size_t bytes)
+{
+    maybe_end_epoch();
+    maybe_reconcile();
+    maybe_backup_trace();
+
+    // Порция отложенной работы на каждое выделение
+    if (rc.deferred)
+    {
+        rc.process_pending(deferred_budget);
+        maybe_collect_cycles();
+    }
+    // Не хватает места — досрочно доделать отложенную работу и собрать циклы
+    if (bytes > get_free_memory() && (rc.has_pending() || !rc.candidates.empty() || !rc.zct.empty() ||
+                                   !rc.modified.empty() || backup_tracing))
+    {
+        run_collection(true, true);
+    }
+    return bytes <= get_free_memory();
+}
+
+void RCHeap::maybe_collect_cycles()
+{
+    if (rc.buffer_candidates && rc.candidates.size() >= cycle_threshold)
+    {
+        run_collection(false, true);
+    }
 }
 
-bool RCHeap::addref(int from, int to)
+// ============================================
+// ОТЛОЖЕННОЕ ОСВОБОЖДЕНИЕ
+// ============================================
+
+void RCHeap::set_deferred_freeing(bool enabled, std::size_t budget_per_allocation)
 {
-    return add_ref(from, to);
+    rc.deferred = enabled;
+    deferred_budget = budget_per_allocation;
+    while (!enabled && rc.has_pending())
+    {
+        rc.process_pending(std::numeric_limits<std::size_t>::max());
+    }
 }
 
-bool RCHeap::removeref(int from, int to)
+size_t RCHeap::step(std::size_t budget)
 {
-    return remove_ref(from, to);
+    std::size_t freed_before = rc.freed_bytes;
+    rc.process_pending(budget);
+    return rc.freed_bytes - freed_before;
 }
 
-int RCHeap::getrefcount(int obj_id) const
+// ============================================
+// СБОРКА ЦИКЛОВ
+// ============================================
+
+void RCHeap::set_cycle_collection(bool enabled, std::size_t buffer_threshold)
 {
-    return get_ref_count(obj_id);
+    cycle_threshold = std::max<std::size_t>(buffer_threshold, 1);
+    if (enabled == rc.buffer_candidates)
+    {
+        return;
+    }
+    if (!enabled)
+    {
+        // Снять пометки, иначе после повторного включения эти объекты
+        // считались бы уже лежащими в буфере
+        for (int id : rc.candidates)
+        {
+            auto it = objects.find(id);
+            if (it != objects.end())
+            {
+                it->second.buffered = false;
+                it->second.color = RCColor::BLACK;
+            }
+        }
+        rc.candidates.clear();
+    }
+    rc.buffer_candidates = enabled;
 }
 
-bool RCHeap::objectexists(int obj_id) const
+size_t RCHeap::collect_cycles()
 {
-    return object_exists(obj_id);
+    return run_collection(false, false);
 }
 
-std::size_t RCHeap::getheapsize() const
+// ============================================
+// ТАБЛИЦА НУЛЕВЫХ СЧЁТЧИКОВ
+// ============================================
+
+void RCHeap::set_zero_count_table(bool enabled, std::size_t threshold)
 {
-    return get_heap_size();
+    zct_threshold = std::max<std::size_t>(threshold, 1);
+    if (enabled == rc.zero_count_table)
+    {
+        return;
+    }
+    flush_updates();
+    if (enabled)
+    {
+        rc.zero_count_table = true;
+        for (int id : roots)
+        {
+            objects[id].ref_count--;
+        }
+        // Сюда попадают и объекты, на которые никогда не ссылались
+        for (auto &[id, obj] : objects)
+        {
+            if (obj.ref_count == 0)
+            {
+                rc.zero_count(obj);
+            }
+        }
+    }
+    else
+    {
+        // После сверки в ZCT остаются только корни с нулевым счётчиком
+        reconcile_zct(true);
+        rc.zero_count_table = false;
+        for (int id : rc.zct)
+        {
+            auto it = objects.find(id);
+            if (it != objects.end())
+            {
+                it->second.in_zct = false;
+            }
+        }
+        rc.zct.clear();
+        for (int id : roots)
+        {
+            objects[id].ref_count++;
+        }
+    }
+    zct_retained = rc.zct.size();
 }
 
-std::size_t RCHeap::getrootscount() const
+size_t RCHeap::reconcile()
 {
-    return get_roots_count();
+    if (!rc.zero_count_table)
+    {
+        return 0;
+    }
+    auto start = std::chrono::high_resolution_clock::now();
+    std::size_t freed_before = rc.freed_bytes;
+    flush_updates();
+    reconcile_zct(true);
+    record_pause(start, false);
+    return rc.freed_bytes - freed_before;
 }
 
-std::size_t RCHeap::get_heap_size_bytes() const
+std::size_t RCHeap::reconcile_zct(bool drain_children)
 {
-    return heap_size_bytes;
-}
\ No newline at end of file
+    // Корни из ZCT переносятся в retained и в следующих проходах не
+    // просматриваются: иначе каждый шаг по длинной цепи стоил бы O(корней)
+    std::vector<int> retained;
+    std::size_t freed_before = rc.freed_objects;
+    std::size_t freed_pass;
+    do
+    {
+        freed_pass = rc.freed_objects;
+        zct_scan.clear();
+        zct_scan.swap(rc.zct);
+        for (int id : zct_scan)
+        {
+            auto it = objects.find(id);
+            if (it == objects.end() || !it->second.in_zct)
+            {
+                continue;
+            }
+            RCObject &obj = it->second;
+            if (obj.ref_count > 0)
+            {
+                obj.in_zct = false;
+            }
+            else if (roots.count(id) > 0)
+            {
+                retained.push_back(id);
+            }
+            else
+            {
+                obj.in_zct = false;
+                rc.free_object(it);
+            }
+        }
+        rc.erase_dead();
+
+        // Дети освобождённых попадают в ZCT, когда их счётчик обнулится
+        while (drain_children && rc.has_pending())
+        {
+            rc.process_pending(std::numeric_limits<std::size_t>::max());
+        }
+    } while (drain_children && rc.freed_objects != freed_pass);
+
+    rc.zct.insert(rc.zct.end(), retained.begin(), retained.end());
+    zct_retained = rc.zct.size();
+    return rc.freed_objects - freed_before;
+}
+
+void RCHeap::maybe_reconcile()
+{
+    if (rc.zero_count_table && rc.zct.size() >= zct_retained + zct_threshold)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        flush_updates();
+        reconcile_zct(!rc.deferred);
+        record_pause(start, true);
+    }
+}
+
+// ============================================
+// СЛИЯНИЕ ОБНОВЛЕНИЙ СЧЁТЧИКОВ
+// ============================================
+
+void RCHeap::set_coalescing(bool enabled, std::size_t buffer_threshold)
+{
+    epoch_threshold = std::max<std::size_t>(buffer_threshold, 1);
+    if (!enabled && rc.coalescing)
+    {
+        flush_updates();
+    }
+    rc.coalescing = enabled;
+}
+
+size_t RCHeap::end_epoch()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::size_t freed_before = rc.freed_bytes;
+    flush_updates();
+    record_pause(start, false);
+    return rc.freed_bytes - freed_before;
+}
+
+void RCHeap::flush_updates()
+{
+    if (!rc.modified.empty())
+    {
+        rc.apply_coalesced();
+    }
+    if (rc.zero_count_table)
+    {
+        return;
+    }
+
+    // Каскад при слиянии тоже откладывает обнуления в zct — до пустой таблицы
+    while (!rc.zct.empty())
+    {
+        zct_scan.clear();
+        zct_scan.swap(rc.zct);
+        for (int id : zct_scan)
+        {
+            auto it = objects.find(id);
+            if (it == objects.end() || !it->second.in_zct)
+            {
+                continue;
+            }
+            it->second.in_zct = false;
+            if (it->second.ref_count == 0 && roots.count(id) == 0)
+            {
+                rc.cascade_delete(id);
+            }
+        }
+    }
+}
+
+void RCHeap::maybe_end_epoch()
+{
+    if (rc.modified.size() >= epoch_threshold)
+    {
+        auto start = std::chrono::high_resolution_clock::now();
+        flush_updates();
+        record_pause(start, true);
+    }
+}
+
+// ============================================
+// РЕЗЕРВНАЯ ТРАССИРОВКА
+// ============================================
+
+void RCHeap::set_backup_tracing(bool enabled, std::size_t interval_bytes)
+{
+    trace_interval = std::max<std::size_t>(interval_bytes, 1);
+    if (enabled && !backup_tracing)
+    {
+        allocated_at_trace = allocated_bytes;
+    }
+    backup_tracing = enabled;
+}
+
+size_t RCHeap::backup_trace()
+{
+    if (!backup_tracing)
+    {
+        return 0;
+    }
+    return run_collection(true, false);
+}
+
+void RCHeap::maybe_backup_trace()
+{
+    if (backup_tracing && allocated_bytes - allocated_at_trace >= trace_interval)
+    {
+        run_collection(true, true);
+    }
+}
+
+std::string RCHeap::get_heap_info() const
+{
+    std::string result;
+    HeapSnapshotWriter writer([&result](const char *data, size_t size) { result.append(data, size); });
+    write_heap_info(writer);
+    writer.flush();
+    return result;
+}
+
+void RCHeap::write_heap_info(HeapSnapshotWriter &w) const
+{
+    // Входящие ссылки RC не хранит — собираются одним проходом для refs_from
+    std::unordered_map<int, std::vector<int>> incoming;
+    for (const auto &entry : objects)
+    {
+        for (int target : entry.second.references)
+        {
+            incoming[target].push_back(entry.first);
+        }
+    }
+
+    w.write("{\n \"total_objects\": ");
+    w.write_uint(objects.size());
+    w.write(",\n \"alive_objects\": ");
+    w.write_int(get_alive_objects_count());
+    w.write(",\n \"total_memory\": ");
+    w.write_uint(get_total_memory());
+    w.write(",\n \"free_memory\": ");
+    w.write_uint(get_free_memory());
+    w.write(",\n \"objects\": [\n");
+
+    bool first = true;
+    for (const auto &entry : objects)
+    {
+        const RCObject &obj = entry.second;
+        if (!first)
+        {
+            w.write(",\n", 2);
+        }
+        first = false;
+
+        w.write(" {\n  \"id\": ");
+        w.write_int(obj.id);
+        w.write(",\n  \"size\": ");
+        w.write_uint(static_cast<uint64_t>(obj.size));
+        w.write(",\n  \"marked\": ");
+        w.write_bool(obj.marked);
+        w.write(",\n  \"is_root\": ");
+        w.write_bool(roots.count(obj.id) > 0);
+        // Освобождённые объекты сразу удаляются из objects
+        w.write(",\n  \"alive\": ");
+        w.write_bool(true);
+        w.write(",\n  \"refs_to\": [");
+        bool first_ref = true;
+        for (int ref_id : obj.references)
+        {
+            if (!first_ref)
+            {
+                w.write(", ", 2);
+            }
+            first_ref = false;
+            w.write_int(ref_id);
+        }
+        w.write("],\n  \"refs_from\": [");
+        first_ref = true;
+        auto from = incoming.find(obj.id);
+        if (from != incoming.end())
+        {
+            for (int ref_id : from->second)
+            {
+                if (!first_ref)
+                {
+                    w.write(", ", 2);
+                }
+                first_ref = false;
+                w.write_int(ref_id);
+            }
+        }
+        w.write("]\n }");
+    }
+
+    w.write("\n ]\n}\n");
+}
+
+std::string RCHeap::get_gc_stats() const
+{
+    std::ostringstream oss;
+    oss << "Reference Counting: " << objects.size() << " alive objects, "
+        << rc.freed_objects << " freed, "
+        << cycles.get_runs() << " cycle collections, "
+        << tracer.get_runs() << " backup traces, "
+        << get_total_memory() << " bytes used";
+    return oss.str();
+}
+
+std::string RCHeap::get_last_operation_log() const
+{
+    const std::vector<std::string> &history = rc_logger.get_history();
+    return history.empty() ? "" : history.back();
+}
+
+size_t RCHeap::get_total_memory() const
+{
+    return allocated_bytes - rc.freed_bytes;
+}
+
+size_t RCHeap::get_free_memory() const
+{
+    size_t used = get_total_memory();
+    return used < heap_size_bytes ? heap_size_bytes - used : 0;
+}
+
+void RCHeap::set_logging_enabled(bool enabled)
+{
+    logging_enabled = enabled;
+    rc.logging_enabled = enabled;
+}
@@ -21,6 +21,7 @@ RCLogger::~RCLogger()
 
 void RCLogger::log_operation(const std::string &operation)
 {
+    history.push_back(operation);
     if (log_file.is_open())
     {
         log_file << "[Step " << current_step << "] " << operation << std::endl;
@@ -1,5 +1,7 @@
 #include "reference_counter.h"
+#include <algorithm>
 #include <iostream>
+#include <utility>
 
 ReferenceCounter::ReferenceCounter(std::unordered_map<int, RCObject> &heap_, EventLogger &logger_)
     : heap(heap_), logger(logger_) {}
@@ -20,14 +22,33 @@ bool ReferenceCounter::add_ref(int from, int to)
         return false;
     }
 
+    // В режиме слияния счётчик изменит конец эпохи. Если ссылку на
+    // объект с нулевым счётчиком снимут в той же эпохе, чистая разница
+    // будет нулевой — поэтому он сразу ждёт проверки в zct
+    if (coalescing)
+    {
+        log_modification(src);
+        src.add_outgoing_ref(to);
+        if (dst.ref_count == 0)
+        {
+            zero_count(dst);
+        }
+        return true;
+    }
+
     src.add_outgoing_ref(to);
     dst.ref_count++;
-    logger.log_add_ref(from, to, dst.ref_count);
+    count_updates++;
+    dst.color = RCColor::BLACK;
+    if (logging_enabled)
+    {
+        logger.log_add_ref(from, to, dst.ref_count);
+    }
 
     return true;
 }
 
-bool ReferenceCounter::remove_ref_no_cascade(int from, int to)
+bool ReferenceCounter::remove_ref(int from, int to)
 {
     if (!heap.count(from) || !heap.count(to))
     {
@@ -43,83 +64,239 @@ bool ReferenceCounter::remove_ref_no_cascade(int from, int to)
         return false;
     }
 
+    if (coalescing)
+    {
+        log_modification(src);
+        src.remove_outgoing_ref(to);
+        return true;
+    }
+
     src.remove_outgoing_ref(to);
     dst.ref_count--;
-    logger.log_remove_ref(from, to, dst.ref_count);
-
-    // НЕ вызываем cascade_delete здесь
-    return true;
-}
-bool ReferenceCounter::remove_ref(int from, int to)
-{
-    if (!heap.count(from) || !heap.count(to))
+    count_updates++;
+    if (logging_enabled)
     {
-        std::cerr << "remove_ref error: invalid object\n";
-        return false;
+        logger.log_remove_ref(from, to, dst.ref_count);
     }
-
-    RCObject &src = heap[from];
-    RCObject &dst = heap[to];
-
-    if (!src.has_reference_to(to))
+    if (dst.ref_count > 0)
     {
-        return false;
+        possible_root(dst);
     }
 
-    src.remove_outgoing_ref(to);
-    dst.ref_count--;
-    logger.log_remove_ref(from, to, dst.ref_count);
-
     // НЕ запускаем каскадное удаление здесь - это будет сделано в RCHeap::remove_ref
     // если объект действительно нужно удалить
     return true;
 }
 
+// Размер пачки удалений: итераторы копятся, пока обход идёт по
+// соседним объектам, и удаляются вместе; память на пачку ограничена
+static const std::size_t CASCADE_ERASE_BATCH = 4096;
+
 void ReferenceCounter::cascade_delete(int obj_id)
 {
-    if (!heap.count(obj_id))
+    auto it = heap.find(obj_id);
+    if (it == heap.end())
     {
         return;
     }
 
-    RCObject &obj = heap[obj_id];
-
     // Удаляем только если ref_count == 0
-    if (obj.ref_count != 0)
+    if (it->second.ref_count != 0)
     {
-        std::cout << "  [CASCADE SKIP] obj_" << obj_id << " has ref_count=" << obj.ref_count << std::endl;
+        if (logging_enabled)
+        {
+            std::cout << "  [CASCADE SKIP] obj_" << obj_id << " has ref_count=" << it->second.ref_count << std::endl;
+        }
         return;
     }
 
-    // Получаем детей перед удалением объекта
-    std::vector<int> children = obj.references;
+    free_object(it);
+    if (!deferred)
+    {
+        process_pending(static_cast<std::size_t>(-1));
+    }
+    erase_dead();
+}
+
+std::size_t ReferenceCounter::process_pending(std::size_t budget)
+{
+    // Во время обхода в heap ничего не вставляется, поэтому итераторы
+    // из dead остаются валидными до erase_dead(). Ребёнок из pending
+    // не может быть удалён раньше, чем до него дойдёт очередь: ссылка
+    // освобождённого родителя ещё входит в его ref_count.
+    std::size_t done = 0;
+    while (done < budget && !pending.empty())
+    {
+        PendingFrame &frame = pending.back();
+        if (frame.next == frame.children.size())
+        {
+            pending.pop_back();
+            continue;
+        }
+        int parent = frame.id;
+        int child = frame.children[frame.next++];
+        if (frame.next == frame.children.size())
+        {
+            // Кадр исчерпан до спуска к ребёнку: на цепи стек не растёт
+            pending.pop_back();
+        }
+        done++;
+
+        auto child_it = heap.find(child);
+        if (child_it == heap.end())
+        {
+            continue;
+        }
+        RCObject &child_obj = child_it->second;
+        child_obj.ref_count--;
+        if (logging_enabled)
+        {
+            logger.log_remove_ref(parent, child, child_obj.ref_count);
+            std::cout << "  [CASCADE] Decreased ref_count for obj_" << child
+                      << " (now: " << child_obj.ref_count << ")" << std::endl;
+        }
+        if (child_obj.ref_count == 0 && (zero_count_table || coalescing))
+        {
+            zero_count(child_obj);
+        }
+        else if (child_obj.ref_count == 0)
+        {
+            free_object(child_it);
+        }
+        else
+        {
+            possible_root(child_obj);
+        }
+        if (dead.size() >= CASCADE_ERASE_BATCH)
+        {
+            erase_dead();
+        }
+    }
+    erase_dead();
+    return done;
+}
+
+void ReferenceCounter::free_object(std::unordered_map<int, RCObject>::iterator it)
+{
+    RCObject &obj = it->second;
+    freed_objects++;
+    freed_bytes += static_cast<std::size_t>(obj.size);
+    if (logging_enabled)
+    {
+        int obj_size = obj.size > 0 ? obj.size : 64;
+        logger.log_delete(obj.id);
+        std::cout << "  [CASCADE] Deleted obj_" << obj.id << " (" << obj_size << " bytes)" << std::endl;
+    }
 
-    // Получаем размер объекта
-    int obj_size = obj.size > 0 ? obj.size : 64;
+    if (!obj.references.empty())
+    {
+        pending.push_back(PendingFrame{it->first, std::move(obj.references), 0});
+    }
+    dead.push_back(it);
+}
 
-    // Удаляем объект из кучи
-    heap.erase(obj_id);
-    logger.log_delete(obj_id);
+void ReferenceCounter::possible_root(RCObject &obj)
+{
+    if (!buffer_candidates || obj.color == RCColor::PURPLE)
+    {
+        return;
+    }
+    obj.color = RCColor::PURPLE;
+    if (!obj.buffered)
+    {
+        obj.buffered = true;
+        candidates.push_back(obj.id);
+    }
+}
 
-    std::cout << "  [CASCADE] Deleted obj_" << obj_id << " (" << obj_size << " bytes)" << std::endl;
+void ReferenceCounter::zero_count(RCObject &obj)
+{
+    if (!obj.in_zct)
+    {
+        obj.in_zct = true;
+        zct.push_back(obj.id);
+    }
+}
 
-    // Рекурсивно обрабатываем детей
-    for (int child : children)
+void ReferenceCounter::log_modification(RCObject &obj)
+{
+    if (!obj.logged)
     {
-        if (heap.count(child))
+        obj.logged = true;
+        modified.push_back(ModifiedEntry{obj.id, std::vector<int>(obj.references.begin(), obj.references.end())});
+    }
+}
+
+void ReferenceCounter::apply_coalesced()
+{
+    // Объекты из журнала не освобождаются до конца эпохи: обнуления
+    // в это время откладываются в zct
+    for (ModifiedEntry &entry : modified)
+    {
+        auto it = heap.find(entry.id);
+        if (it == heap.end())
         {
-            RCObject &child_obj = heap[child];
-            child_obj.ref_count--;
-            logger.log_remove_ref(obj_id, child, child_obj.ref_count);
+            continue;
+        }
+        RCObject &obj = it->second;
+        obj.logged = false;
 
-            std::cout << "  [CASCADE] Decreased ref_count for obj_" << child
-                      << " (now: " << child_obj.ref_count << ")" << std::endl;
+        current_refs.assign(obj.references.begin(), obj.references.end());
+        std::sort(current_refs.begin(), current_refs.end());
+        std::sort(entry.old_references.begin(), entry.old_references.end());
 
-            // Если ref_count стал 0, удаляем рекурсивно
-            if (child_obj.ref_count == 0)
+        // Появившиеся цели — сразу, пропавшие — после всех увеличений
+        auto old_it = entry.old_references.begin();
+        for (int target : current_refs)
+        {
+            while (old_it != entry.old_references.end() && *old_it < target)
             {
-                cascade_delete(child);
+                decrements.push_back(*old_it++);
             }
+            if (old_it != entry.old_references.end() && *old_it == target)
+            {
+                ++old_it;
+                continue;
+            }
+            auto target_it = heap.find(target);
+            if (target_it != heap.end())
+            {
+                target_it->second.ref_count++;
+                target_it->second.color = RCColor::BLACK;
+                count_updates++;
+            }
+        }
+        decrements.insert(decrements.end(), old_it, entry.old_references.end());
+    }
+    modified.clear();
+
+    for (int target : decrements)
+    {
+        auto target_it = heap.find(target);
+        if (target_it == heap.end())
+        {
+            continue;
+        }
+        RCObject &obj = target_it->second;
+        obj.ref_count--;
+        count_updates++;
+        if (obj.ref_count == 0)
+        {
+            zero_count(obj);
+        }
+        else
+        {
+            possible_root(obj);
         }
     }
-}
\ No newline at end of file
+    decrements.clear();
+}
+
+void ReferenceCounter::erase_dead()
+{
+    for (auto it : dead)
+    {
+        heap.erase(it);
+    }
+    dead.clear();
+}